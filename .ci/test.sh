@@ -69,6 +69,33 @@ if [[ $TASK == "if-else" ]]; then
     exit 0
 fi
 
+if [[ $TASK == "float-hist" ]]; then
+    conda install -q -y -n $CONDA_ENV numpy
+    mkdir $BUILD_DIRECTORY/build && cd $BUILD_DIRECTORY/build && cmake .. && make lightgbm -j4 || exit -1
+    cd $BUILD_DIRECTORY/tests/cpp_test && ../../lightgbm config=train.conf && ../../lightgbm config=predict.conf output_result=double_hist.pred || exit -1
+    cd $BUILD_DIRECTORY/build && cmake -DUSE_FLOAT_HIST=ON -DBUILD_CPP_TEST=ON .. && make -j4 && ctest --output-on-failure || exit -1
+    cd $BUILD_DIRECTORY/tests/cpp_test && ../../lightgbm config=train.conf && ../../lightgbm config=predict.conf output_result=float_hist.pred && python test.py 1e-5 || exit -1
+    exit 0
+fi
+
+if [[ $TASK == "cpp-tests" ]]; then
+    mkdir $BUILD_DIRECTORY/build && cd $BUILD_DIRECTORY/build && cmake -DBUILD_CPP_TEST=ON .. && make -j4 || exit -1
+    ctest --output-on-failure || exit -1
+    exit 0
+fi
+
+if [[ $TASK == "compiled-model" ]]; then
+    mkdir $BUILD_DIRECTORY/build && cd $BUILD_DIRECTORY/build && cmake .. && make lightgbm -j4 || exit -1
+    for EXAMPLE in binary_classification:binary regression:regression multiclass_classification:multiclass; do
+        EXAMPLE_DIR=$BUILD_DIRECTORY/examples/${EXAMPLE%%:*}
+        MODEL=$BUILD_DIRECTORY/build/${EXAMPLE##*:}.model.txt
+        cd $EXAMPLE_DIR && ../../lightgbm config=train.conf output_model=$MODEL || exit -1
+        cd $BUILD_DIRECTORY/build && cmake -DCOMPILED_MODEL=$MODEL -DCOMPILED_MODEL_DATA=$EXAMPLE_DIR/${EXAMPLE##*:}.test .. || exit -1
+        make check_compiled_model -j4 && ctest -R compiled_model --output-on-failure || exit -1
+    done
+    exit 0
+fi
+
 if [[ "${TASK:0:9}" == "r-package" ]]; then
     bash ${BUILD_DIRECTORY}/.ci/test_r_package.sh || exit -1
     exit 0
@@ -8,6 +8,7 @@
 #include <LightGBM/meta.h>
 #include <LightGBM/utils/common.h>
 #include <LightGBM/utils/file_io.h>
+#include <LightGBM/utils/quantile_sketch.h>
 
 #include <limits>
 #include <string>
@@ -29,10 +30,23 @@ enum MissingType {
   NaN
 };
 
+// Enable following macro to use float for hist_t
+// #define HIST_T_USE_FLOAT
+
+/*!
+* \brief Type of stored histograms: the histogram pool, split finding and the network use it.
+*        float halves their memory and communication, sums are still accumulated in hist_acc_t
+*/
+#ifdef HIST_T_USE_FLOAT
+typedef float hist_t;
+#else
 typedef double hist_t;
+#endif
+/*! \brief Type in which Bin and MultiValBin accumulate histograms */
+typedef double hist_acc_t;
 typedef uint64_t hist_cnt_t;
 // check at compile time
-static_assert(sizeof(hist_t) == sizeof(hist_cnt_t), "Histogram entry size is not correct");
+static_assert(sizeof(hist_acc_t) == sizeof(hist_cnt_t), "Histogram entry size is not correct");
 
 const size_t kHistEntrySize = 2 * sizeof(hist_t);
 const int kHistOffset = 2;
@@ -41,6 +55,19 @@ const double kSparseThreshold = 0.7;
 #define GET_GRAD(hist, i) hist[(i) << 1]
 #define GET_HESS(hist, i) hist[((i) << 1) + 1]
 
+/*!
+* \brief Convert the quantized gradient and hessian of one data point to an entry of an integer histogram.
+*        The input holds the gradient as int8_t in its high byte and the hessian as uint8_t in its low byte.
+*        The entry holds the gradient in its high HIST_BITS bits and the hessian (which is non-negative)
+*        in its low HIST_BITS bits, so a single integer addition accumulates both.
+*/
+template <typename PACKED_HIST_T, int HIST_BITS>
+inline PACKED_HIST_T PackIntGradHess(int16_t int_grad_hess) {
+  return static_cast<PACKED_HIST_T>(static_cast<int8_t>(int_grad_hess >> 8)) *
+             (static_cast<PACKED_HIST_T>(1) << HIST_BITS) +
+         static_cast<PACKED_HIST_T>(int_grad_hess & 0xff);
+}
+
 inline static void HistogramSumReducer(const char* src, char* dst, int type_size, comm_size_t len) {
   comm_size_t used_size = 0;
   const hist_t* p1;
@@ -160,6 +187,15 @@ class BinMapper {
   void FindBin(double* values, int num_values, size_t total_sample_cnt, int max_bin, int min_data_in_bin, int min_split_data, bool pre_filter, BinType bin_type,
                bool use_missing, bool zero_as_missing, const std::vector<double>& forced_upper_bounds);
 
+  /*!
+  * \brief Construct feature value to bin mapper according to a sketch of feature values, see FindBin
+  * \param sketch Compacted sketch of the non-zero values of this feature
+  * \param total_cnt Number of data summarized by the sketch, including zeros
+  */
+  void FindBinFromSketch(const QuantileSketch& sketch, size_t total_cnt, int max_bin, int min_data_in_bin, int min_split_data,
+                         bool pre_filter, BinType bin_type, bool use_missing, bool zero_as_missing,
+                         const std::vector<double>& forced_upper_bounds);
+
   /*!
   * \brief Use specific number of bin to calculate the size of this class
   * \param bin The number of bin
@@ -199,6 +235,15 @@ class BinMapper {
   }
 
  private:
+  /*!
+  * \brief Construct bin mapper from sorted non-NaN values
+  * \param counts Number of data of each value, nullptr if each value is one data
+  * \param na_cnt Number of NaNs
+  */
+  void FindBinFromSortedValues(const double* values, const int* counts, int num_values, int na_cnt, size_t total_cnt,
+                               int max_bin, int min_data_in_bin, int min_split_data, bool pre_filter, BinType bin_type,
+                               bool use_missing, bool zero_as_missing, const std::vector<double>& forced_upper_bounds);
+
   /*! \brief Number of bins */
   int num_bin_;
   MissingType missing_type_;
@@ -280,6 +325,15 @@ class Bin {
   virtual void LoadFromMemory(const void* memory,
     const std::vector<data_size_t>& local_used_indices) = 0;
 
+  /*!
+  * \brief Load all data from memory written by SaveBinaryToFile, dense bins read the memory
+  *        in place instead of copying it, so it must outlive this bin and must not be modified.
+  *        The bin should be created with 0 data
+  * \param memory
+  * \param num_data Number of data
+  */
+  virtual void LoadFromMemoryInPlace(const void* memory, data_size_t num_data) = 0;
+
   /*!
   * \brief Get sizes in byte of this object
   */
@@ -307,11 +361,11 @@ class Bin {
   virtual void ConstructHistogram(
     const data_size_t* data_indices, data_size_t start, data_size_t end,
     const score_t* ordered_gradients, const score_t* ordered_hessians,
-    hist_t* out) const = 0;
+    hist_acc_t* out) const = 0;
 
   virtual void ConstructHistogram(data_size_t start, data_size_t end,
     const score_t* ordered_gradients, const score_t* ordered_hessians,
-    hist_t* out) const = 0;
+    hist_acc_t* out) const = 0;
 
   /*!
   * \brief Construct histogram of this feature,
@@ -327,10 +381,34 @@ class Bin {
   * \param out Output Result
   */
   virtual void ConstructHistogram(const data_size_t* data_indices, data_size_t start, data_size_t end,
-                                  const score_t* ordered_gradients, hist_t* out) const = 0;
+                                  const score_t* ordered_gradients, hist_acc_t* out) const = 0;
 
   virtual void ConstructHistogram(data_size_t start, data_size_t end,
-                                  const score_t* ordered_gradients, hist_t* out) const = 0;
+                                  const score_t* ordered_gradients, hist_acc_t* out) const = 0;
+
+  /*!
+  * \brief Construct integer histogram of this feature from quantized gradients and hessians,
+  *        each entry holds 16 bits of gradient and 16 bits of hessian, see PackIntGradHess
+  * \param data_indices Used data indices in current leaf
+  * \param start start index in data_indices
+  * \param end end index in data_indices
+  * \param ordered_int_grad_hess Quantized gradient and hessian of the data_indices[i]-th data at index i
+  * \param out Output Result
+  */
+  virtual void ConstructHistogramInt32(const data_size_t* data_indices, data_size_t start, data_size_t end,
+                                       const int16_t* ordered_int_grad_hess, int32_t* out) const = 0;
+
+  virtual void ConstructHistogramInt32(data_size_t start, data_size_t end,
+                                       const int16_t* ordered_int_grad_hess, int32_t* out) const = 0;
+
+  /*!
+  * \brief Same as ConstructHistogramInt32, with 32 bits of gradient and 32 bits of hessian in each entry
+  */
+  virtual void ConstructHistogramInt64(const data_size_t* data_indices, data_size_t start, data_size_t end,
+                                       const int16_t* ordered_int_grad_hess, int64_t* out) const = 0;
+
+  virtual void ConstructHistogramInt64(data_size_t start, data_size_t end,
+                                       const int16_t* ordered_int_grad_hess, int64_t* out) const = 0;
 
   virtual data_size_t Split(uint32_t min_bin, uint32_t max_bin,
                             uint32_t default_bin, uint32_t most_freq_bin,
@@ -426,18 +504,49 @@ class MultiValBin {
                                   data_size_t start, data_size_t end,
                                   const score_t* gradients,
                                   const score_t* hessians,
-                                  hist_t* out) const = 0;
+                                  hist_acc_t* out) const = 0;
 
   virtual void ConstructHistogram(data_size_t start, data_size_t end,
                                   const score_t* gradients,
                                   const score_t* hessians,
-                                  hist_t* out) const = 0;
+                                  hist_acc_t* out) const = 0;
 
   virtual void ConstructHistogramOrdered(const data_size_t* data_indices,
                                          data_size_t start, data_size_t end,
                                          const score_t* ordered_gradients,
                                          const score_t* ordered_hessians,
-                                         hist_t* out) const = 0;
+                                         hist_acc_t* out) const = 0;
+
+  /*!
+  * \brief Integer versions of the above from quantized gradients and hessians, see PackIntGradHess
+  */
+  virtual void ConstructHistogramInt32(const data_size_t* data_indices,
+                                       data_size_t start, data_size_t end,
+                                       const int16_t* int_grad_hess,
+                                       int32_t* out) const = 0;
+
+  virtual void ConstructHistogramInt32(data_size_t start, data_size_t end,
+                                       const int16_t* int_grad_hess,
+                                       int32_t* out) const = 0;
+
+  virtual void ConstructHistogramOrderedInt32(const data_size_t* data_indices,
+                                              data_size_t start, data_size_t end,
+                                              const int16_t* ordered_int_grad_hess,
+                                              int32_t* out) const = 0;
+
+  virtual void ConstructHistogramInt64(const data_size_t* data_indices,
+                                       data_size_t start, data_size_t end,
+                                       const int16_t* int_grad_hess,
+                                       int64_t* out) const = 0;
+
+  virtual void ConstructHistogramInt64(data_size_t start, data_size_t end,
+                                       const int16_t* int_grad_hess,
+                                       int64_t* out) const = 0;
+
+  virtual void ConstructHistogramOrderedInt64(const data_size_t* data_indices,
+                                              data_size_t start, data_size_t end,
+                                              const int16_t* ordered_int_grad_hess,
+                                              int64_t* out) const = 0;
 
   virtual void FinishLoad() = 0;
 
@@ -150,6 +150,60 @@ class LIGHTGBM_EXPORT Boosting {
   virtual void PredictByMap(const std::unordered_map<int, double>& features, double* output,
                             const PredictionEarlyStopInstance* early_stop) const = 0;
 
+  /*!
+  * \brief Prediction for a block of dense records, not sigmoid transform.
+  *        Each tree is applied to all records of the block before moving to the next tree,
+  *        so no early stopping is applied.
+  * \param features Feature values, record i starts at features + i * row_stride
+  * \param num_rows Number of records in the block
+  * \param row_stride Distance between two records, must be larger than the max feature index
+  * \param output Prediction result, NumberOfClasses() values for each record
+  */
+  virtual void PredictRawBlock(const double* features, int num_rows, int row_stride,
+                               double* output) const = 0;
+
+  /*!
+  * \brief Prediction for a block of dense records, sigmoid transformation will be used if needed.
+  *        Each tree is applied to all records of the block before moving to the next tree,
+  *        so no early stopping is applied.
+  * \param features Feature values, record i starts at features + i * row_stride
+  * \param num_rows Number of records in the block
+  * \param row_stride Distance between two records, must be larger than the max feature index
+  * \param output Prediction result, NumberOfClasses() values for each record
+  */
+  virtual void PredictBlock(const double* features, int num_rows, int row_stride,
+                            double* output) const = 0;
+
+  /*!
+  * \brief Get upper bounds of bins of one feature, used to bin records for PredictBinned.
+  *        Value x is in bin i if bounds[i - 1] < x <= bounds[i], i.e. i is the number of bounds smaller than x.
+  * \param feature_idx Index of the feature
+  * \return Upper bounds of bins, the last bin has no upper bound
+  */
+  virtual std::vector<double> FeatureBinUpperBounds(int feature_idx) = 0;
+
+  /*!
+  * \brief Initial work for the prediction of binned records, fails if the model cannot be used on them
+  * \param start_iteration Start index of the iteration to predict
+  * \param num_iteration Number of used iteration
+  * \param max_num_bin Number of bins which the bin type can hold, the max value is kept for missing value
+  */
+  virtual void InitBinnedPredict(int start_iteration, int num_iteration, int max_num_bin) = 0;
+
+  /*!
+  * \brief Prediction for one record binned by FeatureBinUpperBounds
+  * \param bins Bin of each feature, bin of feature j is bins[j * bin_stride], 255 stands for missing value
+  * \param bin_stride Distance between bins of two features
+  * \param is_raw_score True to skip the output transformation
+  * \param output Prediction result for this record
+  */
+  virtual void PredictBinned(const uint8_t* bins, int64_t bin_stride, bool is_raw_score, double* output) const = 0;
+
+  /*!
+  * \brief Same as the uint8_t version, 65535 stands for missing value
+  */
+  virtual void PredictBinned(const uint16_t* bins, int64_t bin_stride, bool is_raw_score, double* output) const = 0;
+
 
   /*!
   * \brief Prediction for one record with leaf index
@@ -169,6 +223,17 @@ class LIGHTGBM_EXPORT Boosting {
   */
   virtual void PredictContrib(const double* features, double* output) const = 0;
 
+  /*!
+  * \brief Feature contributions for a block of dense records.
+  *        Runs on the calling thread, callers predict several blocks in parallel.
+  * \param features Feature values, record i starts at features + i * row_stride
+  * \param num_rows Number of records in the block
+  * \param row_stride Distance between two records, must be larger than the max feature index
+  * \param output Contributions, same as PredictContrib for each record, one record after another
+  */
+  virtual void PredictContribBlock(const double* features, int num_rows, int row_stride,
+                                   double* output) const = 0;
+
   virtual void PredictContribByMap(const std::unordered_map<int, double>& features,
                                    std::vector<std::unordered_map<int, double>>* output) const = 0;
 
@@ -196,15 +261,34 @@ class LIGHTGBM_EXPORT Boosting {
   */
   virtual bool SaveModelToIfElse(int num_iteration, const char* filename) const = 0;
 
+  /*!
+  * \brief Translate model to a self-contained C source exporting a stable C ABI
+  * \param num_iteration Number of iterations that want to translate, -1 means translate all
+  * \param prefix Prefix of the exported functions
+  * \return C source of model
+  */
+  virtual std::string ModelToC(int num_iteration, const std::string& prefix) const = 0;
+
+  /*!
+  * \brief Translate model to a self-contained C source exporting a stable C ABI
+  * \param num_iteration Number of iterations that want to translate, -1 means translate all
+  * \param prefix Prefix of the exported functions
+  * \param filename Filename that want to save to
+  * \return true if succeeded
+  */
+  virtual bool SaveModelToC(int num_iteration, const std::string& prefix, const char* filename) const = 0;
+
   /*!
   * \brief Save model to file
   * \param start_iteration The model will be saved start from
   * \param num_iterations Number of model that want to save, -1 means save all
   * \param feature_importance_type Type of feature importance, 0: split, 1: gain
   * \param filename Filename that want to save to
+  * \param is_binary Save in binary form instead of text, see LoadModelFromBinaryFile
   * \return true if succeeded
   */
-  virtual bool SaveModelToFile(int start_iteration, int num_iterations, int feature_importance_type, const char* filename) const = 0;
+  virtual bool SaveModelToFile(int start_iteration, int num_iterations, int feature_importance_type,
+                               const char* filename, bool is_binary) const = 0;
 
   /*!
   * \brief Save model to string
@@ -223,6 +307,14 @@ class LIGHTGBM_EXPORT Boosting {
   */
   virtual bool LoadModelFromString(const char* buffer, size_t len) = 0;
 
+  /*!
+  * \brief Restore from a file saved with is_binary. The file is memory mapped
+  *        and the packed trees used for prediction are used in place while this object lives
+  * \param filename Filename of the model
+  * \return true if succeeded
+  */
+  virtual bool LoadModelFromBinaryFile(const char* filename) = 0;
+
   /*!
   * \brief Calculate feature importances
   * \param num_iteration Number of model that want to use for feature importance, -1 means use all
@@ -303,6 +395,9 @@ class LIGHTGBM_EXPORT Boosting {
 
   static bool LoadFileToBoosting(Boosting* boosting, const char* filename);
 
+  /*! \brief Token at the start of binary model files */
+  static const char* binary_model_token;
+
   /*!
   * \brief Create boosting object
   * \param type Type of boosting
@@ -23,11 +23,14 @@
 typedef void* DatasetHandle;  /*!< \brief Handle of dataset. */
 typedef void* BoosterHandle;  /*!< \brief Handle of booster. */
 typedef void* FastConfigHandle; /*!< \brief Handle of FastConfig. */
+typedef void* FrozenBoosterHandle; /*!< \brief Handle of frozen booster. */
 
 #define C_API_DTYPE_FLOAT32 (0)  /*!< \brief float32 (single precision float). */
 #define C_API_DTYPE_FLOAT64 (1)  /*!< \brief float64 (double precision float). */
 #define C_API_DTYPE_INT32   (2)  /*!< \brief int32. */
 #define C_API_DTYPE_INT64   (3)  /*!< \brief int64. */
+#define C_API_DTYPE_UINT8   (4)  /*!< \brief uint8, only for binned data. */
+#define C_API_DTYPE_UINT16  (5)  /*!< \brief uint16, only for binned data. */
 
 #define C_API_PREDICT_NORMAL     (0)  /*!< \brief Normal prediction, with transform (if needed). */
 #define C_API_PREDICT_RAW_SCORE  (1)  /*!< \brief Predict raw score. */
@@ -412,7 +415,7 @@ LIGHTGBM_C_EXPORT int LGBM_BoosterCreate(const DatasetHandle train_data,
                                          BoosterHandle* out);
 
 /*!
- * \brief Load an existing booster from model file.
+ * \brief Load an existing booster from model file, in text form or in binary form saved by ``LGBM_BoosterSaveModelBinary``.
  * \param filename Filename of model
  * \param[out] out_num_iterations Number of iterations of this booster
  * \param[out] out Handle of created booster
@@ -1107,6 +1110,124 @@ LIGHTGBM_C_EXPORT int LGBM_BoosterPredictForMatSingleRowFast(FastConfigHandle fa
                                                              int64_t* out_len,
                                                              double* out_result);
 
+/*!
+ * \brief Create a read-only copy of the booster for single row prediction from many threads.
+ * \note
+ *   The frozen booster owns a copy of the current model, later changes of the booster are not visible in it.
+ *   Its prediction functions take no lock and can be called concurrently from any number of threads.
+ *   Release it with ``LGBM_FrozenBoosterFree`` when no longer needed.
+ * \param handle Handle of booster
+ * \param predict_type What should be predicted
+ *   - ``C_API_PREDICT_NORMAL``: normal prediction, with transform (if needed);
+ *   - ``C_API_PREDICT_RAW_SCORE``: raw score;
+ *   - ``C_API_PREDICT_LEAF_INDEX``: leaf index;
+ *   - ``C_API_PREDICT_CONTRIB``: feature contributions (SHAP values)
+ * \param start_iteration Start index of the iteration to predict
+ * \param num_iteration Number of iteration for prediction, <= 0 means no limit
+ * \param parameter Other parameters for prediction, e.g. early stopping for prediction
+ * \param[out] out Handle of created frozen booster
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_BoosterFreeze(BoosterHandle handle,
+                                         int predict_type,
+                                         int start_iteration,
+                                         int num_iteration,
+                                         const char* parameter,
+                                         FrozenBoosterHandle* out);
+
+/*!
+ * \brief Free space for frozen booster.
+ * \param handle Handle of frozen booster to be freed
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_FrozenBoosterFree(FrozenBoosterHandle handle);
+
+/*!
+ * \brief Make prediction for a single row with a frozen booster, thread-safe without locking.
+ * \note
+ * You should pre-allocate memory for ``out_result``, see ``LGBM_BoosterPredictForMatSingleRow``.
+ * \param handle Handle of frozen booster
+ * \param data Single-row array data in row-major form
+ * \param data_type Type of ``data`` pointer, can be ``C_API_DTYPE_FLOAT32`` or ``C_API_DTYPE_FLOAT64``
+ * \param ncol Number of columns
+ * \param[out] out_len Length of output result
+ * \param[out] out_result Pointer to array with predictions
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_FrozenBoosterPredictForMatSingleRow(FrozenBoosterHandle handle,
+                                                               const void* data,
+                                                               int data_type,
+                                                               int32_t ncol,
+                                                               int64_t* out_len,
+                                                               double* out_result);
+
+/*!
+ * \brief Make prediction for a single row in CSR format with a frozen booster, thread-safe without locking.
+ * \note
+ * You should pre-allocate memory for ``out_result``, see ``LGBM_BoosterPredictForCSRSingleRow``.
+ * \param handle Handle of frozen booster
+ * \param indptr Pointer to row headers
+ * \param indptr_type Type of ``indptr``, can be ``C_API_DTYPE_INT32`` or ``C_API_DTYPE_INT64``
+ * \param indices Pointer to column indices
+ * \param data Pointer to the data space
+ * \param data_type Type of ``data`` pointer, can be ``C_API_DTYPE_FLOAT32`` or ``C_API_DTYPE_FLOAT64``
+ * \param nindptr Number of rows in the matrix + 1
+ * \param nelem Number of nonzero elements in the matrix
+ * \param num_col Number of columns
+ * \param[out] out_len Length of output result
+ * \param[out] out_result Pointer to array with predictions
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_FrozenBoosterPredictForCSRSingleRow(FrozenBoosterHandle handle,
+                                                               const void* indptr,
+                                                               int indptr_type,
+                                                               const int32_t* indices,
+                                                               const void* data,
+                                                               int data_type,
+                                                               int64_t nindptr,
+                                                               int64_t nelem,
+                                                               int64_t num_col,
+                                                               int64_t* out_len,
+                                                               double* out_result);
+
+/*!
+ * \brief Get the size of the scratch buffer needed by ``LGBM_FrozenBoosterPredictForMatSingleRowNoAlloc``.
+ * \param handle Handle of frozen booster
+ * \param data_type Type of the row data, can be ``C_API_DTYPE_FLOAT32`` or ``C_API_DTYPE_FLOAT64``
+ * \param ncol Number of columns
+ * \param[out] out_len Number of doubles in the scratch buffer, 0 when the row is read in place
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_FrozenBoosterGetScratchSize(FrozenBoosterHandle handle,
+                                                       int data_type,
+                                                       int32_t ncol,
+                                                       int64_t* out_len);
+
+/*!
+ * \brief Make prediction for a single row with a frozen booster, without any heap allocation.
+ * \note
+ * A ``C_API_DTYPE_FLOAT64`` row with at least as many columns as the model has features
+ * is passed to the trees as is. Other rows are converted into ``scratch``, owned by the caller.
+ *
+ * Normal, raw score and leaf index predictions don't allocate; SHAP contributions still do.
+ * \param handle Handle of frozen booster
+ * \param data Single-row array data in row-major form
+ * \param data_type Type of ``data`` pointer, can be ``C_API_DTYPE_FLOAT32`` or ``C_API_DTYPE_FLOAT64``
+ * \param ncol Number of columns
+ * \param scratch Buffer of the size given by ``LGBM_FrozenBoosterGetScratchSize``, can be ``NULL`` when that size is 0;
+ *                the same buffer must not be used by concurrent calls
+ * \param[out] out_len Length of output result
+ * \param[out] out_result Pointer to array with predictions
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_FrozenBoosterPredictForMatSingleRowNoAlloc(FrozenBoosterHandle handle,
+                                                                      const void* data,
+                                                                      int data_type,
+                                                                      int32_t ncol,
+                                                                      double* scratch,
+                                                                      int64_t* out_len,
+                                                                      double* out_result);
+
 /*!
  * \brief Make prediction for a new dataset presented in a form of array of pointers to rows.
  * \note
@@ -1143,6 +1264,62 @@ LIGHTGBM_C_EXPORT int LGBM_BoosterPredictForMats(BoosterHandle handle,
                                                  int64_t* out_len,
                                                  double* out_result);
 
+/*!
+ * \brief Get upper bounds of bins of a feature, used to bin data for ``LGBM_BoosterPredictForBinnedMat``.
+ * \note
+ * Value ``x`` of the feature is in bin ``i`` if ``out_results[i - 1] < x <= out_results[i]``,
+ * i.e. ``i`` is the number of upper bounds smaller than ``x``, and the last bin has no upper bound.
+ * Missing value (NaN) is represented by the max value of the bin type.
+ * Upper bounds are the distinct thresholds used by the model, so binned data gives the same predictions as raw data.
+ * \param handle Handle of booster
+ * \param feature_idx Index of the feature
+ * \param buffer_len Length of pre-allocated array for upper bounds
+ * \param[out] out_len Number of upper bounds
+ * \param[out] out_results Upper bounds of bins, copied up to ``buffer_len`` values
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_BoosterGetFeatureBinUpperBounds(BoosterHandle handle,
+                                                           int feature_idx,
+                                                           int64_t buffer_len,
+                                                           int64_t* out_len,
+                                                           double* out_results);
+
+/*!
+ * \brief Make prediction for a dense matrix of bins, made by ``LGBM_BoosterGetFeatureBinUpperBounds``.
+ * \note
+ * Only models without categorical splits are supported.
+ * The model should need less than 255 bins for ``C_API_DTYPE_UINT8``, less than 65535 bins for ``C_API_DTYPE_UINT16``,
+ * the max value of the type stands for missing value.
+ * You should pre-allocate memory for ``out_result``, its length is equal to ``num_class * num_data``.
+ * \param handle Handle of booster
+ * \param data Pointer to the bins
+ * \param data_type Type of ``data`` pointer, can be ``C_API_DTYPE_UINT8`` or ``C_API_DTYPE_UINT16``
+ * \param nrow Number of rows
+ * \param ncol Number of columns
+ * \param is_row_major 1 for row-major, 0 for column-major
+ * \param predict_type What should be predicted
+ *   - ``C_API_PREDICT_NORMAL``: normal prediction, with transform (if needed);
+ *   - ``C_API_PREDICT_RAW_SCORE``: raw score
+ * \param start_iteration Start index of the iteration to predict
+ * \param num_iteration Number of iteration for prediction, <= 0 means no limit
+ * \param parameter Other parameters for prediction, e.g. number of threads
+ * \param[out] out_len Length of output result
+ * \param[out] out_result Pointer to array with predictions
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_BoosterPredictForBinnedMat(BoosterHandle handle,
+                                                      const void* data,
+                                                      int data_type,
+                                                      int32_t nrow,
+                                                      int32_t ncol,
+                                                      int is_row_major,
+                                                      int predict_type,
+                                                      int start_iteration,
+                                                      int num_iteration,
+                                                      const char* parameter,
+                                                      int64_t* out_len,
+                                                      double* out_result);
+
 /*!
  * \brief Save model into file.
  * \param handle Handle of booster
@@ -1158,6 +1335,24 @@ LIGHTGBM_C_EXPORT int LGBM_BoosterSaveModel(BoosterHandle handle,
                                             int feature_importance_type,
                                             const char* filename);
 
+/*!
+ * \brief Save model into file in binary form.
+ *        Binary model files are loaded by ``LGBM_BoosterCreateFromModelfile`` much faster than text ones,
+ *        the packed trees used for prediction are memory mapped and used in place.
+ *        The file can only be loaded on machines with the same byte order.
+ * \param handle Handle of booster
+ * \param start_iteration Start index of the iteration that should be saved
+ * \param num_iteration Index of the iteration that should be saved, <= 0 means save all
+ * \param feature_importance_type Type of feature importance, can be ``C_API_FEATURE_IMPORTANCE_SPLIT`` or ``C_API_FEATURE_IMPORTANCE_GAIN``
+ * \param filename The name of the file
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_BoosterSaveModelBinary(BoosterHandle handle,
+                                                  int start_iteration,
+                                                  int num_iteration,
+                                                  int feature_importance_type,
+                                                  const char* filename);
+
 /*!
  * \brief Save model to string.
  * \param handle Handle of booster
@@ -1196,6 +1391,21 @@ LIGHTGBM_C_EXPORT int LGBM_BoosterDumpModel(BoosterHandle handle,
                                             int64_t* out_len,
                                             char* out_str);
 
+/*!
+ * \brief Save model to a self-contained C source file, which exports ``<prefix>_predict`` and friends with a C ABI.
+ * \note
+ * See the comment at the top of the generated file for the exported functions.
+ * \param handle Handle of booster
+ * \param num_iteration Index of the iteration that should be saved, <= 0 means save all
+ * \param prefix Prefix of the exported functions, should be a C identifier
+ * \param filename The name of the file
+ * \return 0 when succeed, -1 when failure happens
+ */
+LIGHTGBM_C_EXPORT int LGBM_BoosterSaveModelToC(BoosterHandle handle,
+                                               int num_iteration,
+                                               const char* prefix,
+                                               const char* filename);
+
 /*!
  * \brief Get leaf value.
  * \param handle Handle of booster
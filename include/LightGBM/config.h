@@ -248,6 +248,28 @@ struct Config {
   // desc = ``< 0`` means no limit
   double histogram_pool_size = -1.0;
 
+  // desc = max size in MB of the histograms evicted from the historical histogram cache (see ``histogram_pool_size``), kept in compressed (sparse) form
+  // desc = an evicted histogram which is needed again is restored from this storage, so the histogram subtraction is still used instead of constructing the histograms of both children
+  // desc = ``0`` means disabled, ``< 0`` means no limit
+  // desc = **Note**: only used when ``histogram_pool_size > 0``
+  double compressed_histogram_pool_size = 0.0;
+
+  // check = >0
+  // desc = number of leaves split at each step of the leaf-wise growth
+  // desc = with values larger than ``1``, the leaves with the largest gains are split together, and the histograms of their new leaves are constructed in one parallel pass, which reduces the threading overhead of small leaves
+  // desc = ``1`` grows the trees exactly one split at a time
+  // desc = **Note**: only used by the ``serial`` tree learner on ``cpu``, with col-wise histograms, ``histogram_pool_size <= 0``, ``use_quantized_grad = false`` and without ``cegb_*`` penalties or ``monotone_constraints``, otherwise ``1`` is used
+  int leaf_batch_size = 1;
+
+  // type = enum
+  // options = leaf_wise, oblivious
+  // desc = how trees are grown
+  // descl2 = ``leaf_wise``, split the leaf with the largest gain at each step
+  // descl2 = ``oblivious``, grow symmetric trees depth by depth: all the nodes of one depth use the same split, which is chosen by the sum of its gains over all the leaves of the depth. A leaf for which the split leaves less than ``min_data_in_leaf`` data or ``min_sum_hessian_in_leaf`` on a side keeps its output in both children. The prediction of these trees only computes the leaf index from the ``depth`` comparisons
+  // desc = with ``oblivious``, trees have ``2^depth`` leaves, ``depth`` is the largest one with ``2^depth <= num_leaves``, limited by ``max_depth``, e.g. the default ``num_leaves = 31`` gives trees of ``16`` leaves
+  // desc = **Note**: ``oblivious`` is only supported by the ``serial`` tree learner on ``cpu``. Categorical features are not used for its splits, ``feature_fraction_bynode`` samples the features once per depth for all its nodes, ``histogram_pool_size`` and ``extra_trees`` are ignored, and ``monotone_constraints``, ``interaction_constraints``, ``forcedsplits_filename``, ``cegb_*`` and ``use_quantized_grad`` cannot be used with it
+  std::string tree_growth_policy = "leaf_wise";
+
   // desc = limit the max depth for tree model. This is used to deal with over-fitting when ``#data`` is small. Tree still grows leaf-wise
   // desc = ``<= 0`` means no limit
   int max_depth = -1;
@@ -516,6 +538,24 @@ struct Config {
   // desc = any two features can only appear in the same branch only if there exists a constraint containing both features
   std::string interaction_constraints = "";
 
+  // desc = set this to ``true`` to quantize gradients and hessians to small integers at each iteration and build histograms with integer additions
+  // desc = this reduces the memory traffic of histogram construction, which speeds up training on large data
+  // desc = split finding and leaf values use the quantized gradients and hessians, so the model may be slightly different
+  // desc = **Note**: only supported by ``device_type = cpu``
+  bool use_quantized_grad = false;
+
+  // check = >= 2
+  // check = <= 127
+  // desc = used only if ``use_quantized_grad = true``
+  // desc = number of levels of quantized hessians, quantized gradients use ``num_grad_quant_bins / 2`` levels on each side of zero
+  // desc = larger values give more accurate histograms, the number of data in the train set times this value must be less than ``2^31``
+  int num_grad_quant_bins = 4;
+
+  // desc = used only if ``use_quantized_grad = true``
+  // desc = set this to ``true`` to round quantized gradients and hessians randomly, so that they are unbiased estimations of the original ones
+  // desc = set this to ``false`` to round them to the nearest integers
+  bool stochastic_rounding = true;
+
   // alias = verbose
   // desc = controls the level of LightGBM's verbosity
   // desc = ``< 0``: Fatal, ``= 0``: Error (Warning), ``= 1``: Info, ``> 1``: Debug
@@ -540,6 +580,12 @@ struct Config {
   // desc = **Note**: can be used only in CLI version
   int saved_feature_importance_type = 0;
 
+  // desc = set this to ``true`` to save the model file in binary form instead of text
+  // desc = binary model files load much faster, the arrays used for prediction are memory mapped and used in place
+  // desc = models in both forms can be loaded by ``input_model`` and the language-specific packages
+  // desc = **Note**: can be used only in CLI version; for language-specific packages you can use the correspondent function
+  bool saved_model_binary = false;
+
   // [no-save]
   // alias = save_period
   // desc = frequency of saving model file snapshot
@@ -577,6 +623,18 @@ struct Config {
   // desc = set this to larger value if data is very sparse
   int bin_construct_sample_cnt = 200000;
 
+  // alias = quantile_sketch
+  // desc = set this to ``true`` to construct the feature bins from all data instead of ``bin_construct_sample_cnt`` sampled data
+  // desc = each feature is summarized by a mergeable quantile sketch of at most ``quantile_sketch_size`` values in one more pass over data, in parallel learning the sketches of all machines are merged
+  // desc = the sample is still used to bundle features, and to construct the bins of categorical features, as their categories must not be merged
+  // desc = **Note**: works only in case of loading data directly from file, and not with ``stream_loading``
+  bool use_quantile_sketch = false;
+
+  // check = >=8
+  // desc = max number of values kept by the quantile sketch of each feature, used only with ``use_quantile_sketch``
+  // desc = features with at most this number of distinct values are summarized exactly, larger values give more accurate bins for the other features, but use more memory
+  int quantile_sketch_size = 4096;
+
   // alias = data_seed
   // desc = random seed for sampling data to construct histogram bins
   int data_random_seed = 1;
@@ -613,6 +671,21 @@ struct Config {
   // desc = **Note**: works only in case of loading data directly from file
   bool two_round = false;
 
+  // [no-save]
+  // alias = streaming, stream_loading_enabled
+  // desc = set this to ``true`` to load data file in one pass with bounded memory
+  // desc = the first ``stream_first_chunk_size`` lines are kept in memory to construct the feature bins, and then all lines are parsed and binned chunk by chunk without keeping the text of the whole file in memory
+  // desc = as the feature bins are constructed from the first chunk only, the lines of data file should be shuffled
+  // desc = takes precedence over ``two_round``
+  // desc = **Note**: works only in case of loading data directly from file, and for parallel learning only with ``pre_partition=true``
+  bool stream_loading = false;
+
+  // [no-save]
+  // check = >0
+  // desc = number of lines kept in memory to construct the feature bins with ``stream_loading``
+  // desc = ``bin_construct_sample_cnt`` lines are sampled from them
+  int stream_first_chunk_size = 1000000;
+
   // alias = has_header
   // desc = set this to ``true`` if input data has header
   // desc = **Note**: works only in case of loading data directly from file
@@ -678,8 +751,16 @@ struct Config {
   // desc = if ``true``, LightGBM will save the dataset (including validation data) to a binary file. This speed ups the data loading for the next time
   // desc = **Note**: ``init_score`` is not saved in binary file
   // desc = **Note**: can be used only in CLI version; for language-specific packages you can use the correspondent function
+  // desc = **Note**: binary files are saved in version 1 of the format, padded for ``mmap_binary_file``. Releases older than 3.1 cannot read them, and do not report an error when they try
   bool save_binary = false;
 
+  // [no-save]
+  // desc = set this to ``true`` to use the feature data of a binary dataset file in place from a read-only memory mapping of the file, instead of copying them into memory
+  // desc = the dataset is loaded almost instantly, and several processes using the same binary file share its pages in memory
+  // desc = **Note**: works only for local binary files saved by LightGBM 3.1 or later, and not when the data are partitioned between machines on loading
+  // desc = **Note**: the binary file must not be modified, truncated or removed while the dataset is in use, otherwise the process can crash or read corrupted data. On Windows the file stays locked as long as the dataset is in use
+  bool mmap_binary_file = false;
+
   #pragma endregion
 
   #pragma region Predict Parameters
@@ -754,7 +835,9 @@ struct Config {
 
   // [no-save]
   // desc = used only in ``convert_model`` task
-  // desc = only ``cpp`` is supported yet; for conversion model to other languages consider using `m2cgen <https://github.com/BayesWitnesses/m2cgen>`__ utility
+  // desc = ``cpp`` replaces the prediction functions of ``GBDT`` and needs the LightGBM sources to be compiled
+  // desc = ``c`` writes a self-contained C source file with a stable C ABI, taking ``float`` rows; it compiles with any C or C++ compiler, see ``convert_model_prefix``
+  // desc = for conversion model to other languages consider using `m2cgen <https://github.com/BayesWitnesses/m2cgen>`__ utility
   // desc = if ``convert_model_language`` is set and ``task=train``, the model will be also converted
   // desc = **Note**: can be used only in CLI version
   std::string convert_model_language = "";
@@ -766,6 +849,12 @@ struct Config {
   // desc = **Note**: can be used only in CLI version
   std::string convert_model = "gbdt_prediction.cpp";
 
+  // [no-save]
+  // desc = used only in ``convert_model`` task with ``convert_model_language=c``
+  // desc = prefix of the exported functions, ``<prefix>_predict`` and so on, so several models can be linked together
+  // desc = **Note**: can be used only in CLI version
+  std::string convert_model_prefix = "lgbm_model";
+
   #pragma endregion
 
   #pragma endregion
@@ -8,6 +8,7 @@
 #include <LightGBM/config.h>
 #include <LightGBM/feature_group.h>
 #include <LightGBM/meta.h>
+#include <LightGBM/utils/file_io.h>
 #include <LightGBM/utils/openmp_wrapper.h>
 #include <LightGBM/utils/random.h>
 #include <LightGBM/utils/text_reader.h>
@@ -71,6 +72,13 @@ class Metadata {
   */
   void Init(data_size_t num_data, int weight_idx, int query_idx);
 
+  /*!
+  * \brief Resize the space allocated by Init, used when the number of data is unknown while loading.
+  *        When shrinking, the space beyond num_data is released.
+  * \param num_data Number of training data
+  */
+  void ReSize(data_size_t num_data);
+
   /*!
   * \brief Partition label by used indices
   * \param used_indices Indices of local used
@@ -272,7 +280,7 @@ class Parser {
   * \param label_idx index of label column
   * \return Object of parser
   */
-  static Parser* CreateParser(const char* filename, bool header, int num_features, int label_idx);
+  LIGHTGBM_EXPORT static Parser* CreateParser(const char* filename, bool header, int num_features, int label_idx);
 };
 
 struct TrainingShareStates {
@@ -280,7 +288,6 @@ struct TrainingShareStates {
   bool is_colwise = true;
   bool is_use_subcol = false;
   bool is_use_subrow = false;
-  bool is_subrow_copied = false;
   bool is_constant_hessian = true;
   const data_size_t* bagging_use_indices;
   data_size_t bagging_indices_cnt;
@@ -290,8 +297,35 @@ struct TrainingShareStates {
   std::vector<uint32_t> hist_move_src;
   std::vector<uint32_t> hist_move_dest;
   std::vector<uint32_t> hist_move_size;
-  std::vector<hist_t, Common::AlignmentAllocator<hist_t, kAlignedSize>>
+  std::vector<hist_acc_t, Common::AlignmentAllocator<hist_acc_t, kAlignedSize>>
       hist_buf;
+  /*! \brief Histograms are accumulated here before being stored, when hist_t is not hist_acc_t */
+  std::vector<hist_acc_t, Common::AlignmentAllocator<hist_acc_t, kAlignedSize>>
+      acc_hist_buf;
+  /*! \brief Histograms of the dense feature groups for the row blocks other than the first one */
+  std::vector<hist_acc_t, Common::AlignmentAllocator<hist_acc_t, kAlignedSize>>
+      tile_hist_buf;
+  /*!
+  * \brief Leaf whose gradients and hessians DataPartition::Split gathered into the ordered buffers,
+  *        -1 if none, and the generation of the data partition they were gathered at.
+  *        They are valid while the partition keeps this generation
+  */
+  int ordered_leaf = -1;
+  uint64_t ordered_generation = 0;
+  /*!
+  * \brief Rows of the full data for the rows of the bagging subset, the histograms of
+  *        the multi-val bin read the full multi_val_bin by them instead of a copy of the subset
+  */
+  std::vector<data_size_t, Common::AlignmentAllocator<data_size_t, kAlignedSize>>
+      subrow_indices;
+  /*! \brief Gradients and hessians of the bagging subset in the order of subrow_indices */
+  std::vector<score_t, Common::AlignmentAllocator<score_t, kAlignedSize>>
+      subrow_gradients;
+  std::vector<score_t, Common::AlignmentAllocator<score_t, kAlignedSize>>
+      subrow_hessians;
+  /*! \brief Quantized gradients and hessians in the order of subrow_indices */
+  std::vector<int16_t, Common::AlignmentAllocator<int16_t, kAlignedSize>>
+      subrow_int_grad_hess;
 
   void SetMultiValBin(MultiValBin* bin) {
     num_threads = OMP_NUM_THREADS();
@@ -307,14 +341,32 @@ struct TrainingShareStates {
     }
   }
 
-  hist_t* TempBuf() {
+  /*! \brief Whether the rows of the bagging subset are read from the full multi_val_bin */
+  bool IsSubrowView() const {
+    return is_use_subrow && !is_use_subcol;
+  }
+
+  /*! \brief Multi-val bin used to construct histograms */
+  const MultiValBin* UsedMultiValBin() const {
+    return is_use_subcol ? multi_val_bin_subset.get() : multi_val_bin.get();
+  }
+
+  hist_acc_t* TempBuf() {
     if (!is_use_subcol) {
       return nullptr;
     }
     return hist_buf.data() + hist_buf.size() - num_bin_aligned * 2;
   }
 
-  void HistMove(const hist_t* src, hist_t* dest) {
+  hist_acc_t* AccHistBuf(size_t size) {
+    if (acc_hist_buf.size() < size) {
+      acc_hist_buf.resize(size);
+    }
+    return acc_hist_buf.data();
+  }
+
+  template <typename SRC_T>
+  void HistMove(const SRC_T* src, hist_t* dest) {
     if (!is_use_subcol) {
       return;
     }
@@ -489,7 +541,7 @@ class Dataset {
                                 score_t* ordered_gradients,
                                 score_t* ordered_hessians,
                                 TrainingShareStates* share_state,
-                                hist_t* hist_data) const;
+                                hist_t* hist_data, bool is_ordered) const;
 
   template <bool USE_INDICES, bool ORDERED>
   void ConstructHistogramsMultiVal(const data_size_t* data_indices,
@@ -499,12 +551,18 @@ class Dataset {
                                    TrainingShareStates* share_state,
                                    hist_t* hist_data) const;
 
+  /*!
+  * \brief Construct the histograms of the data of data_indices
+  * \param is_ordered Whether ordered_gradients and ordered_hessians already hold the gradients and
+  *        hessians of data_indices, gathered by DataPartition::Split
+  */
   inline void ConstructHistograms(
       const std::vector<int8_t>& is_feature_used,
       const data_size_t* data_indices, data_size_t num_data,
       const score_t* gradients, const score_t* hessians,
       score_t* ordered_gradients, score_t* ordered_hessians,
-      TrainingShareStates* share_state, hist_t* hist_data) const {
+      TrainingShareStates* share_state, hist_t* hist_data,
+      bool is_ordered = false) const {
     if (num_data <= 0) {
       return;
     }
@@ -513,25 +571,79 @@ class Dataset {
       if (use_indices) {
         ConstructHistogramsInner<true, false>(
             is_feature_used, data_indices, num_data, gradients, hessians,
-            ordered_gradients, ordered_hessians, share_state, hist_data);
+            ordered_gradients, ordered_hessians, share_state, hist_data, is_ordered);
       } else {
         ConstructHistogramsInner<false, false>(
             is_feature_used, data_indices, num_data, gradients, hessians,
-            ordered_gradients, ordered_hessians, share_state, hist_data);
+            ordered_gradients, ordered_hessians, share_state, hist_data, is_ordered);
       }
     } else {
       if (use_indices) {
         ConstructHistogramsInner<true, true>(
             is_feature_used, data_indices, num_data, gradients, hessians,
-            ordered_gradients, ordered_hessians, share_state, hist_data);
+            ordered_gradients, ordered_hessians, share_state, hist_data, is_ordered);
       } else {
         ConstructHistogramsInner<false, true>(
             is_feature_used, data_indices, num_data, gradients, hessians,
-            ordered_gradients, ordered_hessians, share_state, hist_data);
+            ordered_gradients, ordered_hessians, share_state, hist_data, is_ordered);
       }
     }
   }
 
+  /*! \brief One leaf of ConstructHistogramsForLeaves */
+  struct HistogramLeaf {
+    /*! \brief Whether each feature needs its histogram */
+    const std::vector<int8_t>* is_feature_used;
+    /*! \brief Data indices of the leaf */
+    const data_size_t* data_indices;
+    /*! \brief Number of data in the leaf */
+    data_size_t num_data;
+    /*! \brief Buffers of num_data elements for the gradients and hessians ordered by data_indices */
+    score_t* ordered_gradients;
+    score_t* ordered_hessians;
+    /*! \brief Output histograms, same layout as ConstructHistograms */
+    hist_t* hist_data;
+  };
+
+  /*!
+  * \brief Construct the histograms of several leaves together. With col-wise histograms the
+  *        (leaf, feature group) pairs of the small leaves are spread over the threads in one
+  *        parallel region, instead of one region with few groups per leaf
+  * \param leaves Leaves to construct, their buffers must not overlap
+  * \param gradients Gradients of all data
+  * \param hessians Hessians of all data
+  * \param share_state Shared states of training
+  */
+  void ConstructHistogramsForLeaves(const std::vector<HistogramLeaf>& leaves,
+                                    const score_t* gradients,
+                                    const score_t* hessians,
+                                    TrainingShareStates* share_state) const;
+
+  /*!
+  * \brief Construct histograms from quantized gradients and hessians, accumulated in integers
+  *        and converted to hist_t by grad_scale and hess_scale at the end
+  * \param is_feature_used Whether each feature needs its histogram
+  * \param data_indices Used data indices, nullptr for all data
+  * \param num_data Number of used data
+  * \param int_grad_hess Quantized gradient and hessian of each data, see PackIntGradHess
+  * \param ordered_int_grad_hess Buffer of num_data elements for the values ordered by data_indices
+  * \param grad_scale Value of one unit of quantized gradient
+  * \param hess_scale Value of one unit of quantized hessian
+  * \param max_int_grad_hess Max of absolute quantized gradient and quantized hessian of one data,
+  *        the integer width of histogram entries is chosen by it
+  * \param share_state Shared states of training
+  * \param hist_data Output histograms, same layout as ConstructHistograms
+  */
+  void ConstructIntHistograms(const std::vector<int8_t>& is_feature_used,
+                              const data_size_t* data_indices,
+                              data_size_t num_data,
+                              const int16_t* int_grad_hess,
+                              int16_t* ordered_int_grad_hess,
+                              double grad_scale, double hess_scale,
+                              int max_int_grad_hess,
+                              TrainingShareStates* share_state,
+                              hist_t* hist_data) const;
+
   void FixHistogram(int feature_idx, double sum_gradient, double sum_hessian, hist_t* data) const;
 
   inline data_size_t Split(int feature, const uint32_t* threshold,
@@ -675,7 +787,45 @@ class Dataset {
   void AddFeaturesFrom(Dataset* other);
 
  private:
+  void GetUsedGroups(const std::vector<int8_t>& is_feature_used,
+                     std::vector<int>* used_dense_group,
+                     int* multi_val_group_id) const;
+
+  template <bool USE_HESSIAN>
+  void ConstructHistogramsForLeavesInner(const std::vector<HistogramLeaf>& leaves,
+                                         const score_t* gradients,
+                                         const score_t* hessians,
+                                         TrainingShareStates* share_state) const;
+
+  template <bool USE_INDICES, typename PACKED_HIST_T, int HIST_BITS>
+  void ConstructIntHistogramsInner(const std::vector<int8_t>& is_feature_used,
+                                   const data_size_t* data_indices,
+                                   data_size_t num_data,
+                                   const int16_t* int_grad_hess,
+                                   int16_t* ordered_int_grad_hess,
+                                   double grad_scale, double hess_scale,
+                                   TrainingShareStates* share_state,
+                                   hist_t* hist_data) const;
+
+  template <bool USE_INDICES, bool ORDERED, typename PACKED_HIST_T, int HIST_BITS>
+  void ConstructIntHistogramsMultiVal(const data_size_t* data_indices,
+                                      data_size_t num_data,
+                                      const int16_t* int_grad_hess,
+                                      double grad_scale, double hess_scale,
+                                      TrainingShareStates* share_state,
+                                      hist_t* hist_data) const;
+
+  /*!
+  * \brief Zeros written before the size of a feature group at offset of a binary file,
+  *        so that the group starts at a multiple of kAlignedSize
+  */
+  static size_t BinaryFeaturePadding(size_t offset) {
+    return FeatureGroup::AlignedSize(offset + sizeof(size_t)) - offset - sizeof(size_t);
+  }
+
   std::string data_filename_;
+  /*! \brief Binary file whose memory is read in place by the bins, must outlive feature_groups_ */
+  std::unique_ptr<MappedFile> mapped_file_;
   /*! \brief Store used features */
   std::vector<std::unique_ptr<FeatureGroup>> feature_groups_;
   /*! \brief Mapper from real feature index to used index*/
@@ -694,6 +844,8 @@ class Dataset {
   std::vector<std::string> feature_names_;
   /*! \brief store feature names */
   static const char* binary_file_token;
+  /*! \brief Version of binary files, bin data are aligned from version 1 */
+  static const uint32_t binary_file_version;
   int num_groups_;
   std::vector<int> real_feature_idx_;
   std::vector<int> feature2group_;
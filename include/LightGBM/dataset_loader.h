@@ -42,6 +42,12 @@ class DatasetLoader {
  private:
   Dataset* LoadFromBinFile(const char* data_filename, const char* bin_filename, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
 
+  /*!
+  * \brief Load dataset from Arrow IPC file, column values are read in place from a memory mapping
+  * \param train_data Dataset to align with, nullptr to construct bin mappers from the file
+  */
+  Dataset* LoadFromArrowFile(const char* filename, const Dataset* train_data, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
+
   void SetHeader(const char* filename);
 
   void CheckDataset(const Dataset* dataset);
@@ -52,7 +58,40 @@ class DatasetLoader {
 
   std::vector<std::string> SampleTextDataFromFile(const char* filename, const Metadata& metadata, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
 
-  void ConstructBinMappersFromTextData(int rank, int num_machines, const std::vector<std::string>& sample_data, const Parser* parser, Dataset* dataset);
+  /*!
+  * \brief Summarize the features of lines in memory with quantile sketches
+  */
+  std::vector<QuantileSketch> SketchTextDataFromMemory(const std::vector<std::string>& data, const Parser* parser);
+
+  /*!
+  * \brief Summarize the features of (the used lines of) data file with quantile sketches, in one pass over the file
+  */
+  std::vector<QuantileSketch> SketchTextDataFromFile(const char* filename, const Parser* parser, const std::vector<data_size_t>& used_data_indices);
+
+  /*!
+  * \brief Push the non-ignored features of lines to their sketches, in the order of lines
+  */
+  void PushTextDataToSketches(const std::string* lines, data_size_t num_lines, const Parser* parser, std::vector<QuantileSketch>* sketches);
+
+  /*!
+  * \param sketches Sketches of all local data to find the bins from, nullptr to find the bins from the sample
+  */
+  void ConstructBinMappersFromTextData(int rank, int num_machines, const std::vector<std::string>& sample_data, const Parser* parser,
+                                       std::vector<QuantileSketch>* sketches, Dataset* dataset);
+
+  /*!
+  * \brief Construct bin mappers and feature groups of dataset
+  * \param num_features Number of features, at least the size of sample_values
+  * \param sample_values Sampled non-zero values of each feature
+  * \param sample_indices Indices of the sampled non-zero values in the sample
+  * \param total_sample_cnt Number of sampled data
+  * \param sketches Sketches of all local data to find the bins from, nullptr to find the bins from the sample.
+  *                 The sample is still used to bundle features
+  */
+  void ConstructBinMappersFromSampleValues(int rank, int num_machines, int num_features,
+                                           std::vector<std::vector<double>>* sample_values,
+                                           std::vector<std::vector<int>>* sample_indices,
+                                           size_t total_sample_cnt, std::vector<QuantileSketch>* sketches, Dataset* dataset);
 
   /*! \brief Extract local features from memory */
   void ExtractFeaturesFromMemory(std::vector<std::string>* text_data, const Parser* parser, Dataset* dataset);
@@ -60,6 +99,13 @@ class DatasetLoader {
   /*! \brief Extract local features from file */
   void ExtractFeaturesFromFile(const char* filename, const Parser* parser, const std::vector<data_size_t>& used_data_indices, Dataset* dataset);
 
+  /*!
+  * \brief Extract local features from file in one pass, the number of data needn't be known in advance
+  * \param construct_fun Called once with the first lines of file, should allocate the dataset and its metadata for them
+  */
+  void ExtractFeaturesFromStream(const char* filename, const Parser* parser,
+                                 const std::function<void(const std::vector<std::string>&)>& construct_fun, Dataset* dataset);
+
   /*! \brief Check can load from binary file */
   std::string CheckCanLoadFromBin(const char* filename);
 
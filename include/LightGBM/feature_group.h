@@ -87,9 +87,15 @@ class FeatureGroup {
   * \param memory Pointer of memory
   * \param num_all_data Number of global data
   * \param local_used_indices Local used indices, empty means using all data
+  * \param is_aligned Whether the bin data are aligned as written by SaveBinaryToFile,
+  *        binary files of old versions are not
+  * \param use_memory_in_place Whether bins may read the memory in place instead of copying it,
+  *        only used with all data and aligned bin data
   */
   FeatureGroup(const void* memory, data_size_t num_all_data,
-    const std::vector<data_size_t>& local_used_indices) {
+    const std::vector<data_size_t>& local_used_indices,
+    bool is_aligned = false, bool use_memory_in_place = false) {
+    const char* memory_start = reinterpret_cast<const char*>(memory);
     const char* memory_ptr = reinterpret_cast<const char*>(memory);
     // get is_sparse
     is_multi_val_ = *(reinterpret_cast<const bool*>(memory_ptr));
@@ -114,29 +120,44 @@ class FeatureGroup {
       bin_offsets_.emplace_back(num_total_bin_);
       memory_ptr += bin_mappers_[i]->SizesInByte();
     }
+    if (is_aligned) {
+      memory_ptr = memory_start + AlignedSize(memory_ptr - memory_start);
+    }
+    const bool in_place = use_memory_in_place && is_aligned && local_used_indices.empty();
     data_size_t num_data = num_all_data;
     if (!local_used_indices.empty()) {
       num_data = static_cast<data_size_t>(local_used_indices.size());
     }
+    // bins read in place are created without data
+    const data_size_t num_created_data = in_place ? 0 : num_data;
     if (is_multi_val_) {
       for (int i = 0; i < num_feature_; ++i) {
         int addi = bin_mappers_[i]->GetMostFreqBin() == 0 ? 0 : 1;
         if (bin_mappers_[i]->sparse_rate() >= kSparseThreshold) {
-          multi_bin_data_.emplace_back(Bin::CreateSparseBin(num_data, bin_mappers_[i]->num_bin() + addi));
+          multi_bin_data_.emplace_back(Bin::CreateSparseBin(num_created_data, bin_mappers_[i]->num_bin() + addi));
+        } else {
+          multi_bin_data_.emplace_back(Bin::CreateDenseBin(num_created_data, bin_mappers_[i]->num_bin() + addi));
+        }
+        if (in_place) {
+          multi_bin_data_.back()->LoadFromMemoryInPlace(memory_ptr, num_data);
         } else {
-          multi_bin_data_.emplace_back(Bin::CreateDenseBin(num_data, bin_mappers_[i]->num_bin() + addi));
+          multi_bin_data_.back()->LoadFromMemory(memory_ptr, local_used_indices);
         }
-        multi_bin_data_.back()->LoadFromMemory(memory_ptr, local_used_indices);
-        memory_ptr += multi_bin_data_.back()->SizesInByte();
+        const size_t size = multi_bin_data_.back()->SizesInByte();
+        memory_ptr += is_aligned ? AlignedSize(size) : size;
       }
     } else {
       if (is_sparse_) {
-        bin_data_.reset(Bin::CreateSparseBin(num_data, num_total_bin_));
+        bin_data_.reset(Bin::CreateSparseBin(num_created_data, num_total_bin_));
       } else {
-        bin_data_.reset(Bin::CreateDenseBin(num_data, num_total_bin_));
+        bin_data_.reset(Bin::CreateDenseBin(num_created_data, num_total_bin_));
       }
       // get bin data
-      bin_data_->LoadFromMemory(memory_ptr, local_used_indices);
+      if (in_place) {
+        bin_data_->LoadFromMemoryInPlace(memory_ptr, num_data);
+      } else {
+        bin_data_->LoadFromMemory(memory_ptr, local_used_indices);
+      }
     }
   }
 
@@ -289,6 +310,10 @@ class FeatureGroup {
   * \brief Save binary data to file
   * \param file File want to write
   */
+  /*!
+  * \brief Save binary data to file, the bin data are aligned to kAlignedSize
+  *        relative to the start of this group, so that they can be read in place
+  */
   void SaveBinaryToFile(const VirtualFileWriter* writer) const {
     writer->Write(&is_multi_val_, sizeof(is_multi_val_));
     writer->Write(&is_sparse_, sizeof(is_sparse_));
@@ -296,9 +321,11 @@ class FeatureGroup {
     for (int i = 0; i < num_feature_; ++i) {
       bin_mappers_[i]->SaveBinaryToFile(writer);
     }
+    WritePadding(writer, HeaderSizesInByte());
     if (is_multi_val_) {
       for (int i = 0; i < num_feature_; ++i) {
         multi_bin_data_[i]->SaveBinaryToFile(writer);
+        WritePadding(writer, multi_bin_data_[i]->SizesInByte());
       }
     } else {
       bin_data_->SaveBinaryToFile(writer);
@@ -306,18 +333,15 @@ class FeatureGroup {
   }
 
   /*!
-  * \brief Get sizes in byte of this object
+  * \brief Get sizes in byte of this object, as written by SaveBinaryToFile
   */
   size_t SizesInByte() const {
-    size_t ret = sizeof(is_multi_val_) + sizeof(is_sparse_) + sizeof(num_feature_);
-    for (int i = 0; i < num_feature_; ++i) {
-      ret += bin_mappers_[i]->SizesInByte();
-    }
+    size_t ret = AlignedSize(HeaderSizesInByte());
     if (!is_multi_val_) {
       ret += bin_data_->SizesInByte();
     } else {
       for (int i = 0; i < num_feature_; ++i) {
-        ret += multi_bin_data_[i]->SizesInByte();
+        ret += AlignedSize(multi_bin_data_[i]->SizesInByte());
       }
     }
     return ret;
@@ -349,6 +373,29 @@ class FeatureGroup {
   }
 
  private:
+  /*! \brief Round size up to a multiple of kAlignedSize */
+  static size_t AlignedSize(size_t size) {
+    return (size + kAlignedSize - 1) / kAlignedSize * kAlignedSize;
+  }
+
+  /*! \brief Write zeros after size bytes, up to AlignedSize(size) */
+  static void WritePadding(const VirtualFileWriter* writer, size_t size) {
+    const char zeros[kAlignedSize] = {0};
+    const size_t padding = AlignedSize(size) - size;
+    if (padding > 0) {
+      writer->Write(zeros, padding);
+    }
+  }
+
+  /*! \brief Sizes in byte of the part before the bin data */
+  size_t HeaderSizesInByte() const {
+    size_t ret = sizeof(is_multi_val_) + sizeof(is_sparse_) + sizeof(num_feature_);
+    for (int i = 0; i < num_feature_; ++i) {
+      ret += bin_mappers_[i]->SizesInByte();
+    }
+    return ret;
+  }
+
   void CreateBinData(int num_data, bool is_multi_val, bool force_dense, bool force_sparse) {
     if (is_multi_val) {
       multi_bin_data_.clear();
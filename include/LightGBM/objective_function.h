@@ -68,6 +68,16 @@ class ObjectiveFunction {
     output[0] = input[0];
   }
 
+  /*!
+  * \brief C statements doing the same as ConvertOutput in place on ``double* output``,
+  *        used by the C code generation of models. Objectives overriding ConvertOutput must override it,
+  *        an empty string means the output is not converted
+  */
+  virtual std::string ConvertOutputToC() const {
+    Log::Fatal("Cannot convert the output of objective %s to C", GetName());
+    return "";
+  }
+
   virtual std::string ToString() const = 0;
 
   ObjectiveFunction() = default;
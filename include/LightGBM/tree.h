@@ -11,6 +11,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
 
@@ -19,10 +20,17 @@ namespace LightGBM {
 #define kCategoricalMask (1)
 #define kDefaultLeftMask (2)
 
+/*! \brief forward declaration */
+class FlatForest;
+class ShapForest;
+
 /*!
 * \brief Tree model
 */
 class Tree {
+  friend FlatForest;
+  friend ShapForest;
+
  public:
   /*!
   * \brief Constructor
@@ -38,6 +46,13 @@ class Tree {
   */
   Tree(const char* str, size_t* used_len);
 
+  /*!
+  * \brief Constructor, from memory written by SaveBinaryToFile
+  * \param buffer Start of the serialized tree
+  * \param len Number of bytes available in buffer, reading past it is a fatal error
+  */
+  Tree(const char* buffer, size_t len);
+
   ~Tree();
 
   /*!
@@ -142,6 +157,9 @@ class Tree {
   /*! \brief Get Number of leaves*/
   inline int num_leaves() const { return num_leaves_; }
 
+  /*! \brief Get number of categorical splits */
+  inline int num_cat() const { return num_cat_; }
+
   /*! \brief Get depth of specific leaf*/
   inline int leaf_depth(int leaf_idx) const { return leaf_depth_[leaf_idx]; }
 
@@ -218,12 +236,28 @@ class Tree {
   /*! \brief Serialize this object to string*/
   std::string ToString() const;
 
+  /*!
+  * \brief Save fields used for prediction and for continued training in raw binary form
+  * \param writer Writer
+  * \return Number of bytes written, less than SizesInByte() when writing failed
+  */
+  size_t SaveBinaryToFile(const VirtualFileWriter* writer) const;
+
+  /*! \brief Size of the output of SaveBinaryToFile in bytes */
+  size_t SizesInByte() const;
+
   /*! \brief Serialize this object to json*/
   std::string ToJSON() const;
 
   /*! \brief Serialize this object to if-else statement*/
   std::string ToIfElse(int index, bool predict_leaf_index) const;
 
+  /*!
+  * \brief Serialize this object to a C function ``static double <prefix>_tree_<index>(const float* row)``
+  * \param prefix Prefix of the generated names, categorical splits call ``<prefix>_in_bitset``
+  */
+  std::string ToC(const std::string& prefix, int index) const;
+
   inline static bool IsZero(double fval) {
     return (fval >= -kZeroThreshold && fval <= kZeroThreshold);
   }
@@ -255,6 +289,12 @@ class Tree {
 
   void RecomputeMaxDepth();
 
+  /*!
+  * \brief Check whether the tree is oblivious, i.e. complete and all the nodes of each depth use the
+  *        same numerical split. If so GetLeaf computes the leaf index from the splits of the depths
+  */
+  void RecomputeObliviousLevels();
+
   int NextLeafId() const { return num_leaves_; }
 
  private:
@@ -262,6 +302,12 @@ class Tree {
 
   std::string CategoricalDecisionIfElse(int node) const;
 
+  /*! \brief C condition which is true when the node goes left, same rules as Decision */
+  std::string DecisionToC(int node, const std::string& prefix, const std::string& cat_name) const;
+
+  void NodeToC(int index, int depth, const std::string& prefix, const std::string& cat_name,
+               std::stringstream* str_buf) const;
+
   inline int NumericalDecision(double fval, int node) const {
     uint8_t missing_type = GetMissingType(decision_type_[node]);
     if (std::isnan(fval) && missing_type != MissingType::NaN) {
@@ -353,6 +399,8 @@ class Tree {
   */
   inline int GetLeaf(const double* feature_values) const;
   inline int GetLeafByMap(const std::unordered_map<int, double>& feature_values) const;
+  inline int GetLeafOblivious(const double* feature_values) const;
+  inline int GetLeafObliviousByMap(const std::unordered_map<int, double>& feature_values) const;
 
   /*! \brief Serialize one node to json*/
   std::string NodeToJSON(int index) const;
@@ -454,6 +502,10 @@ class Tree {
   std::vector<std::vector<int>> branch_features_;
   double shrinkage_;
   int max_depth_;
+  /*! \brief For oblivious trees, one node of each depth, whose split is used by all the nodes of the depth */
+  std::vector<int> oblivious_nodes_;
+  /*! \brief For oblivious trees, leaf of each bit index, whose bit of depth d is 1 if the data go right at d */
+  std::vector<int> oblivious_leaves_;
 };
 
 inline void Tree::Split(int leaf, int feature, int real_feature,
@@ -570,6 +622,9 @@ inline void Tree::RecomputeLeafDepths(int node, int depth) {
 }
 
 inline int Tree::GetLeaf(const double* feature_values) const {
+  if (!oblivious_nodes_.empty()) {
+    return GetLeafOblivious(feature_values);
+  }
   int node = 0;
   if (num_cat_ > 0) {
     while (node >= 0) {
@@ -584,6 +639,9 @@ inline int Tree::GetLeaf(const double* feature_values) const {
 }
 
 inline int Tree::GetLeafByMap(const std::unordered_map<int, double>& feature_values) const {
+  if (!oblivious_nodes_.empty()) {
+    return GetLeafObliviousByMap(feature_values);
+  }
   int node = 0;
   if (num_cat_ > 0) {
     while (node >= 0) {
@@ -597,6 +655,25 @@ inline int Tree::GetLeafByMap(const std::unordered_map<int, double>& feature_val
   return ~node;
 }
 
+inline int Tree::GetLeafOblivious(const double* feature_values) const {
+  int index = 0;
+  for (const int node : oblivious_nodes_) {
+    const int next = NumericalDecision(feature_values[split_feature_[node]], node);
+    index = (index << 1) | static_cast<int>(next == right_child_[node]);
+  }
+  return oblivious_leaves_[index];
+}
+
+inline int Tree::GetLeafObliviousByMap(const std::unordered_map<int, double>& feature_values) const {
+  int index = 0;
+  for (const int node : oblivious_nodes_) {
+    const auto it = feature_values.find(split_feature_[node]);
+    const int next = NumericalDecision(it != feature_values.end() ? it->second : 0.0f, node);
+    index = (index << 1) | static_cast<int>(next == right_child_[node]);
+  }
+  return oblivious_leaves_[index];
+}
+
 }  // namespace LightGBM
 
 #endif   // LightGBM_TREE_H_
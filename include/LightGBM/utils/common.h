@@ -5,6 +5,7 @@
 #ifndef LIGHTGBM_UTILS_COMMON_FUN_H_
 #define LIGHTGBM_UTILS_COMMON_FUN_H_
 
+#include <LightGBM/utils/eisel_lemire.h>
 #include <LightGBM/utils/log.h>
 #include <LightGBM/utils/openmp_wrapper.h>
 
@@ -12,9 +13,12 @@
 #include <string>
 #include <algorithm>
 #include <chrono>
+#include <cfloat>
+#include <clocale>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <functional>
 #include <iomanip>
 #include <iterator>
@@ -222,8 +226,7 @@ inline static double Pow(T base, int power) {
 }
 
 inline static const char* Atof(const char* p, double* out) {
-  int frac;
-  double sign, value, scale;
+  double sign;
   *out = NAN;
   // Skip leading white space, if any.
   while (*p == ' ') {
@@ -240,49 +243,103 @@ inline static const char* Atof(const char* p, double* out) {
 
   // is a number
   if ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E') {
+    const char* number_start = p;
+    // the value is significand * 10^exponent
+    uint64_t significand = 0;
+    int64_t exponent = 0;
     // Get digits before decimal point or exponent, if any.
-    for (value = 0.0; *p >= '0' && *p <= '9'; ++p) {
-      value = value * 10.0 + (*p - '0');
+    for (; *p >= '0' && *p <= '9'; ++p) {
+      significand = significand * 10 + (*p - '0');
     }
+    int64_t num_digits = p - number_start;
 
     // Get digits after decimal point, if any.
     if (*p == '.') {
-      double right = 0.0;
-      int nn = 0;
       ++p;
-      while (*p >= '0' && *p <= '9') {
-        right = (*p - '0') + right * 10.0;
-        ++nn;
-        ++p;
+      const char* fraction_start = p;
+      for (; *p >= '0' && *p <= '9'; ++p) {
+        significand = significand * 10 + (*p - '0');
       }
-      value += right / Pow(10.0, nn);
+      exponent = fraction_start - p;
+      num_digits += p - fraction_start;
     }
+    const char* number_end = p;
+    int64_t explicit_exponent = 0;
 
     // Handle exponent, if any.
-    frac = 0;
-    scale = 1.0;
     if ((*p == 'e') || (*p == 'E')) {
-      uint32_t expon;
+      bool is_negative_exponent = false;
+      int64_t expon = 0;
       // Get sign of exponent, if any.
       ++p;
       if (*p == '-') {
-        frac = 1;
+        is_negative_exponent = true;
         ++p;
       } else if (*p == '+') {
         ++p;
       }
       // Get digits of exponent, if any.
-      for (expon = 0; *p >= '0' && *p <= '9'; ++p) {
-        expon = expon * 10 + (*p - '0');
+      for (; *p >= '0' && *p <= '9'; ++p) {
+        if (expon < 100000) {
+          expon = expon * 10 + (*p - '0');
+        }
+      }
+      explicit_exponent = is_negative_exponent ? -expon : expon;
+    }
+
+    // uint64_t holds 19 digits, parse again if there are more significant digits
+    bool is_truncated = false;
+    if (num_digits > 19) {
+      for (const char* q = number_start; q < number_end && (*q == '0' || *q == '.'); ++q) {
+        num_digits -= (*q == '0');
+      }
+      if (num_digits > 19) {
+        int num_kept_digits = 0;
+        bool is_fraction = false;
+        significand = 0;
+        exponent = 0;
+        for (const char* q = number_start; q < number_end; ++q) {
+          if (*q == '.') {
+            is_fraction = true;
+          } else if (num_kept_digits < 19) {
+            significand = significand * 10 + (*q - '0');
+            num_kept_digits += (significand > 0);
+            exponent -= is_fraction;
+          } else {
+            exponent += !is_fraction;
+            is_truncated |= (*q != '0');
+          }
+        }
+      }
+    }
+    exponent += explicit_exponent;
+    // Correctly rounded result
+    const bool is_negative = sign < 0;
+    bool is_rounded = false;
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    // both operands are exact doubles, so is the result of one operation
+    static const double kExactPowersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (!is_truncated && significand <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+      const double value = static_cast<double>(significand);
+      *out = sign * (exponent < 0 ? value / kExactPowersOfTen[-exponent] : value * kExactPowersOfTen[exponent]);
+      is_rounded = true;
+    }
+#endif
+    if (!is_rounded) {
+      is_rounded = EiselLemire::ToDouble(significand, exponent, is_negative, out);
+      // truncated digits don't matter if both bounds round to the same double
+      double upper = 0.0;
+      if (is_rounded && is_truncated) {
+        is_rounded = EiselLemire::ToDouble(significand + 1, exponent, is_negative, &upper) && upper == *out;
       }
-      if (expon > 308) expon = 308;
-      // Calculate scaling factor.
-      while (expon >= 50) { scale *= 1E50; expon -= 50; }
-      while (expon >= 8) { scale *= 1E8;  expon -= 8; }
-      while (expon > 0) { scale *= 10.0; expon -= 1; }
     }
-    // Return signed and scaled floating point result.
-    *out = sign * (frac ? (value / scale) : (value * scale));
+    if (!is_rounded) {
+      // very rare, use strtod with the decimal point of the current locale
+      std::string tmp_str(number_start, p - number_start);
+      std::replace(tmp_str.begin(), tmp_str.end(), '.', *std::localeconv()->decimal_point);
+      *out = sign * std::strtod(tmp_str.c_str(), nullptr);
+    }
   } else {
     size_t cnt = 0;
     while (*(p + cnt) != '\0' && *(p + cnt) != ' '
@@ -31,6 +31,11 @@ struct VirtualFileWriter {
    * \return Number of bytes written
    */
   virtual size_t Write(const void* data, size_t bytes) const = 0;
+  /*!
+   * \brief Write the buffered data to the file
+   * \return True when all the data written so far are in the file
+   */
+  virtual bool Flush() const = 0;
   /*!
    * \brief Create appropriate writer for filename
    * \param filename Filename of the data
@@ -74,6 +79,39 @@ struct VirtualFileReader {
   static std::unique_ptr<VirtualFileReader> Make(const std::string& filename);
 };
 
+/*!
+ * \brief Read-only view of the whole content of a file.
+ *        Local files are memory mapped, so their pages are loaded on demand and shared between processes,
+ *        other files are read into memory
+ */
+class MappedFile {
+ public:
+  ~MappedFile();
+  /*!
+   * \brief Map or read a file
+   * \param filename Filename of the data
+   * \return nullptr when the file cannot be opened
+   */
+  static std::unique_ptr<MappedFile> Make(const std::string& filename);
+  /*! \brief Start of the content, aligned to the page size when the file is mapped */
+  inline const char* data() const { return data_; }
+  /*! \brief Size of the content in bytes */
+  inline size_t size() const { return size_; }
+  /*! \brief Whether the content is mapped rather than copied */
+  inline bool is_mapped() const { return is_mapped_; }
+
+ private:
+  MappedFile() {}
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  bool is_mapped_ = false;
+  /*! \brief Content of files that are not mapped */
+  std::unique_ptr<char[]> buffer_;
+};
+
 }  // namespace LightGBM
 
 #endif   // LightGBM_UTILS_FILE_IO_H_
@@ -35,7 +35,10 @@ class ThreadExceptionHelper {
   }
   void ReThrow() {
     if (ex_ptr_ != nullptr) {
-      std::rethrow_exception(ex_ptr_);
+      // clear it first, the destructor must not throw it again while it is propagating
+      std::exception_ptr ex_ptr = ex_ptr_;
+      ex_ptr_ = nullptr;
+      std::rethrow_exception(ex_ptr);
     }
   }
   void CaptureException() {
@@ -79,6 +82,7 @@ class ThreadExceptionHelper {
   inline void omp_set_num_threads(int) {}
   inline int omp_get_num_threads() {return 1;}
   inline int omp_get_thread_num() {return 0;}
+  inline int omp_in_parallel() {return 0;}
   inline int OMP_NUM_THREADS() { return 1; }
 #ifdef __cplusplus
 }  // extern "C"
@@ -0,0 +1,212 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#ifndef LIGHTGBM_UTILS_QUANTILE_SKETCH_H_
+#define LIGHTGBM_UTILS_QUANTILE_SKETCH_H_
+
+#include <LightGBM/meta.h>
+#include <LightGBM/utils/log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace LightGBM {
+
+/*!
+* \brief Mergeable summary of the non-zero values of one feature, used to find bins from all data in bounded memory.
+*        The summary is a sorted list of at most capacity distinct values with weights, the weight of a value
+*        counts the data in (previous value, value]. It is exact while there are at most capacity distinct values,
+*        otherwise the number of data below a value is off by about (number of data) / capacity per merge.
+*        Zeros are not stored, NaNs are only counted. Results don't depend on the order of merges of
+*        the same sketches, as long as no summary is pruned.
+*/
+class QuantileSketch {
+ public:
+  /*! \brief Smallest capacity, a pruned summary keeps its first, last and last negative values */
+  static const int kMinCapacity = 8;
+
+  /*!
+  * \brief Constructor
+  * \param capacity Max number of values in the summary
+  */
+  explicit QuantileSketch(int capacity = kMinCapacity) : capacity_(std::max(capacity, kMinCapacity)), na_cnt_(0) {}
+
+  /*! \brief Add one value, zeros are skipped */
+  inline void Push(double value) {
+    if (std::isnan(value)) {
+      ++na_cnt_;
+    } else if (std::fabs(value) > kZeroThreshold) {
+      buffer_.push_back(value);
+      if (static_cast<int>(buffer_.size()) >= capacity_) {
+        Compact();
+      }
+    }
+  }
+
+  /*! \brief Add all values of another sketch */
+  void Merge(const QuantileSketch& other) {
+    buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+    na_cnt_ += other.na_cnt_;
+    MergeSummary(other.values_, other.weights_);
+    Compact();
+  }
+
+  /*! \brief Merge pending values into the summary, should be called before reading the summary */
+  void Compact() {
+    std::sort(buffer_.begin(), buffer_.end());
+    std::vector<double> values;
+    std::vector<int> weights;
+    for (double value : buffer_) {
+      if (values.empty() || values.back() != value) {
+        values.push_back(value);
+        weights.push_back(1);
+      } else {
+        ++weights.back();
+      }
+    }
+    buffer_.clear();
+    MergeSummary(values, weights);
+  }
+
+  /*! \brief Sorted distinct values of the summary */
+  inline const std::vector<double>& values() const { return values_; }
+
+  /*! \brief Number of data represented by each value of the summary */
+  inline const std::vector<int>& weights() const { return weights_; }
+
+  /*! \brief Number of NaNs */
+  inline int na_cnt() const { return na_cnt_; }
+
+  /*! \brief Size of the serialized sketch of a capacity */
+  static int SizesInByte(int capacity) {
+    capacity = std::max(capacity, kMinCapacity);
+    return static_cast<int>(2 * sizeof(int) + capacity * (sizeof(double) + sizeof(int)));
+  }
+
+  /*!
+  * \brief Serialize the summary to SizesInByte(capacity) bytes, pending values must be compacted
+  */
+  void CopyTo(char* buffer) const {
+    CHECK(buffer_.empty());
+    const int num_values = static_cast<int>(values_.size());
+    std::memset(buffer, 0, SizesInByte(capacity_));
+    std::memcpy(buffer, &num_values, sizeof(int));
+    std::memcpy(buffer + sizeof(int), &na_cnt_, sizeof(int));
+    char* values_ptr = buffer + 2 * sizeof(int);
+    std::memcpy(values_ptr, values_.data(), num_values * sizeof(double));
+    std::memcpy(values_ptr + capacity_ * sizeof(double), weights_.data(), num_values * sizeof(int));
+  }
+
+  /*!
+  * \brief Deserialize a summary of SizesInByte(capacity) bytes
+  */
+  void CopyFrom(const char* buffer) {
+    int num_values = 0;
+    std::memcpy(&num_values, buffer, sizeof(int));
+    std::memcpy(&na_cnt_, buffer + sizeof(int), sizeof(int));
+    CHECK(num_values >= 0 && num_values <= capacity_);
+    const char* values_ptr = buffer + 2 * sizeof(int);
+    buffer_.clear();
+    values_.resize(num_values);
+    weights_.resize(num_values);
+    std::memcpy(values_.data(), values_ptr, num_values * sizeof(double));
+    std::memcpy(weights_.data(), values_ptr + capacity_ * sizeof(double), num_values * sizeof(int));
+  }
+
+  /*!
+  * \brief Reduce function for Network, merges arrays of serialized sketches of the same capacity
+  */
+  static void MergeReducer(const char* src, char* dst, int type_size, comm_size_t len) {
+    const int capacity = static_cast<int>((type_size - 2 * sizeof(int)) / (sizeof(double) + sizeof(int)));
+    QuantileSketch src_sketch(capacity);
+    QuantileSketch dst_sketch(capacity);
+    for (comm_size_t used_size = 0; used_size < len; used_size += type_size) {
+      src_sketch.CopyFrom(src + used_size);
+      dst_sketch.CopyFrom(dst + used_size);
+      dst_sketch.Merge(src_sketch);
+      dst_sketch.CopyTo(dst + used_size);
+    }
+  }
+
+ private:
+  /*! \brief Merge sorted distinct values into the summary, and prune it to the capacity */
+  void MergeSummary(const std::vector<double>& values, const std::vector<int>& weights) {
+    if (values.empty()) {
+      return;
+    }
+    std::vector<double> merged_values;
+    std::vector<int> merged_weights;
+    merged_values.reserve(values_.size() + values.size());
+    merged_weights.reserve(values_.size() + values.size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < values_.size() || j < values.size()) {
+      if (j >= values.size() || (i < values_.size() && values_[i] < values[j])) {
+        merged_values.push_back(values_[i]);
+        merged_weights.push_back(weights_[i++]);
+      } else if (i >= values_.size() || values[j] < values_[i]) {
+        merged_values.push_back(values[j]);
+        merged_weights.push_back(weights[j++]);
+      } else {
+        merged_values.push_back(values_[i]);
+        merged_weights.push_back(weights_[i++] + weights[j++]);
+      }
+    }
+    values_.swap(merged_values);
+    weights_.swap(merged_weights);
+    if (static_cast<int>(values_.size()) > capacity_) {
+      Prune();
+    }
+  }
+
+  /*!
+  * \brief Keep the values at evenly spaced ranks, the weights of the others go to the next kept value.
+  *        The first and last values, and the last negative value are always kept,
+  *        so the number of negative and positive data stay exact.
+  */
+  void Prune() {
+    const int num_values = static_cast<int>(values_.size());
+    int64_t total_weight = 0;
+    for (int w : weights_) {
+      total_weight += w;
+    }
+    const int64_t num_steps = capacity_ - 3;
+    int64_t step = 1;
+    int64_t next_rank = (total_weight + num_steps - 1) / num_steps;
+    int64_t rank = 0;
+    int pending_weight = 0;
+    int num_kept = 0;
+    for (int i = 0; i < num_values; ++i) {
+      rank += weights_[i];
+      const bool is_last_negative = values_[i] < 0.0 && i + 1 < num_values && values_[i + 1] > 0.0;
+      if (i == 0 || i == num_values - 1 || is_last_negative || rank >= next_rank) {
+        values_[num_kept] = values_[i];
+        weights_[num_kept] = pending_weight + weights_[i];
+        ++num_kept;
+        pending_weight = 0;
+        while (step <= num_steps && rank >= next_rank) {
+          ++step;
+          next_rank = (step * total_weight + num_steps - 1) / num_steps;
+        }
+      } else {
+        pending_weight += weights_[i];
+      }
+    }
+    values_.resize(num_kept);
+    weights_.resize(num_kept);
+  }
+
+  int capacity_;
+  int na_cnt_;
+  /*! \brief Values not yet merged into the summary */
+  std::vector<double> buffer_;
+  std::vector<double> values_;
+  std::vector<int> weights_;
+};
+
+}  // namespace LightGBM
+#endif   // LIGHTGBM_UTILS_QUANTILE_SKETCH_H_
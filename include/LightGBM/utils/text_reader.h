@@ -5,6 +5,7 @@
 #ifndef LIGHTGBM_UTILS_TEXT_READER_H_
 #define LIGHTGBM_UTILS_TEXT_READER_H_
 
+#include <LightGBM/export.h>
 #include <LightGBM/utils/log.h>
 #include <LightGBM/utils/pipeline_reader.h>
 #include <LightGBM/utils/random.h>
@@ -19,6 +20,12 @@ namespace LightGBM {
 
 const size_t kGbs = size_t(1024) * 1024 * 1024;
 
+/*!
+* \brief Find the first '\n' or '\r' of a buffer, 16 bytes at a time with SSE2 on x86
+* \return end if there is none
+*/
+LIGHTGBM_EXPORT const char* FindEndOfLine(const char* begin, const char* end);
+
 /*!
 * \brief Read text data from file
 */
@@ -101,7 +108,8 @@ class TextReader {
         last_i = i;
       }
       while (i < read_cnt) {
-        if (buffer_process[i] == '\n' || buffer_process[i] == '\r') {
+        i = FindEndOfLine(buffer_process + i, buffer_process + read_cnt) - buffer_process;
+        if (i < read_cnt) {
           if (last_line_.size() > 0) {
             last_line_.append(buffer_process + last_i, i - last_i);
             process_fun(total_cnt, last_line_.c_str(), last_line_.size());
@@ -113,10 +121,8 @@ class TextReader {
           ++i;
           ++total_cnt;
           // skip end of line
-          while ((buffer_process[i] == '\n' || buffer_process[i] == '\r') && i < read_cnt) { ++i; }
+          while (i < read_cnt && (buffer_process[i] == '\n' || buffer_process[i] == '\r')) { ++i; }
           last_i = i;
-        } else {
-          ++i;
         }
       }
       if (last_i != read_cnt) {
@@ -253,7 +259,8 @@ class TextReader {
         last_i = i;
       }
       while (i < read_cnt) {
-        if (buffer_process[i] == '\n' || buffer_process[i] == '\r') {
+        i = FindEndOfLine(buffer_process + i, buffer_process + read_cnt) - buffer_process;
+        if (i < read_cnt) {
           if (last_line_.size() > 0) {
             last_line_.append(buffer_process + last_i, i - last_i);
             if (filter_fun(used_cnt, total_cnt)) {
@@ -271,10 +278,8 @@ class TextReader {
           ++i;
           ++total_cnt;
           // skip end of line
-          while ((buffer_process[i] == '\n' || buffer_process[i] == '\r') && i < read_cnt) { ++i; }
+          while (i < read_cnt && (buffer_process[i] == '\n' || buffer_process[i] == '\r')) { ++i; }
           last_i = i;
-        } else {
-          ++i;
         }
       }
       process_fun(start_idx, lines_);
@@ -74,6 +74,7 @@ class Threading {
     OMP_THROW_EX();
     return n_block;
   }
+
 };
 
 template <typename INDEX_T, bool TWO_BUFFER>
@@ -102,11 +103,22 @@ class ParallelPartitionRunner {
     }
   }
 
+  /*!
+  * \brief Partition cnt indices into out, left part first
+  * \param cnt Number of indices
+  * \param func Partition function of a block, returns the number of indices in the left part
+  * \param out Output of the partitioned indices
+  * \param gather_func Optional function called on the blocks of the smaller part (the left part
+  *        when it has less indices than the right part), with the indices of the block, their
+  *        number and their position in the part, while the partitioned indices are written
+  * \return Number of indices in the left part
+  */
   template<bool FORCE_SIZE>
   INDEX_T Run(
       INDEX_T cnt,
       const std::function<INDEX_T(int, INDEX_T, INDEX_T, INDEX_T*, INDEX_T*)>& func,
-      INDEX_T* out) {
+      INDEX_T* out,
+      const std::function<void(const INDEX_T*, INDEX_T, INDEX_T)>& gather_func = nullptr) {
     int nblock = 1;
     INDEX_T inner_size = cnt;
     if (FORCE_SIZE) {
@@ -156,18 +168,26 @@ class ParallelPartitionRunner {
     data_size_t left_cnt = left_write_pos_[nblock - 1] + left_cnts_[nblock - 1];
 
     auto right_start = out + left_cnt;
+    const bool gather_left = left_cnt < cnt - left_cnt;
 #pragma omp parallel for schedule(static, 1) num_threads(num_threads_)
     for (int i = 0; i < nblock; ++i) {
-      std::copy_n(left_.data() + offsets_[i], left_cnts_[i],
-                  out + left_write_pos_[i]);
-      if (TWO_BUFFER) {
-        std::copy_n(right_.data() + offsets_[i], right_cnts_[i],
-                    right_start + right_write_pos_[i]);
-      } else {
-        std::copy_n(left_.data() + offsets_[i] + left_cnts_[i], right_cnts_[i],
-                    right_start + right_write_pos_[i]);
+      OMP_LOOP_EX_BEGIN();
+      const INDEX_T* left_src = left_.data() + offsets_[i];
+      const INDEX_T* right_src = TWO_BUFFER ? right_.data() + offsets_[i]
+                                            : left_src + left_cnts_[i];
+      std::copy_n(left_src, left_cnts_[i], out + left_write_pos_[i]);
+      std::copy_n(right_src, right_cnts_[i], right_start + right_write_pos_[i]);
+      if (gather_func != nullptr) {
+        // the indices of the block are still in cache
+        if (gather_left) {
+          gather_func(left_src, left_cnts_[i], left_write_pos_[i]);
+        } else {
+          gather_func(right_src, right_cnts_[i], right_write_pos_[i]);
+        }
       }
+      OMP_LOOP_EX_END();
     }
+    OMP_THROW_EX();
     return left_cnt;
   }
 
@@ -247,9 +247,14 @@ class _ConfigAliases(object):
                              "application"},
                "pre_partition": {"pre_partition",
                                  "is_pre_partition"},
+               "stream_loading": {"stream_loading",
+                                  "streaming",
+                                  "stream_loading_enabled"},
                "two_round": {"two_round",
                              "two_round_loading",
                              "use_two_round_loading"},
+               "use_quantile_sketch": {"use_quantile_sketch",
+                                       "quantile_sketch"},
                "verbosity": {"verbosity",
                              "verbose"},
                "weight_column": {"weight_column",
@@ -1000,9 +1005,14 @@ class Dataset(object):
                                                 "max_bin",
                                                 "max_bin_by_feature",
                                                 "min_data_in_bin",
+                                                "mmap_binary_file",
                                                 "pre_partition",
+                                                "quantile_sketch_size",
+                                                "stream_first_chunk_size",
+                                                "stream_loading",
                                                 "two_round",
                                                 "use_missing",
+                                                "use_quantile_sketch",
                                                 "weight_column",
                                                 "zero_as_missing")
             return {k: v for k, v in self.params.items() if k in dataset_params}
@@ -2615,7 +2625,7 @@ class Booster(object):
         return [item for i in range_(1, self.__num_dataset)
                 for item in self.__inner_eval(self.name_valid_sets[i - 1], i, feval)]
 
-    def save_model(self, filename, num_iteration=None, start_iteration=0, importance_type='split'):
+    def save_model(self, filename, num_iteration=None, start_iteration=0, importance_type='split', binary=False):
         """Save Booster to file.
 
         Parameters
@@ -2632,6 +2642,9 @@ class Booster(object):
             What type of feature importance should be saved.
             If "split", result contains numbers of times the feature is used in a model.
             If "gain", result contains total gains of splits which use the feature.
+        binary : bool, optional (default=False)
+            If True, save the model in binary form, which is loaded much faster than text.
+            Binary model files can only be loaded on machines with the same byte order.
 
         Returns
         -------
@@ -2641,7 +2654,8 @@ class Booster(object):
         if num_iteration is None:
             num_iteration = self.best_iteration
         importance_type_int = FEATURE_IMPORTANCE_TYPE_MAPPER[importance_type]
-        _safe_call(_LIB.LGBM_BoosterSaveModel(
+        save_model = _LIB.LGBM_BoosterSaveModelBinary if binary else _LIB.LGBM_BoosterSaveModel
+        _safe_call(save_model(
             self.handle,
             ctypes.c_int(start_iteration),
             ctypes.c_int(num_iteration),
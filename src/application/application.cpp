@@ -202,10 +202,12 @@ void Application::Train() {
   Log::Info("Started training...");
   boosting_->Train(config_.snapshot_freq, config_.output_model);
   boosting_->SaveModelToFile(0, -1, config_.saved_feature_importance_type,
-                             config_.output_model.c_str());
+                             config_.output_model.c_str(), config_.saved_model_binary);
   // convert model to if-else statement code
   if (config_.convert_model_language == std::string("cpp")) {
     boosting_->SaveModelToIfElse(-1, config_.convert_model.c_str());
+  } else if (config_.convert_model_language == std::string("c")) {
+    boosting_->SaveModelToC(-1, config_.convert_model_prefix, config_.convert_model.c_str());
   }
   Log::Info("Finished training");
 }
@@ -235,7 +237,7 @@ void Application::Predict() {
                     Common::ConstPtrInVectorWrapper<Metric>(train_metric_));
     boosting_->RefitTree(pred_leaf);
     boosting_->SaveModelToFile(0, -1, config_.saved_feature_importance_type,
-                               config_.output_model.c_str());
+                               config_.output_model.c_str(), config_.saved_model_binary);
     Log::Info("Finished RefitTree");
   } else {
     // create predictor
@@ -258,7 +260,11 @@ void Application::InitPredict() {
 void Application::ConvertModel() {
   boosting_.reset(
     Boosting::CreateBoosting(config_.boosting, config_.input_model.c_str()));
-  boosting_->SaveModelToIfElse(-1, config_.convert_model.c_str());
+  if (config_.convert_model_language == std::string("c")) {
+    boosting_->SaveModelToC(-1, config_.convert_model_prefix, config_.convert_model.c_str());
+  } else {
+    boosting_->SaveModelToIfElse(-1, config_.convert_model.c_str());
+  }
 }
 
 
@@ -42,7 +42,8 @@ class Predictor {
             int early_stop_freq, double early_stop_margin) {
     early_stop_ = CreatePredictionEarlyStopInstance(
         "none", LightGBM::PredictionEarlyStopConfig());
-    if (early_stop && !boosting->NeedAccuratePrediction()) {
+    const bool use_early_stop = early_stop && !boosting->NeedAccuratePrediction();
+    if (use_early_stop) {
       PredictionEarlyStopConfig pred_early_stop_config;
       CHECK_GT(early_stop_freq, 0);
       CHECK_GE(early_stop_margin, 0);
@@ -59,6 +60,9 @@ class Predictor {
 
     boosting->InitPredict(start_iteration, num_iteration, predict_contrib);
     boosting_ = boosting;
+    is_raw_score_ = is_raw_score;
+    predict_leaf_index_ = predict_leaf_index;
+    predict_contrib_ = predict_contrib;
     num_pred_one_row_ = boosting_->NumPredictOneRow(start_iteration,
         num_iteration, predict_leaf_index, predict_contrib);
     num_feature_ = boosting_->MaxFeatureIdx() + 1;
@@ -100,6 +104,10 @@ class Predictor {
         // get sparse feature importances
         boosting_->PredictContribByMap(buf, output);
       };
+      predict_block_fun_ = [=](const double* features, int num_rows, int row_stride,
+                               double* output) {
+        boosting_->PredictContribBlock(features, num_rows, row_stride, output);
+      };
 
     } else {
       if (is_raw_score) {
@@ -134,6 +142,20 @@ class Predictor {
           }
         };
       }
+      // block prediction runs tree by tree, cannot stop early for single records
+      if (!use_early_stop) {
+        if (is_raw_score) {
+          predict_block_fun_ = [=](const double* features, int num_rows, int row_stride,
+                                   double* output) {
+            boosting_->PredictRawBlock(features, num_rows, row_stride, output);
+          };
+        } else {
+          predict_block_fun_ = [=](const double* features, int num_rows, int row_stride,
+                                   double* output) {
+            boosting_->PredictBlock(features, num_rows, row_stride, output);
+          };
+        }
+      }
     }
   }
 
@@ -152,6 +174,31 @@ class Predictor {
     return predict_sparse_fun_;
   }
 
+  /*!
+  * \brief Predict one dense record, the values are passed to the boosting as is
+  * \param features Feature values, at least MaxFeatureIdx() + 1 of them
+  * \param output Prediction result
+  */
+  inline void PredictDense(const double* features, double* output) const {
+    if (predict_leaf_index_) {
+      boosting_->PredictLeafIndex(features, output);
+    } else if (predict_contrib_) {
+      boosting_->PredictContrib(features, output);
+    } else if (is_raw_score_) {
+      boosting_->PredictRaw(features, output, &early_stop_);
+    } else {
+      boosting_->Predict(features, output, &early_stop_);
+    }
+  }
+
+  /*!
+  * \brief Get the function to predict a block of dense records
+  * \return nullptr if this kind of prediction cannot be done by blocks
+  */
+  inline const PredictBlockFunction& GetPredictBlockFunction() const {
+    return predict_block_fun_;
+  }
+
   /*!
   * \brief predicting on data, then saving result to disk
   * \param data_filename Filename of data
@@ -288,7 +335,11 @@ class Predictor {
   /*! \brief function for prediction */
   PredictFunction predict_fun_;
   PredictSparseFunction predict_sparse_fun_;
+  PredictBlockFunction predict_block_fun_;
   PredictionEarlyStopInstance early_stop_;
+  bool is_raw_score_;
+  bool predict_leaf_index_;
+  bool predict_contrib_;
   int num_feature_;
   int num_pred_one_row_;
   std::vector<std::vector<double, Common::AlignmentAllocator<double, kAlignedSize>>> predict_buf_;
@@ -4,6 +4,12 @@
  */
 #include <LightGBM/boosting.h>
 
+#include <LightGBM/utils/file_io.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include "dart.hpp"
 #include "gbdt.h"
 #include "goss.hpp"
@@ -11,7 +17,25 @@
 
 namespace LightGBM {
 
+const char* Boosting::binary_model_token =
+  "______LightGBM_Binary_Model_Token______\n";
+
+bool IsBinaryModelFile(const char* filename) {
+  auto reader = VirtualFileReader::Make(filename);
+  if (!reader->Init()) {
+    return false;
+  }
+  const size_t size_of_token = std::strlen(Boosting::binary_model_token);
+  std::vector<char> buffer(size_of_token);
+  return reader->Read(buffer.data(), size_of_token) == size_of_token
+         && std::memcmp(buffer.data(), Boosting::binary_model_token, size_of_token) == 0;
+}
+
 std::string GetBoostingTypeFromModelFile(const char* filename) {
+  if (IsBinaryModelFile(filename)) {
+    // only tree models are saved in binary form
+    return "tree";
+  }
   TextReader<size_t> model_reader(filename, true);
   std::string type = model_reader.first_line();
   return type;
@@ -19,7 +43,11 @@ std::string GetBoostingTypeFromModelFile(const char* filename) {
 
 bool Boosting::LoadFileToBoosting(Boosting* boosting, const char* filename) {
   auto start_time = std::chrono::steady_clock::now();
-  if (boosting != nullptr) {
+  if (boosting != nullptr && IsBinaryModelFile(filename)) {
+    if (!boosting->LoadModelFromBinaryFile(filename)) {
+      return false;
+    }
+  } else if (boosting != nullptr) {
     TextReader<size_t> model_reader(filename, true);
     size_t buffer_len = 0;
     auto buffer = model_reader.ReadContent(&buffer_len);
@@ -131,8 +131,8 @@ class DART: public GBDT {
     for (auto i : drop_index_) {
       for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
         auto curr_tree = i * num_tree_per_iteration_ + cur_tree_id;
-        models_[curr_tree]->Shrinkage(-1.0);
-        train_score_updater_->AddScore(models_[curr_tree].get(), cur_tree_id);
+        Models()[curr_tree]->Shrinkage(-1.0);
+        train_score_updater_->AddScore(Models()[curr_tree].get(), cur_tree_id);
       }
     }
     if (!config_->xgboost_dart_mode) {
@@ -162,13 +162,13 @@ class DART: public GBDT {
         for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
           auto curr_tree = i * num_tree_per_iteration_ + cur_tree_id;
           // update validation score
-          models_[curr_tree]->Shrinkage(1.0f / (k + 1.0f));
+          Models()[curr_tree]->Shrinkage(1.0f / (k + 1.0f));
           for (auto& score_updater : valid_score_updater_) {
-            score_updater->AddScore(models_[curr_tree].get(), cur_tree_id);
+            score_updater->AddScore(Models()[curr_tree].get(), cur_tree_id);
           }
           // update training score
-          models_[curr_tree]->Shrinkage(-k);
-          train_score_updater_->AddScore(models_[curr_tree].get(), cur_tree_id);
+          Models()[curr_tree]->Shrinkage(-k);
+          train_score_updater_->AddScore(Models()[curr_tree].get(), cur_tree_id);
         }
         if (!config_->uniform_drop) {
           sum_weight_ -= tree_weight_[i - num_init_iteration_] * (1.0f / (k + 1.0f));
@@ -180,13 +180,13 @@ class DART: public GBDT {
         for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
           auto curr_tree = i * num_tree_per_iteration_ + cur_tree_id;
           // update validation score
-          models_[curr_tree]->Shrinkage(shrinkage_rate_);
+          Models()[curr_tree]->Shrinkage(shrinkage_rate_);
           for (auto& score_updater : valid_score_updater_) {
-            score_updater->AddScore(models_[curr_tree].get(), cur_tree_id);
+            score_updater->AddScore(Models()[curr_tree].get(), cur_tree_id);
           }
           // update training score
-          models_[curr_tree]->Shrinkage(-k / config_->learning_rate);
-          train_score_updater_->AddScore(models_[curr_tree].get(), cur_tree_id);
+          Models()[curr_tree]->Shrinkage(-k / config_->learning_rate);
+          train_score_updater_->AddScore(Models()[curr_tree].get(), cur_tree_id);
         }
         if (!config_->uniform_drop) {
           sum_weight_ -= tree_weight_[i - num_init_iteration_] * (1.0f / (k + config_->learning_rate));;
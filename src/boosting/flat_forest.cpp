@@ -0,0 +1,410 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+// the kernel is compiled for its own instruction set and selected at runtime,
+// so the rest of the library keeps running on CPUs without AVX-512
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ >= 5)
+  #include <immintrin.h>
+  #define FLAT_FOREST_AVX512
+  #define TARGET_AVX512 __attribute__((target("avx2,avx512f")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1910 && (defined(_M_X64) || defined(_M_IX86))
+  #include <immintrin.h>
+  #include <intrin.h>
+  #define FLAT_FOREST_AVX512
+  #define TARGET_AVX512
+#endif
+
+// intrinsics headers go first, common.h may redefine _mm_malloc
+#include "flat_forest.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+namespace LightGBM {
+
+#ifdef FLAT_FOREST_AVX512
+
+static_assert(sizeof(FlatNode) == 24, "FlatNode should be 3 int64 wide");
+static_assert(offsetof(FlatNode, split_feature) == 8, "FlatNode layout is used by the AVX-512 kernel");
+static_assert(offsetof(FlatNode, left_child) == 12, "FlatNode layout is used by the AVX-512 kernel");
+static_assert(offsetof(FlatNode, right_child) == 16, "FlatNode layout is used by the AVX-512 kernel");
+static_assert(offsetof(FlatNode, decision_type) == 20, "FlatNode layout is used by the AVX-512 kernel");
+
+static bool DetectAVX512() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  // the OS must save the AVX-512 registers
+  if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0xE6) != 0xE6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  const bool avx2 = (info[1] & (1 << 5)) != 0;
+  const bool avx512f = (info[1] & (1 << 16)) != 0;
+  return avx2 && avx512f;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512f");
+#endif
+}
+
+static bool HasAVX512() {
+  static const bool has_avx512 = DetectAVX512();
+  return has_avx512;
+}
+
+/*! \brief Number of records routed by one vector */
+const int kLanes = 8;
+/*! \brief Number of independent vectors in flight, hides the latency of gathers */
+const int kLaneGroups = 2;
+
+/*!
+* \brief Records being routed by one vector.
+*        node < 0 means the lane is at leaf ~node, such lanes are skipped by StepLanes.
+*/
+struct LaneGroup {
+  alignas(32) int node[kLanes];
+  alignas(32) int offset[kLanes];
+  int row[kLanes];
+};
+
+/*! \brief Expand a 8-bit lane mask to 32-bit lanes */
+TARGET_AVX512 static inline __m256i ExpandMask(__mmask8 mask) {
+  const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), bits), bits);
+}
+
+/*! \brief Compress a 32-bit lane mask to 8 bits */
+TARGET_AVX512 static inline __mmask8 CompressMask(__m256i mask) {
+  return static_cast<__mmask8>(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+}
+
+/*!
+* \brief Move every lane not at a leaf one level down, same rules as FlatForest::NumericalDecision
+* \return Bit mask of lanes which reached a leaf in this step
+*/
+TARGET_AVX512 static inline int StepLanes(const FlatNode* nodes, const double* features, LaneGroup* group) {
+  // (split_feature, left_child) is the 2nd int64 of a node, (right_child, decision_type) the 3rd one
+  const long long* node_pairs = reinterpret_cast<const long long*>(nodes);
+  const double* node_doubles = reinterpret_cast<const double*>(nodes);
+  const __m512i no_pairs = _mm512_setzero_si512();
+  const __m512d zero = _mm512_setzero_pd();
+  const __m256i minus_one = _mm256_set1_epi32(-1);
+
+  __m256i node = _mm256_load_si256(reinterpret_cast<const __m256i*>(group->node));
+  const __m256i offset = _mm256_load_si256(reinterpret_cast<const __m256i*>(group->offset));
+  const __m256i active = _mm256_cmpgt_epi32(node, minus_one);
+  // lanes at a leaf read node 0, their result is discarded below
+  const __m256i idx = _mm256_and_si256(_mm256_add_epi32(_mm256_add_epi32(node, node), node), active);
+  const __m512i pair0 = _mm512_mask_i32gather_epi64(no_pairs, 0xFF, _mm256_add_epi32(idx, _mm256_set1_epi32(1)),
+                                                    node_pairs, 8);
+  const __m512i pair1 = _mm512_mask_i32gather_epi64(no_pairs, 0xFF, _mm256_add_epi32(idx, _mm256_set1_epi32(2)),
+                                                    node_pairs, 8);
+  const __m256i split_feature = _mm512_maskz_cvtepi64_epi32(0xFF, pair0);
+  const __m256i left_child = _mm512_maskz_cvtepi64_epi32(0xFF, _mm512_maskz_srli_epi64(0xFF, pair0, 32));
+  const __m256i right_child = _mm512_maskz_cvtepi64_epi32(0xFF, pair1);
+  const __m256i decision_type = _mm256_and_si256(
+      _mm512_maskz_cvtepi64_epi32(0xFF, _mm512_maskz_srli_epi64(0xFF, pair1, 32)), _mm256_set1_epi32(0xFF));
+  const __m512d threshold = _mm512_mask_i32gather_pd(zero, 0xFF, idx, node_doubles, 8);
+  __m512d fval = _mm512_mask_i32gather_pd(zero, 0xFF, _mm256_add_epi32(offset, split_feature), features, 8);
+
+  const __m256i missing_type = _mm256_and_si256(_mm256_srli_epi32(decision_type, 2), _mm256_set1_epi32(3));
+  const __mmask8 is_missing_nan = CompressMask(
+      _mm256_cmpeq_epi32(missing_type, _mm256_set1_epi32(MissingType::NaN)));
+  const __mmask8 is_missing_zero = CompressMask(
+      _mm256_cmpeq_epi32(missing_type, _mm256_set1_epi32(MissingType::Zero)));
+  const __m256i default_left = _mm256_set1_epi32(kDefaultLeftMask);
+  const __mmask8 is_default_left = CompressMask(
+      _mm256_cmpeq_epi32(_mm256_and_si256(decision_type, default_left), default_left));
+  const __mmask8 is_nan = _mm512_cmp_pd_mask(fval, fval, _CMP_UNORD_Q);
+  // NaN is treated as zero unless missing type is NaN
+  fval = _mm512_mask_blend_pd(static_cast<__mmask8>(is_nan & ~is_missing_nan), fval, zero);
+  const __mmask8 is_zero = _mm512_cmp_pd_mask(fval, _mm512_set1_pd(-kZeroThreshold), _CMP_GE_OQ)
+                           & _mm512_cmp_pd_mask(fval, _mm512_set1_pd(kZeroThreshold), _CMP_LE_OQ);
+  const __mmask8 is_missing = (is_missing_zero & is_zero) | (is_missing_nan & is_nan);
+  const __mmask8 is_le = _mm512_cmp_pd_mask(fval, threshold, _CMP_LE_OQ);
+  const __mmask8 go_left = (is_missing & is_default_left) | (~is_missing & is_le);
+  node = _mm256_blendv_epi8(node, _mm256_blendv_epi8(right_child, left_child, ExpandMask(go_left)), active);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(group->node), node);
+  return CompressMask(_mm256_andnot_si256(_mm256_cmpgt_epi32(node, minus_one), active));
+}
+
+/*!
+* \brief Add outputs of lanes which just reached a leaf, and refill them with the next records,
+*        so lanes stay busy on unbalanced trees
+* \return Number of lanes left without a record
+*/
+static inline int RefillLanes(LaneGroup* group, int finished, const double* leaf_values, int num_rows,
+                              int row_stride, double* output, int output_stride, int* next_row) {
+  int num_idle = 0;
+  for (int i = 0; i < kLanes; ++i, finished >>= 1) {
+    if ((finished & 1) == 0) {
+      continue;
+    }
+    output[static_cast<size_t>(group->row[i]) * output_stride] += leaf_values[~group->node[i]];
+    if (*next_row < num_rows) {
+      group->row[i] = *next_row;
+      group->node[i] = 0;
+      group->offset[i] = *next_row * row_stride;
+      ++(*next_row);
+    } else {
+      ++num_idle;
+    }
+  }
+  return num_idle;
+}
+
+/*!
+* \brief Route records through a tree without categorical splits, kLanes * kLaneGroups at a time
+* \return Number of records processed
+*/
+TARGET_AVX512 static int AddPredictionToBlockAVX512(const FlatNode* nodes, const double* leaf_values,
+                                                    const double* features, int num_rows, int row_stride,
+                                                    double* output, int output_stride) {
+  if (num_rows < kLanes * kLaneGroups) {
+    return 0;
+  }
+  LaneGroup groups[kLaneGroups];
+  int next_row = 0;
+  for (int g = 0; g < kLaneGroups; ++g) {
+    for (int i = 0; i < kLanes; ++i) {
+      groups[g].node[i] = 0;
+      groups[g].offset[i] = next_row * row_stride;
+      groups[g].row[i] = next_row++;
+    }
+  }
+  int num_busy = kLanes * kLaneGroups;
+  while (num_busy > 0) {
+    int finished[kLaneGroups];
+    for (int g = 0; g < kLaneGroups; ++g) {
+      finished[g] = StepLanes(nodes, features, &groups[g]);
+    }
+    for (int g = 0; g < kLaneGroups; ++g) {
+      if (finished[g] != 0) {
+        num_busy -= RefillLanes(&groups[g], finished[g], leaf_values, num_rows, row_stride,
+                                output, output_stride, &next_row);
+      }
+    }
+  }
+  return num_rows;
+}
+
+#endif  // FLAT_FOREST_AVX512
+
+void FlatForest::AddPredictionToBlock(int tree_idx, const double* features, int num_rows, int row_stride,
+                                      double* output, int output_stride) const {
+  if (oblivious_begin_[tree_idx + 1] > oblivious_begin_[tree_idx]) {
+    AddObliviousPredictionToBlock(tree_idx, features, num_rows, row_stride, output, output_stride);
+    return;
+  }
+  const double* leaf_values = leaf_values_ + leaf_offsets_[tree_idx];
+  int i = 0;
+#ifdef FLAT_FOREST_AVX512
+  // gather offsets inside the block must fit in int32
+  const bool can_use_simd = node_offsets_[tree_idx + 1] > node_offsets_[tree_idx] && !has_categorical_[tree_idx]
+                            && static_cast<int64_t>(num_rows) * row_stride <= std::numeric_limits<int>::max();
+  if (can_use_simd && HasAVX512()) {
+    i = AddPredictionToBlockAVX512(nodes_ + node_offsets_[tree_idx], leaf_values, features,
+                                   num_rows, row_stride, output, output_stride);
+  }
+#endif  // FLAT_FOREST_AVX512
+  for (; i < num_rows; ++i) {
+    output[static_cast<size_t>(i) * output_stride] +=
+        leaf_values[GetLeaf(tree_idx, features + static_cast<size_t>(i) * row_stride)];
+  }
+}
+
+void FlatForest::AddObliviousPredictionToBlock(int tree_idx, const double* features, int num_rows, int row_stride,
+                                               double* output, int output_stride) const {
+  const int kChunkSize = 64;
+  const FlatNode* nodes = nodes_ + node_offsets_[tree_idx];
+  const double* leaf_values = leaf_values_ + leaf_offsets_[tree_idx];
+  const int* leaves = oblivious_leaves_.data() + oblivious_leaf_begin_[tree_idx];
+  int index[kChunkSize];
+  for (int start = 0; start < num_rows; start += kChunkSize) {
+    const int cnt = std::min(kChunkSize, num_rows - start);
+    std::fill(index, index + cnt, 0);
+    // all the records use the same split at each depth
+    for (int i = oblivious_begin_[tree_idx]; i < oblivious_begin_[tree_idx + 1]; ++i) {
+      const FlatNode& node = nodes[oblivious_nodes_[i]];
+      const double* fval = features + static_cast<size_t>(start) * row_stride + node.split_feature;
+      for (int j = 0; j < cnt; ++j) {
+        const int next = NumericalDecision(node, fval[static_cast<size_t>(j) * row_stride]);
+        index[j] = (index[j] << 1) | static_cast<int>(next == node.right_child);
+      }
+    }
+    for (int j = 0; j < cnt; ++j) {
+      output[static_cast<size_t>(start + j) * output_stride] += leaf_values[leaves[index[j]]];
+    }
+  }
+}
+
+namespace {
+
+/*! \brief Number of int32 in the header of the binary form, padded to kAlignedSize */
+const int kFlatForestHeaderSize = kAlignedSize / sizeof(int32_t);
+
+/*! \brief Write an array followed by zeros up to the next multiple of kAlignedSize bytes, return the bytes written */
+size_t WriteAligned(const VirtualFileWriter* writer, const void* data, size_t bytes) {
+  static const char zeros[kAlignedSize] = {0};
+  size_t written = 0;
+  if (bytes > 0) {
+    written += writer->Write(data, bytes);
+  }
+  if (SIZE_ALIGNED(bytes) > bytes) {
+    written += writer->Write(zeros, SIZE_ALIGNED(bytes) - bytes);
+  }
+  return written;
+}
+
+/*! \brief Point out to an array of count elements at *offset of buffer, and advance *offset past it */
+template<typename T>
+bool ViewAligned(const char* buffer, size_t len, size_t count, size_t* offset, const T** out) {
+  const size_t bytes = sizeof(T) * count;
+  if (*offset > len || len - *offset < bytes) {
+    return false;
+  }
+  *out = reinterpret_cast<const T*>(buffer + *offset);
+  *offset += SIZE_ALIGNED(bytes);
+  return true;
+}
+
+}  // namespace
+
+size_t FlatForest::SaveBinaryToFile(const VirtualFileWriter* writer) const {
+  int32_t header[kFlatForestHeaderSize] = {0};
+  header[0] = static_cast<int32_t>(sizeof(FlatNode));
+  header[1] = num_trees_;
+  header[2] = node_offsets_[num_trees_];
+  header[3] = leaf_offsets_[num_trees_];
+  header[4] = num_cat_bitsets_;
+  header[5] = cat_boundaries_[num_cat_bitsets_];
+  size_t written = writer->Write(header, sizeof(header));
+  written += WriteAligned(writer, nodes_, sizeof(FlatNode) * header[2]);
+  written += WriteAligned(writer, leaf_values_, sizeof(double) * header[3]);
+  written += WriteAligned(writer, node_offsets_, sizeof(int) * (num_trees_ + 1));
+  written += WriteAligned(writer, leaf_offsets_, sizeof(int) * (num_trees_ + 1));
+  written += WriteAligned(writer, has_categorical_, sizeof(uint8_t) * num_trees_);
+  written += WriteAligned(writer, cat_boundaries_, sizeof(int) * (num_cat_bitsets_ + 1));
+  written += WriteAligned(writer, cat_threshold_, sizeof(uint32_t) * header[5]);
+  return written;
+}
+
+size_t FlatForest::SizesInByte() const {
+  return sizeof(int32_t) * kFlatForestHeaderSize
+    + SIZE_ALIGNED(sizeof(FlatNode) * node_offsets_[num_trees_])
+    + SIZE_ALIGNED(sizeof(double) * leaf_offsets_[num_trees_])
+    + SIZE_ALIGNED(sizeof(int) * (num_trees_ + 1)) * 2
+    + SIZE_ALIGNED(sizeof(uint8_t) * num_trees_)
+    + SIZE_ALIGNED(sizeof(int) * (num_cat_bitsets_ + 1))
+    + SIZE_ALIGNED(sizeof(uint32_t) * cat_boundaries_[num_cat_bitsets_]);
+}
+
+bool FlatForest::InitFromMemory(const char* buffer, size_t len, int num_features) {
+  int32_t header[kFlatForestHeaderSize];
+  if (len < sizeof(header) || reinterpret_cast<uintptr_t>(buffer) % sizeof(double) != 0) {
+    return false;
+  }
+  std::memcpy(header, buffer, sizeof(header));
+  if (header[0] != static_cast<int32_t>(sizeof(FlatNode))) {
+    return false;
+  }
+  for (int i = 1; i < 6; ++i) {
+    if (header[i] < 0) {
+      return false;
+    }
+  }
+  const int num_trees = header[1];
+  const int num_cat_bitsets = header[4];
+  const FlatNode* nodes;
+  const double* leaf_values;
+  const int* node_offsets;
+  const int* leaf_offsets;
+  const uint8_t* has_categorical;
+  const int* cat_boundaries;
+  const uint32_t* cat_threshold;
+  size_t offset = sizeof(header);
+  if (!ViewAligned(buffer, len, header[2], &offset, &nodes)
+      || !ViewAligned(buffer, len, header[3], &offset, &leaf_values)
+      || !ViewAligned(buffer, len, num_trees + 1, &offset, &node_offsets)
+      || !ViewAligned(buffer, len, num_trees + 1, &offset, &leaf_offsets)
+      || !ViewAligned(buffer, len, num_trees, &offset, &has_categorical)
+      || !ViewAligned(buffer, len, num_cat_bitsets + 1, &offset, &cat_boundaries)
+      || !ViewAligned(buffer, len, header[5], &offset, &cat_threshold)) {
+    return false;
+  }
+  if (node_offsets[0] != 0 || leaf_offsets[0] != 0 || cat_boundaries[0] != 0
+      || node_offsets[num_trees] != header[2] || leaf_offsets[num_trees] != header[3]
+      || cat_boundaries[num_cat_bitsets] != header[5]) {
+    return false;
+  }
+  for (int i = 0; i < num_cat_bitsets; ++i) {
+    if (cat_boundaries[i] > cat_boundaries[i + 1]) {
+      return false;
+    }
+  }
+  // nodes are followed without bounds checks, so every index must stay inside its tree
+  for (int tree_idx = 0; tree_idx < num_trees; ++tree_idx) {
+    const int num_nodes = node_offsets[tree_idx + 1] - node_offsets[tree_idx];
+    const int num_leaves = leaf_offsets[tree_idx + 1] - leaf_offsets[tree_idx];
+    if (num_nodes < 0 || num_leaves != num_nodes + 1) {
+      return false;
+    }
+    const FlatNode* tree_nodes = nodes + node_offsets[tree_idx];
+    for (int i = 0; i < num_nodes; ++i) {
+      const FlatNode& node = tree_nodes[i];
+      if (node.split_feature < 0 || node.split_feature >= num_features
+          || Tree::GetMissingType(node.decision_type) > MissingType::NaN) {
+        return false;
+      }
+      // children always have larger indices than their parent, so the walk down the tree ends
+      for (const int child : {node.left_child, node.right_child}) {
+        if (child >= 0 ? (child <= i || child >= num_nodes) : (~child >= num_leaves)) {
+          return false;
+        }
+      }
+      if (Tree::GetDecisionType(node.decision_type, kCategoricalMask)) {
+        const int cat_idx = static_cast<int>(node.threshold);
+        if (!has_categorical[tree_idx] || !(node.threshold >= 0 && node.threshold < num_cat_bitsets)
+            || node.threshold != cat_idx) {
+          return false;
+        }
+      } else if (std::isnan(node.threshold)) {
+        return false;
+      }
+    }
+  }
+  Clear();
+  nodes_ = nodes;
+  leaf_values_ = leaf_values;
+  node_offsets_ = node_offsets;
+  leaf_offsets_ = leaf_offsets;
+  has_categorical_ = has_categorical;
+  cat_boundaries_ = cat_boundaries;
+  cat_threshold_ = cat_threshold;
+  num_trees_ = num_trees;
+  num_cat_bitsets_ = num_cat_bitsets;
+  InitBins(num_features, false);
+  // thresholds in bin are used in place as well, they must agree with the rebuilt bin upper bounds
+  for (int i = 0; i < node_offsets_[num_trees_]; ++i) {
+    const FlatNode& node = nodes_[i];
+    if (!Tree::GetDecisionType(node.decision_type, kCategoricalMask)
+        && node.threshold_in_bin != std::min<uint32_t>(BinOf(bin_upper_bounds_[node.split_feature], node.threshold),
+                                                       std::numeric_limits<uint16_t>::max())) {
+      Clear();
+      return false;
+    }
+  }
+  InitOblivious();
+  return true;
+}
+
+}  // namespace LightGBM
@@ -0,0 +1,526 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#ifndef LIGHTGBM_BOOSTING_FLAT_FOREST_HPP_
+#define LIGHTGBM_BOOSTING_FLAT_FOREST_HPP_
+
+#include <LightGBM/meta.h>
+#include <LightGBM/tree.h>
+#include <LightGBM/utils/common.h>
+#include <LightGBM/utils/file_io.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace LightGBM {
+
+/*!
+* \brief One non-leaf node of a flattened tree.
+*        Everything needed to route a sample lives in the same 24 bytes,
+*        so one node visit touches a single cache line.
+*/
+struct FlatNode {
+  /*! \brief Threshold on feature value; for categorical splits, the index of its bitset in FlatForest */
+  double threshold;
+  /*! \brief Split feature, the original index on data */
+  int32_t split_feature;
+  /*! \brief Left child, node index inside the tree if >= 0, otherwise ~leaf index */
+  int32_t left_child;
+  /*! \brief Right child, node index inside the tree if >= 0, otherwise ~leaf index */
+  int32_t right_child;
+  /*! \brief Same encoding as Tree::decision_type_ */
+  int8_t decision_type;
+  /*! \brief Index of threshold in the bin upper bounds of split feature, for numerical splits */
+  uint16_t threshold_in_bin;
+};
+
+/*!
+* \brief Read-only copy of a list of trees stored in contiguous arrays, used for prediction.
+*        Nodes of tree i are nodes_[node_offsets_[i], node_offsets_[i + 1]),
+*        leaf outputs are leaf_values_[leaf_offsets_[i], leaf_offsets_[i + 1]).
+*        Routing follows exactly the same rules as Tree::Decision.
+*        Records can also be routed by bins: the upper bounds of bins of a feature are the distinct thresholds
+*        of its numerical splits, so comparing bins gives the same decisions as comparing values.
+*        The arrays are either owned, or used in place from a buffer written by SaveBinaryToFile,
+*        e.g. a memory mapped model file.
+*/
+class FlatForest {
+ public:
+  FlatForest() {
+    Clear();
+  }
+
+  FlatForest(const FlatForest&) = delete;
+  FlatForest& operator=(const FlatForest&) = delete;
+
+  /*!
+  * \brief Rebuild from trees
+  * \param models Trees to copy, in the order they will be indexed
+  * \param num_features Number of features of the model
+  */
+  void Init(const std::vector<std::unique_ptr<Tree>>& models, int num_features) {
+    Init(models, 0, static_cast<int>(models.size()), num_features);
+  }
+
+  /*!
+  * \brief Rebuild from trees [start_tree, start_tree + num_trees) of models
+  */
+  void Init(const std::vector<std::unique_ptr<Tree>>& models, int start_tree, int num_trees, int num_features) {
+    Clear();
+    size_t total_nodes = 0;
+    size_t total_leaves = 0;
+    for (int i = start_tree; i < start_tree + num_trees; ++i) {
+      total_leaves += models[i]->num_leaves_;
+      total_nodes += models[i]->num_leaves_ - 1;
+    }
+    nodes_storage_.reserve(total_nodes);
+    leaf_values_storage_.reserve(total_leaves);
+    node_offsets_storage_.reserve(num_trees + 1);
+    leaf_offsets_storage_.reserve(num_trees + 1);
+    has_categorical_storage_.reserve(num_trees);
+    for (int i = start_tree; i < start_tree + num_trees; ++i) {
+      AppendTree(*models[i]);
+    }
+    InitBins(num_features, true);
+    UseStorage();
+    InitOblivious();
+  }
+
+  /*!
+  * \brief Use arrays written by SaveBinaryToFile in place, without copying them.
+  *        The buffer must outlive this object or the next Init / Clear.
+  * \param buffer Start of the serialized arrays, aligned to at least 8 bytes
+  * \param len Size of buffer in bytes
+  * \param num_features Number of features of the model
+  * \return false if the buffer was written with another layout or holds invalid trees,
+  *         then the forest is empty
+  */
+  bool InitFromMemory(const char* buffer, size_t len, int num_features);
+
+  /*!
+  * \brief Save the arrays used for prediction, each of them aligned to kAlignedSize bytes from the start.
+  *        Bin upper bounds are rebuilt by InitFromMemory.
+  * \param writer Writer, its position must be aligned to kAlignedSize bytes for the arrays to be aligned in file
+  * \return Number of bytes written, less than SizesInByte() when writing failed
+  */
+  size_t SaveBinaryToFile(const VirtualFileWriter* writer) const;
+
+  /*! \brief Size of the output of SaveBinaryToFile in bytes */
+  size_t SizesInByte() const;
+
+  void Clear() {
+    // swap with empty containers to release memory
+    decltype(nodes_storage_)().swap(nodes_storage_);
+    decltype(leaf_values_storage_)().swap(leaf_values_storage_);
+    node_offsets_storage_.assign(1, 0);
+    leaf_offsets_storage_.assign(1, 0);
+    std::vector<uint8_t>().swap(has_categorical_storage_);
+    cat_boundaries_storage_.assign(1, 0);
+    std::vector<uint32_t>().swap(cat_threshold_storage_);
+    bin_upper_bounds_.clear();
+    zero_bin_.clear();
+    zero_bin_begin_.clear();
+    zero_bin_end_.clear();
+    max_num_bin_ = 0;
+    oblivious_begin_.assign(1, 0);
+    oblivious_leaf_begin_.assign(1, 0);
+    oblivious_nodes_.clear();
+    oblivious_leaves_.clear();
+    UseStorage();
+  }
+
+  inline int num_trees() const { return num_trees_; }
+
+  inline int num_features() const { return static_cast<int>(bin_upper_bounds_.size()); }
+
+  /*! \brief Max number of bins over all features */
+  inline int max_num_bin() const { return max_num_bin_; }
+
+  /*!
+  * \brief Upper bounds of bins of one feature, value x is in bin i if bounds[i - 1] < x <= bounds[i].
+  *        The last bin has no upper bound.
+  */
+  inline const std::vector<double>& bin_upper_bounds(int feature_idx) const {
+    return bin_upper_bounds_[feature_idx];
+  }
+
+  /*!
+  * \brief Whether any of trees [start_tree, start_tree + num_trees) has a categorical split
+  */
+  inline bool HasCategorical(int start_tree, int num_trees) const {
+    for (int i = start_tree; i < start_tree + num_trees; ++i) {
+      if (has_categorical_[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*!
+  * \brief Find leaf index of which record belongs in one tree
+  * \param tree_idx Index of the tree
+  * \param feature_values Feature value of this record
+  * \return Leaf index inside the tree
+  */
+  inline int GetLeaf(int tree_idx, const double* feature_values) const {
+    const FlatNode* nodes = nodes_ + node_offsets_[tree_idx];
+    if (node_offsets_[tree_idx + 1] == node_offsets_[tree_idx]) {
+      return 0;
+    }
+    if (oblivious_begin_[tree_idx + 1] > oblivious_begin_[tree_idx]) {
+      int index = 0;
+      for (int i = oblivious_begin_[tree_idx]; i < oblivious_begin_[tree_idx + 1]; ++i) {
+        const FlatNode& cur_node = nodes[oblivious_nodes_[i]];
+        const int next = NumericalDecision(cur_node, feature_values[cur_node.split_feature]);
+        index = (index << 1) | static_cast<int>(next == cur_node.right_child);
+      }
+      return oblivious_leaves_[oblivious_leaf_begin_[tree_idx] + index];
+    }
+    int node = 0;
+    if (has_categorical_[tree_idx]) {
+      while (node >= 0) {
+        node = Decision(nodes[node], feature_values[nodes[node].split_feature]);
+      }
+    } else {
+      while (node >= 0) {
+        node = NumericalDecision(nodes[node], feature_values[nodes[node].split_feature]);
+      }
+    }
+    return ~node;
+  }
+
+  /*!
+  * \brief Find leaf index of which binned record belongs in a tree without categorical splits
+  * \param tree_idx Index of the tree
+  * \param bins Bin of each feature, bin of feature j is bins[j * bin_stride].
+  *             The max value of BIN_T stands for missing value (NaN)
+  * \param bin_stride Distance between bins of two features
+  * \return Leaf index inside the tree
+  */
+  template<typename BIN_T>
+  inline int GetLeafByBin(int tree_idx, const BIN_T* bins, int64_t bin_stride) const {
+    const FlatNode* nodes = nodes_ + node_offsets_[tree_idx];
+    if (node_offsets_[tree_idx + 1] == node_offsets_[tree_idx]) {
+      return 0;
+    }
+    const uint32_t missing_bin = std::numeric_limits<BIN_T>::max();
+    if (oblivious_begin_[tree_idx + 1] > oblivious_begin_[tree_idx]) {
+      int index = 0;
+      for (int i = oblivious_begin_[tree_idx]; i < oblivious_begin_[tree_idx + 1]; ++i) {
+        const FlatNode& cur_node = nodes[oblivious_nodes_[i]];
+        const int next = NumericalDecisionInBin(cur_node, bins[cur_node.split_feature * bin_stride], missing_bin);
+        index = (index << 1) | static_cast<int>(next == cur_node.right_child);
+      }
+      return oblivious_leaves_[oblivious_leaf_begin_[tree_idx] + index];
+    }
+    int node = 0;
+    while (node >= 0) {
+      const FlatNode& cur_node = nodes[node];
+      node = NumericalDecisionInBin(cur_node, bins[cur_node.split_feature * bin_stride], missing_bin);
+    }
+    return ~node;
+  }
+
+  /*!
+  * \brief Prediction of one tree on one record
+  * \param tree_idx Index of the tree
+  * \param feature_values Feature value of this record
+  * \return Output of the leaf
+  */
+  inline double Predict(int tree_idx, const double* feature_values) const {
+    return leaf_values_[leaf_offsets_[tree_idx] + GetLeaf(tree_idx, feature_values)];
+  }
+
+  /*!
+  * \brief Prediction of one tree without categorical splits on one binned record
+  * \param tree_idx Index of the tree
+  * \param bins Bin of each feature, same as GetLeafByBin
+  * \param bin_stride Distance between bins of two features
+  * \return Output of the leaf
+  */
+  template<typename BIN_T>
+  inline double PredictByBin(int tree_idx, const BIN_T* bins, int64_t bin_stride) const {
+    return leaf_values_[leaf_offsets_[tree_idx] + GetLeafByBin(tree_idx, bins, bin_stride)];
+  }
+
+  /*!
+  * \brief Add prediction of one tree to a block of records.
+  *        Trees without categorical splits advance 16 records at once with AVX-512
+  *        when the CPU supports it.
+  * \param tree_idx Index of the tree
+  * \param features Feature values, record i starts at features + i * row_stride
+  * \param num_rows Number of records
+  * \param row_stride Distance between two records
+  * \param output Prediction of record i is added to output[i * output_stride]
+  * \param output_stride Distance between outputs of two records
+  */
+  void AddPredictionToBlock(int tree_idx, const double* features, int num_rows, int row_stride,
+                            double* output, int output_stride) const;
+
+ private:
+  /*! \brief Same as AddPredictionToBlock for an oblivious tree, records are routed depth by depth */
+  void AddObliviousPredictionToBlock(int tree_idx, const double* features, int num_rows, int row_stride,
+                                     double* output, int output_stride) const;
+
+  /*!
+  * \brief Find the trees whose nodes of each depth share one numerical split, same rules as
+  *        Tree::RecomputeObliviousLevels. Their leaf is found from a bit per depth.
+  */
+  void InitOblivious() {
+    oblivious_begin_.assign(1, 0);
+    oblivious_leaf_begin_.assign(1, 0);
+    oblivious_nodes_.clear();
+    oblivious_leaves_.clear();
+    std::vector<int> level;
+    std::vector<int> next_level;
+    std::vector<int> level_nodes;
+    for (int tree_idx = 0; tree_idx < num_trees_; ++tree_idx) {
+      const FlatNode* nodes = nodes_ + node_offsets_[tree_idx];
+      const int num_leaves = node_offsets_[tree_idx + 1] - node_offsets_[tree_idx] + 1;
+      bool is_oblivious = num_leaves > 1 && (num_leaves & (num_leaves - 1)) == 0 && !has_categorical_[tree_idx];
+      level.assign(1, 0);
+      level_nodes.clear();
+      while (is_oblivious && level[0] >= 0) {
+        const FlatNode& first = nodes[level[0]];
+        next_level.clear();
+        for (const int cur : level) {
+          if (cur < 0 || nodes[cur].split_feature != first.split_feature
+              || nodes[cur].threshold != first.threshold
+              || nodes[cur].decision_type != first.decision_type) {
+            is_oblivious = false;
+            break;
+          }
+          next_level.push_back(nodes[cur].left_child);
+          next_level.push_back(nodes[cur].right_child);
+        }
+        level_nodes.push_back(level[0]);
+        level.swap(next_level);
+      }
+      for (const int leaf : level) {
+        is_oblivious = is_oblivious && leaf < 0;
+      }
+      if (is_oblivious) {
+        oblivious_nodes_.insert(oblivious_nodes_.end(), level_nodes.begin(), level_nodes.end());
+        for (const int leaf : level) {
+          oblivious_leaves_.push_back(~leaf);
+        }
+      }
+      oblivious_begin_.push_back(static_cast<int>(oblivious_nodes_.size()));
+      oblivious_leaf_begin_.push_back(static_cast<int>(oblivious_leaves_.size()));
+    }
+  }
+
+  void AppendTree(const Tree& tree) {
+    const int num_nodes = tree.num_leaves_ - 1;
+    const int cat_base = static_cast<int>(cat_boundaries_storage_.size()) - 1;
+    for (int i = 0; i < num_nodes; ++i) {
+      FlatNode node = FlatNode();
+      node.split_feature = tree.split_feature_[i];
+      node.left_child = tree.left_child_[i];
+      node.right_child = tree.right_child_[i];
+      node.decision_type = tree.decision_type_[i];
+      node.threshold = tree.threshold_[i];
+      if (Tree::GetDecisionType(node.decision_type, kCategoricalMask)) {
+        node.threshold += cat_base;
+      }
+      nodes_storage_.push_back(node);
+    }
+    const int cat_threshold_base = static_cast<int>(cat_threshold_storage_.size());
+    for (int i = 0; i < tree.num_cat_; ++i) {
+      cat_boundaries_storage_.push_back(cat_threshold_base + tree.cat_boundaries_[i + 1]);
+    }
+    cat_threshold_storage_.insert(cat_threshold_storage_.end(), tree.cat_threshold_.begin(), tree.cat_threshold_.end());
+    for (int i = 0; i < tree.num_leaves_; ++i) {
+      leaf_values_storage_.push_back(tree.leaf_value_[i]);
+    }
+    node_offsets_storage_.push_back(static_cast<int>(nodes_storage_.size()));
+    leaf_offsets_storage_.push_back(static_cast<int>(leaf_values_storage_.size()));
+    has_categorical_storage_.push_back(tree.num_cat_ > 0);
+  }
+
+  /*! \brief Point the arrays used for prediction to the owned storage */
+  void UseStorage() {
+    nodes_ = nodes_storage_.data();
+    leaf_values_ = leaf_values_storage_.data();
+    node_offsets_ = node_offsets_storage_.data();
+    leaf_offsets_ = leaf_offsets_storage_.data();
+    has_categorical_ = has_categorical_storage_.data();
+    cat_boundaries_ = cat_boundaries_storage_.data();
+    cat_threshold_ = cat_threshold_storage_.data();
+    num_trees_ = static_cast<int>(has_categorical_storage_.size());
+    num_cat_bitsets_ = static_cast<int>(cat_boundaries_storage_.size()) - 1;
+  }
+
+  inline static int NumericalDecision(const FlatNode& node, double fval) {
+    const int8_t missing_type = Tree::GetMissingType(node.decision_type);
+    if (std::isnan(fval) && missing_type != MissingType::NaN) {
+      fval = 0.0f;
+    }
+    if ((missing_type == MissingType::Zero && Tree::IsZero(fval))
+        || (missing_type == MissingType::NaN && std::isnan(fval))) {
+      if (Tree::GetDecisionType(node.decision_type, kDefaultLeftMask)) {
+        return node.left_child;
+      } else {
+        return node.right_child;
+      }
+    }
+    if (fval <= node.threshold) {
+      return node.left_child;
+    } else {
+      return node.right_child;
+    }
+  }
+
+  /*! \brief Same as NumericalDecision, on the bin of feature value */
+  inline int NumericalDecisionInBin(const FlatNode& node, uint32_t bin, uint32_t missing_bin) const {
+    const int8_t missing_type = Tree::GetMissingType(node.decision_type);
+    if (bin == missing_bin) {
+      if (missing_type == MissingType::NaN) {
+        return Tree::GetDecisionType(node.decision_type, kDefaultLeftMask) ? node.left_child : node.right_child;
+      }
+      bin = zero_bin_[node.split_feature];
+    }
+    if (missing_type == MissingType::Zero
+        && bin >= zero_bin_begin_[node.split_feature] && bin <= zero_bin_end_[node.split_feature]) {
+      return Tree::GetDecisionType(node.decision_type, kDefaultLeftMask) ? node.left_child : node.right_child;
+    }
+    if (bin <= node.threshold_in_bin) {
+      return node.left_child;
+    } else {
+      return node.right_child;
+    }
+  }
+
+  /*!
+  * \brief Collect bin upper bounds from numerical thresholds, and locate thresholds in them.
+  *        Bounds just below -kZeroThreshold and at kZeroThreshold are always included,
+  *        so the values treated as zero form a range of bins.
+  * \param num_features Number of features of the model
+  * \param locate_thresholds Whether to set threshold_in_bin of nodes_storage_,
+  *        nodes used in place from memory already have it
+  */
+  void InitBins(int num_features, bool locate_thresholds) {
+    const FlatNode* nodes = locate_thresholds ? nodes_storage_.data() : nodes_;
+    const int num_nodes = locate_thresholds ? static_cast<int>(nodes_storage_.size()) : node_offsets_[num_trees_];
+    for (int i = 0; i < num_nodes; ++i) {
+      num_features = std::max(num_features, nodes[i].split_feature + 1);
+    }
+    const double below_zero = std::nextafter(-kZeroThreshold, -std::numeric_limits<double>::infinity());
+    bin_upper_bounds_.assign(num_features, std::vector<double>{below_zero, kZeroThreshold});
+    for (int i = 0; i < num_nodes; ++i) {
+      const FlatNode& node = nodes[i];
+      if (!Tree::GetDecisionType(node.decision_type, kCategoricalMask)) {
+        bin_upper_bounds_[node.split_feature].push_back(node.threshold);
+      }
+    }
+    zero_bin_.resize(num_features);
+    zero_bin_begin_.resize(num_features);
+    zero_bin_end_.resize(num_features);
+    max_num_bin_ = 0;
+    for (int i = 0; i < num_features; ++i) {
+      auto& bounds = bin_upper_bounds_[i];
+      std::sort(bounds.begin(), bounds.end());
+      bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+      zero_bin_[i] = BinOf(bounds, 0.0);
+      zero_bin_begin_[i] = BinOf(bounds, -kZeroThreshold);
+      zero_bin_end_[i] = BinOf(bounds, kZeroThreshold);
+      max_num_bin_ = std::max(max_num_bin_, static_cast<int>(bounds.size()) + 1);
+    }
+    if (!locate_thresholds) {
+      return;
+    }
+    for (auto& node : nodes_storage_) {
+      if (!Tree::GetDecisionType(node.decision_type, kCategoricalMask)) {
+        const uint32_t bin = BinOf(bin_upper_bounds_[node.split_feature], node.threshold);
+        node.threshold_in_bin = static_cast<uint16_t>(std::min<uint32_t>(bin, std::numeric_limits<uint16_t>::max()));
+      }
+    }
+  }
+
+  /*! \brief Number of bounds smaller than value */
+  inline static uint32_t BinOf(const std::vector<double>& bounds, double value) {
+    return static_cast<uint32_t>(std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
+  }
+
+  inline int CategoricalDecision(const FlatNode& node, double fval) const {
+    const int8_t missing_type = Tree::GetMissingType(node.decision_type);
+    int int_fval = static_cast<int>(fval);
+    if (int_fval < 0) {
+      return node.right_child;
+    } else if (std::isnan(fval)) {
+      // NaN is always in the right
+      if (missing_type == MissingType::NaN) {
+        return node.right_child;
+      }
+      int_fval = 0;
+    }
+    const int cat_idx = static_cast<int>(node.threshold);
+    if (Common::FindInBitset(cat_threshold_ + cat_boundaries_[cat_idx],
+                             cat_boundaries_[cat_idx + 1] - cat_boundaries_[cat_idx], int_fval)) {
+      return node.left_child;
+    }
+    return node.right_child;
+  }
+
+  inline int Decision(const FlatNode& node, double fval) const {
+    if (Tree::GetDecisionType(node.decision_type, kCategoricalMask)) {
+      return CategoricalDecision(node, fval);
+    } else {
+      return NumericalDecision(node, fval);
+    }
+  }
+
+  /*! \brief Non-leaf nodes of all trees */
+  const FlatNode* nodes_;
+  /*! \brief Leaf outputs of all trees */
+  const double* leaf_values_;
+  /*! \brief Start position of each tree in nodes_, num_trees_ + 1 elements */
+  const int* node_offsets_;
+  /*! \brief Start position of each tree in leaf_values_, num_trees_ + 1 elements */
+  const int* leaf_offsets_;
+  /*! \brief Whether each tree has any categorical split */
+  const uint8_t* has_categorical_;
+  /*! \brief Boundaries of categorical bitsets of all trees in cat_threshold_, num_cat_bitsets_ + 1 elements */
+  const int* cat_boundaries_;
+  /*! \brief Categorical bitsets of all trees */
+  const uint32_t* cat_threshold_;
+  int num_trees_;
+  int num_cat_bitsets_;
+  /*! \brief Owned arrays, used when built from trees */
+  std::vector<FlatNode, Common::AlignmentAllocator<FlatNode, kAlignedSize>> nodes_storage_;
+  std::vector<double, Common::AlignmentAllocator<double, kAlignedSize>> leaf_values_storage_;
+  std::vector<int> node_offsets_storage_;
+  std::vector<int> leaf_offsets_storage_;
+  std::vector<uint8_t> has_categorical_storage_;
+  std::vector<int> cat_boundaries_storage_;
+  std::vector<uint32_t> cat_threshold_storage_;
+  /*! \brief Upper bounds of bins of each feature */
+  std::vector<std::vector<double>> bin_upper_bounds_;
+  /*! \brief Bin of value 0 of each feature, used for NaN when missing type is not NaN */
+  std::vector<uint32_t> zero_bin_;
+  /*! \brief First bin of values treated as zero of each feature */
+  std::vector<uint32_t> zero_bin_begin_;
+  /*! \brief Last bin of values treated as zero of each feature */
+  std::vector<uint32_t> zero_bin_end_;
+  /*! \brief Max number of bins over all features */
+  int max_num_bin_;
+  /*!
+  * \brief Start of each tree in oblivious_nodes_, num_trees_ + 1 elements, empty for trees which are not oblivious.
+  *        Rebuilt from the nodes, not saved
+  */
+  std::vector<int> oblivious_begin_;
+  /*! \brief Start of each tree in oblivious_leaves_, num_trees_ + 1 elements */
+  std::vector<int> oblivious_leaf_begin_;
+  /*! \brief Node inside the tree whose split is used by each depth of oblivious trees */
+  std::vector<int> oblivious_nodes_;
+  /*! \brief Leaf inside the tree of each bit index of oblivious trees, the bit of a depth is 1 for right */
+  std::vector<int> oblivious_leaves_;
+};
+
+}  // namespace LightGBM
+#endif   // LIGHTGBM_BOOSTING_FLAT_FOREST_HPP_
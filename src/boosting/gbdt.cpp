@@ -31,7 +31,11 @@ GBDT::GBDT()
       num_init_iteration_(0),
       need_re_bagging_(false),
       balanced_bagging_(false),
-      bagging_runner_(0, bagging_rand_block_) {
+      bagging_runner_(0, bagging_rand_block_),
+      mapped_trees_(nullptr),
+      has_mapped_trees_(false),
+      is_flat_forest_valid_(false),
+      is_shap_forest_valid_(false) {
   average_output_ = false;
   tree_learner_ = nullptr;
 }
@@ -129,7 +133,7 @@ void GBDT::AddValidDataset(const Dataset* valid_data,
   for (int i = 0; i < iter_; ++i) {
     for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
       auto curr_tree = (i + num_init_iteration_) * num_tree_per_iteration_ + cur_tree_id;
-      new_score_updater->AddScore(models_[curr_tree].get(), cur_tree_id);
+      new_score_updater->AddScore(Models()[curr_tree].get(), cur_tree_id);
     }
   }
   valid_score_updater_.push_back(std::move(new_score_updater));
@@ -258,7 +262,8 @@ void GBDT::Train(int snapshot_freq, const std::string& model_output_path) {
     if (snapshot_freq > 0
         && (iter + 1) % snapshot_freq == 0) {
       std::string snapshot_out = model_output_path + ".snapshot_iter_" + std::to_string(iter + 1);
-      SaveModelToFile(0, -1, config_->saved_feature_importance_type, snapshot_out.c_str());
+      SaveModelToFile(0, -1, config_->saved_feature_importance_type, snapshot_out.c_str(),
+                      config_->saved_model_binary);
     }
   }
 }
@@ -269,6 +274,8 @@ void GBDT::RefitTree(const std::vector<std::vector<int>>& tree_leaf_prediction)
   CHECK_EQ(static_cast<size_t>(models_.size()), tree_leaf_prediction[0].size());
   int num_iterations = static_cast<int>(models_.size() / num_tree_per_iteration_);
   std::vector<int> leaf_pred(num_data_);
+  ResetFlatForest();
+  auto& models = Models();
   for (int iter = 0; iter < num_iterations; ++iter) {
     Boosting();
     for (int tree_id = 0; tree_id < num_tree_per_iteration_; ++tree_id) {
@@ -276,14 +283,14 @@ void GBDT::RefitTree(const std::vector<std::vector<int>>& tree_leaf_prediction)
       #pragma omp parallel for schedule(static)
       for (int i = 0; i < num_data_; ++i) {
         leaf_pred[i] = tree_leaf_prediction[i][model_index];
-        CHECK_LT(leaf_pred[i], models_[model_index]->num_leaves());
+        CHECK_LT(leaf_pred[i], models[model_index]->num_leaves());
       }
       size_t offset = static_cast<size_t>(tree_id) * num_data_;
       auto grad = gradients_.data() + offset;
       auto hess = hessians_.data() + offset;
-      auto new_tree = tree_learner_->FitByExistingTree(models_[model_index].get(), leaf_pred, grad, hess);
+      auto new_tree = tree_learner_->FitByExistingTree(models[model_index].get(), leaf_pred, grad, hess);
       train_score_updater_->AddScore(tree_learner_.get(), new_tree, tree_id);
-      models_[model_index].reset(new_tree);
+      models[model_index].reset(new_tree);
     }
   }
 }
@@ -336,6 +343,7 @@ double GBDT::BoostFromAverage(int class_id, bool update_scorer) {
 
 bool GBDT::TrainOneIter(const score_t* gradients, const score_t* hessians) {
   Common::FunctionTimer fun_timer("GBDT::TrainOneIter", global_timer);
+  ResetFlatForest();
   std::vector<double> init_scores(num_tree_per_iteration_, 0.0);
   // boosting first
   if (gradients == nullptr || hessians == nullptr) {
@@ -420,13 +428,14 @@ bool GBDT::TrainOneIter(const score_t* gradients, const score_t* hessians) {
 
 void GBDT::RollbackOneIter() {
   if (iter_ <= 0) { return; }
+  ResetFlatForest();
   // reset score
   for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
     auto curr_tree = models_.size() - num_tree_per_iteration_ + cur_tree_id;
-    models_[curr_tree]->Shrinkage(-1.0);
-    train_score_updater_->AddScore(models_[curr_tree].get(), cur_tree_id);
+    Models()[curr_tree]->Shrinkage(-1.0);
+    train_score_updater_->AddScore(Models()[curr_tree].get(), cur_tree_id);
     for (auto& score_updater : valid_score_updater_) {
-      score_updater->AddScore(models_[curr_tree].get(), cur_tree_id);
+      score_updater->AddScore(Models()[curr_tree].get(), cur_tree_id);
     }
   }
   // remove model
@@ -448,6 +457,7 @@ bool GBDT::EvalAndCheckEarlyStopping() {
               iter_, iter_ - early_stopping_round_);
     Log::Info("Output of best iteration round:\n%s", best_msg.c_str());
     // pop last early_stopping_round_ models
+    ResetFlatForest();
     for (int i = 0; i < early_stopping_round_ * num_tree_per_iteration_; ++i) {
       models_.pop_back();
     }
@@ -571,6 +581,11 @@ const double* GBDT::GetTrainingScore(int64_t* out_len) {
 }
 
 void GBDT::PredictContrib(const double* features, double* output) const {
+  const ShapForest* shap_forest = GetShapForest();
+  if (shap_forest != nullptr) {
+    PredictContribBlock(features, 1, max_feature_idx_ + 1, output);
+    return;
+  }
   // set zero
   const int num_features = max_feature_idx_ + 1;
   std::memset(output, 0, sizeof(double) * num_tree_per_iteration_ * (num_features + 1));
@@ -578,11 +593,36 @@ void GBDT::PredictContrib(const double* features, double* output) const {
   for (int i = start_iteration_for_pred_; i < end_iteration_for_pred; ++i) {
     // predict all the trees for one iteration
     for (int k = 0; k < num_tree_per_iteration_; ++k) {
-      models_[i * num_tree_per_iteration_ + k]->PredictContrib(features, num_features, output + k*(num_features + 1));
+      Models()[i * num_tree_per_iteration_ + k]->PredictContrib(features, num_features, output + k*(num_features + 1));
     }
   }
 }
 
+void GBDT::PredictContribBlock(const double* features, int num_rows, int row_stride, double* output) const {
+  const ShapForest* shap_forest = GetShapForest();
+  if (shap_forest == nullptr) {
+    const int num_pred_in_one_row = num_tree_per_iteration_ * (max_feature_idx_ + 2);
+    for (int i = 0; i < num_rows; ++i) {
+      PredictContrib(features + static_cast<size_t>(i) * row_stride, output + static_cast<size_t>(i) * num_pred_in_one_row);
+    }
+    return;
+  }
+  const int num_features = max_feature_idx_ + 1;
+  const int num_pred_in_one_row = num_tree_per_iteration_ * (num_features + 1);
+  const size_t output_size = static_cast<size_t>(num_rows) * num_pred_in_one_row;
+  const int start_tree = start_iteration_for_pred_ * num_tree_per_iteration_;
+  const int num_trees = num_iteration_for_pred_ * num_tree_per_iteration_;
+  std::memset(output, 0, sizeof(double) * output_size);
+  ShapForest::Buffer buffer(*shap_forest);
+  // one tree over the whole block, records walk it together
+  for (int i = 0; i < num_trees; ++i) {
+    const int tree_idx = start_tree + i;
+    const int k = tree_idx % num_tree_per_iteration_;
+    shap_forest->AddContribToBlock(tree_idx, features, num_rows, row_stride, output + k * (num_features + 1),
+                                   num_pred_in_one_row, num_features, &buffer);
+  }
+}
+
 void GBDT::PredictContribByMap(const std::unordered_map<int, double>& features,
                                std::vector<std::unordered_map<int, double>>* output) const {
   const int num_features = max_feature_idx_ + 1;
@@ -590,7 +630,7 @@ void GBDT::PredictContribByMap(const std::unordered_map<int, double>& features,
   for (int i = start_iteration_for_pred_; i < end_iteration_for_pred; ++i) {
     // predict all the trees for one iteration
     for (int k = 0; k < num_tree_per_iteration_; ++k) {
-      models_[i * num_tree_per_iteration_ + k]->PredictContribByMap(features, num_features, &((*output)[k]));
+      Models()[i * num_tree_per_iteration_ + k]->PredictContribByMap(features, num_features, &((*output)[k]));
     }
   }
 }
@@ -634,7 +674,7 @@ void GBDT::GetPredictAt(int data_idx, double* out_result, int64_t* out_len) {
 
 double GBDT::GetUpperBoundValue() const {
   double max_value = 0.0;
-  for (const auto &tree : models_) {
+  for (const auto &tree : Models()) {
     max_value += tree->GetUpperBoundValue();
   }
   return max_value;
@@ -642,7 +682,7 @@ double GBDT::GetUpperBoundValue() const {
 
 double GBDT::GetLowerBoundValue() const {
   double min_value = 0.0;
-  for (const auto &tree : models_) {
+  for (const auto &tree : Models()) {
     min_value += tree->GetLowerBoundValue();
   }
   return min_value;
@@ -677,7 +717,7 @@ void GBDT::ResetTrainingData(const Dataset* train_data, const ObjectiveFunction*
     for (int i = 0; i < iter_; ++i) {
       for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
         auto curr_tree = (i + num_init_iteration_) * num_tree_per_iteration_ + cur_tree_id;
-        train_score_updater_->AddScore(models_[curr_tree].get(), cur_tree_id);
+        train_score_updater_->AddScore(Models()[curr_tree].get(), cur_tree_id);
       }
     }
 
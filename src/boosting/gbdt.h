@@ -13,6 +13,7 @@
 
 #include <string>
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <fstream>
 #include <map>
@@ -22,7 +23,9 @@
 #include <utility>
 #include <vector>
 
+#include "flat_forest.hpp"
 #include "score_updater.hpp"
+#include "shap_forest.hpp"
 
 namespace LightGBM {
 
@@ -59,12 +62,13 @@ class GBDT : public GBDTBase {
   * \param other
   */
   void MergeFrom(const Boosting* other) override {
+    ResetFlatForest();
     auto other_gbdt = reinterpret_cast<const GBDT*>(other);
     // tmp move to other vector
     auto original_models = std::move(models_);
     models_ = std::vector<std::unique_ptr<Tree>>();
     // push model from other first
-    for (const auto& tree : other_gbdt->models_) {
+    for (const auto& tree : other_gbdt->Models()) {
       auto new_tree = std::unique_ptr<Tree>(new Tree(*(tree.get())));
       models_.push_back(std::move(new_tree));
     }
@@ -84,6 +88,7 @@ class GBDT : public GBDTBase {
       end_iter = total_iter;
     }
     end_iter = std::min(total_iter, end_iter);
+    ResetFlatForest();
     auto original_models = std::move(models_);
     std::vector<int> indices(total_iter);
     for (int i = 0; i < total_iter; ++i) {
@@ -239,12 +244,29 @@ class GBDT : public GBDTBase {
   void PredictByMap(const std::unordered_map<int, double>& features, double* output,
                     const PredictionEarlyStopInstance* early_stop) const override;
 
+  void PredictRawBlock(const double* features, int num_rows, int row_stride,
+                       double* output) const override;
+
+  void PredictBlock(const double* features, int num_rows, int row_stride,
+                    double* output) const override;
+
+  std::vector<double> FeatureBinUpperBounds(int feature_idx) override;
+
+  void InitBinnedPredict(int start_iteration, int num_iteration, int max_num_bin) override;
+
+  void PredictBinned(const uint8_t* bins, int64_t bin_stride, bool is_raw_score, double* output) const override;
+
+  void PredictBinned(const uint16_t* bins, int64_t bin_stride, bool is_raw_score, double* output) const override;
+
   void PredictLeafIndex(const double* features, double* output) const override;
 
   void PredictLeafIndexByMap(const std::unordered_map<int, double>& features, double* output) const override;
 
   void PredictContrib(const double* features, double* output) const override;
 
+  void PredictContribBlock(const double* features, int num_rows, int row_stride,
+                           double* output) const override;
+
   void PredictContribByMap(const std::unordered_map<int, double>& features,
                            std::vector<std::unordered_map<int, double>>* output) const override;
 
@@ -273,17 +295,35 @@ class GBDT : public GBDTBase {
   */
   bool SaveModelToIfElse(int num_iteration, const char* filename) const override;
 
+  /*!
+  * \brief Translate model to a self-contained C source exporting a stable C ABI
+  * \param num_iteration Number of iterations that want to translate, -1 means translate all
+  * \param prefix Prefix of the exported functions
+  * \return C source of model
+  */
+  std::string ModelToC(int num_iteration, const std::string& prefix) const override;
+
+  /*!
+  * \brief Translate model to a self-contained C source exporting a stable C ABI
+  * \param num_iteration Number of iterations that want to translate, -1 means translate all
+  * \param prefix Prefix of the exported functions
+  * \param filename Filename that want to save to
+  * \return true if succeeded
+  */
+  bool SaveModelToC(int num_iteration, const std::string& prefix, const char* filename) const override;
+
   /*!
   * \brief Save model to file
   * \param start_iteration The model will be saved start from
   * \param num_iterations Number of model that want to save, -1 means save all
   * \param feature_importance_type Type of feature importance, 0: split, 1: gain
   * \param filename Filename that want to save to
+  * \param is_binary Save in binary form instead of text
   * \return is_finish Is training finished or not
   */
   bool SaveModelToFile(int start_iteration, int num_iterations,
                        int feature_importance_type,
-                       const char* filename) const override;
+                       const char* filename, bool is_binary) const override;
 
   /*!
   * \brief Save model to string
@@ -299,6 +339,11 @@ class GBDT : public GBDTBase {
   */
   bool LoadModelFromString(const char* buffer, size_t len) override;
 
+  /*!
+  * \brief Restore from a binary model file, the packed trees in it are used in place
+  */
+  bool LoadModelFromBinaryFile(const char* filename) override;
+
   /*!
   * \brief Calculate feature importances
   * \param num_iteration Number of model that want to use for feature importance, -1 means use all
@@ -366,23 +411,28 @@ class GBDT : public GBDTBase {
     }
     start_iteration_for_pred_ = start_iteration;
     if (is_pred_contrib) {
+      const auto& models = Models();
       #pragma omp parallel for schedule(static)
-      for (int i = 0; i < static_cast<int>(models_.size()); ++i) {
-        models_[i]->RecomputeMaxDepth();
+      for (int i = 0; i < static_cast<int>(models.size()); ++i) {
+        models[i]->RecomputeMaxDepth();
       }
+      BuildShapForest();
+    } else {
+      BuildFlatForest();
     }
   }
 
   inline double GetLeafValue(int tree_idx, int leaf_idx) const override {
     CHECK(tree_idx >= 0 && static_cast<size_t>(tree_idx) < models_.size());
-    CHECK(leaf_idx >= 0 && leaf_idx < models_[tree_idx]->num_leaves());
-    return models_[tree_idx]->LeafOutput(leaf_idx);
+    CHECK(leaf_idx >= 0 && leaf_idx < Models()[tree_idx]->num_leaves());
+    return Models()[tree_idx]->LeafOutput(leaf_idx);
   }
 
   inline void SetLeafValue(int tree_idx, int leaf_idx, double val) override {
+    ResetFlatForest();
     CHECK(tree_idx >= 0 && static_cast<size_t>(tree_idx) < models_.size());
-    CHECK(leaf_idx >= 0 && leaf_idx < models_[tree_idx]->num_leaves());
-    models_[tree_idx]->SetLeafOutput(leaf_idx, val);
+    CHECK(leaf_idx >= 0 && leaf_idx < Models()[tree_idx]->num_leaves());
+    Models()[tree_idx]->SetLeafOutput(leaf_idx, val);
   }
 
   /*!
@@ -447,6 +497,97 @@ class GBDT : public GBDTBase {
 
   double BoostFromAverage(int class_id, bool update_scorer);
 
+  /*! \brief Lines of the text model before the trees */
+  std::string ModelHeaderToString() const;
+
+  /*! \brief Lines of the text model after the trees: feature importances and parameters */
+  std::string ModelTrailerToString(int num_iteration, int feature_importance_type) const;
+
+  /*!
+  * \brief Save model in binary form: the text model without trees, the trees, and the packed trees
+  */
+  bool SaveModelToBinaryFile(int start_iteration, int num_iteration, int feature_importance_type,
+                             const char* filename) const;
+
+  /*!
+  * \brief Discard the copies of models used for prediction, must be called whenever models_ changes.
+  *        It will be rebuilt by the next InitPredict.
+  */
+  inline void ResetFlatForest() {
+    // the trees are constructed before the mapping they are read from is released
+    LoadMappedTrees();
+    if (is_flat_forest_valid_.load(std::memory_order_acquire)) {
+      is_flat_forest_valid_.store(false, std::memory_order_release);
+      flat_forest_.Clear();
+      mapped_model_.reset();
+    }
+    if (is_shap_forest_valid_.load(std::memory_order_acquire)) {
+      is_shap_forest_valid_.store(false, std::memory_order_release);
+      shap_forest_.Clear();
+    }
+  }
+
+  /*!
+  * \brief Construct the trees of the binary model file the model was loaded from, if they are not yet.
+  *        Loading only maps the file and its packed trees are used in place for predictions,
+  *        the trees are read from the mapping the first time anything else needs them.
+  *        Until then, models_ holds nullptrs and flat_forest_ is valid
+  */
+  void LoadMappedTrees() const;
+
+  /*!
+  * \brief Trees of the model, every access to a tree goes through it so that mapped trees are constructed first
+  * \return models_
+  */
+  inline std::vector<std::unique_ptr<Tree>>& Models() const {
+    LoadMappedTrees();
+    return models_;
+  }
+
+  /*! \brief Build the packed copy of models used for prediction if it is not up to date */
+  inline void BuildFlatForest() {
+    if (!is_flat_forest_valid_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(flat_forest_mutex_);
+      if (!is_flat_forest_valid_.load(std::memory_order_relaxed)) {
+        flat_forest_.Init(Models(), max_feature_idx_ + 1);
+        is_flat_forest_valid_.store(true, std::memory_order_release);
+      }
+    }
+  }
+
+  /*! \brief Build the view of models used for feature contributions if it is not up to date */
+  inline void BuildShapForest() {
+    if (!is_shap_forest_valid_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(flat_forest_mutex_);
+      if (!is_shap_forest_valid_.load(std::memory_order_relaxed)) {
+        shap_forest_.Init(Models());
+        is_shap_forest_valid_.store(true, std::memory_order_release);
+      }
+    }
+  }
+
+  /*!
+  * \brief Get the view of models used for feature contributions
+  * \return nullptr if it is not built, then use models_ directly
+  */
+  inline const ShapForest* GetShapForest() const {
+    return is_shap_forest_valid_.load(std::memory_order_acquire) ? &shap_forest_ : nullptr;
+  }
+
+  /*!
+  * \brief Prediction for one binned record, shared by the PredictBinned overloads
+  */
+  template<typename BIN_T>
+  void PredictBinnedInner(const BIN_T* bins, int64_t bin_stride, bool is_raw_score, double* output) const;
+
+  /*!
+  * \brief Get the packed copy of models used for prediction
+  * \return nullptr if it is not built, then predict with models_ directly
+  */
+  inline const FlatForest* GetFlatForest() const {
+    return is_flat_forest_valid_.load(std::memory_order_acquire) ? &flat_forest_ : nullptr;
+  }
+
   /*! \brief current iteration */
   int iter_;
   /*! \brief Pointer to training data */
@@ -475,8 +616,8 @@ class GBDT : public GBDTBase {
   std::vector<std::vector<double>> best_score_;
   /*! \brief output message of best iteration */
   std::vector<std::vector<std::string>> best_msg_;
-  /*! \brief Trained models(trees) */
-  std::vector<std::unique_ptr<Tree>> models_;
+  /*! \brief Trained models(trees), read them through Models(), they may not be constructed yet */
+  mutable std::vector<std::unique_ptr<Tree>> models_;
   /*! \brief Max feature index of training data*/
   int max_feature_idx_;
   /*! \brief First order derivative of training data */
@@ -520,6 +661,25 @@ class GBDT : public GBDTBase {
   std::vector<Random> bagging_rands_;
   ParallelPartitionRunner<data_size_t, false> bagging_runner_;
   Json forced_splits_json_;
+  /*! \brief Packed copy of models_ for fast prediction */
+  FlatForest flat_forest_;
+  /*! \brief Binary model file whose packed trees are used in place by flat_forest_ */
+  std::unique_ptr<MappedFile> mapped_model_;
+  /*! \brief Trees of mapped_model_, tree i is [mapped_trees_ + offsets[i], mapped_trees_ + offsets[i + 1]) */
+  const char* mapped_trees_;
+  std::vector<uint64_t> mapped_tree_offsets_;
+  /*! \brief Whether models_ still has to be constructed from mapped_model_ */
+  mutable std::atomic<bool> has_mapped_trees_;
+  /*! \brief Guards LoadMappedTrees */
+  mutable std::mutex mapped_trees_mutex_;
+  /*! \brief Whether flat_forest_ is up to date with models_ */
+  std::atomic<bool> is_flat_forest_valid_;
+  /*! \brief View of models_ for feature contributions of blocks of records */
+  ShapForest shap_forest_;
+  /*! \brief Whether shap_forest_ is up to date with models_ */
+  std::atomic<bool> is_shap_forest_valid_;
+  /*! \brief Guards the building of flat_forest_ and shap_forest_ */
+  std::mutex flat_forest_mutex_;
 };
 
 }  // namespace LightGBM
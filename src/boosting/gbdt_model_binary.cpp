@@ -0,0 +1,190 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#include <LightGBM/utils/common.h>
+#include <LightGBM/utils/file_io.h>
+#include <LightGBM/utils/openmp_wrapper.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gbdt.h"
+
+namespace LightGBM {
+
+/*
+ * Layout of binary model files, all numbers in the byte order of the machine that saved the file:
+ *   binary_model_token
+ *   uint32 version, uint32 byte order mark
+ *   uint64 size of text part, uint64 number of trees
+ *   uint64 offset and uint64 size of packed trees, offset is 0 when they are absent
+ *   text part: the text model without trees
+ *   uint64 offsets of each tree and of the end of trees, from the first tree
+ *   trees, as written by Tree::SaveBinaryToFile
+ *   packed trees, as written by FlatForest::SaveBinaryToFile, aligned to kAlignedSize bytes
+ * Data appended after the packed trees is ignored.
+ */
+const uint32_t kBinaryModelVersion = 1;
+const uint32_t kBinaryModelByteOrderMark = 0x01020304;
+
+namespace {
+
+template<typename T>
+void ReadHeaderValue(const char** p, T* out) {
+  std::memcpy(out, *p, sizeof(T));
+  *p += sizeof(T);
+}
+
+}  // namespace
+
+bool GBDT::SaveModelToBinaryFile(int start_iteration, int num_iteration, int feature_importance_type,
+                                 const char* filename) const {
+  int num_used_model = static_cast<int>(models_.size());
+  int total_iteration = num_used_model / num_tree_per_iteration_;
+  start_iteration = std::max(start_iteration, 0);
+  start_iteration = std::min(start_iteration, total_iteration);
+  if (num_iteration > 0) {
+    int end_iteration = start_iteration + num_iteration;
+    num_used_model = std::min(end_iteration * num_tree_per_iteration_, num_used_model);
+  }
+  const int start_model = start_iteration * num_tree_per_iteration_;
+  const int num_trees = num_used_model - start_model;
+
+  const std::string text = ModelHeaderToString() + '\n' + ModelTrailerToString(num_iteration, feature_importance_type);
+  std::vector<uint64_t> tree_offsets(num_trees + 1, 0);
+  for (int i = 0; i < num_trees; ++i) {
+    tree_offsets[i + 1] = tree_offsets[i] + Models()[start_model + i]->SizesInByte();
+  }
+  FlatForest flat_forest;
+  flat_forest.Init(Models(), start_model, num_trees, max_feature_idx_ + 1);
+
+  const uint64_t size_of_token = std::strlen(binary_model_token);
+  const uint64_t size_of_header = size_of_token + sizeof(uint32_t) * 2 + sizeof(uint64_t) * 4;
+  const uint64_t end_of_trees = size_of_header + text.size() + sizeof(uint64_t) * tree_offsets.size()
+                                + tree_offsets.back();
+  const uint64_t flat_forest_offset = SIZE_ALIGNED(end_of_trees);
+  const uint64_t flat_forest_size = flat_forest.SizesInByte();
+  const uint64_t text_size = text.size();
+  const uint64_t num_trees_to_write = num_trees;
+
+  auto writer = VirtualFileWriter::Make(filename);
+  if (!writer->Init()) {
+    Log::Fatal("Cannot write binary model to %s", filename);
+  }
+  uint64_t written = writer->Write(binary_model_token, size_of_token);
+  written += writer->Write(&kBinaryModelVersion, sizeof(kBinaryModelVersion));
+  written += writer->Write(&kBinaryModelByteOrderMark, sizeof(kBinaryModelByteOrderMark));
+  written += writer->Write(&text_size, sizeof(text_size));
+  written += writer->Write(&num_trees_to_write, sizeof(num_trees_to_write));
+  written += writer->Write(&flat_forest_offset, sizeof(flat_forest_offset));
+  written += writer->Write(&flat_forest_size, sizeof(flat_forest_size));
+  written += writer->Write(text.data(), text.size());
+  written += writer->Write(tree_offsets.data(), sizeof(uint64_t) * tree_offsets.size());
+  for (int i = 0; i < num_trees; ++i) {
+    written += Models()[start_model + i]->SaveBinaryToFile(writer.get());
+  }
+  const char zeros[kAlignedSize] = {0};
+  written += writer->Write(zeros, flat_forest_offset - end_of_trees);
+  written += flat_forest.SaveBinaryToFile(writer.get());
+  // a short write, e.g. on a full disk, would leave a truncated model file
+  if (written != flat_forest_offset + flat_forest_size || !writer->Flush()) {
+    Log::Fatal("Cannot write binary model to %s, the file is incomplete", filename);
+  }
+  return true;
+}
+
+bool GBDT::LoadModelFromBinaryFile(const char* filename) {
+  auto file = MappedFile::Make(filename);
+  if (file == nullptr) {
+    Log::Fatal("Could not open model file %s", filename);
+  }
+  const char* buffer = file->data();
+  const uint64_t size_of_token = std::strlen(binary_model_token);
+  const uint64_t size_of_header = size_of_token + sizeof(uint32_t) * 2 + sizeof(uint64_t) * 4;
+  if (file->size() < size_of_header || std::memcmp(buffer, binary_model_token, size_of_token) != 0) {
+    Log::Fatal("Model file %s is not a binary model file", filename);
+  }
+  const char* p = buffer + size_of_token;
+  uint32_t version, byte_order_mark;
+  uint64_t text_size, num_trees, flat_forest_offset, flat_forest_size;
+  ReadHeaderValue(&p, &version);
+  ReadHeaderValue(&p, &byte_order_mark);
+  ReadHeaderValue(&p, &text_size);
+  ReadHeaderValue(&p, &num_trees);
+  ReadHeaderValue(&p, &flat_forest_offset);
+  ReadHeaderValue(&p, &flat_forest_size);
+  if (byte_order_mark != kBinaryModelByteOrderMark) {
+    Log::Fatal("Binary model file %s was saved on a machine with another byte order", filename);
+  }
+  if (version > kBinaryModelVersion) {
+    Log::Fatal("Binary model file %s has version %u, this version of LightGBM reads up to version %u",
+               filename, version, kBinaryModelVersion);
+  }
+  const uint64_t remain = file->size() - size_of_header;
+  if (text_size > remain || num_trees >= (remain - text_size) / sizeof(uint64_t)) {
+    Log::Fatal("Binary model file %s is truncated", filename);
+  }
+  if (!LoadModelFromString(p, static_cast<size_t>(text_size))) {
+    return false;
+  }
+  p += text_size;
+
+  std::vector<uint64_t> tree_offsets(num_trees + 1);
+  std::memcpy(tree_offsets.data(), p, sizeof(uint64_t) * tree_offsets.size());
+  p += sizeof(uint64_t) * tree_offsets.size();
+  const uint64_t trees_size = file->size() - static_cast<uint64_t>(p - buffer);
+  for (size_t i = 0; i < num_trees; ++i) {
+    if (tree_offsets[i] > tree_offsets[i + 1] || tree_offsets[i + 1] > trees_size) {
+      Log::Fatal("Binary model file %s is truncated", filename);
+    }
+  }
+  models_.resize(num_trees);
+  num_iteration_for_pred_ = static_cast<int>(models_.size()) / num_tree_per_iteration_;
+  num_init_iteration_ = num_iteration_for_pred_;
+  mapped_trees_ = p;
+  mapped_tree_offsets_ = std::move(tree_offsets);
+
+  // the packed trees are used in place, this is what makes loading fast,
+  // the trees are only read from the mapping when something else than prediction needs them
+  if (flat_forest_offset > 0 && flat_forest_offset <= file->size()
+      && flat_forest_size <= file->size() - flat_forest_offset) {
+    std::lock_guard<std::mutex> lock(flat_forest_mutex_);
+    if (flat_forest_.InitFromMemory(buffer + flat_forest_offset, static_cast<size_t>(flat_forest_size),
+                                    max_feature_idx_ + 1)
+        && flat_forest_.num_trees() == static_cast<int>(num_trees)) {
+      mapped_model_ = std::move(file);
+      is_flat_forest_valid_.store(true, std::memory_order_release);
+      has_mapped_trees_.store(true, std::memory_order_release);
+      return true;
+    }
+    Log::Warning("Packed trees in binary model file %s cannot be used, they will be rebuilt", filename);
+    flat_forest_.Clear();
+  }
+  has_mapped_trees_.store(true, std::memory_order_release);
+  LoadMappedTrees();
+  return true;
+}
+
+void GBDT::LoadMappedTrees() const {
+  if (!has_mapped_trees_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mapped_trees_mutex_);
+  if (!has_mapped_trees_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  OMP_INIT_EX();
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < static_cast<int>(models_.size()); ++i) {
+    OMP_LOOP_EX_BEGIN();
+    models_[i].reset(new Tree(mapped_trees_ + mapped_tree_offsets_[i],
+                              static_cast<size_t>(mapped_tree_offsets_[i + 1] - mapped_tree_offsets_[i])));
+    OMP_LOOP_EX_END();
+  }
+  OMP_THROW_EX();
+  has_mapped_trees_.store(false, std::memory_order_release);
+}
+
+}  // namespace LightGBM
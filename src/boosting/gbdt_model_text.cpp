@@ -8,6 +8,8 @@
 #include <LightGBM/utils/array_args.h>
 #include <LightGBM/utils/common.h>
 
+#include <cctype>
+#include <cstring>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -90,7 +92,7 @@ std::string GBDT::DumpModel(int start_iteration, int num_iteration, int feature_
     }
     str_buf << "{";
     str_buf << "\"tree_index\":" << i << ",";
-    str_buf << models_[i]->ToJSON();
+    str_buf << Models()[i]->ToJSON();
     str_buf << "}";
   }
   str_buf << "]," << '\n';
@@ -142,7 +144,7 @@ std::string GBDT::ModelToIfElse(int num_iteration) const {
 
   // PredictRaw
   for (int i = 0; i < num_used_model; ++i) {
-    str_buf << models_[i]->ToIfElse(i, false) << '\n';
+    str_buf << Models()[i]->ToIfElse(i, false) << '\n';
   }
 
   str_buf << "double (*PredictTreePtr[])(const double*) = { ";
@@ -237,7 +239,7 @@ std::string GBDT::ModelToIfElse(int num_iteration) const {
 
   // PredictLeafIndex
   for (int i = 0; i < num_used_model; ++i) {
-    str_buf << models_[i]->ToIfElse(i, true) << '\n';
+    str_buf << Models()[i]->ToIfElse(i, true) << '\n';
   }
 
   str_buf << "double (*PredictTreeLeafPtr[])(const double*) = { ";
@@ -303,7 +305,130 @@ bool GBDT::SaveModelToIfElse(int num_iteration, const char* filename) const {
   return static_cast<bool>(output_file);
 }
 
-std::string GBDT::SaveModelToString(int start_iteration, int num_iteration, int feature_importance_type) const {
+std::string GBDT::ModelToC(int num_iteration, const std::string& prefix) const {
+  bool is_identifier = !prefix.empty() && !std::isdigit(static_cast<unsigned char>(prefix[0]));
+  for (char c : prefix) {
+    is_identifier = is_identifier && (std::isalnum(static_cast<unsigned char>(c)) || c == '_');
+  }
+  if (!is_identifier) {
+    Log::Fatal("Prefix of generated C functions should be a C identifier, got \"%s\"", prefix.c_str());
+  }
+  std::stringstream str_buf;
+  int num_used_model = static_cast<int>(models_.size());
+  if (num_iteration > 0) {
+    num_used_model = std::min(num_iteration * num_tree_per_iteration_, num_used_model);
+  }
+  const int num_feature = max_feature_idx_ + 1;
+  bool has_categorical = false;
+  for (int i = 0; i < num_used_model; ++i) {
+    has_categorical = has_categorical || Models()[i]->num_cat() > 0;
+  }
+
+  str_buf << "/*\n";
+  str_buf << " * Generated by LightGBM from a model with " << num_used_model << " trees, do not edit.\n";
+  str_buf << " *\n";
+  str_buf << " * int " << prefix << "_num_features(void)\n";
+  str_buf << " *   Number of values read from each row.\n";
+  str_buf << " * int " << prefix << "_num_outputs(void)\n";
+  str_buf << " *   Number of values predicted for each row.\n";
+  str_buf << " * void " << prefix << "_predict_row(const float* row, int is_raw_score, double* output)\n";
+  str_buf << " *   Predict one row, output holds " << prefix << "_num_outputs() values.\n";
+  str_buf << " * void " << prefix << "_predict(const float* data, int64_t num_rows, int32_t num_cols,\n";
+  str_buf << " *   " << std::string(prefix.size() + 14, ' ') << "int is_raw_score, double* output)\n";
+  str_buf << " *   Predict a row-major matrix, num_cols is at least " << prefix << "_num_features().\n";
+  str_buf << " *\n";
+  str_buf << " * Define LGBM_MODEL_EXPORT, e.g. to __declspec(dllexport), to export the functions from a DLL.\n";
+  str_buf << " */\n";
+  str_buf << "#include <math.h>\n";
+  str_buf << "#include <stdint.h>\n\n";
+  str_buf << "#ifndef LGBM_MODEL_EXPORT\n";
+  str_buf << "#define LGBM_MODEL_EXPORT\n";
+  str_buf << "#endif\n\n";
+  str_buf << "#ifdef __cplusplus\n";
+  str_buf << "extern \"C\" {\n";
+  str_buf << "#endif\n\n";
+
+  if (has_categorical) {
+    str_buf << "static int " << prefix << "_in_bitset(const uint32_t* bits, int n, double fval) {\n";
+    str_buf << "  int pos;\n";
+    str_buf << "  if (isnan(fval) || fval <= -1.0 || fval >= 2147483648.0) {\n";
+    str_buf << "    return 0;\n";
+    str_buf << "  }\n";
+    str_buf << "  pos = (int)fval;\n";
+    str_buf << "  if (pos / 32 >= n) {\n";
+    str_buf << "    return 0;\n";
+    str_buf << "  }\n";
+    str_buf << "  return (bits[pos / 32] >> (pos % 32)) & 1;\n";
+    str_buf << "}\n\n";
+  }
+
+  for (int i = 0; i < num_used_model; ++i) {
+    str_buf << Models()[i]->ToC(prefix, i) << '\n';
+  }
+
+  // trees are added in the same order as GBDT::PredictRaw, so sums are the same
+  str_buf << "static void " << prefix << "_predict_raw(const float* row, double* output) {\n";
+  for (int k = 0; k < num_tree_per_iteration_; ++k) {
+    str_buf << "  output[" << k << "] = 0.0;\n";
+  }
+  for (int i = 0; i < num_used_model; ++i) {
+    str_buf << "  output[" << i % num_tree_per_iteration_ << "] += " << prefix << "_tree_" << i << "(row);\n";
+  }
+  str_buf << "}\n\n";
+
+  str_buf << "LGBM_MODEL_EXPORT int " << prefix << "_num_features(void) {\n";
+  str_buf << "  return " << num_feature << ";\n";
+  str_buf << "}\n\n";
+
+  str_buf << "LGBM_MODEL_EXPORT int " << prefix << "_num_outputs(void) {\n";
+  str_buf << "  return " << num_tree_per_iteration_ << ";\n";
+  str_buf << "}\n\n";
+
+  str_buf << "LGBM_MODEL_EXPORT void " << prefix << "_predict_row(const float* row, int is_raw_score, double* output) {\n";
+  str_buf << "  " << prefix << "_predict_raw(row, output);\n";
+  str_buf << "  if (is_raw_score) {\n";
+  str_buf << "    return;\n";
+  str_buf << "  }\n";
+  if (average_output_) {
+    for (int k = 0; k < num_tree_per_iteration_; ++k) {
+      str_buf << "  output[" << k << "] /= " << num_used_model / num_tree_per_iteration_ << ";\n";
+    }
+  }
+  if (objective_function_ != nullptr) {
+    std::string convert_output = objective_function_->ConvertOutputToC();
+    if (!convert_output.empty()) {
+      str_buf << "  {\n";
+      for (const auto& line : Common::Split(convert_output.c_str(), '\n')) {
+        str_buf << "    " << line << '\n';
+      }
+      str_buf << "  }\n";
+    }
+  }
+  str_buf << "}\n\n";
+
+  str_buf << "LGBM_MODEL_EXPORT void " << prefix << "_predict(const float* data, int64_t num_rows, int32_t num_cols,\n";
+  str_buf << std::string(prefix.size() + 31, ' ') << "int is_raw_score, double* output) {\n";
+  str_buf << "  int64_t i;\n";
+  str_buf << "  for (i = 0; i < num_rows; ++i) {\n";
+  str_buf << "    " << prefix << "_predict_row(data + i * num_cols, is_raw_score, output + i * "
+          << num_tree_per_iteration_ << ");\n";
+  str_buf << "  }\n";
+  str_buf << "}\n\n";
+
+  str_buf << "#ifdef __cplusplus\n";
+  str_buf << "}  /* extern \"C\" */\n";
+  str_buf << "#endif\n";
+  return str_buf.str();
+}
+
+bool GBDT::SaveModelToC(int num_iteration, const std::string& prefix, const char* filename) const {
+  std::ofstream output_file(filename);
+  output_file << ModelToC(num_iteration, prefix);
+  output_file.close();
+  return static_cast<bool>(output_file);
+}
+
+std::string GBDT::ModelHeaderToString() const {
   std::stringstream ss;
 
   // output model type
@@ -333,36 +458,11 @@ std::string GBDT::SaveModelToString(int start_iteration, int num_iteration, int
   }
 
   ss << "feature_infos=" << Common::Join(feature_infos_, " ") << '\n';
+  return ss.str();
+}
 
-  int num_used_model = static_cast<int>(models_.size());
-  int total_iteration = num_used_model / num_tree_per_iteration_;
-  start_iteration = std::max(start_iteration, 0);
-  start_iteration = std::min(start_iteration, total_iteration);
-  if (num_iteration > 0) {
-    int end_iteration = start_iteration + num_iteration;
-    num_used_model = std::min(end_iteration * num_tree_per_iteration_, num_used_model);
-  }
-
-  int start_model = start_iteration * num_tree_per_iteration_;
-
-  std::vector<std::string> tree_strs(num_used_model - start_model);
-  std::vector<size_t> tree_sizes(num_used_model - start_model);
-  // output tree models
-  #pragma omp parallel for schedule(static)
-  for (int i = start_model; i < num_used_model; ++i) {
-    const int idx = i - start_model;
-    tree_strs[idx] = "Tree=" + std::to_string(idx) + '\n';
-    tree_strs[idx] += models_[i]->ToString() + '\n';
-    tree_sizes[idx] = tree_strs[idx].size();
-  }
-
-  ss << "tree_sizes=" << Common::Join(tree_sizes, " ") << '\n';
-  ss << '\n';
-
-  for (int i = 0; i < num_used_model - start_model; ++i) {
-    ss << tree_strs[i];
-    tree_strs[i].clear();
-  }
+std::string GBDT::ModelTrailerToString(int num_iteration, int feature_importance_type) const {
+  std::stringstream ss;
   ss << "end of trees" << "\n";
   std::vector<double> feature_importances = FeatureImportance(
       num_iteration, feature_importance_type);
@@ -396,7 +496,49 @@ std::string GBDT::SaveModelToString(int start_iteration, int num_iteration, int
   return ss.str();
 }
 
-bool GBDT::SaveModelToFile(int start_iteration, int num_iteration, int feature_importance_type, const char* filename) const {
+std::string GBDT::SaveModelToString(int start_iteration, int num_iteration, int feature_importance_type) const {
+  std::stringstream ss;
+  ss << ModelHeaderToString();
+
+  int num_used_model = static_cast<int>(models_.size());
+  int total_iteration = num_used_model / num_tree_per_iteration_;
+  start_iteration = std::max(start_iteration, 0);
+  start_iteration = std::min(start_iteration, total_iteration);
+  if (num_iteration > 0) {
+    int end_iteration = start_iteration + num_iteration;
+    num_used_model = std::min(end_iteration * num_tree_per_iteration_, num_used_model);
+  }
+
+  int start_model = start_iteration * num_tree_per_iteration_;
+
+  std::vector<std::string> tree_strs(num_used_model - start_model);
+  std::vector<size_t> tree_sizes(num_used_model - start_model);
+  // output tree models
+  const auto& models = Models();
+  #pragma omp parallel for schedule(static)
+  for (int i = start_model; i < num_used_model; ++i) {
+    const int idx = i - start_model;
+    tree_strs[idx] = "Tree=" + std::to_string(idx) + '\n';
+    tree_strs[idx] += models[i]->ToString() + '\n';
+    tree_sizes[idx] = tree_strs[idx].size();
+  }
+
+  ss << "tree_sizes=" << Common::Join(tree_sizes, " ") << '\n';
+  ss << '\n';
+
+  for (int i = 0; i < num_used_model - start_model; ++i) {
+    ss << tree_strs[i];
+    tree_strs[i].clear();
+  }
+  ss << ModelTrailerToString(num_iteration, feature_importance_type);
+  return ss.str();
+}
+
+bool GBDT::SaveModelToFile(int start_iteration, int num_iteration, int feature_importance_type, const char* filename,
+                           bool is_binary) const {
+  if (is_binary) {
+    return SaveModelToBinaryFile(start_iteration, num_iteration, feature_importance_type, filename);
+  }
   /*! \brief File to write models */
   std::ofstream output_file;
   output_file.open(filename, std::ios::out | std::ios::binary);
@@ -409,6 +551,8 @@ bool GBDT::SaveModelToFile(int start_iteration, int num_iteration, int feature_i
 
 bool GBDT::LoadModelFromString(const char* buffer, size_t len) {
   // use serialized string to restore this object
+  has_mapped_trees_.store(false, std::memory_order_release);
+  ResetFlatForest();
   models_.clear();
   auto c_str = buffer;
   auto p = c_str;
@@ -418,7 +562,8 @@ bool GBDT::LoadModelFromString(const char* buffer, size_t len) {
     auto line_len = Common::GetLine(p);
     if (line_len > 0) {
       std::string cur_line(p, line_len);
-      if (!Common::StartsWith(cur_line, "Tree=")) {
+      // a model without trees, e.g. the text part of a binary model, ends the header at "end of trees"
+      if (!Common::StartsWith(cur_line, "Tree=") && cur_line != "end of trees") {
         auto strs = Common::Split(cur_line.c_str(), '=');
         if (strs.size() == 1) {
           key_vals[strs[0]] = "";
@@ -515,50 +660,49 @@ bool GBDT::LoadModelFromString(const char* buffer, size_t len) {
     objective_function_ = loaded_objective_.get();
   }
 
+  // first pass finds where each tree starts, so they can be parsed in parallel
+  std::vector<const char*> tree_starts;
   if (!key_vals.count("tree_sizes")) {
+    // same rules as reading the trees one by one: a tree ends at an empty line,
+    // and trees end at the first non-empty line between trees which is not "Tree="
+    bool in_tree = false;
     while (p < end) {
       auto line_len = Common::GetLine(p);
-      if (line_len > 0) {
-        std::string cur_line(p, line_len);
-        if (Common::StartsWith(cur_line, "Tree=")) {
-          p += line_len;
-          p = Common::SkipNewLine(p);
-          size_t used_len = 0;
-          models_.emplace_back(new Tree(p, &used_len));
-          p += used_len;
-        } else {
-          break;
-        }
+      if (in_tree) {
+        in_tree = line_len > 0;
+      } else if (line_len >= 5 && std::strncmp(p, "Tree=", 5) == 0) {
+        in_tree = true;
+        tree_starts.push_back(Common::SkipNewLine(p + line_len));
+      } else if (line_len > 0) {
+        break;
       }
+      p += line_len;
       p = Common::SkipNewLine(p);
     }
   } else {
     std::vector<size_t> tree_sizes = Common::StringToArray<size_t>(key_vals["tree_sizes"].c_str(), ' ');
-    std::vector<size_t> tree_boundries(tree_sizes.size() + 1, 0);
-    int num_trees = static_cast<int>(tree_sizes.size());
-    for (int i = 0; i < num_trees; ++i) {
-      tree_boundries[i + 1] = tree_boundries[i] + tree_sizes[i];
-      models_.emplace_back(nullptr);
-    }
-    OMP_INIT_EX();
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < num_trees; ++i) {
-      OMP_LOOP_EX_BEGIN();
-      auto cur_p = p + tree_boundries[i];
-      auto line_len = Common::GetLine(cur_p);
-      std::string cur_line(cur_p, line_len);
-      if (Common::StartsWith(cur_line, "Tree=")) {
-        cur_p += line_len;
-        cur_p = Common::SkipNewLine(cur_p);
-        size_t used_len = 0;
-        models_[i].reset(new Tree(cur_p, &used_len));
-      } else {
+    tree_starts.reserve(tree_sizes.size());
+    for (size_t i = 0; i < tree_sizes.size(); ++i) {
+      auto line_len = Common::GetLine(p);
+      if (static_cast<size_t>(end - p) < tree_sizes[i] || line_len < 5 || std::strncmp(p, "Tree=", 5) != 0) {
+        std::string cur_line(p, std::min<size_t>(line_len, 128));
         Log::Fatal("Model format error, expect a tree here. met %s", cur_line.c_str());
       }
-      OMP_LOOP_EX_END();
+      tree_starts.push_back(Common::SkipNewLine(p + line_len));
+      p += tree_sizes[i];
     }
-    OMP_THROW_EX();
   }
+  const int num_trees = static_cast<int>(tree_starts.size());
+  models_.resize(num_trees);
+  OMP_INIT_EX();
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < num_trees; ++i) {
+    OMP_LOOP_EX_BEGIN();
+    size_t used_len = 0;
+    models_[i].reset(new Tree(tree_starts[i], &used_len));
+    OMP_LOOP_EX_END();
+  }
+  OMP_THROW_EX();
   num_iteration_for_pred_ = static_cast<int>(models_.size()) / num_tree_per_iteration_;
   num_init_iteration_ = num_iteration_for_pred_;
   iter_ = 0;
@@ -592,26 +736,27 @@ std::vector<double> GBDT::FeatureImportance(int num_iteration, int importance_ty
     num_used_model = std::min(num_iteration * num_tree_per_iteration_, num_used_model);
   }
 
+  const auto& models = Models();
   std::vector<double> feature_importances(max_feature_idx_ + 1, 0.0);
   if (importance_type == 0) {
     for (int iter = 0; iter < num_used_model; ++iter) {
-      for (int split_idx = 0; split_idx < models_[iter]->num_leaves() - 1; ++split_idx) {
-        if (models_[iter]->split_gain(split_idx) > 0) {
+      for (int split_idx = 0; split_idx < models[iter]->num_leaves() - 1; ++split_idx) {
+        if (models[iter]->split_gain(split_idx) > 0) {
 #ifdef DEBUG
-          CHECK_GE(models_[iter]->split_feature(split_idx), 0);
+          CHECK_GE(models[iter]->split_feature(split_idx), 0);
 #endif
-          feature_importances[models_[iter]->split_feature(split_idx)] += 1.0;
+          feature_importances[models[iter]->split_feature(split_idx)] += 1.0;
         }
       }
     }
   } else if (importance_type == 1) {
     for (int iter = 0; iter < num_used_model; ++iter) {
-      for (int split_idx = 0; split_idx < models_[iter]->num_leaves() - 1; ++split_idx) {
-        if (models_[iter]->split_gain(split_idx) > 0) {
+      for (int split_idx = 0; split_idx < models[iter]->num_leaves() - 1; ++split_idx) {
+        if (models[iter]->split_gain(split_idx) > 0) {
 #ifdef DEBUG
-          CHECK_GE(models_[iter]->split_feature(split_idx), 0);
+          CHECK_GE(models[iter]->split_feature(split_idx), 0);
 #endif
-          feature_importances[models_[iter]->split_feature(split_idx)] += models_[iter]->split_gain(split_idx);
+          feature_importances[models[iter]->split_feature(split_idx)] += models[iter]->split_gain(split_idx);
         }
       }
     }
@@ -14,11 +14,17 @@ void GBDT::PredictRaw(const double* features, double* output, const PredictionEa
   int early_stop_round_counter = 0;
   // set zero
   std::memset(output, 0, sizeof(double) * num_tree_per_iteration_);
+  const FlatForest* flat_forest = GetFlatForest();
   const int end_iteration_for_pred = start_iteration_for_pred_ + num_iteration_for_pred_;
   for (int i = start_iteration_for_pred_; i < end_iteration_for_pred; ++i) {
     // predict all the trees for one iteration
     for (int k = 0; k < num_tree_per_iteration_; ++k) {
-      output[k] += models_[i * num_tree_per_iteration_ + k]->Predict(features);
+      const int tree_idx = i * num_tree_per_iteration_ + k;
+      if (flat_forest != nullptr) {
+        output[k] += flat_forest->Predict(tree_idx, features);
+      } else {
+        output[k] += Models()[tree_idx]->Predict(features);
+      }
     }
     // check early stopping
     ++early_stop_round_counter;
@@ -39,7 +45,7 @@ void GBDT::PredictRawByMap(const std::unordered_map<int, double>& features, doub
   for (int i = start_iteration_for_pred_; i < end_iteration_for_pred; ++i) {
     // predict all the trees for one iteration
     for (int k = 0; k < num_tree_per_iteration_; ++k) {
-      output[k] += models_[i * num_tree_per_iteration_ + k]->PredictByMap(features);
+      output[k] += Models()[i * num_tree_per_iteration_ + k]->PredictByMap(features);
     }
     // check early stopping
     ++early_stop_round_counter;
@@ -76,10 +82,107 @@ void GBDT::PredictByMap(const std::unordered_map<int, double>& features, double*
   }
 }
 
+void GBDT::PredictRawBlock(const double* features, int num_rows, int row_stride, double* output) const {
+  // set zero
+  std::memset(output, 0, sizeof(double) * num_rows * num_tree_per_iteration_);
+  const FlatForest* flat_forest = GetFlatForest();
+  const int end_iteration_for_pred = start_iteration_for_pred_ + num_iteration_for_pred_;
+  for (int i = start_iteration_for_pred_; i < end_iteration_for_pred; ++i) {
+    for (int k = 0; k < num_tree_per_iteration_; ++k) {
+      const int tree_idx = i * num_tree_per_iteration_ + k;
+      // one tree over the whole block, keeps its nodes in cache
+      if (flat_forest != nullptr) {
+        flat_forest->AddPredictionToBlock(tree_idx, features, num_rows, row_stride,
+                                          output + k, num_tree_per_iteration_);
+      } else {
+        const Tree* tree = Models()[tree_idx].get();
+        for (int j = 0; j < num_rows; ++j) {
+          output[static_cast<size_t>(j) * num_tree_per_iteration_ + k] +=
+              tree->Predict(features + static_cast<size_t>(j) * row_stride);
+        }
+      }
+    }
+  }
+}
+
+void GBDT::PredictBlock(const double* features, int num_rows, int row_stride, double* output) const {
+  PredictRawBlock(features, num_rows, row_stride, output);
+  for (int j = 0; j < num_rows; ++j) {
+    double* row_output = output + static_cast<size_t>(j) * num_tree_per_iteration_;
+    if (average_output_) {
+      for (int k = 0; k < num_tree_per_iteration_; ++k) {
+        row_output[k] /= num_iteration_for_pred_;
+      }
+    }
+    if (objective_function_ != nullptr) {
+      objective_function_->ConvertOutput(row_output, row_output);
+    }
+  }
+}
+
+std::vector<double> GBDT::FeatureBinUpperBounds(int feature_idx) {
+  BuildFlatForest();
+  if (feature_idx < 0 || feature_idx >= flat_forest_.num_features()) {
+    Log::Fatal("Feature index %d is out of range [0, %d)", feature_idx, flat_forest_.num_features());
+  }
+  return flat_forest_.bin_upper_bounds(feature_idx);
+}
+
+void GBDT::InitBinnedPredict(int start_iteration, int num_iteration, int max_num_bin) {
+  InitPredict(start_iteration, num_iteration, false);
+  if (flat_forest_.HasCategorical(start_iteration_for_pred_ * num_tree_per_iteration_,
+                                  num_iteration_for_pred_ * num_tree_per_iteration_)) {
+    Log::Fatal("Cannot predict binned data with categorical splits");
+  }
+  if (flat_forest_.max_num_bin() > max_num_bin) {
+    Log::Fatal("Model needs %d bins for some feature, more than %d bins supported by the binned data type",
+               flat_forest_.max_num_bin(), max_num_bin);
+  }
+}
+
+template<typename BIN_T>
+void GBDT::PredictBinnedInner(const BIN_T* bins, int64_t bin_stride, bool is_raw_score, double* output) const {
+  // set zero
+  std::memset(output, 0, sizeof(double) * num_tree_per_iteration_);
+  const int end_iteration_for_pred = start_iteration_for_pred_ + num_iteration_for_pred_;
+  for (int i = start_iteration_for_pred_; i < end_iteration_for_pred; ++i) {
+    for (int k = 0; k < num_tree_per_iteration_; ++k) {
+      const int tree_idx = i * num_tree_per_iteration_ + k;
+      output[k] += flat_forest_.PredictByBin(tree_idx, bins, bin_stride);
+    }
+  }
+  if (is_raw_score) {
+    return;
+  }
+  if (average_output_) {
+    for (int k = 0; k < num_tree_per_iteration_; ++k) {
+      output[k] /= num_iteration_for_pred_;
+    }
+  }
+  if (objective_function_ != nullptr) {
+    objective_function_->ConvertOutput(output, output);
+  }
+}
+
+void GBDT::PredictBinned(const uint8_t* bins, int64_t bin_stride, bool is_raw_score, double* output) const {
+  PredictBinnedInner(bins, bin_stride, is_raw_score, output);
+}
+
+void GBDT::PredictBinned(const uint16_t* bins, int64_t bin_stride, bool is_raw_score, double* output) const {
+  PredictBinnedInner(bins, bin_stride, is_raw_score, output);
+}
+
 void GBDT::PredictLeafIndex(const double* features, double* output) const {
   int start_tree = start_iteration_for_pred_ * num_tree_per_iteration_;
   int num_trees = num_iteration_for_pred_ * num_tree_per_iteration_;
-  const auto* models_ptr = models_.data() + start_tree;
+  const FlatForest* flat_forest = GetFlatForest();
+  if (flat_forest != nullptr) {
+    for (int i = 0; i < num_trees; ++i) {
+      output[i] = flat_forest->GetLeaf(start_tree + i, features);
+    }
+    return;
+  }
+  const auto* models_ptr = Models().data() + start_tree;
   for (int i = 0; i < num_trees; ++i) {
     output[i] = models_ptr[i]->PredictLeafIndex(features);
   }
@@ -88,7 +191,7 @@ void GBDT::PredictLeafIndex(const double* features, double* output) const {
 void GBDT::PredictLeafIndexByMap(const std::unordered_map<int, double>& features, double* output) const {
   int start_tree = start_iteration_for_pred_ * num_tree_per_iteration_;
   int num_trees = num_iteration_for_pred_ * num_tree_per_iteration_;
-  const auto* models_ptr = models_.data() + start_tree;
+  const auto* models_ptr = Models().data() + start_tree;
   for (int i = 0; i < num_trees; ++i) {
     output[i] = models_ptr[i]->PredictLeafIndexByMap(features);
   }
@@ -101,6 +101,7 @@ class RF : public GBDT {
   }
 
   bool TrainOneIter(const score_t* gradients, const score_t* hessians) override {
+    ResetFlatForest();
     // bagging logic
     Bagging(iter_);
     CHECK_EQ(gradients, nullptr);
@@ -166,15 +167,16 @@ class RF : public GBDT {
 
   void RollbackOneIter() override {
     if (iter_ <= 0) { return; }
+    ResetFlatForest();
     int cur_iter = iter_ + num_init_iteration_ - 1;
     // reset score
     for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
       auto curr_tree = cur_iter * num_tree_per_iteration_ + cur_tree_id;
-      models_[curr_tree]->Shrinkage(-1.0);
+      Models()[curr_tree]->Shrinkage(-1.0);
       MultiplyScore(cur_tree_id, (iter_ + num_init_iteration_));
-      train_score_updater_->AddScore(models_[curr_tree].get(), cur_tree_id);
+      train_score_updater_->AddScore(Models()[curr_tree].get(), cur_tree_id);
       for (auto& score_updater : valid_score_updater_) {
-        score_updater->AddScore(models_[curr_tree].get(), cur_tree_id);
+        score_updater->AddScore(Models()[curr_tree].get(), cur_tree_id);
       }
       MultiplyScore(cur_tree_id, 1.0f / (iter_ + num_init_iteration_ - 1));
     }
@@ -0,0 +1,303 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#include "shap_forest.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace LightGBM {
+
+ShapForest::Buffer::Buffer(const ShapForest& forest) {
+  const size_t max_path_len = static_cast<size_t>(forest.max_depth()) + 1;
+  const size_t num_elements = max_path_len * (max_path_len + 1) / 2;
+  feature_index_.resize(num_elements);
+  zero_fraction_.resize(num_elements);
+  one_fraction_.resize(num_elements * kBlockRows);
+  pweight_.resize(num_elements * kBlockRows);
+  // the root gets one fractions of 1, then each level two arrays for its children
+  child_one_fraction_.resize((max_path_len * 2 + 1) * kBlockRows);
+  reciprocal_.resize(max_path_len + 2);
+  for (size_t i = 1; i < reciprocal_.size(); ++i) {
+    reciprocal_[i] = 1.0 / static_cast<double>(i);
+  }
+}
+
+void ShapForest::Init(const std::vector<std::unique_ptr<Tree>>& models) {
+  Clear();
+  size_t total_nodes = 0;
+  for (const auto& tree : models) {
+    total_nodes += tree->num_leaves_ - 1;
+  }
+  trees_.reserve(models.size());
+  nodes_.reserve(total_nodes);
+  node_offsets_.reserve(models.size() + 1);
+  expected_values_.reserve(models.size());
+  std::vector<std::pair<int, int>> stack;
+  for (const auto& tree : models) {
+    trees_.push_back(tree.get());
+    expected_values_.push_back(tree->ExpectedValue());
+    const int num_nodes = tree->num_leaves_ - 1;
+    for (int i = 0; i < num_nodes; ++i) {
+      ShapNode node;
+      const double w = tree->data_count(i);
+      // nodes without training data (e.g. of oblivious trees) split their weight evenly, as in Tree::TreeSHAP
+      node.left_zero_fraction = w > 0 ? tree->data_count(tree->left_child_[i]) / w : 0.5;
+      node.right_zero_fraction = w > 0 ? tree->data_count(tree->right_child_[i]) / w : 0.5;
+      node.split_feature = tree->split_feature_[i];
+      node.left_child = tree->left_child_[i];
+      node.right_child = tree->right_child_[i];
+      nodes_.push_back(node);
+    }
+    node_offsets_.push_back(static_cast<int>(nodes_.size()));
+    if (num_nodes == 0) {
+      continue;
+    }
+    // depth of leaves, the stored leaf depths are not kept in model files
+    stack.emplace_back(0, 0);
+    while (!stack.empty()) {
+      const int node = stack.back().first;
+      const int depth = stack.back().second;
+      stack.pop_back();
+      if (node < 0) {
+        max_depth_ = std::max(max_depth_, depth);
+      } else {
+        stack.emplace_back(tree->left_child_[node], depth + 1);
+        stack.emplace_back(tree->right_child_[node], depth + 1);
+      }
+    }
+  }
+}
+
+void ShapForest::AddContribToBlock(int tree_idx, const double* features, int num_rows, int row_stride,
+                                   double* output, int output_stride, int num_features, Buffer* buffer) const {
+  const double expected_value = expected_values_[tree_idx];
+  for (int i = 0; i < num_rows; ++i) {
+    output[static_cast<size_t>(i) * output_stride + num_features] += expected_value;
+  }
+  if (node_offsets_[tree_idx + 1] == node_offsets_[tree_idx]) {
+    return;
+  }
+  int i = 0;
+  for (; i + kBlockRows <= num_rows; i += kBlockRows) {
+    AddContrib<kBlockRows>(tree_idx, features + static_cast<size_t>(i) * row_stride, kBlockRows, row_stride,
+                           output + static_cast<size_t>(i) * output_stride, output_stride, buffer);
+  }
+  // a partial block costs as much as a full one, unless it is small enough to go record by record
+  if (num_rows - i > kBlockRows / 4) {
+    AddContrib<kBlockRows>(tree_idx, features + static_cast<size_t>(i) * row_stride, num_rows - i, row_stride,
+                           output + static_cast<size_t>(i) * output_stride, output_stride, buffer);
+    return;
+  }
+  for (; i < num_rows; ++i) {
+    AddContrib<1>(tree_idx, features + static_cast<size_t>(i) * row_stride, 1, row_stride,
+                  output + static_cast<size_t>(i) * output_stride, output_stride, buffer);
+  }
+}
+
+template<int kRows>
+void ShapForest::AddContrib(int tree_idx, const double* features, int num_rows, int row_stride,
+                            double* output, int output_stride, Buffer* buffer) const {
+  Walk<kRows> walk;
+  walk.tree = trees_[tree_idx];
+  walk.nodes = nodes_.data() + node_offsets_[tree_idx];
+  for (int r = 0; r < kRows; ++r) {
+    // missing records of a partial block walk along with the first one, their results are dropped
+    const int row = r < num_rows ? r : 0;
+    walk.rows[r] = features + static_cast<size_t>(row) * row_stride;
+    walk.phi[r] = output + static_cast<size_t>(row) * output_stride;
+  }
+  walk.num_rows = num_rows;
+  walk.feature_index = buffer->feature_index_.data();
+  walk.zero_fraction = buffer->zero_fraction_.data();
+  walk.one_fraction = buffer->one_fraction_.data();
+  walk.pweight = buffer->pweight_.data();
+  walk.reciprocal = buffer->reciprocal_.data();
+  walk.child_one_fraction = buffer->child_one_fraction_.data() + kRows;
+  double* root_one_fraction = buffer->child_one_fraction_.data();
+  std::fill(root_one_fraction, root_one_fraction + kRows, 1.0);
+  TreeSHAP(&walk, 0, 0, 0, 1, root_one_fraction, -1, 0);
+}
+
+template<int kRows>
+void ShapForest::ExtendPath(Walk<kRows>* walk, int path, int unique_depth,
+                            double zero_fraction, const double* one_fraction, int feature_index) {
+  walk->feature_index[path + unique_depth] = feature_index;
+  walk->zero_fraction[path + unique_depth] = zero_fraction;
+  double* pweight = walk->pweight + static_cast<size_t>(path) * kRows;
+  double* last_one_fraction = walk->one_fraction + static_cast<size_t>(path + unique_depth) * kRows;
+  double* last_pweight = pweight + static_cast<size_t>(unique_depth) * kRows;
+  for (int r = 0; r < kRows; ++r) {
+    last_one_fraction[r] = one_fraction[r];
+    last_pweight[r] = (unique_depth == 0 ? 1 : 0);
+  }
+  const double inv_len = walk->reciprocal[unique_depth + 1];
+  for (int i = unique_depth - 1; i >= 0; i--) {
+    double* pweight_i = pweight + static_cast<size_t>(i) * kRows;
+    double* pweight_next = pweight_i + kRows;
+    const double one_scale = (i + 1) * inv_len;
+    const double zero_scale = zero_fraction * (unique_depth - i) * inv_len;
+    for (int r = 0; r < kRows; ++r) {
+      pweight_next[r] += one_fraction[r] * pweight_i[r] * one_scale;
+      pweight_i[r] *= zero_scale;
+    }
+  }
+}
+
+template<int kRows>
+void ShapForest::UnwindPath(Walk<kRows>* walk, int path, int unique_depth, int path_index) {
+  const double* one_fraction = walk->one_fraction + static_cast<size_t>(path + path_index) * kRows;
+  const double zero_fraction = walk->zero_fraction[path + path_index];
+  const double inv_zero_fraction = 1.0 / zero_fraction;
+  const double* reciprocal = walk->reciprocal;
+  double* pweight = walk->pweight + static_cast<size_t>(path) * kRows;
+  double next_one_portion[kRows];
+  for (int r = 0; r < kRows; ++r) {
+    next_one_portion[r] = pweight[static_cast<size_t>(unique_depth) * kRows + r];
+  }
+  for (int i = unique_depth - 1; i >= 0; --i) {
+    double* pweight_i = pweight + static_cast<size_t>(i) * kRows;
+    const double one_scale = (unique_depth + 1) * reciprocal[i + 1];
+    const double zero_scale = (unique_depth + 1) * reciprocal[unique_depth - i] * inv_zero_fraction;
+    const double next_scale = zero_fraction * (unique_depth - i) * reciprocal[unique_depth + 1];
+    // one fractions are 0 or 1, both branches of Tree::UnwindPath are computed and one is selected
+    for (int r = 0; r < kRows; ++r) {
+      const double tmp = pweight_i[r];
+      const double one_weight = next_one_portion[r] * one_scale;
+      const bool is_one = one_fraction[r] != 0;
+      // rows cold on an element of zero fraction have all weights 0, and would get 0 * inf
+      pweight_i[r] = is_one ? one_weight : (zero_fraction > 0 ? tmp * zero_scale : 0);
+      next_one_portion[r] = is_one ? tmp - one_weight * next_scale : next_one_portion[r];
+    }
+  }
+
+  for (int i = path_index; i < unique_depth; ++i) {
+    walk->feature_index[path + i] = walk->feature_index[path + i + 1];
+    walk->zero_fraction[path + i] = walk->zero_fraction[path + i + 1];
+    std::copy(walk->one_fraction + static_cast<size_t>(path + i + 1) * kRows,
+              walk->one_fraction + static_cast<size_t>(path + i + 2) * kRows,
+              walk->one_fraction + static_cast<size_t>(path + i) * kRows);
+  }
+}
+
+template<int kRows>
+void ShapForest::AddLeafContrib(Walk<kRows>* walk, int path, int unique_depth, double leaf_value) {
+  const double* reciprocal = walk->reciprocal;
+  const double* pweight = walk->pweight + static_cast<size_t>(path) * kRows;
+  // when the unwound element has one fraction 0, Tree::UnwoundPathSum is the same sum divided by its
+  // zero fraction, so it is computed once for all elements
+  double zero_total[kRows];
+  for (int r = 0; r < kRows; ++r) {
+    zero_total[r] = 0;
+  }
+  for (int i = unique_depth - 1; i >= 0; --i) {
+    const double* pweight_i = pweight + static_cast<size_t>(i) * kRows;
+    const double scale = (unique_depth + 1) * reciprocal[unique_depth - i];
+    for (int r = 0; r < kRows; ++r) {
+      zero_total[r] += pweight_i[r] * scale;
+    }
+  }
+  for (int j = 1; j <= unique_depth; ++j) {
+    const int feature_index = walk->feature_index[path + j];
+    const double zero_fraction = walk->zero_fraction[path + j];
+    const double inv_zero_fraction = 1.0 / zero_fraction;
+    const double* one_fraction = walk->one_fraction + static_cast<size_t>(path + j) * kRows;
+    bool has_one = false;
+    for (int r = 0; r < kRows; ++r) {
+      has_one = has_one || one_fraction[r] != 0;
+    }
+    double total[kRows];
+    for (int r = 0; r < kRows; ++r) {
+      total[r] = 0;
+    }
+    if (has_one) {
+      double next_one_portion[kRows];
+      for (int r = 0; r < kRows; ++r) {
+        next_one_portion[r] = pweight[static_cast<size_t>(unique_depth) * kRows + r];
+      }
+      for (int i = unique_depth - 1; i >= 0; --i) {
+        const double* pweight_i = pweight + static_cast<size_t>(i) * kRows;
+        const double one_scale = (unique_depth + 1) * reciprocal[i + 1];
+        const double next_scale = zero_fraction * (unique_depth - i) * reciprocal[unique_depth + 1];
+        for (int r = 0; r < kRows; ++r) {
+          const double tmp = next_one_portion[r] * one_scale;
+          total[r] += tmp;
+          next_one_portion[r] = pweight_i[r] - tmp * next_scale;
+        }
+      }
+    }
+    for (int r = 0; r < walk->num_rows; ++r) {
+      const double w = one_fraction[r] != 0 ? total[r] : (zero_fraction > 0 ? zero_total[r] * inv_zero_fraction : 0);
+      walk->phi[r][feature_index] += w * (one_fraction[r] - zero_fraction) * leaf_value;
+    }
+  }
+}
+
+template<int kRows>
+void ShapForest::TreeSHAP(Walk<kRows>* walk, int node, int unique_depth, int parent_path,
+                          double parent_zero_fraction, const double* parent_one_fraction,
+                          int parent_feature_index, int level) {
+  // extend the unique path
+  const int path = parent_path + unique_depth;
+  if (unique_depth > 0) {
+    std::copy(walk->feature_index + parent_path, walk->feature_index + path, walk->feature_index + path);
+    std::copy(walk->zero_fraction + parent_path, walk->zero_fraction + path, walk->zero_fraction + path);
+    std::copy(walk->one_fraction + static_cast<size_t>(parent_path) * kRows,
+              walk->one_fraction + static_cast<size_t>(path) * kRows,
+              walk->one_fraction + static_cast<size_t>(path) * kRows);
+    std::copy(walk->pweight + static_cast<size_t>(parent_path) * kRows,
+              walk->pweight + static_cast<size_t>(path) * kRows,
+              walk->pweight + static_cast<size_t>(path) * kRows);
+  }
+  ExtendPath(walk, path, unique_depth, parent_zero_fraction, parent_one_fraction, parent_feature_index);
+
+  // leaf node
+  if (node < 0) {
+    AddLeafContrib(walk, path, unique_depth, walk->tree->leaf_value_[~node]);
+
+  // internal node
+  } else {
+    const ShapNode& cur_node = walk->nodes[node];
+    double incoming_zero_fraction = 1;
+    const double* incoming_one_fraction = nullptr;
+
+    // see if we have already split on this feature,
+    // if so we undo that split so we can redo it for this node
+    int path_index = 0;
+    for (; path_index <= unique_depth; ++path_index) {
+      if (walk->feature_index[path + path_index] == cur_node.split_feature) break;
+    }
+    if (path_index != unique_depth + 1) {
+      incoming_zero_fraction = walk->zero_fraction[path + path_index];
+      incoming_one_fraction = walk->one_fraction + static_cast<size_t>(path + path_index) * kRows;
+    }
+    // the hot child gets the incoming one fraction and the cold child 0, as in Tree::TreeSHAP
+    double* left_one_fraction = walk->child_one_fraction + static_cast<size_t>(level) * 2 * kRows;
+    double* right_one_fraction = left_one_fraction + kRows;
+    for (int r = 0; r < kRows; ++r) {
+      const double one_fraction = incoming_one_fraction == nullptr ? 1 : incoming_one_fraction[r];
+      const bool is_left = walk->tree->Decision(walk->rows[r][cur_node.split_feature], node) == cur_node.left_child;
+      left_one_fraction[r] = is_left ? one_fraction : 0;
+      right_one_fraction[r] = is_left ? 0 : one_fraction;
+    }
+    if (path_index != unique_depth + 1) {
+      UnwindPath(walk, path, unique_depth, path_index);
+      unique_depth -= 1;
+    }
+
+    // a child without training data adds nothing to the rows it is cold for, so it is skipped when cold for all
+    if (IsWalked(walk, cur_node.left_zero_fraction*incoming_zero_fraction, left_one_fraction)) {
+      TreeSHAP(walk, cur_node.left_child, unique_depth + 1, path,
+               cur_node.left_zero_fraction*incoming_zero_fraction, left_one_fraction,
+               cur_node.split_feature, level + 1);
+    }
+    if (IsWalked(walk, cur_node.right_zero_fraction*incoming_zero_fraction, right_one_fraction)) {
+      TreeSHAP(walk, cur_node.right_child, unique_depth + 1, path,
+               cur_node.right_zero_fraction*incoming_zero_fraction, right_one_fraction,
+               cur_node.split_feature, level + 1);
+    }
+  }
+}
+
+}  // namespace LightGBM
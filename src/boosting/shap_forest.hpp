@@ -0,0 +1,170 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#ifndef LIGHTGBM_BOOSTING_SHAP_FOREST_HPP_
+#define LIGHTGBM_BOOSTING_SHAP_FOREST_HPP_
+
+#include <LightGBM/tree.h>
+
+#include <memory>
+#include <vector>
+
+namespace LightGBM {
+
+/*!
+* \brief Non-leaf node of a tree as seen by TreeSHAP, with the fractions of data going to each child precomputed
+*/
+struct ShapNode {
+  /*! \brief Fraction of the data of this node which goes to the left child */
+  double left_zero_fraction;
+  /*! \brief Fraction of the data of this node which goes to the right child */
+  double right_zero_fraction;
+  /*! \brief Split feature, the original index on data */
+  int32_t split_feature;
+  /*! \brief Left child, same encoding as Tree::left_child_ */
+  int32_t left_child;
+  /*! \brief Right child, same encoding as Tree::right_child_ */
+  int32_t right_child;
+};
+
+/*!
+* \brief Read-only view of a list of trees used to compute SHAP feature contributions of many records at once.
+*        TreeSHAP visits every node of a tree whatever the record is, only the one fractions on the path
+*        depend on the record. So a block of records walks the tree together, the path is kept with one
+*        column per record and its updates are loops over records which the compiler can vectorize.
+*        Contributions are the same as Tree::PredictContrib up to rounding: divisions are replaced by products
+*        with reciprocals, and the path sums of elements with one fraction 0 share one sum per leaf.
+*        The trees must outlive this object or the next Init / Clear.
+*/
+class ShapForest {
+ public:
+  /*! \brief Number of records which walk a tree together */
+  static const int kBlockRows = 16;
+
+  /*!
+  * \brief Scratch memory of AddContribToBlock, one is needed for each thread
+  */
+  class Buffer {
+   public:
+    explicit Buffer(const ShapForest& forest);
+
+   private:
+    friend ShapForest;
+    std::vector<int> feature_index_;
+    std::vector<double> zero_fraction_;
+    /*! \brief One fractions of path elements, kBlockRows for each element */
+    std::vector<double> one_fraction_;
+    /*! \brief Permutation weights of path elements, kBlockRows for each element */
+    std::vector<double> pweight_;
+    /*! \brief One fractions given to the left and right children of each tree level */
+    std::vector<double> child_one_fraction_;
+    /*! \brief 1 / i, the path updates multiply by them instead of dividing */
+    std::vector<double> reciprocal_;
+  };
+
+  ShapForest() {
+    Clear();
+  }
+
+  ShapForest(const ShapForest&) = delete;
+  ShapForest& operator=(const ShapForest&) = delete;
+
+  /*!
+  * \brief Rebuild from trees
+  * \param models Trees to use, in the order they will be indexed
+  */
+  void Init(const std::vector<std::unique_ptr<Tree>>& models);
+
+  void Clear() {
+    trees_.clear();
+    nodes_.clear();
+    node_offsets_.assign(1, 0);
+    expected_values_.clear();
+    max_depth_ = 0;
+  }
+
+  inline int num_trees() const { return static_cast<int>(trees_.size()); }
+
+  /*! \brief Max depth of leaves over all trees */
+  inline int max_depth() const { return max_depth_; }
+
+  /*!
+  * \brief Add SHAP feature contributions of one tree to a block of records
+  * \param tree_idx Index of the tree
+  * \param features Feature values, record i starts at features + i * row_stride
+  * \param num_rows Number of records
+  * \param row_stride Distance between two records, must be larger than the max feature index
+  * \param output Contributions of record i are added to output + i * output_stride,
+  *               the contribution of feature j at index j and the expected value after the last feature
+  * \param output_stride Distance between outputs of two records
+  * \param num_features Number of features, the expected value is added at index num_features
+  * \param buffer Scratch memory built for this forest
+  */
+  void AddContribToBlock(int tree_idx, const double* features, int num_rows, int row_stride,
+                         double* output, int output_stride, int num_features, Buffer* buffer) const;
+
+ private:
+  /*! \brief State of one walk of a tree by a block of kRows records */
+  template<int kRows>
+  struct Walk {
+    const Tree* tree;
+    const ShapNode* nodes;
+    const double* rows[kRows];
+    double* phi[kRows];
+    int num_rows;
+    int* feature_index;
+    double* zero_fraction;
+    double* one_fraction;
+    double* pweight;
+    double* child_one_fraction;
+    const double* reciprocal;
+  };
+
+  template<int kRows>
+  void AddContrib(int tree_idx, const double* features, int num_rows, int row_stride,
+                  double* output, int output_stride, Buffer* buffer) const;
+
+  /*! \brief Same recursion as Tree::TreeSHAP, for kRows records at once */
+  template<int kRows>
+  static void TreeSHAP(Walk<kRows>* walk, int node, int unique_depth, int parent_path,
+                       double parent_zero_fraction, const double* parent_one_fraction,
+                       int parent_feature_index, int level);
+
+  /*! \brief Whether a child is walked, false when it has zero fraction 0 and is cold for all records */
+  template<int kRows>
+  static inline bool IsWalked(const Walk<kRows>* walk, double zero_fraction, const double* one_fraction) {
+    if (zero_fraction > 0) {
+      return true;
+    }
+    for (int r = 0; r < walk->num_rows; ++r) {
+      if (one_fraction[r] != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template<int kRows>
+  static void ExtendPath(Walk<kRows>* walk, int path, int unique_depth,
+                         double zero_fraction, const double* one_fraction, int feature_index);
+
+  template<int kRows>
+  static void UnwindPath(Walk<kRows>* walk, int path, int unique_depth, int path_index);
+
+  /*!
+  * \brief Add contributions of a leaf at the end of the path, Tree::UnwoundPathSum of all elements in O(depth^2)
+  */
+  template<int kRows>
+  static void AddLeafContrib(Walk<kRows>* walk, int path, int unique_depth, double leaf_value);
+
+  std::vector<const Tree*> trees_;
+  /*! \brief Nodes of tree i are nodes_[node_offsets_[i], node_offsets_[i + 1]), in the order of the tree */
+  std::vector<ShapNode> nodes_;
+  std::vector<int> node_offsets_;
+  std::vector<double> expected_values_;
+  int max_depth_;
+};
+
+}  // namespace LightGBM
+#endif   // LIGHTGBM_BOOSTING_SHAP_FOREST_HPP_
@@ -19,8 +19,10 @@
 #include <LightGBM/utils/threading.h>
 
 #include <string>
+#include <algorithm>
 #include <cstdio>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -56,6 +58,21 @@ yamc::shared_lock<yamc::alternate::shared_mutex> lock(&mtx);
 
 const int PREDICTOR_TYPES = 4;
 
+// max number of records predicted together by one thread
+const int kPredictBlockSize = 64;
+// max number of feature values in the dense buffer of one block
+const int kPredictBlockBufferSize = 1 << 18;
+
+/*!
+* \brief Function to get a block of dense records
+* \param start_row Index of the first record of the block
+* \param num_rows Number of records in the block
+* \param row_stride Distance between two records in the returned block
+* \param buffer Buffer with num_rows * row_stride values to store the records if needed
+* \return Pointer to the records, either buffer or the input data if it is already in this layout
+*/
+using BlockFunction = std::function<const double*(int start_row, int num_rows, int row_stride, double* buffer)>;
+
 // Single row predictor to abstract away caching logic
 class SingleRowPredictor {
  public:
@@ -88,6 +105,11 @@ class SingleRowPredictor {
 
   ~SingleRowPredictor() {}
 
+  /*! \brief Predict one dense record without going through predict_function */
+  void PredictDense(const double* features, double* output) const {
+    predictor_->PredictDense(features, output);
+  }
+
   bool IsPredictorEqual(const Config& config, int iter, Boosting* boosting) {
     return early_stop_ == config.pred_early_stop &&
       early_stop_freq_ == config.pred_early_stop_freq &&
@@ -105,6 +127,128 @@ class SingleRowPredictor {
   int num_total_model_;
 };
 
+/*!
+* \brief Read-only copy of a model for single row prediction from any number of threads.
+*        Prediction type, iteration range and early stopping are fixed when it is created,
+*        and predictions modify nothing shared, so no lock is taken.
+*/
+class FrozenBooster {
+ public:
+  FrozenBooster(const std::string& model_str, int predict_type, int start_iteration, int num_iteration,
+                const Config& config) : predict_type_(predict_type) {
+    // own copy of the model, so the source booster can keep training or be freed
+    boosting_.reset(Boosting::CreateBoosting("gbdt", nullptr));
+    boosting_->LoadModelFromString(model_str.c_str(), model_str.size());
+    const bool is_predict_leaf = predict_type == C_API_PREDICT_LEAF_INDEX;
+    const bool predict_contrib = predict_type == C_API_PREDICT_CONTRIB;
+    boosting_->InitPredict(start_iteration, num_iteration, predict_contrib);
+    num_pred_in_one_row_ = boosting_->NumPredictOneRow(start_iteration, num_iteration, is_predict_leaf, predict_contrib);
+    num_feature_ = boosting_->MaxFeatureIdx() + 1;
+    disable_shape_check_ = config.predict_disable_shape_check;
+    early_stop_ = CreatePredictionEarlyStopInstance("none", PredictionEarlyStopConfig());
+    if (config.pred_early_stop && !boosting_->NeedAccuratePrediction()) {
+      PredictionEarlyStopConfig pred_early_stop_config;
+      CHECK_GT(config.pred_early_stop_freq, 0);
+      CHECK_GE(config.pred_early_stop_margin, 0);
+      pred_early_stop_config.margin_threshold = config.pred_early_stop_margin;
+      pred_early_stop_config.round_period = config.pred_early_stop_freq;
+      early_stop_ = CreatePredictionEarlyStopInstance(boosting_->NumberOfClasses() == 1 ? "binary" : "multiclass",
+                                                      pred_early_stop_config);
+    }
+  }
+
+  /*!
+  * \brief Predict one record
+  * \param ncol Number of columns of the record
+  * \param get_row_fun Function to get the record as dense values, called with a buffer of this thread
+  */
+  void Predict(int ncol, const BlockFunction& get_row_fun, double* out_result, int64_t* out_len) const {
+    CheckShape(ncol);
+    const double* features = get_row_fun(0, 1, std::max(ncol, num_feature_), ThreadBuffer(ncol));
+    PredictFeatures(features, out_result, out_len);
+  }
+
+  /*! \brief Number of doubles PredictDense needs in scratch, 0 if the record is read in place */
+  int ScratchSize(int data_type, int ncol) const {
+    if (data_type == C_API_DTYPE_FLOAT64 && ncol >= num_feature_) {
+      return 0;
+    }
+    return std::max(ncol, num_feature_);
+  }
+
+  /*!
+  * \brief Predict one dense record without allocation
+  * \param data Record in data_type
+  * \param ncol Number of columns of the record
+  * \param scratch Buffer of ScratchSize(data_type, ncol) doubles, unused if that is 0
+  */
+  void PredictDense(const void* data, int data_type, int ncol, double* scratch,
+                    double* out_result, int64_t* out_len) const {
+    CheckShape(ncol);
+    const double* features = nullptr;
+    if (data_type == C_API_DTYPE_FLOAT64) {
+      features = ncol >= num_feature_ ? reinterpret_cast<const double*>(data)
+                                      : CopyRow(reinterpret_cast<const double*>(data), ncol, scratch);
+    } else if (data_type == C_API_DTYPE_FLOAT32) {
+      features = CopyRow(reinterpret_cast<const float*>(data), ncol, scratch);
+    } else {
+      Log::Fatal("Unknown data type in FrozenBooster::PredictDense");
+    }
+    PredictFeatures(features, out_result, out_len);
+  }
+
+  /*! \brief Scratch buffer of the calling thread, at least ScratchSize doubles, only grows */
+  double* ThreadBuffer(int ncol) const {
+    static THREAD_LOCAL std::vector<double, Common::AlignmentAllocator<double, kAlignedSize>> buffer;
+    const size_t size = static_cast<size_t>(std::max(ncol, num_feature_));
+    if (buffer.size() < size) {
+      buffer.resize(size);
+    }
+    return buffer.data();
+  }
+
+ private:
+  void CheckShape(int ncol) const {
+    if (!disable_shape_check_ && ncol != num_feature_) {
+      Log::Fatal("The number of features in data (%d) is not the same as it was in training data (%d).\n" \
+                 "You can set ``predict_disable_shape_check=true`` to discard this error, but please be aware what you are doing.", ncol, num_feature_);
+    }
+  }
+
+  template <typename T>
+  const double* CopyRow(const T* data, int ncol, double* scratch) const {
+    if (scratch == nullptr) {
+      Log::Fatal("Scratch buffer is needed for this row");
+    }
+    for (int j = 0; j < ncol; ++j) {
+      scratch[j] = static_cast<double>(data[j]);
+    }
+    std::fill(scratch + ncol, scratch + std::max(ncol, num_feature_), 0.0);
+    return scratch;
+  }
+
+  /*! \brief Call the boosting directly, no intermediate copy nor std::function */
+  void PredictFeatures(const double* features, double* out_result, int64_t* out_len) const {
+    if (predict_type_ == C_API_PREDICT_LEAF_INDEX) {
+      boosting_->PredictLeafIndex(features, out_result);
+    } else if (predict_type_ == C_API_PREDICT_CONTRIB) {
+      boosting_->PredictContrib(features, out_result);
+    } else if (predict_type_ == C_API_PREDICT_RAW_SCORE) {
+      boosting_->PredictRaw(features, out_result, &early_stop_);
+    } else {
+      boosting_->Predict(features, out_result, &early_stop_);
+    }
+    *out_len = num_pred_in_one_row_;
+  }
+
+  std::unique_ptr<Boosting> boosting_;
+  PredictionEarlyStopInstance early_stop_;
+  const int predict_type_;
+  int64_t num_pred_in_one_row_;
+  int num_feature_;
+  bool disable_shape_check_;
+};
+
 class Booster {
  public:
   explicit Booster(const char* filename) {
@@ -255,6 +399,26 @@ class Booster {
         new_config.two_round != old_config.two_round) {
       Log::Fatal("Cannot change two_round after constructed Dataset handle.");
     }
+    if (new_param.count("stream_loading") &&
+        new_config.stream_loading != old_config.stream_loading) {
+      Log::Fatal("Cannot change stream_loading after constructed Dataset handle.");
+    }
+    if (new_param.count("stream_first_chunk_size") &&
+        new_config.stream_first_chunk_size != old_config.stream_first_chunk_size) {
+      Log::Fatal("Cannot change stream_first_chunk_size after constructed Dataset handle.");
+    }
+    if (new_param.count("use_quantile_sketch") &&
+        new_config.use_quantile_sketch != old_config.use_quantile_sketch) {
+      Log::Fatal("Cannot change use_quantile_sketch after constructed Dataset handle.");
+    }
+    if (new_param.count("quantile_sketch_size") &&
+        new_config.quantile_sketch_size != old_config.quantile_sketch_size) {
+      Log::Fatal("Cannot change quantile_sketch_size after constructed Dataset handle.");
+    }
+    if (new_param.count("mmap_binary_file") &&
+        new_config.mmap_binary_file != old_config.mmap_binary_file) {
+      Log::Fatal("Cannot change mmap_binary_file after constructed Dataset handle.");
+    }
     if (new_param.count("label_column") &&
         new_config.label_column != old_config.label_column) {
       Log::Fatal(
@@ -395,6 +559,45 @@ class Booster {
     *out_len = single_row_predictor->num_pred_in_one_row;
   }
 
+  /*!
+  * \brief Predict one dense record in row-major form, without allocation once the buffer of the thread is allocated
+  * \param data Record in data_type, C_API_DTYPE_FLOAT32 or C_API_DTYPE_FLOAT64
+  */
+  void PredictSingleRowDense(int predict_type, int ncol, const void* data, int data_type,
+                             const Config& config, double* out_result, int64_t* out_len) const {
+    const int num_feature = boosting_->MaxFeatureIdx() + 1;
+    if (!config.predict_disable_shape_check && ncol != num_feature) {
+      Log::Fatal("The number of features in data (%d) is not the same as it was in training data (%d).\n"\
+                 "You can set ``predict_disable_shape_check=true`` to discard this error, but please be aware what you are doing.", ncol, num_feature);
+    }
+    const double* features = nullptr;
+    if (data_type == C_API_DTYPE_FLOAT64 && ncol >= num_feature) {
+      features = reinterpret_cast<const double*>(data);
+    } else {
+      // scratch buffer of the calling thread, only grows
+      static THREAD_LOCAL std::vector<double, Common::AlignmentAllocator<double, kAlignedSize>> buffer;
+      const int row_stride = std::max(ncol, num_feature);
+      if (static_cast<int>(buffer.size()) < row_stride) {
+        buffer.resize(row_stride);
+      }
+      if (data_type == C_API_DTYPE_FLOAT64) {
+        const double* data_ptr = reinterpret_cast<const double*>(data);
+        std::copy(data_ptr, data_ptr + ncol, buffer.data());
+      } else if (data_type == C_API_DTYPE_FLOAT32) {
+        const float* data_ptr = reinterpret_cast<const float*>(data);
+        std::copy(data_ptr, data_ptr + ncol, buffer.data());
+      } else {
+        Log::Fatal("Unknown data type in PredictSingleRowDense");
+      }
+      std::fill(buffer.data() + ncol, buffer.data() + row_stride, 0.0);
+      features = buffer.data();
+    }
+    SHARED_LOCK(mutex_)
+    const auto& single_row_predictor = single_row_predictor_[predict_type];
+    single_row_predictor->PredictDense(features, out_result);
+    *out_len = single_row_predictor->num_pred_in_one_row;
+  }
+
   Predictor CreatePredictor(int start_iteration, int num_iteration, int predict_type, int ncol, const Config& config) const {
     if (!config.predict_disable_shape_check && ncol != boosting_->MaxFeatureIdx() + 1) {
       Log::Fatal("The number of features in data (%d) is not the same as it was in training data (%d).\n" \
@@ -420,6 +623,7 @@ class Booster {
 
   void Predict(int start_iteration, int num_iteration, int predict_type, int nrow, int ncol,
                std::function<std::vector<std::pair<int, double>>(int row_idx)> get_row_fun,
+               const BlockFunction& get_block_fun,
                const Config& config,
                double* out_result, int64_t* out_len) const {
     SHARED_LOCK(mutex_);
@@ -432,6 +636,35 @@ class Booster {
       predict_contrib = true;
     }
     int64_t num_pred_in_one_row = boosting_->NumPredictOneRow(start_iteration, num_iteration, is_predict_leaf, predict_contrib);
+    // predict by blocks of records, so that each tree is applied to many records while it is in cache
+    const int row_stride = std::max(ncol, boosting_->MaxFeatureIdx() + 1);
+    int block_size = std::min(std::min(kPredictBlockSize, kPredictBlockBufferSize / row_stride), nrow);
+    auto pred_block_fun = predictor.GetPredictBlockFunction();
+    // feature contributions are worth a block for any number of records, and are computed
+    // per record, so smaller blocks keep all the threads busy without changing them
+    const int min_block_size = predict_contrib ? 1 : kPredictBlockSize / 8;
+    if (predict_contrib) {
+      const int num_threads = OMP_NUM_THREADS();
+      block_size = std::max(1, std::min(block_size, (nrow + num_threads - 1) / num_threads));
+    }
+    if (get_block_fun != nullptr && pred_block_fun != nullptr && block_size >= min_block_size) {
+      const int num_blocks = (nrow + block_size - 1) / block_size;
+      std::vector<double, Common::AlignmentAllocator<double, kAlignedSize>> block_buf;
+      OMP_INIT_EX();
+      #pragma omp parallel for schedule(static) firstprivate(block_buf)
+      for (int i = 0; i < num_blocks; ++i) {
+        OMP_LOOP_EX_BEGIN();
+        const int start_row = i * block_size;
+        const int num_rows = std::min(block_size, nrow - start_row);
+        block_buf.resize(static_cast<size_t>(block_size) * row_stride);
+        auto block = get_block_fun(start_row, num_rows, row_stride, block_buf.data());
+        pred_block_fun(block, num_rows, row_stride, out_result + static_cast<size_t>(num_pred_in_one_row) * start_row);
+        OMP_LOOP_EX_END();
+      }
+      OMP_THROW_EX();
+      *out_len = num_pred_in_one_row * nrow;
+      return;
+    }
     auto pred_fun = predictor.GetPredictFunction();
     OMP_INIT_EX();
     #pragma omp parallel for schedule(static)
@@ -446,6 +679,44 @@ class Booster {
     *out_len = num_pred_in_one_row * nrow;
   }
 
+  FrozenBooster* Freeze(int predict_type, int start_iteration, int num_iteration, const Config& config) const {
+    SHARED_LOCK(mutex_);
+    return new FrozenBooster(boosting_->SaveModelToString(0, -1, 0), predict_type, start_iteration, num_iteration,
+                             config);
+  }
+
+  std::vector<double> FeatureBinUpperBounds(int feature_idx) const {
+    SHARED_LOCK(mutex_);
+    return boosting_->FeatureBinUpperBounds(feature_idx);
+  }
+
+  template<typename BIN_T>
+  void PredictBinned(int start_iteration, int num_iteration, int predict_type, const BIN_T* data,
+                     int nrow, int ncol, int is_row_major, double* out_result, int64_t* out_len) const {
+    if (predict_type != C_API_PREDICT_NORMAL && predict_type != C_API_PREDICT_RAW_SCORE) {
+      Log::Fatal("Only normal and raw score predictions are supported for binned data");
+    }
+    if (ncol < boosting_->MaxFeatureIdx() + 1) {
+      Log::Fatal("The number of features in binned data (%d) is less than it was in training data (%d).",
+                 ncol, boosting_->MaxFeatureIdx() + 1);
+    }
+    SHARED_LOCK(mutex_);
+    boosting_->InitBinnedPredict(start_iteration, num_iteration, std::numeric_limits<BIN_T>::max());
+    const bool is_raw_score = predict_type == C_API_PREDICT_RAW_SCORE;
+    const int64_t num_pred_in_one_row = boosting_->NumPredictOneRow(start_iteration, num_iteration, false, false);
+    const int64_t row_stride = is_row_major ? ncol : 1;
+    const int64_t bin_stride = is_row_major ? 1 : nrow;
+    OMP_INIT_EX();
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < nrow; ++i) {
+      OMP_LOOP_EX_BEGIN();
+      boosting_->PredictBinned(data + row_stride * i, bin_stride, is_raw_score, out_result + num_pred_in_one_row * i);
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
+    *out_len = num_pred_in_one_row * nrow;
+  }
+
   void PredictSparse(int start_iteration, int num_iteration, int predict_type, int64_t nrow, int ncol,
                      std::function<std::vector<std::pair<int, double>>(int64_t row_idx)> get_row_fun,
                      const Config& config, int64_t* out_elements_size,
@@ -702,8 +973,15 @@ class Booster {
     boosting_->GetPredictAt(data_idx, out_result, out_len);
   }
 
-  void SaveModelToFile(int start_iteration, int num_iteration, int feature_importance_type, const char* filename) const {
-    boosting_->SaveModelToFile(start_iteration, num_iteration, feature_importance_type, filename);
+  void SaveModelToFile(int start_iteration, int num_iteration, int feature_importance_type, const char* filename,
+                       bool is_binary) const {
+    boosting_->SaveModelToFile(start_iteration, num_iteration, feature_importance_type, filename, is_binary);
+  }
+
+  void SaveModelToC(int num_iteration, const char* prefix, const char* filename) const {
+    if (!boosting_->SaveModelToC(num_iteration, prefix, filename)) {
+      Log::Fatal("Cannot write C model to %s", filename);
+    }
   }
 
   void LoadModelFromString(const char* model_str) {
@@ -825,6 +1103,7 @@ using LightGBM::Config;
 using LightGBM::data_size_t;
 using LightGBM::Dataset;
 using LightGBM::DatasetLoader;
+using LightGBM::FrozenBooster;
 using LightGBM::kZeroThreshold;
 using LightGBM::LGBM_APIHandleException;
 using LightGBM::Log;
@@ -848,6 +1127,16 @@ std::function<std::vector<std::pair<int, double>>(T idx)>
 RowFunctionFromCSR(const void* indptr, int indptr_type, const int32_t* indices,
                    const void* data, int data_type, int64_t nindptr, int64_t nelem);
 
+LightGBM::BlockFunction
+BlockFunctionFromDenseMatric(const void* data, int num_row, int num_col, int data_type, int is_row_major);
+
+LightGBM::BlockFunction
+BlockFunctionFromDenseRows(const void** data, int num_col, int data_type);
+
+LightGBM::BlockFunction
+BlockFunctionFromCSR(const void* indptr, int indptr_type, const int32_t* indices,
+                     const void* data, int data_type);
+
 // Row iterator of on column for CSC matrix
 class CSC_RowIterator {
  public:
@@ -1819,9 +2108,10 @@ int LGBM_BoosterPredictForCSR(BoosterHandle handle,
   }
   Booster* ref_booster = reinterpret_cast<Booster*>(handle);
   auto get_row_fun = RowFunctionFromCSR<int>(indptr, indptr_type, indices, data, data_type, nindptr, nelem);
+  auto get_block_fun = BlockFunctionFromCSR(indptr, indptr_type, indices, data, data_type);
   int nrow = static_cast<int>(nindptr - 1);
   ref_booster->Predict(start_iteration, num_iteration, predict_type, nrow, static_cast<int>(num_col), get_row_fun,
-                       config, out_result, out_len);
+                       get_block_fun, config, out_result, out_len);
   API_END();
 }
 
@@ -2039,8 +2329,8 @@ int LGBM_BoosterPredictForCSC(BoosterHandle handle,
         }
         return one_row;
       };
-  ref_booster->Predict(start_iteration, num_iteration, predict_type, static_cast<int>(num_row), ncol, get_row_fun, config,
-                       out_result, out_len);
+  ref_booster->Predict(start_iteration, num_iteration, predict_type, static_cast<int>(num_row), ncol, get_row_fun, nullptr,
+                       config, out_result, out_len);
   API_END();
 }
 
@@ -2065,7 +2355,8 @@ int LGBM_BoosterPredictForMat(BoosterHandle handle,
   }
   Booster* ref_booster = reinterpret_cast<Booster*>(handle);
   auto get_row_fun = RowPairFunctionFromDenseMatric(data, nrow, ncol, data_type, is_row_major);
-  ref_booster->Predict(start_iteration, num_iteration, predict_type, nrow, ncol, get_row_fun,
+  auto get_block_fun = BlockFunctionFromDenseMatric(data, nrow, ncol, data_type, is_row_major);
+  ref_booster->Predict(start_iteration, num_iteration, predict_type, nrow, ncol, get_row_fun, get_block_fun,
                        config, out_result, out_len);
   API_END();
 }
@@ -2095,6 +2386,85 @@ int LGBM_BoosterPredictForMatSingleRow(BoosterHandle handle,
   API_END();
 }
 
+int LGBM_BoosterFreeze(BoosterHandle handle,
+                       int predict_type,
+                       int start_iteration,
+                       int num_iteration,
+                       const char* parameter,
+                       FrozenBoosterHandle* out) {
+  API_BEGIN();
+  auto param = Config::Str2Map(parameter);
+  Config config;
+  config.Set(param);
+  Booster* ref_booster = reinterpret_cast<Booster*>(handle);
+  *out = ref_booster->Freeze(predict_type, start_iteration, num_iteration, config);
+  API_END();
+}
+
+int LGBM_FrozenBoosterFree(FrozenBoosterHandle handle) {
+  API_BEGIN();
+  delete reinterpret_cast<FrozenBooster*>(handle);
+  API_END();
+}
+
+int LGBM_FrozenBoosterPredictForMatSingleRow(FrozenBoosterHandle handle,
+                                             const void* data,
+                                             int data_type,
+                                             int32_t ncol,
+                                             int64_t* out_len,
+                                             double* out_result) {
+  API_BEGIN();
+  const FrozenBooster* ref_booster = reinterpret_cast<const FrozenBooster*>(handle);
+  ref_booster->PredictDense(data, data_type, ncol, ref_booster->ThreadBuffer(ncol), out_result, out_len);
+  API_END();
+}
+
+int LGBM_FrozenBoosterPredictForCSRSingleRow(FrozenBoosterHandle handle,
+                                             const void* indptr,
+                                             int indptr_type,
+                                             const int32_t* indices,
+                                             const void* data,
+                                             int data_type,
+                                             int64_t,
+                                             int64_t,
+                                             int64_t num_col,
+                                             int64_t* out_len,
+                                             double* out_result) {
+  API_BEGIN();
+  if (num_col <= 0) {
+    Log::Fatal("The number of columns should be greater than zero.");
+  } else if (num_col >= INT32_MAX) {
+    Log::Fatal("The number of columns should be smaller than INT32_MAX.");
+  }
+  const FrozenBooster* ref_booster = reinterpret_cast<const FrozenBooster*>(handle);
+  auto get_row_fun = BlockFunctionFromCSR(indptr, indptr_type, indices, data, data_type);
+  ref_booster->Predict(static_cast<int>(num_col), get_row_fun, out_result, out_len);
+  API_END();
+}
+
+int LGBM_FrozenBoosterGetScratchSize(FrozenBoosterHandle handle,
+                                     int data_type,
+                                     int32_t ncol,
+                                     int64_t* out_len) {
+  API_BEGIN();
+  const FrozenBooster* ref_booster = reinterpret_cast<const FrozenBooster*>(handle);
+  *out_len = ref_booster->ScratchSize(data_type, ncol);
+  API_END();
+}
+
+int LGBM_FrozenBoosterPredictForMatSingleRowNoAlloc(FrozenBoosterHandle handle,
+                                                    const void* data,
+                                                    int data_type,
+                                                    int32_t ncol,
+                                                    double* scratch,
+                                                    int64_t* out_len,
+                                                    double* out_result) {
+  API_BEGIN();
+  const FrozenBooster* ref_booster = reinterpret_cast<const FrozenBooster*>(handle);
+  ref_booster->PredictDense(data, data_type, ncol, scratch, out_result, out_len);
+  API_END();
+}
+
 int LGBM_BoosterPredictForMatSingleRowFastInit(BoosterHandle handle,
                                                const int predict_type,
                                                const int start_iteration,
@@ -2127,11 +2497,10 @@ int LGBM_BoosterPredictForMatSingleRowFast(FastConfigHandle fastConfig_handle,
                                            double* out_result) {
   API_BEGIN();
   FastConfig *fastConfig = reinterpret_cast<FastConfig*>(fastConfig_handle);
-  // Single row in row-major format:
-  auto get_row_fun = RowPairFunctionFromDenseMatric(data, 1, fastConfig->ncol, fastConfig->data_type, 1);
-  fastConfig->booster->PredictSingleRow(fastConfig->predict_type, fastConfig->ncol,
-                                        get_row_fun, fastConfig->config,
-                                        out_result, out_len);
+  // Single row in row-major format, read in place when possible:
+  fastConfig->booster->PredictSingleRowDense(fastConfig->predict_type, fastConfig->ncol,
+                                             data, fastConfig->data_type, fastConfig->config,
+                                             out_result, out_len);
   API_END();
 }
 
@@ -2156,7 +2525,54 @@ int LGBM_BoosterPredictForMats(BoosterHandle handle,
   }
   Booster* ref_booster = reinterpret_cast<Booster*>(handle);
   auto get_row_fun = RowPairFunctionFromDenseRows(data, ncol, data_type);
-  ref_booster->Predict(start_iteration, num_iteration, predict_type, nrow, ncol, get_row_fun, config, out_result, out_len);
+  auto get_block_fun = BlockFunctionFromDenseRows(data, ncol, data_type);
+  ref_booster->Predict(start_iteration, num_iteration, predict_type, nrow, ncol, get_row_fun, get_block_fun,
+                       config, out_result, out_len);
+  API_END();
+}
+
+int LGBM_BoosterGetFeatureBinUpperBounds(BoosterHandle handle,
+                                         int feature_idx,
+                                         int64_t buffer_len,
+                                         int64_t* out_len,
+                                         double* out_results) {
+  API_BEGIN();
+  Booster* ref_booster = reinterpret_cast<Booster*>(handle);
+  auto bounds = ref_booster->FeatureBinUpperBounds(feature_idx);
+  *out_len = static_cast<int64_t>(bounds.size());
+  std::copy(bounds.begin(), bounds.begin() + std::min(buffer_len, *out_len), out_results);
+  API_END();
+}
+
+int LGBM_BoosterPredictForBinnedMat(BoosterHandle handle,
+                                    const void* data,
+                                    int data_type,
+                                    int32_t nrow,
+                                    int32_t ncol,
+                                    int is_row_major,
+                                    int predict_type,
+                                    int start_iteration,
+                                    int num_iteration,
+                                    const char* parameter,
+                                    int64_t* out_len,
+                                    double* out_result) {
+  API_BEGIN();
+  auto param = Config::Str2Map(parameter);
+  Config config;
+  config.Set(param);
+  if (config.num_threads > 0) {
+    omp_set_num_threads(config.num_threads);
+  }
+  Booster* ref_booster = reinterpret_cast<Booster*>(handle);
+  if (data_type == C_API_DTYPE_UINT8) {
+    ref_booster->PredictBinned(start_iteration, num_iteration, predict_type, reinterpret_cast<const uint8_t*>(data),
+                               nrow, ncol, is_row_major, out_result, out_len);
+  } else if (data_type == C_API_DTYPE_UINT16) {
+    ref_booster->PredictBinned(start_iteration, num_iteration, predict_type, reinterpret_cast<const uint16_t*>(data),
+                               nrow, ncol, is_row_major, out_result, out_len);
+  } else {
+    Log::Fatal("Unknown data type in LGBM_BoosterPredictForBinnedMat");
+  }
   API_END();
 }
 
@@ -2168,7 +2584,19 @@ int LGBM_BoosterSaveModel(BoosterHandle handle,
   API_BEGIN();
   Booster* ref_booster = reinterpret_cast<Booster*>(handle);
   ref_booster->SaveModelToFile(start_iteration, num_iteration,
-                               feature_importance_type, filename);
+                               feature_importance_type, filename, false);
+  API_END();
+}
+
+int LGBM_BoosterSaveModelBinary(BoosterHandle handle,
+                                int start_iteration,
+                                int num_iteration,
+                                int feature_importance_type,
+                                const char* filename) {
+  API_BEGIN();
+  Booster* ref_booster = reinterpret_cast<Booster*>(handle);
+  ref_booster->SaveModelToFile(start_iteration, num_iteration,
+                               feature_importance_type, filename, true);
   API_END();
 }
 
@@ -2208,6 +2636,16 @@ int LGBM_BoosterDumpModel(BoosterHandle handle,
   API_END();
 }
 
+int LGBM_BoosterSaveModelToC(BoosterHandle handle,
+                             int num_iteration,
+                             const char* prefix,
+                             const char* filename) {
+  API_BEGIN();
+  Booster* ref_booster = reinterpret_cast<Booster*>(handle);
+  ref_booster->SaveModelToC(num_iteration, prefix, filename);
+  API_END();
+}
+
 int LGBM_BoosterGetLeafValue(BoosterHandle handle,
                              int tree_idx,
                              int leaf_idx,
@@ -2446,6 +2884,121 @@ RowFunctionFromCSR(const void* indptr, int indptr_type, const int32_t* indices,
   return nullptr;
 }
 
+template<typename T>
+const double* CopyDenseBlock(const T* data_ptr, int num_row, int num_col, int is_row_major,
+                             int start_row, int num_rows, int row_stride, double* buffer) {
+  for (int i = 0; i < num_rows; ++i) {
+    double* row = buffer + static_cast<size_t>(row_stride) * i;
+    if (is_row_major) {
+      auto tmp_ptr = data_ptr + static_cast<size_t>(num_col) * (start_row + i);
+      for (int j = 0; j < num_col; ++j) {
+        row[j] = static_cast<double>(tmp_ptr[j]);
+      }
+    } else {
+      for (int j = 0; j < num_col; ++j) {
+        row[j] = static_cast<double>(data_ptr[static_cast<size_t>(num_row) * j + start_row + i]);
+      }
+    }
+    std::fill(row + num_col, row + row_stride, 0.0);
+  }
+  return buffer;
+}
+
+LightGBM::BlockFunction
+BlockFunctionFromDenseMatric(const void* data, int num_row, int num_col, int data_type, int is_row_major) {
+  if (data_type == C_API_DTYPE_FLOAT32) {
+    const float* data_ptr = reinterpret_cast<const float*>(data);
+    return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+      return CopyDenseBlock(data_ptr, num_row, num_col, is_row_major, start_row, num_rows, row_stride, buffer);
+    };
+  } else if (data_type == C_API_DTYPE_FLOAT64) {
+    const double* data_ptr = reinterpret_cast<const double*>(data);
+    return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+      if (is_row_major && row_stride == num_col) {
+        // already in the needed layout, no copy
+        return data_ptr + static_cast<size_t>(num_col) * start_row;
+      }
+      return CopyDenseBlock(data_ptr, num_row, num_col, is_row_major, start_row, num_rows, row_stride, buffer);
+    };
+  }
+  Log::Fatal("Unknown data type in BlockFunctionFromDenseMatric");
+  return nullptr;
+}
+
+// data is array of pointers to individual rows
+LightGBM::BlockFunction
+BlockFunctionFromDenseRows(const void** data, int num_col, int data_type) {
+  if (data_type == C_API_DTYPE_FLOAT32) {
+    return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+      for (int i = 0; i < num_rows; ++i) {
+        CopyDenseBlock(reinterpret_cast<const float*>(data[start_row + i]), 1, num_col, 1,
+                       0, 1, row_stride, buffer + static_cast<size_t>(row_stride) * i);
+      }
+      return const_cast<const double*>(buffer);
+    };
+  } else if (data_type == C_API_DTYPE_FLOAT64) {
+    return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+      for (int i = 0; i < num_rows; ++i) {
+        CopyDenseBlock(reinterpret_cast<const double*>(data[start_row + i]), 1, num_col, 1,
+                       0, 1, row_stride, buffer + static_cast<size_t>(row_stride) * i);
+      }
+      return const_cast<const double*>(buffer);
+    };
+  }
+  Log::Fatal("Unknown data type in BlockFunctionFromDenseRows");
+  return nullptr;
+}
+
+template<typename T_INDPTR, typename T_DATA>
+const double* CopyCSRBlock(const T_INDPTR* ptr_indptr, const int32_t* indices, const T_DATA* data_ptr,
+                           int start_row, int num_rows, int row_stride, double* buffer) {
+  std::fill(buffer, buffer + static_cast<size_t>(row_stride) * num_rows, 0.0);
+  for (int i = 0; i < num_rows; ++i) {
+    double* row = buffer + static_cast<size_t>(row_stride) * i;
+    int64_t start = ptr_indptr[start_row + i];
+    int64_t end = ptr_indptr[start_row + i + 1];
+    for (int64_t j = start; j < end; ++j) {
+      if (indices[j] < row_stride) {
+        row[indices[j]] = static_cast<double>(data_ptr[j]);
+      }
+    }
+  }
+  return buffer;
+}
+
+LightGBM::BlockFunction
+BlockFunctionFromCSR(const void* indptr, int indptr_type, const int32_t* indices, const void* data, int data_type) {
+  if (data_type == C_API_DTYPE_FLOAT32) {
+    const float* data_ptr = reinterpret_cast<const float*>(data);
+    if (indptr_type == C_API_DTYPE_INT32) {
+      const int32_t* ptr_indptr = reinterpret_cast<const int32_t*>(indptr);
+      return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+        return CopyCSRBlock(ptr_indptr, indices, data_ptr, start_row, num_rows, row_stride, buffer);
+      };
+    } else if (indptr_type == C_API_DTYPE_INT64) {
+      const int64_t* ptr_indptr = reinterpret_cast<const int64_t*>(indptr);
+      return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+        return CopyCSRBlock(ptr_indptr, indices, data_ptr, start_row, num_rows, row_stride, buffer);
+      };
+    }
+  } else if (data_type == C_API_DTYPE_FLOAT64) {
+    const double* data_ptr = reinterpret_cast<const double*>(data);
+    if (indptr_type == C_API_DTYPE_INT32) {
+      const int32_t* ptr_indptr = reinterpret_cast<const int32_t*>(indptr);
+      return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+        return CopyCSRBlock(ptr_indptr, indices, data_ptr, start_row, num_rows, row_stride, buffer);
+      };
+    } else if (indptr_type == C_API_DTYPE_INT64) {
+      const int64_t* ptr_indptr = reinterpret_cast<const int64_t*>(indptr);
+      return [=] (int start_row, int num_rows, int row_stride, double* buffer) {
+        return CopyCSRBlock(ptr_indptr, indices, data_ptr, start_row, num_rows, row_stride, buffer);
+      };
+    }
+  }
+  Log::Fatal("Unknown data type in BlockFunctionFromCSR");
+  return nullptr;
+}
+
 std::function<std::pair<int, double>(int idx)>
 IterateFunctionFromCSC(const void* col_ptr, int col_ptr_type, const int32_t* indices, const void* data, int data_type, int64_t ncol_ptr, int64_t , int col_idx) {
   CHECK(col_idx < ncol_ptr && col_idx >= 0);
@@ -0,0 +1,481 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#ifndef LIGHTGBM_IO_ARROW_FILE_HPP_
+#define LIGHTGBM_IO_ARROW_FILE_HPP_
+
+#include <LightGBM/utils/file_io.h>
+#include <LightGBM/utils/log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LightGBM {
+
+/*!
+* \brief Reader of Arrow IPC files (also known as Feather V2), without depending on the Arrow library.
+*        The file is memory mapped and the values of the columns are read in place.
+*        Columns of integer, floating point and boolean types can be used, columns of other flat types
+*        (e.g. strings or timestamps) are allowed only when they are ignored.
+*        Nested types, dictionary encoding, compression and big-endian files are not supported.
+*/
+class ArrowFile {
+ public:
+  /*! \brief Check whether a file starts with the magic of Arrow IPC files */
+  static bool IsArrowFile(const char* filename) {
+    auto reader = VirtualFileReader::Make(filename);
+    if (!reader->Init()) {
+      return false;
+    }
+    char buffer[kMagicSize];
+    return reader->Read(buffer, kMagicSize) == kMagicSize && std::memcmp(buffer, kMagic, kMagicSize) == 0;
+  }
+
+  /*! \brief Map a file and read its schema and the layout of its record batches */
+  explicit ArrowFile(const char* filename) : filename_(filename) {
+    file_ = MappedFile::Make(filename);
+    if (file_ == nullptr) {
+      Log::Fatal("Could not open data file %s", filename);
+    }
+    const char* data = file_->data();
+    const size_t size = file_->size();
+    // magic, padding, ..., footer, size of footer, magic
+    if (size < 2 * kMagicSize + 2 + sizeof(int32_t) || std::memcmp(data, kMagic, kMagicSize) != 0
+        || std::memcmp(data + size - kMagicSize, kMagic, kMagicSize) != 0) {
+      Log::Fatal("Arrow file %s is incomplete", filename);
+    }
+    const char* footer_end = data + size - kMagicSize - sizeof(int32_t);
+    const int32_t footer_size = Read<int32_t>(footer_end);
+    if (footer_size <= 0 || static_cast<size_t>(footer_size) > size - 2 * kMagicSize - sizeof(int32_t)) {
+      Log::Fatal("Arrow file %s has a wrong footer size", filename);
+    }
+    const FlatTable footer = FlatTable::Root(footer_end - footer_size, footer_end, filename_);
+    ReadSchema(footer.Table(kFooterSchema));
+    uint32_t num_batches = 0;
+    const char* blocks = footer.Vector(kFooterRecordBatches, kBlockSize, &num_batches);
+    for (uint32_t i = 0; i < num_batches; ++i) {
+      const char* block = blocks + static_cast<size_t>(i) * kBlockSize;
+      ReadRecordBatch(Read<int64_t>(block), Read<int32_t>(block + 8), Read<int64_t>(block + 16));
+    }
+  }
+
+  inline int num_columns() const { return static_cast<int>(columns_.size()); }
+
+  inline int64_t num_rows() const { return num_rows_; }
+
+  inline std::vector<std::string> column_names() const {
+    std::vector<std::string> ret;
+    for (const auto& column : columns_) {
+      ret.push_back(column.name);
+    }
+    return ret;
+  }
+
+  /*! \brief Whether the values of a column can be read */
+  inline bool IsSupported(int col) const { return columns_[col].type != ColumnType::kUnsupported; }
+
+  /*! \brief Fatal error if the values of a column cannot be read */
+  inline void CheckSupported(int col) const {
+    if (!IsSupported(col)) {
+      Log::Fatal("Column %s of Arrow file %s has an unsupported type, please ignore it",
+                 columns_[col].name.c_str(), filename_.c_str());
+    }
+  }
+
+  inline int num_batches() const { return static_cast<int>(batches_.size()); }
+
+  /*! \brief Index of the first row of a record batch */
+  inline int64_t batch_start(int batch) const { return batches_[batch].start; }
+
+  inline int64_t batch_num_rows(int batch) const { return batches_[batch].num_rows; }
+
+  /*! \brief Index of the record batch containing a row */
+  inline int BatchOf(int64_t row) const {
+    auto it = std::upper_bound(batches_.begin(), batches_.end(), row,
+                               [](int64_t r, const RecordBatch& batch) { return r < batch.start; });
+    return static_cast<int>(it - batches_.begin()) - 1;
+  }
+
+  /*! \brief Value of a row of a record batch, NaN for nulls */
+  inline double Value(int batch, int col, int64_t row) const {
+    const ColumnData& data = batches_[batch].columns[col];
+    if (data.validity != nullptr && !((data.validity[row >> 3] >> (row & 7)) & 1)) {
+      return NAN;
+    }
+    switch (columns_[col].type) {
+      case ColumnType::kInt8: return ValueAs<int8_t>(data.values, row);
+      case ColumnType::kInt16: return ValueAs<int16_t>(data.values, row);
+      case ColumnType::kInt32: return ValueAs<int32_t>(data.values, row);
+      case ColumnType::kInt64: return ValueAs<int64_t>(data.values, row);
+      case ColumnType::kUInt8: return ValueAs<uint8_t>(data.values, row);
+      case ColumnType::kUInt16: return ValueAs<uint16_t>(data.values, row);
+      case ColumnType::kUInt32: return ValueAs<uint32_t>(data.values, row);
+      case ColumnType::kUInt64: return ValueAs<uint64_t>(data.values, row);
+      case ColumnType::kFloat: return ValueAs<float>(data.values, row);
+      case ColumnType::kDouble: return ValueAs<double>(data.values, row);
+      case ColumnType::kBool: return (data.values[row >> 3] >> (row & 7)) & 1;
+      default: CheckSupported(col); return NAN;
+    }
+  }
+
+  /*!
+  * \brief Read all values of a column of a record batch
+  * \param out Buffer of batch_num_rows(batch) values, NaN for nulls
+  */
+  inline void ReadColumn(int batch, int col, double* out) const {
+    const ColumnData& data = batches_[batch].columns[col];
+    const int64_t num_rows = batches_[batch].num_rows;
+    switch (columns_[col].type) {
+      case ColumnType::kInt8: ReadValues<int8_t>(data.values, num_rows, out); break;
+      case ColumnType::kInt16: ReadValues<int16_t>(data.values, num_rows, out); break;
+      case ColumnType::kInt32: ReadValues<int32_t>(data.values, num_rows, out); break;
+      case ColumnType::kInt64: ReadValues<int64_t>(data.values, num_rows, out); break;
+      case ColumnType::kUInt8: ReadValues<uint8_t>(data.values, num_rows, out); break;
+      case ColumnType::kUInt16: ReadValues<uint16_t>(data.values, num_rows, out); break;
+      case ColumnType::kUInt32: ReadValues<uint32_t>(data.values, num_rows, out); break;
+      case ColumnType::kUInt64: ReadValues<uint64_t>(data.values, num_rows, out); break;
+      case ColumnType::kFloat: ReadValues<float>(data.values, num_rows, out); break;
+      case ColumnType::kDouble: ReadValues<double>(data.values, num_rows, out); break;
+      case ColumnType::kBool:
+        for (int64_t i = 0; i < num_rows; ++i) {
+          out[i] = (data.values[i >> 3] >> (i & 7)) & 1;
+        }
+        break;
+      default: CheckSupported(col);
+    }
+    if (data.validity != nullptr) {
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (!((data.validity[i >> 3] >> (i & 7)) & 1)) {
+          out[i] = NAN;
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr const char* kMagic = "ARROW1";
+  static const size_t kMagicSize = 6;
+  /*! \brief Size of the Block struct: offset, metaDataLength (padded), bodyLength */
+  static const size_t kBlockSize = 24;
+  /*! \brief Size of the FieldNode and Buffer structs */
+  static const size_t kNodeSize = 16;
+  /*! \brief Field ids of the flatbuffers tables, see File.fbs, Schema.fbs and Message.fbs of Arrow */
+  static const int kFooterSchema = 1;
+  static const int kFooterRecordBatches = 3;
+  static const int kSchemaEndianness = 0;
+  static const int kSchemaFields = 1;
+  static const int kFieldName = 0;
+  static const int kFieldTypeType = 2;
+  static const int kFieldType = 3;
+  static const int kFieldDictionary = 4;
+  static const int kFieldChildren = 5;
+  static const int kIntBitWidth = 0;
+  static const int kIntIsSigned = 1;
+  static const int kFloatingPointPrecision = 0;
+  static const int kMessageHeaderType = 1;
+  static const int kMessageHeader = 2;
+  static const int kRecordBatchLength = 0;
+  static const int kRecordBatchNodes = 1;
+  static const int kRecordBatchBuffers = 2;
+  static const int kRecordBatchCompression = 3;
+  static const uint8_t kMessageRecordBatch = 3;
+
+  enum class ColumnType {
+    kInt8, kInt16, kInt32, kInt64, kUInt8, kUInt16, kUInt32, kUInt64, kFloat, kDouble, kBool, kUnsupported
+  };
+
+  struct Column {
+    std::string name;
+    ColumnType type;
+    /*! \brief Bits of a value, 1 for booleans */
+    int bit_width;
+    /*! \brief Number of buffers of the column in a record batch */
+    int num_buffers;
+  };
+
+  struct ColumnData {
+    /*! \brief Bitmap of non-null values, nullptr if there is no null */
+    const uint8_t* validity;
+    const uint8_t* values;
+  };
+
+  struct RecordBatch {
+    int64_t start;
+    int64_t num_rows;
+    std::vector<ColumnData> columns;
+  };
+
+  template <typename T>
+  static inline T Read(const char* p) {
+    T ret;
+    std::memcpy(&ret, p, sizeof(T));
+    return ret;
+  }
+
+  template <typename T>
+  static inline double ValueAs(const uint8_t* values, int64_t row) {
+    return static_cast<double>(Read<T>(reinterpret_cast<const char*>(values) + row * sizeof(T)));
+  }
+
+  template <typename T>
+  static inline void ReadValues(const uint8_t* values, int64_t num_rows, double* out) {
+    for (int64_t i = 0; i < num_rows; ++i) {
+      out[i] = ValueAs<T>(values, i);
+    }
+  }
+
+  /*! \brief Accessor of a flatbuffers table, all reads are checked against the bounds of the buffer */
+  class FlatTable {
+   public:
+    FlatTable(const char* begin, const char* end, const char* table, const std::string& filename)
+      : begin_(begin), end_(end), table_(table), filename_(filename) {
+      CheckBounds(table_, sizeof(int32_t));
+      vtable_ = table_ - Read<int32_t>(table_);
+      CheckBounds(vtable_, sizeof(uint16_t));
+      vtable_size_ = Read<uint16_t>(vtable_);
+      CheckBounds(vtable_, vtable_size_);
+    }
+
+    static FlatTable Root(const char* begin, const char* end, const std::string& filename) {
+      if (end - begin < static_cast<ptrdiff_t>(sizeof(uint32_t))) {
+        Log::Fatal("Arrow file %s is corrupted", filename.c_str());
+      }
+      return FlatTable(begin, end, begin + Read<uint32_t>(begin), filename);
+    }
+
+    inline bool Has(int field) const { return FieldOffset(field) != 0; }
+
+    template <typename T>
+    inline T Scalar(int field, T default_value) const {
+      const uint16_t offset = FieldOffset(field);
+      if (offset == 0) {
+        return default_value;
+      }
+      CheckBounds(table_ + offset, sizeof(T));
+      return Read<T>(table_ + offset);
+    }
+
+    inline FlatTable Table(int field) const {
+      const char* p = Target(field);
+      if (p == nullptr) {
+        Log::Fatal("Arrow file %s misses required metadata", filename_.c_str());
+      }
+      return FlatTable(begin_, end_, p, filename_);
+    }
+
+    inline std::string String(int field) const {
+      const char* p = Target(field);
+      if (p == nullptr) {
+        return std::string();
+      }
+      CheckBounds(p, sizeof(uint32_t));
+      const uint32_t len = Read<uint32_t>(p);
+      CheckBounds(p + sizeof(uint32_t), len);
+      return std::string(p + sizeof(uint32_t), len);
+    }
+
+    /*! \brief Start of the elements of a vector, nullptr and zero length if it is absent */
+    inline const char* Vector(int field, size_t element_size, uint32_t* len) const {
+      const char* p = Target(field);
+      *len = 0;
+      if (p == nullptr) {
+        return nullptr;
+      }
+      CheckBounds(p, sizeof(uint32_t));
+      *len = Read<uint32_t>(p);
+      CheckBounds(p + sizeof(uint32_t), static_cast<size_t>(*len) * element_size);
+      return p + sizeof(uint32_t);
+    }
+
+    /*! \brief Table at index i of a vector of tables */
+    inline FlatTable TableAt(const char* elements, uint32_t i) const {
+      const char* p = elements + static_cast<size_t>(i) * sizeof(uint32_t);
+      return FlatTable(begin_, end_, p + Read<uint32_t>(p), filename_);
+    }
+
+   private:
+    inline uint16_t FieldOffset(int field) const {
+      const size_t pos = (2 + static_cast<size_t>(field)) * sizeof(uint16_t);
+      return pos + sizeof(uint16_t) <= vtable_size_ ? Read<uint16_t>(vtable_ + pos) : 0;
+    }
+
+    inline const char* Target(int field) const {
+      const uint16_t offset = FieldOffset(field);
+      if (offset == 0) {
+        return nullptr;
+      }
+      const char* p = table_ + offset;
+      CheckBounds(p, sizeof(uint32_t));
+      return p + Read<uint32_t>(p);
+    }
+
+    inline void CheckBounds(const char* p, size_t len) const {
+      if (p < begin_ || p > end_ || static_cast<size_t>(end_ - p) < len) {
+        Log::Fatal("Arrow file %s is corrupted", filename_.c_str());
+      }
+    }
+
+    const char* begin_;
+    const char* end_;
+    const char* table_;
+    const char* vtable_;
+    uint16_t vtable_size_;
+    const std::string& filename_;
+  };
+
+  void ReadSchema(const FlatTable& schema) {
+    if (schema.Scalar<int16_t>(kSchemaEndianness, 0) != 0) {
+      Log::Fatal("Arrow file %s is big-endian, which is not supported", filename_.c_str());
+    }
+    uint32_t num_fields = 0;
+    const char* fields = schema.Vector(kSchemaFields, sizeof(uint32_t), &num_fields);
+    for (uint32_t i = 0; i < num_fields; ++i) {
+      const FlatTable field = schema.TableAt(fields, i);
+      Column column;
+      column.name = field.String(kFieldName);
+      column.type = ColumnType::kUnsupported;
+      column.bit_width = 0;
+      column.num_buffers = 2;
+      uint32_t num_children = 0;
+      field.Vector(kFieldChildren, sizeof(uint32_t), &num_children);
+      if (field.Has(kFieldDictionary) || num_children > 0) {
+        Log::Fatal("Column %s of Arrow file %s is dictionary encoded or nested, which is not supported",
+                   column.name.c_str(), filename_.c_str());
+      }
+      // see the Type union of Schema.fbs
+      const uint8_t type_type = field.Scalar<uint8_t>(kFieldTypeType, 0);
+      switch (type_type) {
+        case 1:  // Null
+          column.num_buffers = 0;
+          break;
+        case 2: {  // Int
+          const FlatTable type = field.Table(kFieldType);
+          column.bit_width = type.Scalar<int32_t>(kIntBitWidth, 0);
+          const bool is_signed = type.Scalar<uint8_t>(kIntIsSigned, 0) != 0;
+          switch (column.bit_width) {
+            case 8: column.type = is_signed ? ColumnType::kInt8 : ColumnType::kUInt8; break;
+            case 16: column.type = is_signed ? ColumnType::kInt16 : ColumnType::kUInt16; break;
+            case 32: column.type = is_signed ? ColumnType::kInt32 : ColumnType::kUInt32; break;
+            case 64: column.type = is_signed ? ColumnType::kInt64 : ColumnType::kUInt64; break;
+            default: break;
+          }
+          break;
+        }
+        case 3: {  // FloatingPoint, precision is HALF, SINGLE or DOUBLE
+          const int16_t precision = field.Table(kFieldType).Scalar<int16_t>(kFloatingPointPrecision, 0);
+          if (precision == 1) {
+            column.type = ColumnType::kFloat;
+            column.bit_width = 32;
+          } else if (precision == 2) {
+            column.type = ColumnType::kDouble;
+            column.bit_width = 64;
+          }
+          break;
+        }
+        case 4: case 5: case 19: case 20:  // Binary, Utf8, LargeBinary, LargeUtf8
+          column.num_buffers = 3;
+          break;
+        case 6:  // Bool
+          column.type = ColumnType::kBool;
+          column.bit_width = 1;
+          break;
+        case 7: case 8: case 9: case 10: case 11: case 15: case 18:
+          // Decimal, Date, Time, Timestamp, Interval, FixedSizeBinary, Duration
+          break;
+        default:
+          Log::Fatal("Column %s of Arrow file %s has a nested or unknown type, which is not supported",
+                     column.name.c_str(), filename_.c_str());
+      }
+      columns_.push_back(column);
+    }
+  }
+
+  void ReadRecordBatch(int64_t offset, int32_t metadata_size, int64_t body_size) {
+    const char* data = file_->data();
+    const int64_t size = static_cast<int64_t>(file_->size());
+    if (offset < 0 || metadata_size < 8 || body_size < 0 || offset + metadata_size + body_size > size) {
+      Log::Fatal("Arrow file %s is corrupted", filename_.c_str());
+    }
+    // the message starts with a continuation marker and its size, or only its size in old files
+    const char* message_begin = data + offset;
+    int32_t message_size = Read<int32_t>(message_begin);
+    message_begin += sizeof(int32_t);
+    if (message_size == -1) {
+      message_size = Read<int32_t>(message_begin);
+      message_begin += sizeof(int32_t);
+    }
+    const char* message_end = data + offset + metadata_size;
+    if (message_size < 0 || message_size > message_end - message_begin) {
+      Log::Fatal("Arrow file %s is corrupted", filename_.c_str());
+    }
+    const FlatTable message = FlatTable::Root(message_begin, message_begin + message_size, filename_);
+    if (message.Scalar<uint8_t>(kMessageHeaderType, 0) != kMessageRecordBatch) {
+      Log::Fatal("Arrow file %s has a block which is not a record batch", filename_.c_str());
+    }
+    const FlatTable batch = message.Table(kMessageHeader);
+    if (batch.Has(kRecordBatchCompression)) {
+      Log::Fatal("Arrow file %s is compressed, which is not supported", filename_.c_str());
+    }
+    RecordBatch record_batch;
+    record_batch.start = num_rows_;
+    record_batch.num_rows = batch.Scalar<int64_t>(kRecordBatchLength, 0);
+    uint32_t num_nodes = 0;
+    uint32_t num_buffers = 0;
+    const char* nodes = batch.Vector(kRecordBatchNodes, kNodeSize, &num_nodes);
+    const char* buffers = batch.Vector(kRecordBatchBuffers, kNodeSize, &num_buffers);
+    if (num_nodes != columns_.size()) {
+      Log::Fatal("Arrow file %s has a record batch with %d columns, but its schema has %d columns",
+                 filename_.c_str(), static_cast<int>(num_nodes), num_columns());
+    }
+    const uint8_t* body = reinterpret_cast<const uint8_t*>(data + offset + metadata_size);
+    // buffers of a column, checked to be in the body
+    auto get_buffer = [&](uint32_t i, int64_t min_size) -> const uint8_t* {
+      if (i >= num_buffers) {
+        Log::Fatal("Arrow file %s has a record batch with too few buffers", filename_.c_str());
+      }
+      const int64_t buffer_offset = Read<int64_t>(buffers + i * kNodeSize);
+      const int64_t buffer_size = Read<int64_t>(buffers + i * kNodeSize + 8);
+      if (buffer_size == 0 && min_size == 0) {
+        return nullptr;
+      }
+      if (buffer_offset < 0 || buffer_size < min_size || buffer_offset + buffer_size > body_size) {
+        Log::Fatal("Arrow file %s has a record batch with a wrong buffer", filename_.c_str());
+      }
+      return body + buffer_offset;
+    };
+    uint32_t buffer_idx = 0;
+    for (int col = 0; col < num_columns(); ++col) {
+      const int64_t length = Read<int64_t>(nodes + col * kNodeSize);
+      const int64_t null_count = Read<int64_t>(nodes + col * kNodeSize + 8);
+      if (length != record_batch.num_rows) {
+        Log::Fatal("Arrow file %s has columns of different lengths", filename_.c_str());
+      }
+      ColumnData column_data = {nullptr, nullptr};
+      if (IsSupported(col)) {
+        // no validity bitmap is needed without null
+        const uint8_t* validity = get_buffer(buffer_idx, null_count > 0 ? (length + 7) / 8 : 0);
+        column_data.validity = null_count > 0 ? validity : nullptr;
+        column_data.values = get_buffer(buffer_idx + 1, (length * columns_[col].bit_width + 7) / 8);
+      }
+      buffer_idx += columns_[col].num_buffers;
+      record_batch.columns.push_back(column_data);
+    }
+    num_rows_ += record_batch.num_rows;
+    batches_.push_back(record_batch);
+  }
+
+  std::string filename_;
+  std::unique_ptr<MappedFile> file_;
+  std::vector<Column> columns_;
+  std::vector<RecordBatch> batches_;
+  int64_t num_rows_ = 0;
+};
+
+}  // namespace LightGBM
+#endif   // LIGHTGBM_IO_ARROW_FILE_HPP_
@@ -326,26 +326,53 @@ namespace LightGBM {
                           int max_bin, int min_data_in_bin, int min_split_data, bool pre_filter, BinType bin_type,
                           bool use_missing, bool zero_as_missing,
                           const std::vector<double>& forced_upper_bounds) {
-    int na_cnt = 0;
     int tmp_num_sample_values = 0;
     for (int i = 0; i < num_sample_values; ++i) {
       if (!std::isnan(values[i])) {
         values[tmp_num_sample_values++] = values[i];
       }
     }
+    std::stable_sort(values, values + tmp_num_sample_values);
+    FindBinFromSortedValues(values, nullptr, tmp_num_sample_values, num_sample_values - tmp_num_sample_values,
+                            total_sample_cnt, max_bin, min_data_in_bin, min_split_data, pre_filter, bin_type,
+                            use_missing, zero_as_missing, forced_upper_bounds);
+  }
+
+  void BinMapper::FindBinFromSketch(const QuantileSketch& sketch, size_t total_cnt,
+                                    int max_bin, int min_data_in_bin, int min_split_data, bool pre_filter, BinType bin_type,
+                                    bool use_missing, bool zero_as_missing,
+                                    const std::vector<double>& forced_upper_bounds) {
+    FindBinFromSortedValues(sketch.values().data(), sketch.weights().data(), static_cast<int>(sketch.values().size()),
+                            sketch.na_cnt(), total_cnt, max_bin, min_data_in_bin, min_split_data, pre_filter, bin_type,
+                            use_missing, zero_as_missing, forced_upper_bounds);
+  }
+
+  void BinMapper::FindBinFromSortedValues(const double* values, const int* counts_of_values, int num_values, int na_cnt,
+                                          size_t total_sample_cnt, int max_bin, int min_data_in_bin, int min_split_data,
+                                          bool pre_filter, BinType bin_type, bool use_missing, bool zero_as_missing,
+                                          const std::vector<double>& forced_upper_bounds) {
     if (!use_missing) {
       missing_type_ = MissingType::None;
     } else if (zero_as_missing) {
       missing_type_ = MissingType::Zero;
     } else {
-      if (tmp_num_sample_values == num_sample_values) {
+      if (na_cnt == 0) {
         missing_type_ = MissingType::None;
       } else {
         missing_type_ = MissingType::NaN;
-        na_cnt = num_sample_values - tmp_num_sample_values;
       }
     }
-    num_sample_values = tmp_num_sample_values;
+    if (missing_type_ != MissingType::NaN) {
+      na_cnt = 0;
+    }
+    auto count_of = [counts_of_values] (int i) { return counts_of_values == nullptr ? 1 : counts_of_values[i]; };
+    int num_sample_values = num_values;
+    if (counts_of_values != nullptr) {
+      num_sample_values = 0;
+      for (int i = 0; i < num_values; ++i) {
+        num_sample_values += counts_of_values[i];
+      }
+    }
 
     bin_type_ = bin_type;
     default_bin_ = 0;
@@ -354,36 +381,34 @@ namespace LightGBM {
     std::vector<double> distinct_values;
     std::vector<int> counts;
 
-    std::stable_sort(values, values + num_sample_values);
-
     // push zero in the front
-    if (num_sample_values == 0 || (values[0] > 0.0f && zero_cnt > 0)) {
+    if (num_values == 0 || (values[0] > 0.0f && zero_cnt > 0)) {
       distinct_values.push_back(0.0f);
       counts.push_back(zero_cnt);
     }
 
-    if (num_sample_values > 0) {
+    if (num_values > 0) {
       distinct_values.push_back(values[0]);
-      counts.push_back(1);
+      counts.push_back(count_of(0));
     }
 
-    for (int i = 1; i < num_sample_values; ++i) {
+    for (int i = 1; i < num_values; ++i) {
       if (!Common::CheckDoubleEqualOrdered(values[i - 1], values[i])) {
         if (values[i - 1] < 0.0f && values[i] > 0.0f) {
           distinct_values.push_back(0.0f);
           counts.push_back(zero_cnt);
         }
         distinct_values.push_back(values[i]);
-        counts.push_back(1);
+        counts.push_back(count_of(i));
       } else {
         // use the large value
         distinct_values.back() = values[i];
-        ++counts.back();
+        counts.back() += count_of(i);
       }
     }
 
     // push zero in the back
-    if (num_sample_values > 0 && values[num_sample_values - 1] < 0.0f && zero_cnt > 0) {
+    if (num_values > 0 && values[num_values - 1] < 0.0f && zero_cnt > 0) {
       distinct_values.push_back(0.0f);
       counts.push_back(zero_cnt);
     }
@@ -324,6 +324,46 @@ void Config::CheckParamConflict() {
     force_col_wise = true;
     force_row_wise = false;
   }
+  if (use_quantized_grad && device_type != std::string("cpu")) {
+    Log::Warning("Quantized gradients are only supported by the CPU tree learner, auto set use_quantized_grad=false.");
+    use_quantized_grad = false;
+  }
+  if (leaf_batch_size > 1 && (device_type != std::string("cpu") || tree_learner != std::string("serial"))) {
+    Log::Warning("leaf_batch_size is only supported by the serial CPU tree learner, auto set leaf_batch_size=1.");
+    leaf_batch_size = 1;
+  }
+  if (tree_growth_policy == std::string("oblivious")) {
+    if (device_type != std::string("cpu") || tree_learner != std::string("serial")) {
+      Log::Fatal("Oblivious trees are only supported by the serial CPU tree learner");
+    }
+    if (!monotone_constraints.empty() || !interaction_constraints_vector.empty() ||
+        !forcedsplits_filename.empty() || use_quantized_grad) {
+      Log::Fatal("Cannot use monotone_constraints, interaction_constraints, forcedsplits_filename or use_quantized_grad with oblivious trees");
+    }
+    if (cegb_tradeoff < 1.0f || cegb_penalty_split > 0.0f ||
+        !cegb_penalty_feature_coupled.empty() || !cegb_penalty_feature_lazy.empty()) {
+      Log::Fatal("Cannot use cegb penalties with oblivious trees");
+    }
+    if (histogram_pool_size >= 0) {
+      // the histograms of all the leaves of a depth are needed together
+      Log::Warning("histogram_pool_size is not supported by oblivious trees, auto set histogram_pool_size=-1.");
+      histogram_pool_size = -1;
+    }
+    if (extra_trees) {
+      // the thresholds are chosen by their gains summed over the leaves of a depth
+      Log::Warning("extra_trees is not supported by oblivious trees, auto set extra_trees=false.");
+      extra_trees = false;
+    }
+    if ((num_leaves & (num_leaves - 1)) != 0) {
+      int depth = 0;
+      while ((2 << depth) <= num_leaves) {
+        ++depth;
+      }
+      Log::Warning("num_leaves=%d is not a power of two, oblivious trees have up to %d leaves.", num_leaves, 1 << depth);
+    }
+  } else if (tree_growth_policy != std::string("leaf_wise")) {
+    Log::Fatal("Unknown tree growth policy %s", tree_growth_policy.c_str());
+  }
   // min_data_in_leaf must be at least 2 if path smoothing is active. This is because when the split is calculated
   // the count is calculated using the proportion of hessian in the leaf which is rounded up to nearest int, so it can
   // be 1 when there is actually no data in the leaf. In rare cases this can cause a bug because with path smoothing the
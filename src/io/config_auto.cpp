@@ -105,6 +105,7 @@ const std::unordered_map<std::string, std::string>& Config::alias_table() {
   {"model_out", "output_model"},
   {"save_period", "snapshot_freq"},
   {"subsample_for_bin", "bin_construct_sample_cnt"},
+  {"quantile_sketch", "use_quantile_sketch"},
   {"data_seed", "data_random_seed"},
   {"is_sparse", "is_enable_sparse"},
   {"enable_sparse", "is_enable_sparse"},
@@ -114,6 +115,8 @@ const std::unordered_map<std::string, std::string>& Config::alias_table() {
   {"is_pre_partition", "pre_partition"},
   {"two_round_loading", "two_round"},
   {"use_two_round_loading", "two_round"},
+  {"streaming", "stream_loading"},
+  {"stream_loading_enabled", "stream_loading"},
   {"has_header", "header"},
   {"label", "label_column"},
   {"weight", "weight_column"},
@@ -186,6 +189,9 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "force_col_wise",
   "force_row_wise",
   "histogram_pool_size",
+  "compressed_histogram_pool_size",
+  "leaf_batch_size",
+  "tree_growth_policy",
   "max_depth",
   "min_data_in_leaf",
   "min_sum_hessian_in_leaf",
@@ -231,15 +237,21 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "cegb_penalty_feature_coupled",
   "path_smooth",
   "interaction_constraints",
+  "use_quantized_grad",
+  "num_grad_quant_bins",
+  "stochastic_rounding",
   "verbosity",
   "input_model",
   "output_model",
   "saved_feature_importance_type",
+  "saved_model_binary",
   "snapshot_freq",
   "max_bin",
   "max_bin_by_feature",
   "min_data_in_bin",
   "bin_construct_sample_cnt",
+  "use_quantile_sketch",
+  "quantile_sketch_size",
   "data_random_seed",
   "is_enable_sparse",
   "enable_bundle",
@@ -248,6 +260,8 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "feature_pre_filter",
   "pre_partition",
   "two_round",
+  "stream_loading",
+  "stream_first_chunk_size",
   "header",
   "label_column",
   "weight_column",
@@ -256,6 +270,7 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "categorical_feature",
   "forcedbins_filename",
   "save_binary",
+  "mmap_binary_file",
   "start_iteration_predict",
   "num_iteration_predict",
   "predict_raw_score",
@@ -268,6 +283,7 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "output_result",
   "convert_model_language",
   "convert_model",
+  "convert_model_prefix",
   "objective_seed",
   "num_class",
   "is_unbalance",
@@ -326,6 +342,13 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetDouble(params, "histogram_pool_size", &histogram_pool_size);
 
+  GetDouble(params, "compressed_histogram_pool_size", &compressed_histogram_pool_size);
+
+  GetInt(params, "leaf_batch_size", &leaf_batch_size);
+  CHECK_GT(leaf_batch_size, 0);
+
+  GetString(params, "tree_growth_policy", &tree_growth_policy);
+
   GetInt(params, "max_depth", &max_depth);
 
   GetInt(params, "min_data_in_leaf", &min_data_in_leaf);
@@ -459,6 +482,14 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetString(params, "interaction_constraints", &interaction_constraints);
 
+  GetBool(params, "use_quantized_grad", &use_quantized_grad);
+
+  GetInt(params, "num_grad_quant_bins", &num_grad_quant_bins);
+  CHECK_GE(num_grad_quant_bins,  2);
+  CHECK_LE(num_grad_quant_bins,  127);
+
+  GetBool(params, "stochastic_rounding", &stochastic_rounding);
+
   GetInt(params, "verbosity", &verbosity);
 
   GetString(params, "input_model", &input_model);
@@ -467,6 +498,8 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetInt(params, "saved_feature_importance_type", &saved_feature_importance_type);
 
+  GetBool(params, "saved_model_binary", &saved_model_binary);
+
   GetInt(params, "snapshot_freq", &snapshot_freq);
 
   GetInt(params, "max_bin", &max_bin);
@@ -482,6 +515,11 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
   GetInt(params, "bin_construct_sample_cnt", &bin_construct_sample_cnt);
   CHECK_GT(bin_construct_sample_cnt, 0);
 
+  GetBool(params, "use_quantile_sketch", &use_quantile_sketch);
+
+  GetInt(params, "quantile_sketch_size", &quantile_sketch_size);
+  CHECK_GE(quantile_sketch_size, 8);
+
   GetInt(params, "data_random_seed", &data_random_seed);
 
   GetBool(params, "is_enable_sparse", &is_enable_sparse);
@@ -498,6 +536,11 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetBool(params, "two_round", &two_round);
 
+  GetBool(params, "stream_loading", &stream_loading);
+
+  GetInt(params, "stream_first_chunk_size", &stream_first_chunk_size);
+  CHECK_GT(stream_first_chunk_size, 0);
+
   GetBool(params, "header", &header);
 
   GetString(params, "label_column", &label_column);
@@ -514,6 +557,8 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetBool(params, "save_binary", &save_binary);
 
+  GetBool(params, "mmap_binary_file", &mmap_binary_file);
+
   GetInt(params, "start_iteration_predict", &start_iteration_predict);
 
   GetInt(params, "num_iteration_predict", &num_iteration_predict);
@@ -538,6 +583,8 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetString(params, "convert_model", &convert_model);
 
+  GetString(params, "convert_model_prefix", &convert_model_prefix);
+
   GetInt(params, "objective_seed", &objective_seed);
 
   GetInt(params, "num_class", &num_class);
@@ -624,6 +671,9 @@ std::string Config::SaveMembersToString() const {
   str_buf << "[force_col_wise: " << force_col_wise << "]\n";
   str_buf << "[force_row_wise: " << force_row_wise << "]\n";
   str_buf << "[histogram_pool_size: " << histogram_pool_size << "]\n";
+  str_buf << "[compressed_histogram_pool_size: " << compressed_histogram_pool_size << "]\n";
+  str_buf << "[leaf_batch_size: " << leaf_batch_size << "]\n";
+  str_buf << "[tree_growth_policy: " << tree_growth_policy << "]\n";
   str_buf << "[max_depth: " << max_depth << "]\n";
   str_buf << "[min_data_in_leaf: " << min_data_in_leaf << "]\n";
   str_buf << "[min_sum_hessian_in_leaf: " << min_sum_hessian_in_leaf << "]\n";
@@ -669,12 +719,18 @@ std::string Config::SaveMembersToString() const {
   str_buf << "[cegb_penalty_feature_coupled: " << Common::Join(cegb_penalty_feature_coupled, ",") << "]\n";
   str_buf << "[path_smooth: " << path_smooth << "]\n";
   str_buf << "[interaction_constraints: " << interaction_constraints << "]\n";
+  str_buf << "[use_quantized_grad: " << use_quantized_grad << "]\n";
+  str_buf << "[num_grad_quant_bins: " << num_grad_quant_bins << "]\n";
+  str_buf << "[stochastic_rounding: " << stochastic_rounding << "]\n";
   str_buf << "[verbosity: " << verbosity << "]\n";
   str_buf << "[saved_feature_importance_type: " << saved_feature_importance_type << "]\n";
+  str_buf << "[saved_model_binary: " << saved_model_binary << "]\n";
   str_buf << "[max_bin: " << max_bin << "]\n";
   str_buf << "[max_bin_by_feature: " << Common::Join(max_bin_by_feature, ",") << "]\n";
   str_buf << "[min_data_in_bin: " << min_data_in_bin << "]\n";
   str_buf << "[bin_construct_sample_cnt: " << bin_construct_sample_cnt << "]\n";
+  str_buf << "[use_quantile_sketch: " << use_quantile_sketch << "]\n";
+  str_buf << "[quantile_sketch_size: " << quantile_sketch_size << "]\n";
   str_buf << "[data_random_seed: " << data_random_seed << "]\n";
   str_buf << "[is_enable_sparse: " << is_enable_sparse << "]\n";
   str_buf << "[enable_bundle: " << enable_bundle << "]\n";
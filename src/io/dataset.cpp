@@ -12,14 +12,52 @@
 
 #include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 #include <sstream>
+#include <type_traits>
 #include <unordered_map>
 
 namespace LightGBM {
 
 const char* Dataset::binary_file_token =
     "______LightGBM_Binary_File_Token______\n";
+const uint32_t Dataset::binary_file_version = 1;
+
+/*! \brief Minimal number of rows of a tile of (feature group, row block) in histogram construction */
+const data_size_t kMinRowsPerHistogramTile = 4096;
+/*! \brief Number of tiles of (feature group, row block) per thread when there are few feature groups */
+const int kHistogramTilesPerThread = 4;
+/*! \brief Number of rows of a pass over all the feature groups when there are many of them */
+const data_size_t kRowsPerHistogramPass = 1 << 17;
+
+/*!
+* \brief Row blocks of the col-wise histograms of a leaf, none with a single thread.
+*        With few used dense groups, the blocks are constructed at the same time into their own
+*        histograms, merged afterwards in order, so that there are about kHistogramTilesPerThread
+*        tiles per thread. The sums then depend on the number of threads.
+*        With many groups, the blocks are passes over all the groups, each group accumulating its
+*        blocks in order into the same histogram, so the ordered gradients of a block are read
+*        from cache by all the groups. The sums are the same as with a single block.
+*/
+static void HistogramRowBlocks(data_size_t num_data, int num_used_dense_group, int num_threads,
+                               int* n_row_block, data_size_t* row_block_size, bool* is_pass) {
+  *n_row_block = 1;
+  *row_block_size = num_data;
+  *is_pass = false;
+  if (num_threads <= 1 || num_used_dense_group <= 0) {
+    return;
+  }
+  const int num_tiles = kHistogramTilesPerThread * num_threads;
+  if (2 * num_used_dense_group <= num_tiles) {
+    Threading::BlockInfo<data_size_t>(num_tiles / num_used_dense_group, num_data,
+                                      kMinRowsPerHistogramTile, n_row_block, row_block_size);
+  } else if (num_data > kRowsPerHistogramPass) {
+    *n_row_block = static_cast<int>((num_data + kRowsPerHistogramPass - 1) / kRowsPerHistogramPass);
+    *row_block_size = (num_data + *n_row_block - 1) / *n_row_block;
+    *is_pass = true;
+  }
+}
 
 Dataset::Dataset() {
   data_filename_ = "noname";
@@ -917,7 +955,8 @@ void Dataset::SaveBinaryFile(const char* bin_filename) {
     size_t size_of_header = sizeof(num_data_) + sizeof(num_features_) + sizeof(num_total_features_)
       + sizeof(int) * num_total_features_ + sizeof(label_idx_) + sizeof(num_groups_)
       + 3 * sizeof(int) * num_features_ + sizeof(uint64_t) * (num_groups_ + 1) + 2 * sizeof(int) * num_groups_
-      + sizeof(int32_t) * num_total_features_ + sizeof(int) * 3 + sizeof(bool) * 2;
+      + sizeof(int32_t) * num_total_features_ + sizeof(int) * 3 + sizeof(bool) * 2
+      + sizeof(binary_file_version);
 
     // size of feature names
     for (int i = 0; i < num_total_features_; ++i) {
@@ -973,6 +1012,8 @@ void Dataset::SaveBinaryFile(const char* bin_filename) {
         writer->Write(&forced_bin_bounds_[i][j], sizeof(double));
       }
     }
+    // version at the end of header, files of version 0 don't have it
+    writer->Write(&binary_file_version, sizeof(binary_file_version));
 
     // get size of meta data
     size_t size_of_metadata = metadata_.SizesInByte();
@@ -980,13 +1021,18 @@ void Dataset::SaveBinaryFile(const char* bin_filename) {
     // write meta data
     metadata_.SaveBinaryToFile(writer.get());
 
-    // write feature data
+    // write feature data, each group starts at a multiple of kAlignedSize in the file
+    size_t offset = size_of_token + sizeof(size_of_header) + size_of_header
+                    + sizeof(size_of_metadata) + size_of_metadata;
     for (int i = 0; i < num_groups_; ++i) {
+      const size_t padding = BinaryFeaturePadding(offset);
+      FeatureGroup::WritePadding(writer.get(), offset + sizeof(size_t));
       // get size of feature
       size_t size_of_feature = feature_groups_[i]->SizesInByte();
       writer->Write(&size_of_feature, sizeof(size_of_feature));
       // write feature
       feature_groups_[i]->SaveBinaryToFile(writer.get());
+      offset += padding + sizeof(size_of_feature) + size_of_feature;
     }
   }
 }
@@ -1089,25 +1135,9 @@ void Dataset::InitTrain(const std::vector<int8_t>& is_feature_used,
     }
   }
   const double k_subfeature_threshold = 0.6;
-  if (sum_used_dense_ratio >= sum_dense_ratio * k_subfeature_threshold) {
-    // only need to copy subset
-    if (share_state->is_use_subrow && !share_state->is_subrow_copied) {
-      if (share_state->multi_val_bin_subset == nullptr) {
-        share_state->multi_val_bin_subset.reset(multi_val_bin->CreateLike(
-            share_state->bagging_indices_cnt, multi_val_bin->num_bin(), total,
-            multi_val_bin->num_element_per_row()));
-      } else {
-        share_state->multi_val_bin_subset->ReSize(
-            share_state->bagging_indices_cnt, multi_val_bin->num_bin(), total,
-            multi_val_bin->num_element_per_row());
-      }
-      share_state->multi_val_bin_subset->CopySubrow(
-          multi_val_bin, share_state->bagging_use_indices,
-          share_state->bagging_indices_cnt);
-      // avoid to copy subset many times
-      share_state->is_subrow_copied = true;
-    }
-  } else {
+  // without a subset of columns, the rows of the bagging subset are read
+  // from the full multi_val_bin when constructing histograms, no copy is needed
+  if (sum_used_dense_ratio < sum_dense_ratio * k_subfeature_threshold) {
     share_state->is_use_subcol = true;
     std::vector<uint32_t> upper_bound;
     std::vector<uint32_t> lower_bound;
@@ -1185,8 +1215,6 @@ void Dataset::InitTrain(const std::vector<int8_t>& is_feature_used,
           multi_val_bin, share_state->bagging_use_indices,
           share_state->bagging_indices_cnt, used_feature_index, lower_bound,
           upper_bound, delta);
-      // may need to recopy subset
-      share_state->is_subrow_copied = false;
     } else {
       share_state->multi_val_bin_subset->CopySubcol(
           multi_val_bin, used_feature_index, lower_bound, upper_bound, delta);
@@ -1194,6 +1222,46 @@ void Dataset::InitTrain(const std::vector<int8_t>& is_feature_used,
   }
 }
 
+/*!
+* \brief Map the rows [start, end) of a leaf of the bagging subset to the rows of the full data
+* \param bagging_use_indices Rows of the full data used by the bagging subset
+* \param data_indices Rows of the leaf in the subset, not used when USE_INDICES is false
+* \param out_rows Output, rows of the full data at the same positions
+*/
+template <bool USE_INDICES>
+static inline void GetSubrowIndices(const data_size_t* bagging_use_indices,
+                                    const data_size_t* data_indices,
+                                    data_size_t start, data_size_t end,
+                                    data_size_t* out_rows) {
+  for (data_size_t i = start; i < end; ++i) {
+    out_rows[i] = bagging_use_indices[USE_INDICES ? data_indices[i] : i];
+  }
+}
+
+/*!
+* \brief Make the buffers used to read the bagging subset from the full multi_val_bin
+*        large enough for num_data rows
+*/
+template <bool NEED_GATHER>
+static void ResizeSubrowBuffers(data_size_t num_data, bool is_int,
+                                TrainingShareStates* share_state) {
+  const size_t size = static_cast<size_t>(num_data);
+  if (share_state->subrow_indices.size() < size) {
+    share_state->subrow_indices.resize(size);
+  }
+  if (!NEED_GATHER) {
+    return;
+  }
+  if (is_int) {
+    if (share_state->subrow_int_grad_hess.size() < size) {
+      share_state->subrow_int_grad_hess.resize(size);
+    }
+  } else if (share_state->subrow_gradients.size() < size) {
+    share_state->subrow_gradients.resize(size);
+    share_state->subrow_hessians.resize(size);
+  }
+}
+
 template <bool USE_INDICES, bool ORDERED>
 void Dataset::ConstructHistogramsMultiVal(const data_size_t* data_indices,
                                           data_size_t num_data,
@@ -1203,10 +1271,7 @@ void Dataset::ConstructHistogramsMultiVal(const data_size_t* data_indices,
                                           hist_t* hist_data) const {
   Common::FunctionTimer fun_time("Dataset::ConstructHistogramsMultiVal",
                                  global_timer);
-  const auto multi_val_bin =
-      (share_state->is_use_subcol || share_state->is_use_subrow)
-          ? share_state->multi_val_bin_subset.get()
-          : share_state->multi_val_bin.get();
+  const auto multi_val_bin = share_state->UsedMultiValBin();
   if (multi_val_bin == nullptr) {
     return;
   }
@@ -1223,9 +1288,17 @@ void Dataset::ConstructHistogramsMultiVal(const data_size_t* data_indices,
   if (share_state->hist_buf.size() < buf_size) {
     share_state->hist_buf.resize(buf_size);
   }
-  auto origin_hist_data = hist_data;
+  const bool is_subrow_view = share_state->IsSubrowView();
+  if (is_subrow_view) {
+    ResizeSubrowBuffers<USE_INDICES && !ORDERED>(num_data, false, share_state);
+  }
+  hist_acc_t* acc_hist_data;
   if (share_state->is_use_subcol) {
-    hist_data = share_state->TempBuf();
+    acc_hist_data = share_state->TempBuf();
+  } else if (std::is_same<hist_t, hist_acc_t>::value) {
+    acc_hist_data = reinterpret_cast<hist_acc_t*>(hist_data);
+  } else {
+    acc_hist_data = share_state->AccHistBuf(static_cast<size_t>(num_bin) * 2);
   }
   OMP_INIT_EX();
 #pragma omp parallel for schedule(static, 1) num_threads(share_state->num_threads)
@@ -1233,13 +1306,33 @@ void Dataset::ConstructHistogramsMultiVal(const data_size_t* data_indices,
     OMP_LOOP_EX_BEGIN();
     data_size_t start = tid * data_block_size;
     data_size_t end = std::min(start + data_block_size, num_data);
-    auto data_ptr = hist_data;
+    auto data_ptr = acc_hist_data;
     if (tid > 0) {
       data_ptr = share_state->hist_buf.data() +
                  static_cast<size_t>(num_bin_aligned) * 2 * (tid - 1);
     }
-    std::memset(reinterpret_cast<void*>(data_ptr), 0, num_bin * kHistEntrySize);
-    if (USE_INDICES) {
+    std::memset(reinterpret_cast<void*>(data_ptr), 0,
+                num_bin * 2 * sizeof(hist_acc_t));
+    if (is_subrow_view) {
+      data_size_t* rows = share_state->subrow_indices.data();
+      GetSubrowIndices<USE_INDICES>(share_state->bagging_use_indices,
+                                    data_indices, start, end, rows);
+      if (USE_INDICES && !ORDERED) {
+        score_t* ordered_gradients = share_state->subrow_gradients.data();
+        score_t* ordered_hessians = share_state->subrow_hessians.data();
+        for (data_size_t i = start; i < end; ++i) {
+          ordered_gradients[i] = gradients[data_indices[i]];
+          ordered_hessians[i] = hessians[data_indices[i]];
+        }
+        multi_val_bin->ConstructHistogramOrdered(rows, start, end,
+                                                 ordered_gradients,
+                                                 ordered_hessians, data_ptr);
+      } else {
+        // gradients are in the order of the rows of the subset
+        multi_val_bin->ConstructHistogramOrdered(rows, start, end, gradients,
+                                                 hessians, data_ptr);
+      }
+    } else if (USE_INDICES) {
       if (ORDERED) {
         multi_val_bin->ConstructHistogramOrdered(data_indices, start, end,
                                                  gradients, hessians, data_ptr);
@@ -1269,29 +1362,26 @@ void Dataset::ConstructHistogramsMultiVal(const data_size_t* data_indices,
       auto src_ptr = share_state->hist_buf.data() +
                      static_cast<size_t>(num_bin_aligned) * 2 * (tid - 1);
       for (int i = start * 2; i < end * 2; ++i) {
-        hist_data[i] += src_ptr[i];
+        acc_hist_data[i] += src_ptr[i];
       }
     }
   }
   global_timer.Stop("Dataset::sparse_bin_histogram_merge");
   global_timer.Start("Dataset::sparse_bin_histogram_move");
-  share_state->HistMove(hist_data, origin_hist_data);
+  if (share_state->is_use_subcol) {
+    share_state->HistMove(acc_hist_data, hist_data);
+  } else if (!std::is_same<hist_t, hist_acc_t>::value) {
+    std::copy_n(acc_hist_data, num_bin * 2, hist_data);
+  }
   global_timer.Stop("Dataset::sparse_bin_histogram_move");
 }
 
-template <bool USE_INDICES, bool USE_HESSIAN>
-void Dataset::ConstructHistogramsInner(
-    const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
-    data_size_t num_data, const score_t* gradients, const score_t* hessians,
-    score_t* ordered_gradients, score_t* ordered_hessians,
-    TrainingShareStates* share_state, hist_t* hist_data) const {
-  if (!share_state->is_colwise) {
-    return ConstructHistogramsMultiVal<USE_INDICES, false>(
-        data_indices, num_data, gradients, hessians, share_state, hist_data);
-  }
-  std::vector<int> used_dense_group;
-  int multi_val_groud_id = -1;
-  used_dense_group.reserve(num_groups_);
+void Dataset::GetUsedGroups(const std::vector<int8_t>& is_feature_used,
+                            std::vector<int>* used_dense_group,
+                            int* multi_val_group_id) const {
+  used_dense_group->clear();
+  used_dense_group->reserve(num_groups_);
+  *multi_val_group_id = -1;
   for (int group = 0; group < num_groups_; ++group) {
     const int f_cnt = group_feature_cnt_[group];
     bool is_group_used = false;
@@ -1304,19 +1394,38 @@ void Dataset::ConstructHistogramsInner(
     }
     if (is_group_used) {
       if (feature_groups_[group]->is_multi_val_) {
-        multi_val_groud_id = group;
+        *multi_val_group_id = group;
       } else {
-        used_dense_group.push_back(group);
+        used_dense_group->push_back(group);
       }
     }
   }
+}
+
+template <bool USE_INDICES, bool USE_HESSIAN>
+void Dataset::ConstructHistogramsInner(
+    const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
+    data_size_t num_data, const score_t* gradients, const score_t* hessians,
+    score_t* ordered_gradients, score_t* ordered_hessians,
+    TrainingShareStates* share_state, hist_t* hist_data, bool is_ordered) const {
+  if (!share_state->is_colwise) {
+    return ConstructHistogramsMultiVal<USE_INDICES, false>(
+        data_indices, num_data, gradients, hessians, share_state, hist_data);
+  }
+  std::vector<int> used_dense_group;
+  int multi_val_groud_id = -1;
+  GetUsedGroups(is_feature_used, &used_dense_group, &multi_val_groud_id);
   int num_used_dense_group = static_cast<int>(used_dense_group.size());
   global_timer.Start("Dataset::dense_bin_histogram");
   auto ptr_ordered_grad = gradients;
   auto ptr_ordered_hess = hessians;
   if (num_used_dense_group > 0) {
     if (USE_INDICES) {
-      if (USE_HESSIAN) {
+      if (is_ordered) {
+        // already gathered while the data were partitioned
+        ptr_ordered_grad = ordered_gradients;
+        ptr_ordered_hess = USE_HESSIAN ? ordered_hessians : hessians;
+      } else if (USE_HESSIAN) {
 #pragma omp parallel for schedule(static, 512) if (num_data >= 1024)
         for (data_size_t i = 0; i < num_data; ++i) {
           ordered_gradients[i] = gradients[data_indices[i]];
@@ -1332,40 +1441,110 @@ void Dataset::ConstructHistogramsInner(
         ptr_ordered_grad = ordered_gradients;
       }
     }
-    OMP_INIT_EX();
-#pragma omp parallel for schedule(static) num_threads(share_state->num_threads)
+    hist_acc_t* acc_hist_data =
+        std::is_same<hist_t, hist_acc_t>::value
+            ? reinterpret_cast<hist_acc_t*>(hist_data)
+            : share_state->AccHistBuf(static_cast<size_t>(NumTotalBin()) * 2);
+    // split the rows of the groups into blocks, so the histograms are constructed by tiles of
+    // (group, row block)
+    const int num_threads = share_state->num_threads;
+    int n_row_block = 1;
+    data_size_t row_block_size = num_data;
+    bool is_pass = false;
+    HistogramRowBlocks(num_data, num_used_dense_group, num_threads, &n_row_block,
+                       &row_block_size, &is_pass);
+    // row blocks constructed at the same time, the ones other than the first one into their
+    // own histograms, merged afterwards
+    const int n_merged_block = is_pass ? 1 : n_row_block;
+    const int n_pass = is_pass ? n_row_block : 1;
+    std::vector<size_t> tile_hist_offset(num_used_dense_group + 1, 0);
     for (int gi = 0; gi < num_used_dense_group; ++gi) {
-      OMP_LOOP_EX_BEGIN();
-      int group = used_dense_group[gi];
-      auto data_ptr = hist_data + group_bin_boundaries_[group] * 2;
-      const int num_bin = feature_groups_[group]->num_total_bin_;
-      std::memset(reinterpret_cast<void*>(data_ptr), 0,
-                  num_bin * kHistEntrySize);
-      if (USE_HESSIAN) {
-        if (USE_INDICES) {
-          feature_groups_[group]->bin_data_->ConstructHistogram(
-              data_indices, 0, num_data, ptr_ordered_grad, ptr_ordered_hess,
-              data_ptr);
+      tile_hist_offset[gi + 1] =
+          tile_hist_offset[gi] +
+          static_cast<size_t>(feature_groups_[used_dense_group[gi]]->num_total_bin_) * 2;
+    }
+    const size_t tile_hist_stride = tile_hist_offset[num_used_dense_group];
+    if (n_merged_block > 1) {
+      const size_t buf_size = tile_hist_stride * (n_merged_block - 1);
+      if (share_state->tile_hist_buf.size() < buf_size) {
+        share_state->tile_hist_buf.resize(buf_size);
+      }
+    }
+    const int num_tiles = num_used_dense_group * n_merged_block;
+    for (int pass = 0; pass < n_pass; ++pass) {
+      OMP_INIT_EX();
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+      for (int tile = 0; tile < num_tiles; ++tile) {
+        OMP_LOOP_EX_BEGIN();
+        const int gi = tile / n_merged_block;
+        const int merged_block = tile % n_merged_block;
+        const int group = used_dense_group[gi];
+        const data_size_t start = (pass + merged_block) * row_block_size;
+        const data_size_t end = std::min(start + row_block_size, num_data);
+        auto data_ptr = acc_hist_data + group_bin_boundaries_[group] * 2;
+        if (merged_block > 0) {
+          data_ptr = share_state->tile_hist_buf.data() +
+                     tile_hist_stride * (merged_block - 1) + tile_hist_offset[gi];
+        }
+        const int num_bin = feature_groups_[group]->num_total_bin_;
+        if (pass == 0) {
+          std::memset(reinterpret_cast<void*>(data_ptr), 0,
+                      num_bin * 2 * sizeof(hist_acc_t));
+        }
+        if (USE_HESSIAN) {
+          if (USE_INDICES) {
+            feature_groups_[group]->bin_data_->ConstructHistogram(
+                data_indices, start, end, ptr_ordered_grad, ptr_ordered_hess,
+                data_ptr);
+          } else {
+            feature_groups_[group]->bin_data_->ConstructHistogram(
+                start, end, ptr_ordered_grad, ptr_ordered_hess, data_ptr);
+          }
         } else {
-          feature_groups_[group]->bin_data_->ConstructHistogram(
-              0, num_data, ptr_ordered_grad, ptr_ordered_hess, data_ptr);
+          if (USE_INDICES) {
+            feature_groups_[group]->bin_data_->ConstructHistogram(
+                data_indices, start, end, ptr_ordered_grad, data_ptr);
+          } else {
+            feature_groups_[group]->bin_data_->ConstructHistogram(
+                start, end, ptr_ordered_grad, data_ptr);
+          }
         }
-      } else {
-        if (USE_INDICES) {
-          feature_groups_[group]->bin_data_->ConstructHistogram(
-              data_indices, 0, num_data, ptr_ordered_grad, data_ptr);
+        OMP_LOOP_EX_END();
+      }
+      OMP_THROW_EX();
+    }
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+    for (int gi = 0; gi < num_used_dense_group; ++gi) {
+      int group = used_dense_group[gi];
+      auto data_ptr = acc_hist_data + group_bin_boundaries_[group] * 2;
+      const int num_bin = feature_groups_[group]->num_total_bin_;
+      for (int merged_block = 1; merged_block < n_merged_block; ++merged_block) {
+        auto src_ptr = share_state->tile_hist_buf.data() +
+                       tile_hist_stride * (merged_block - 1) + tile_hist_offset[gi];
+        if (USE_HESSIAN) {
+          for (int i = 0; i < num_bin * 2; ++i) {
+            data_ptr[i] += src_ptr[i];
+          }
         } else {
-          feature_groups_[group]->bin_data_->ConstructHistogram(
-              0, num_data, ptr_ordered_grad, data_ptr);
+          auto cnt_dst = reinterpret_cast<hist_cnt_t*>(data_ptr);
+          auto cnt_src = reinterpret_cast<const hist_cnt_t*>(src_ptr);
+          for (int i = 0; i < num_bin * 2; i += 2) {
+            data_ptr[i] += src_ptr[i];
+            cnt_dst[i + 1] += cnt_src[i + 1];
+          }
         }
+      }
+      if (!USE_HESSIAN) {
         auto cnt_dst = reinterpret_cast<hist_cnt_t*>(data_ptr + 1);
         for (int i = 0; i < num_bin * 2; i += 2) {
           data_ptr[i + 1] = static_cast<double>(cnt_dst[i]) * hessians[0];
         }
       }
-      OMP_LOOP_EX_END();
+      if (!std::is_same<hist_t, hist_acc_t>::value) {
+        std::copy_n(data_ptr, num_bin * 2,
+                    hist_data + group_bin_boundaries_[group] * 2);
+      }
     }
-    OMP_THROW_EX();
   }
   global_timer.Stop("Dataset::dense_bin_histogram");
   if (multi_val_groud_id >= 0) {
@@ -1387,25 +1566,480 @@ template void Dataset::ConstructHistogramsInner<true, true>(
     const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
     data_size_t num_data, const score_t* gradients, const score_t* hessians,
     score_t* ordered_gradients, score_t* ordered_hessians,
-    TrainingShareStates* share_state, hist_t* hist_data) const;
+    TrainingShareStates* share_state, hist_t* hist_data, bool is_ordered) const;
 
 template void Dataset::ConstructHistogramsInner<true, false>(
     const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
     data_size_t num_data, const score_t* gradients, const score_t* hessians,
     score_t* ordered_gradients, score_t* ordered_hessians,
-    TrainingShareStates* share_state, hist_t* hist_data) const;
+    TrainingShareStates* share_state, hist_t* hist_data, bool is_ordered) const;
 
 template void Dataset::ConstructHistogramsInner<false, true>(
     const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
     data_size_t num_data, const score_t* gradients, const score_t* hessians,
     score_t* ordered_gradients, score_t* ordered_hessians,
-    TrainingShareStates* share_state, hist_t* hist_data) const;
+    TrainingShareStates* share_state, hist_t* hist_data, bool is_ordered) const;
 
 template void Dataset::ConstructHistogramsInner<false, false>(
     const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
     data_size_t num_data, const score_t* gradients, const score_t* hessians,
     score_t* ordered_gradients, score_t* ordered_hessians,
-    TrainingShareStates* share_state, hist_t* hist_data) const;
+    TrainingShareStates* share_state, hist_t* hist_data, bool is_ordered) const;
+
+void Dataset::ConstructHistogramsForLeaves(
+    const std::vector<HistogramLeaf>& leaves, const score_t* gradients,
+    const score_t* hessians, TrainingShareStates* share_state) const {
+  if (!share_state->is_colwise || !std::is_same<hist_t, hist_acc_t>::value) {
+    for (const auto& leaf : leaves) {
+      ConstructHistograms(*leaf.is_feature_used, leaf.data_indices,
+                          leaf.num_data, gradients, hessians,
+                          leaf.ordered_gradients, leaf.ordered_hessians,
+                          share_state, leaf.hist_data);
+    }
+    return;
+  }
+  if (share_state->is_constant_hessian) {
+    ConstructHistogramsForLeavesInner<false>(leaves, gradients, hessians,
+                                             share_state);
+  } else {
+    ConstructHistogramsForLeavesInner<true>(leaves, gradients, hessians,
+                                            share_state);
+  }
+}
+
+template <bool USE_HESSIAN>
+void Dataset::ConstructHistogramsForLeavesInner(
+    const std::vector<HistogramLeaf>& leaves, const score_t* gradients,
+    const score_t* hessians, TrainingShareStates* share_state) const {
+  const int num_threads = share_state->num_threads;
+  std::vector<const HistogramLeaf*> batched_leaves;
+  std::vector<std::vector<int>> used_dense_group;
+  std::vector<int> multi_val_group_id;
+  // (leaf, position in used_dense_group) of each tile
+  std::vector<std::pair<int, int>> tiles;
+  std::vector<int> leaf_used_dense_group;
+  for (const auto& leaf : leaves) {
+    if (leaf.num_data <= 0) {
+      continue;
+    }
+    int leaf_multi_val_group_id = -1;
+    GetUsedGroups(*leaf.is_feature_used, &leaf_used_dense_group,
+                  &leaf_multi_val_group_id);
+    int n_row_block = 1;
+    data_size_t row_block_size = leaf.num_data;
+    bool is_pass = false;
+    HistogramRowBlocks(leaf.num_data, static_cast<int>(leaf_used_dense_group.size()),
+                       num_threads, &n_row_block, &row_block_size, &is_pass);
+    // leaves with several row blocks are constructed by their tiles, the other ones give
+    // the same sums with one tile per group
+    if (n_row_block > 1) {
+      ConstructHistograms(*leaf.is_feature_used, leaf.data_indices,
+                          leaf.num_data, gradients, hessians,
+                          leaf.ordered_gradients, leaf.ordered_hessians,
+                          share_state, leaf.hist_data);
+      continue;
+    }
+    const int i = static_cast<int>(batched_leaves.size());
+    for (int gi = 0; gi < static_cast<int>(leaf_used_dense_group.size()); ++gi) {
+      tiles.emplace_back(i, gi);
+    }
+    batched_leaves.push_back(&leaf);
+    used_dense_group.push_back(leaf_used_dense_group);
+    multi_val_group_id.push_back(leaf_multi_val_group_id);
+  }
+  const int num_leaves = static_cast<int>(batched_leaves.size());
+  if (num_leaves == 0) {
+    return;
+  }
+  global_timer.Start("Dataset::dense_bin_histogram");
+  OMP_INIT_EX();
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (int i = 0; i < num_leaves; ++i) {
+    OMP_LOOP_EX_BEGIN();
+    const HistogramLeaf& leaf = *batched_leaves[i];
+    if (!used_dense_group[i].empty()) {
+      for (data_size_t j = 0; j < leaf.num_data; ++j) {
+        leaf.ordered_gradients[j] = gradients[leaf.data_indices[j]];
+      }
+      if (USE_HESSIAN) {
+        for (data_size_t j = 0; j < leaf.num_data; ++j) {
+          leaf.ordered_hessians[j] = hessians[leaf.data_indices[j]];
+        }
+      }
+    }
+    OMP_LOOP_EX_END();
+  }
+  OMP_THROW_EX();
+  const int num_tiles = static_cast<int>(tiles.size());
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    OMP_LOOP_EX_BEGIN();
+    const HistogramLeaf& leaf = *batched_leaves[tiles[tile].first];
+    const int group = used_dense_group[tiles[tile].first][tiles[tile].second];
+    auto data_ptr = reinterpret_cast<hist_acc_t*>(leaf.hist_data) +
+                    group_bin_boundaries_[group] * 2;
+    const int num_bin = feature_groups_[group]->num_total_bin_;
+    std::memset(reinterpret_cast<void*>(data_ptr), 0,
+                num_bin * 2 * sizeof(hist_acc_t));
+    if (USE_HESSIAN) {
+      feature_groups_[group]->bin_data_->ConstructHistogram(
+          leaf.data_indices, 0, leaf.num_data, leaf.ordered_gradients,
+          leaf.ordered_hessians, data_ptr);
+    } else {
+      feature_groups_[group]->bin_data_->ConstructHistogram(
+          leaf.data_indices, 0, leaf.num_data, leaf.ordered_gradients,
+          data_ptr);
+      auto cnt_dst = reinterpret_cast<hist_cnt_t*>(data_ptr + 1);
+      for (int j = 0; j < num_bin * 2; j += 2) {
+        data_ptr[j + 1] = static_cast<double>(cnt_dst[j]) * hessians[0];
+      }
+    }
+    OMP_LOOP_EX_END();
+  }
+  OMP_THROW_EX();
+  global_timer.Stop("Dataset::dense_bin_histogram");
+  for (int i = 0; i < num_leaves; ++i) {
+    if (multi_val_group_id[i] < 0) {
+      continue;
+    }
+    const HistogramLeaf& leaf = *batched_leaves[i];
+    hist_t* hist_data =
+        leaf.hist_data + group_bin_boundaries_[multi_val_group_id[i]] * 2;
+    if (!used_dense_group[i].empty()) {
+      ConstructHistogramsMultiVal<true, true>(
+          leaf.data_indices, leaf.num_data, leaf.ordered_gradients,
+          USE_HESSIAN ? leaf.ordered_hessians : hessians, share_state,
+          hist_data);
+    } else {
+      ConstructHistogramsMultiVal<true, false>(
+          leaf.data_indices, leaf.num_data, gradients, hessians, share_state,
+          hist_data);
+    }
+  }
+}
+
+/*!
+* \brief Convert num_bin entries of an integer histogram stored at the start of data
+*        to hist_t entries in place, from the last entry to the first
+*/
+template <typename PACKED_HIST_T, int HIST_BITS, typename OUT_T>
+static void DequantizeHistogram(OUT_T* data, int num_bin, double grad_scale,
+                                double hess_scale) {
+  static_assert(sizeof(PACKED_HIST_T) <= 2 * sizeof(OUT_T), "Integer histogram entry size is not correct");
+  const PACKED_HIST_T hess_mask = (static_cast<PACKED_HIST_T>(1) << HIST_BITS) - 1;
+  const char* src = reinterpret_cast<const char*>(data);
+  for (int i = num_bin - 1; i >= 0; --i) {
+    PACKED_HIST_T packed;
+    std::memcpy(&packed, src + static_cast<size_t>(i) * sizeof(PACKED_HIST_T),
+                sizeof(PACKED_HIST_T));
+    GET_GRAD(data, i) = static_cast<OUT_T>(static_cast<double>(packed >> HIST_BITS) * grad_scale);
+    GET_HESS(data, i) = static_cast<OUT_T>(static_cast<double>(packed & hess_mask) * hess_scale);
+  }
+}
+
+template <bool USE_INDICES, bool ORDERED, typename PACKED_HIST_T, int HIST_BITS>
+void Dataset::ConstructIntHistogramsMultiVal(const data_size_t* data_indices,
+                                             data_size_t num_data,
+                                             const int16_t* int_grad_hess,
+                                             double grad_scale,
+                                             double hess_scale,
+                                             TrainingShareStates* share_state,
+                                             hist_t* hist_data) const {
+  Common::FunctionTimer fun_time("Dataset::ConstructIntHistogramsMultiVal",
+                                 global_timer);
+  const auto multi_val_bin = share_state->UsedMultiValBin();
+  if (multi_val_bin == nullptr) {
+    return;
+  }
+  global_timer.Start("Dataset::sparse_bin_histogram");
+  const int num_bin = multi_val_bin->num_bin();
+  const int num_bin_aligned =
+      (num_bin + kAlignedSize - 1) / kAlignedSize * kAlignedSize;
+  int n_data_block = 1;
+  int data_block_size = num_data;
+  Threading::BlockInfo<data_size_t>(share_state->num_threads, num_data, 1024,
+                                    &n_data_block, &data_block_size);
+  const size_t buf_size =
+      static_cast<size_t>(n_data_block - 1) * num_bin_aligned * 2;
+  if (share_state->hist_buf.size() < buf_size) {
+    share_state->hist_buf.resize(buf_size);
+  }
+  const bool is_subrow_view = share_state->IsSubrowView();
+  if (is_subrow_view) {
+    ResizeSubrowBuffers<USE_INDICES && !ORDERED>(num_data, true, share_state);
+  }
+  hist_acc_t* temp_hist_data = share_state->TempBuf();
+  // integer histograms of the blocks are stored at the start of the same buffers as hist_t ones
+  auto int_hist_data = share_state->is_use_subcol
+                           ? reinterpret_cast<PACKED_HIST_T*>(temp_hist_data)
+                           : reinterpret_cast<PACKED_HIST_T*>(hist_data);
+  OMP_INIT_EX();
+#pragma omp parallel for schedule(static, 1) num_threads(share_state->num_threads)
+  for (int tid = 0; tid < n_data_block; ++tid) {
+    OMP_LOOP_EX_BEGIN();
+    data_size_t start = tid * data_block_size;
+    data_size_t end = std::min(start + data_block_size, num_data);
+    auto data_ptr = int_hist_data;
+    if (tid > 0) {
+      data_ptr = reinterpret_cast<PACKED_HIST_T*>(
+          share_state->hist_buf.data() +
+          static_cast<size_t>(num_bin_aligned) * 2 * (tid - 1));
+    }
+    std::memset(reinterpret_cast<void*>(data_ptr), 0,
+                num_bin * sizeof(PACKED_HIST_T));
+    if (is_subrow_view) {
+      data_size_t* rows = share_state->subrow_indices.data();
+      GetSubrowIndices<USE_INDICES>(share_state->bagging_use_indices,
+                                    data_indices, start, end, rows);
+      const int16_t* ordered_int_grad_hess = int_grad_hess;
+      if (USE_INDICES && !ORDERED) {
+        int16_t* buf = share_state->subrow_int_grad_hess.data();
+        for (data_size_t i = start; i < end; ++i) {
+          buf[i] = int_grad_hess[data_indices[i]];
+        }
+        ordered_int_grad_hess = buf;
+      }
+      if (HIST_BITS == 16) {
+        multi_val_bin->ConstructHistogramOrderedInt32(
+            rows, start, end, ordered_int_grad_hess,
+            reinterpret_cast<int32_t*>(data_ptr));
+      } else {
+        multi_val_bin->ConstructHistogramOrderedInt64(
+            rows, start, end, ordered_int_grad_hess,
+            reinterpret_cast<int64_t*>(data_ptr));
+      }
+    } else if (HIST_BITS == 16) {
+      auto out = reinterpret_cast<int32_t*>(data_ptr);
+      if (USE_INDICES) {
+        if (ORDERED) {
+          multi_val_bin->ConstructHistogramOrderedInt32(data_indices, start, end,
+                                                        int_grad_hess, out);
+        } else {
+          multi_val_bin->ConstructHistogramInt32(data_indices, start, end,
+                                                 int_grad_hess, out);
+        }
+      } else {
+        multi_val_bin->ConstructHistogramInt32(start, end, int_grad_hess, out);
+      }
+    } else {
+      auto out = reinterpret_cast<int64_t*>(data_ptr);
+      if (USE_INDICES) {
+        if (ORDERED) {
+          multi_val_bin->ConstructHistogramOrderedInt64(data_indices, start, end,
+                                                        int_grad_hess, out);
+        } else {
+          multi_val_bin->ConstructHistogramInt64(data_indices, start, end,
+                                                 int_grad_hess, out);
+        }
+      } else {
+        multi_val_bin->ConstructHistogramInt64(start, end, int_grad_hess, out);
+      }
+    }
+    OMP_LOOP_EX_END();
+  }
+  OMP_THROW_EX();
+  global_timer.Stop("Dataset::sparse_bin_histogram");
+
+  global_timer.Start("Dataset::sparse_bin_histogram_merge");
+  int n_bin_block = 1;
+  int bin_block_size = num_bin;
+  Threading::BlockInfo<data_size_t>(share_state->num_threads, num_bin, 512, &n_bin_block,
+                                    &bin_block_size);
+#pragma omp parallel for schedule(static, 1) num_threads(share_state->num_threads)
+  for (int t = 0; t < n_bin_block; ++t) {
+    const int start = t * bin_block_size;
+    const int end = std::min(start + bin_block_size, num_bin);
+    for (int tid = 1; tid < n_data_block; ++tid) {
+      auto src_ptr = reinterpret_cast<const PACKED_HIST_T*>(
+          share_state->hist_buf.data() +
+          static_cast<size_t>(num_bin_aligned) * 2 * (tid - 1));
+      for (int i = start; i < end; ++i) {
+        int_hist_data[i] += src_ptr[i];
+      }
+    }
+  }
+  global_timer.Stop("Dataset::sparse_bin_histogram_merge");
+  global_timer.Start("Dataset::sparse_bin_histogram_move");
+  if (share_state->is_use_subcol) {
+    DequantizeHistogram<PACKED_HIST_T, HIST_BITS>(temp_hist_data, num_bin,
+                                                  grad_scale, hess_scale);
+    share_state->HistMove(temp_hist_data, hist_data);
+  } else {
+    DequantizeHistogram<PACKED_HIST_T, HIST_BITS>(hist_data, num_bin,
+                                                  grad_scale, hess_scale);
+  }
+  global_timer.Stop("Dataset::sparse_bin_histogram_move");
+}
+
+template <bool USE_INDICES, typename PACKED_HIST_T, int HIST_BITS>
+void Dataset::ConstructIntHistogramsInner(
+    const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
+    data_size_t num_data, const int16_t* int_grad_hess,
+    int16_t* ordered_int_grad_hess, double grad_scale, double hess_scale,
+    TrainingShareStates* share_state, hist_t* hist_data) const {
+  if (!share_state->is_colwise) {
+    return ConstructIntHistogramsMultiVal<USE_INDICES, false, PACKED_HIST_T, HIST_BITS>(
+        data_indices, num_data, int_grad_hess, grad_scale, hess_scale,
+        share_state, hist_data);
+  }
+  std::vector<int> used_dense_group;
+  int multi_val_groud_id = -1;
+  GetUsedGroups(is_feature_used, &used_dense_group, &multi_val_groud_id);
+  int num_used_dense_group = static_cast<int>(used_dense_group.size());
+  global_timer.Start("Dataset::dense_bin_histogram");
+  auto ptr_ordered_int_grad_hess = int_grad_hess;
+  if (num_used_dense_group > 0) {
+    if (USE_INDICES) {
+#pragma omp parallel for schedule(static, 512) if (num_data >= 1024)
+      for (data_size_t i = 0; i < num_data; ++i) {
+        ordered_int_grad_hess[i] = int_grad_hess[data_indices[i]];
+      }
+      ptr_ordered_int_grad_hess = ordered_int_grad_hess;
+    }
+    // tiles of (group, row block) like ConstructHistogramsInner, the integer sums don't depend
+    // on the blocks
+    const int num_threads = share_state->num_threads;
+    int n_row_block = 1;
+    data_size_t row_block_size = num_data;
+    bool is_pass = false;
+    HistogramRowBlocks(num_data, num_used_dense_group, num_threads, &n_row_block,
+                       &row_block_size, &is_pass);
+    const int n_merged_block = is_pass ? 1 : n_row_block;
+    const int n_pass = is_pass ? n_row_block : 1;
+    std::vector<size_t> tile_hist_offset(num_used_dense_group + 1, 0);
+    for (int gi = 0; gi < num_used_dense_group; ++gi) {
+      tile_hist_offset[gi + 1] =
+          tile_hist_offset[gi] +
+          static_cast<size_t>(feature_groups_[used_dense_group[gi]]->num_total_bin_) * 2;
+    }
+    const size_t tile_hist_stride = tile_hist_offset[num_used_dense_group];
+    if (n_merged_block > 1) {
+      const size_t buf_size = tile_hist_stride * (n_merged_block - 1);
+      if (share_state->tile_hist_buf.size() < buf_size) {
+        share_state->tile_hist_buf.resize(buf_size);
+      }
+    }
+    // the integer histograms are built at the start of the space of the hist_t ones
+    auto tile_hist = [&](int gi, int merged_block) {
+      if (merged_block == 0) {
+        return reinterpret_cast<PACKED_HIST_T*>(
+            hist_data + group_bin_boundaries_[used_dense_group[gi]] * 2);
+      }
+      return reinterpret_cast<PACKED_HIST_T*>(
+          share_state->tile_hist_buf.data() +
+          tile_hist_stride * (merged_block - 1) + tile_hist_offset[gi]);
+    };
+    const int num_tiles = num_used_dense_group * n_merged_block;
+    for (int pass = 0; pass < n_pass; ++pass) {
+      OMP_INIT_EX();
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+      for (int tile = 0; tile < num_tiles; ++tile) {
+        OMP_LOOP_EX_BEGIN();
+        const int gi = tile / n_merged_block;
+        const int merged_block = tile % n_merged_block;
+        const int group = used_dense_group[gi];
+        const data_size_t start = (pass + merged_block) * row_block_size;
+        const data_size_t end = std::min(start + row_block_size, num_data);
+        PACKED_HIST_T* out = tile_hist(gi, merged_block);
+        const int num_bin = feature_groups_[group]->num_total_bin_;
+        if (pass == 0) {
+          std::memset(reinterpret_cast<void*>(out), 0,
+                      num_bin * sizeof(PACKED_HIST_T));
+        }
+        const auto bin_data = feature_groups_[group]->bin_data_.get();
+        if (HIST_BITS == 16) {
+          if (USE_INDICES) {
+            bin_data->ConstructHistogramInt32(data_indices, start, end,
+                                              ptr_ordered_int_grad_hess,
+                                              reinterpret_cast<int32_t*>(out));
+          } else {
+            bin_data->ConstructHistogramInt32(start, end,
+                                              ptr_ordered_int_grad_hess,
+                                              reinterpret_cast<int32_t*>(out));
+          }
+        } else {
+          if (USE_INDICES) {
+            bin_data->ConstructHistogramInt64(data_indices, start, end,
+                                              ptr_ordered_int_grad_hess,
+                                              reinterpret_cast<int64_t*>(out));
+          } else {
+            bin_data->ConstructHistogramInt64(start, end,
+                                              ptr_ordered_int_grad_hess,
+                                              reinterpret_cast<int64_t*>(out));
+          }
+        }
+        OMP_LOOP_EX_END();
+      }
+      OMP_THROW_EX();
+    }
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+    for (int gi = 0; gi < num_used_dense_group; ++gi) {
+      const int group = used_dense_group[gi];
+      const int num_bin = feature_groups_[group]->num_total_bin_;
+      PACKED_HIST_T* out = tile_hist(gi, 0);
+      // packed sums of the blocks are the packed sums of the rows, as the bins add them
+      for (int merged_block = 1; merged_block < n_merged_block; ++merged_block) {
+        const PACKED_HIST_T* src = tile_hist(gi, merged_block);
+        for (int i = 0; i < num_bin; ++i) {
+          out[i] += src[i];
+        }
+      }
+      DequantizeHistogram<PACKED_HIST_T, HIST_BITS>(
+          hist_data + group_bin_boundaries_[group] * 2, num_bin, grad_scale,
+          hess_scale);
+    }
+  }
+  global_timer.Stop("Dataset::dense_bin_histogram");
+  if (multi_val_groud_id >= 0) {
+    if (num_used_dense_group > 0) {
+      ConstructIntHistogramsMultiVal<USE_INDICES, true, PACKED_HIST_T, HIST_BITS>(
+          data_indices, num_data, ptr_ordered_int_grad_hess, grad_scale,
+          hess_scale, share_state,
+          hist_data + group_bin_boundaries_[multi_val_groud_id] * 2);
+    } else {
+      ConstructIntHistogramsMultiVal<USE_INDICES, false, PACKED_HIST_T, HIST_BITS>(
+          data_indices, num_data, int_grad_hess, grad_scale, hess_scale,
+          share_state,
+          hist_data + group_bin_boundaries_[multi_val_groud_id] * 2);
+    }
+  }
+}
+
+void Dataset::ConstructIntHistograms(
+    const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices,
+    data_size_t num_data, const int16_t* int_grad_hess,
+    int16_t* ordered_int_grad_hess, double grad_scale, double hess_scale,
+    int max_int_grad_hess, TrainingShareStates* share_state,
+    hist_t* hist_data) const {
+  if (num_data <= 0) {
+    return;
+  }
+  bool use_indices = data_indices != nullptr && (num_data < num_data_);
+  // an entry is at most the sum over all used data, 16 bits are enough when it is below 2^15
+  const bool use_16bits = static_cast<int64_t>(num_data) * max_int_grad_hess <
+                          (static_cast<int64_t>(1) << 15);
+  if (use_16bits) {
+    if (use_indices) {
+      ConstructIntHistogramsInner<true, int32_t, 16>(
+          is_feature_used, data_indices, num_data, int_grad_hess,
+          ordered_int_grad_hess, grad_scale, hess_scale, share_state, hist_data);
+    } else {
+      ConstructIntHistogramsInner<false, int32_t, 16>(
+          is_feature_used, data_indices, num_data, int_grad_hess,
+          ordered_int_grad_hess, grad_scale, hess_scale, share_state, hist_data);
+    }
+  } else {
+    if (use_indices) {
+      ConstructIntHistogramsInner<true, int64_t, 32>(
+          is_feature_used, data_indices, num_data, int_grad_hess,
+          ordered_int_grad_hess, grad_scale, hess_scale, share_state, hist_data);
+    } else {
+      ConstructIntHistogramsInner<false, int64_t, 32>(
+          is_feature_used, data_indices, num_data, int_grad_hess,
+          ordered_int_grad_hess, grad_scale, hess_scale, share_state, hist_data);
+    }
+  }
+}
 
 void Dataset::FixHistogram(int feature_idx, double sum_gradient,
                            double sum_hessian, hist_t* data) const {
@@ -1416,14 +2050,17 @@ void Dataset::FixHistogram(int feature_idx, double sum_gradient,
   const int most_freq_bin = bin_mapper->GetMostFreqBin();
   if (most_freq_bin > 0) {
     const int num_bin = bin_mapper->num_bin();
-    GET_GRAD(data, most_freq_bin) = sum_gradient;
-    GET_HESS(data, most_freq_bin) = sum_hessian;
+    // subtract in double, hist_t may be float
+    double most_freq_gradient = sum_gradient;
+    double most_freq_hessian = sum_hessian;
     for (int i = 0; i < num_bin; ++i) {
       if (i != most_freq_bin) {
-        GET_GRAD(data, most_freq_bin) -= GET_GRAD(data, i);
-        GET_HESS(data, most_freq_bin) -= GET_HESS(data, i);
+        most_freq_gradient -= GET_GRAD(data, i);
+        most_freq_hessian -= GET_HESS(data, i);
       }
     }
+    GET_GRAD(data, most_freq_bin) = static_cast<hist_t>(most_freq_gradient);
+    GET_HESS(data, most_freq_bin) = static_cast<hist_t>(most_freq_hessian);
   }
 }
 
@@ -9,8 +9,14 @@
 #include <LightGBM/utils/json11.h>
 #include <LightGBM/utils/log.h>
 #include <LightGBM/utils/openmp_wrapper.h>
+#include <LightGBM/utils/threading.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <limits>
+
+#include "arrow_file.hpp"
 
 namespace LightGBM {
 
@@ -31,10 +37,11 @@ void DatasetLoader::SetHeader(const char* filename) {
   std::unordered_map<std::string, int> name2idx;
   std::string name_prefix("name:");
   if (filename != nullptr) {
-    TextReader<data_size_t> text_reader(filename, config_.header);
-
     // get column names
-    if (config_.header) {
+    if (ArrowFile::IsArrowFile(filename)) {
+      feature_names_ = ArrowFile(filename).column_names();
+    } else if (config_.header) {
+      TextReader<data_size_t> text_reader(filename, config_.header);
       std::string first_line = text_reader.first_line();
       feature_names_ = Common::Split(first_line.c_str(), "\t,");
     }
@@ -67,6 +74,10 @@ void DatasetLoader::SetHeader(const char* filename) {
     }
 
     if (!feature_names_.empty()) {
+      if (label_idx_ >= static_cast<int>(feature_names_.size())) {
+        Log::Fatal("Label column %d is out of the range of the %d columns of data file",
+                   label_idx_, static_cast<int>(feature_names_.size()));
+      }
       // erase label column name
       feature_names_.erase(feature_names_.begin() + label_idx_);
       for (size_t i = 0; i < feature_names_.size(); ++i) {
@@ -176,7 +187,9 @@ Dataset* DatasetLoader::LoadFromFile(const char* filename, int rank, int num_mac
   data_size_t num_global_data = 0;
   std::vector<data_size_t> used_data_indices;
   auto bin_filename = CheckCanLoadFromBin(filename);
-  if (bin_filename.size() == 0) {
+  if (bin_filename.size() == 0 && ArrowFile::IsArrowFile(filename)) {
+    dataset.reset(LoadFromArrowFile(filename, nullptr, rank, num_machines, &num_global_data, &used_data_indices));
+  } else if (bin_filename.size() == 0) {
     auto parser = std::unique_ptr<Parser>(Parser::CreateParser(filename, config_.header, 0, label_idx_));
     if (parser == nullptr) {
       Log::Fatal("Could not recognize data format of %s", filename);
@@ -184,14 +197,40 @@ Dataset* DatasetLoader::LoadFromFile(const char* filename, int rank, int num_mac
     dataset->data_filename_ = filename;
     dataset->label_idx_ = label_idx_;
     dataset->metadata_.Init(filename);
-    if (!config_.two_round) {
+    bool stream_loading = config_.stream_loading;
+    if (stream_loading && num_machines > 1 && !config_.pre_partition) {
+      Log::Warning("stream_loading is only supported with pre_partition in parallel learning, will not use it");
+      stream_loading = false;
+    }
+    if (stream_loading && config_.use_quantile_sketch) {
+      Log::Warning("use_quantile_sketch is not supported with stream_loading, will construct the feature bins from the first chunk");
+    }
+    if (stream_loading) {
+      ExtractFeaturesFromStream(filename, parser.get(),
+                                [this, rank, num_machines, &parser, &dataset] (const std::vector<std::string>& first_chunk) {
+        dataset->num_data_ = static_cast<data_size_t>(first_chunk.size());
+        // sample data from the first chunk
+        auto sample_data = SampleTextDataFromMemory(first_chunk);
+        // construct feature bin mappers
+        ConstructBinMappersFromTextData(rank, num_machines, sample_data, parser.get(), nullptr, dataset.get());
+        // initialize label
+        dataset->metadata_.Init(dataset->num_data_, weight_idx_, group_idx_);
+      }, dataset.get());
+      num_global_data = dataset->num_data_;
+    } else if (!config_.two_round) {
       // read data to memory
       auto text_data = LoadTextDataToMemory(filename, dataset->metadata_, rank, num_machines, &num_global_data, &used_data_indices);
       dataset->num_data_ = static_cast<data_size_t>(text_data.size());
       // sample data
       auto sample_data = SampleTextDataFromMemory(text_data);
+      // summarize all data
+      std::vector<QuantileSketch> sketches;
+      if (config_.use_quantile_sketch) {
+        sketches = SketchTextDataFromMemory(text_data, parser.get());
+      }
       // construct feature bin mappers
-      ConstructBinMappersFromTextData(rank, num_machines, sample_data, parser.get(), dataset.get());
+      ConstructBinMappersFromTextData(rank, num_machines, sample_data, parser.get(),
+                                      config_.use_quantile_sketch ? &sketches : nullptr, dataset.get());
       // initialize label
       dataset->metadata_.Init(dataset->num_data_, weight_idx_, group_idx_);
       // extract features
@@ -205,8 +244,14 @@ Dataset* DatasetLoader::LoadFromFile(const char* filename, int rank, int num_mac
       } else {
         dataset->num_data_ = num_global_data;
       }
+      // summarize all data
+      std::vector<QuantileSketch> sketches;
+      if (config_.use_quantile_sketch) {
+        sketches = SketchTextDataFromFile(filename, parser.get(), used_data_indices);
+      }
       // construct feature bin mappers
-      ConstructBinMappersFromTextData(rank, num_machines, sample_data, parser.get(), dataset.get());
+      ConstructBinMappersFromTextData(rank, num_machines, sample_data, parser.get(),
+                                      config_.use_quantile_sketch ? &sketches : nullptr, dataset.get());
       // initialize label
       dataset->metadata_.Init(dataset->num_data_, weight_idx_, group_idx_);
       Log::Debug("Making second pass...");
@@ -231,7 +276,9 @@ Dataset* DatasetLoader::LoadFromFileAlignWithOtherDataset(const char* filename,
   std::vector<data_size_t> used_data_indices;
   auto dataset = std::unique_ptr<Dataset>(new Dataset());
   auto bin_filename = CheckCanLoadFromBin(filename);
-  if (bin_filename.size() == 0) {
+  if (bin_filename.size() == 0 && ArrowFile::IsArrowFile(filename)) {
+    dataset.reset(LoadFromArrowFile(filename, train_data, 0, 1, &num_global_data, &used_data_indices));
+  } else if (bin_filename.size() == 0) {
     auto parser = std::unique_ptr<Parser>(Parser::CreateParser(filename, config_.header, 0, label_idx_));
     if (parser == nullptr) {
       Log::Fatal("Could not recognize data format of %s", filename);
@@ -239,7 +286,16 @@ Dataset* DatasetLoader::LoadFromFileAlignWithOtherDataset(const char* filename,
     dataset->data_filename_ = filename;
     dataset->label_idx_ = label_idx_;
     dataset->metadata_.Init(filename);
-    if (!config_.two_round) {
+    if (config_.stream_loading) {
+      ExtractFeaturesFromStream(filename, parser.get(),
+                                [this, train_data, &dataset] (const std::vector<std::string>& first_chunk) {
+        dataset->num_data_ = static_cast<data_size_t>(first_chunk.size());
+        // initialize label
+        dataset->metadata_.Init(dataset->num_data_, weight_idx_, group_idx_);
+        dataset->CreateValid(train_data);
+      }, dataset.get());
+      num_global_data = dataset->num_data_;
+    } else if (!config_.two_round) {
       // read data in memory
       auto text_data = LoadTextDataToMemory(filename, dataset->metadata_, 0, 1, &num_global_data, &used_data_indices);
       dataset->num_data_ = static_cast<data_size_t>(text_data.size());
@@ -270,6 +326,240 @@ Dataset* DatasetLoader::LoadFromFileAlignWithOtherDataset(const char* filename,
   return dataset.release();
 }
 
+Dataset* DatasetLoader::LoadFromArrowFile(const char* filename, const Dataset* train_data, int rank, int num_machines,
+                                          int* num_global_data, std::vector<data_size_t>* used_data_indices) {
+  auto dataset = std::unique_ptr<Dataset>(new Dataset());
+  ArrowFile file(filename);
+  const int num_columns = file.num_columns();
+  if (label_idx_ >= num_columns) {
+    Log::Fatal("Label column %d is out of the range of the %d columns of data file %s", label_idx_, num_columns, filename);
+  }
+  if (file.num_rows() > std::numeric_limits<data_size_t>::max()) {
+    Log::Fatal("Data file %s has too many rows", filename);
+  }
+  const int num_features = num_columns - 1;
+  // features don't count the label column
+  auto column_of = [this] (int feature) { return feature >= label_idx_ ? feature + 1 : feature; };
+  if (weight_idx_ >= num_features) {
+    Log::Fatal("Weight column %d is out of the range of the %d non-label columns of data file %s", weight_idx_, num_features, filename);
+  }
+  if (group_idx_ >= num_features) {
+    Log::Fatal("Query column %d is out of the range of the %d non-label columns of data file %s", group_idx_, num_features, filename);
+  }
+  if (train_data != nullptr) {
+    for (int i = 0; i < train_data->num_features(); ++i) {
+      const int real_feature = train_data->RealFeatureIndex(i);
+      if (real_feature >= num_features) {
+        Log::Fatal("Feature %d of training data is out of the range of the %d non-label columns of data file %s",
+                   real_feature, num_features, filename);
+      }
+    }
+  }
+  file.CheckSupported(label_idx_);
+  for (int i = 0; i < num_features; ++i) {
+    if (ignore_features_.count(i) == 0 || i == weight_idx_ || i == group_idx_) {
+      file.CheckSupported(column_of(i));
+    }
+  }
+  dataset->data_filename_ = filename;
+  dataset->label_idx_ = label_idx_;
+  dataset->metadata_.Init(filename);
+  *num_global_data = static_cast<data_size_t>(file.num_rows());
+  used_data_indices->clear();
+  const bool need_partition = train_data == nullptr && num_machines > 1 && !config_.pre_partition;
+  if (need_partition) {
+    const data_size_t* query_boundaries = dataset->metadata_.query_boundaries();
+    const data_size_t num_queries = dataset->metadata_.num_queries();
+    data_size_t qid = -1;
+    bool is_used = false;
+    for (data_size_t i = 0; i < *num_global_data; ++i) {
+      if (query_boundaries == nullptr) {
+        // if not contain query data, minimal sample unit is one record
+        is_used = random_.NextShort(0, num_machines) == rank;
+      } else if (i >= query_boundaries[qid + 1]) {
+        // if contain query data, minimal sample unit is one query
+        if (qid + 1 >= num_queries) {
+          Log::Fatal("Current query exceeds the range of the query file,\n"
+                     "please ensure the query file is correct");
+        }
+        is_used = random_.NextShort(0, num_machines) == rank;
+        ++qid;
+      }
+      if (is_used) {
+        used_data_indices->push_back(i);
+      }
+    }
+    dataset->num_data_ = static_cast<data_size_t>(used_data_indices->size());
+  } else {
+    dataset->num_data_ = *num_global_data;
+  }
+  const data_size_t num_data = dataset->num_data_;
+  const std::vector<data_size_t>& used_indices = *used_data_indices;
+  auto global_row = [need_partition, &used_indices] (data_size_t i) {
+    return need_partition ? used_indices[i] : i;
+  };
+
+  if (train_data == nullptr) {
+    // sample data
+    const int sample_cnt = std::min(config_.bin_construct_sample_cnt, num_data);
+    auto sample_rows = random_.Sample(num_data, sample_cnt);
+    std::vector<int> sample_batches(sample_rows.size());
+    std::vector<int64_t> sample_batch_rows(sample_rows.size());
+    for (size_t i = 0; i < sample_rows.size(); ++i) {
+      const int64_t row = global_row(sample_rows[i]);
+      sample_batches[i] = file.BatchOf(row);
+      sample_batch_rows[i] = row - file.batch_start(sample_batches[i]);
+    }
+    std::vector<std::vector<double>> sample_values(num_features);
+    std::vector<std::vector<int>> sample_indices(num_features);
+    OMP_INIT_EX();
+    #pragma omp parallel for schedule(guided)
+    for (int i = 0; i < num_features; ++i) {
+      OMP_LOOP_EX_BEGIN();
+      const int col = column_of(i);
+      if (ignore_features_.count(i) > 0 || !file.IsSupported(col)) {
+        continue;
+      }
+      for (int j = 0; j < static_cast<int>(sample_rows.size()); ++j) {
+        const double value = file.Value(sample_batches[j], col, sample_batch_rows[j]);
+        if (std::fabs(value) > kZeroThreshold || std::isnan(value)) {
+          sample_values[i].emplace_back(value);
+          sample_indices[i].emplace_back(j);
+        }
+      }
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
+    // summarize all data
+    std::vector<QuantileSketch> sketches;
+    if (config_.use_quantile_sketch) {
+      sketches.resize(num_features, QuantileSketch(config_.quantile_sketch_size));
+      std::vector<double> values;
+      OMP_INIT_EX();
+      #pragma omp parallel for schedule(dynamic) private(values)
+      for (int i = 0; i < num_features; ++i) {
+        OMP_LOOP_EX_BEGIN();
+        const int col = column_of(i);
+        if (ignore_features_.count(i) > 0 || !file.IsSupported(col)) {
+          continue;
+        }
+        data_size_t row = 0;
+        for (int batch = 0; batch < file.num_batches() && row < num_data; ++batch) {
+          const int64_t batch_start = file.batch_start(batch);
+          const int64_t batch_end = batch_start + file.batch_num_rows(batch);
+          values.resize(file.batch_num_rows(batch));
+          file.ReadColumn(batch, col, values.data());
+          for (; row < num_data && global_row(row) < batch_end; ++row) {
+            sketches[i].Push(values[global_row(row) - batch_start]);
+          }
+        }
+        OMP_LOOP_EX_END();
+      }
+      OMP_THROW_EX();
+    }
+    // construct feature bin mappers
+    ConstructBinMappersFromSampleValues(rank, num_machines, num_features, &sample_values, &sample_indices,
+                                        sample_rows.size(), config_.use_quantile_sketch ? &sketches : nullptr,
+                                        dataset.get());
+    // initialize label
+    dataset->metadata_.Init(num_data, weight_idx_, group_idx_);
+  } else {
+    // initialize label
+    dataset->metadata_.Init(num_data, weight_idx_, group_idx_);
+    dataset->CreateValid(train_data);
+  }
+
+  // extract features, batch by batch
+  std::vector<double> init_score;
+  if (predict_fun_ != nullptr) {
+    init_score.resize(static_cast<size_t>(num_data) * num_class_);
+  }
+  std::vector<double> values;
+  data_size_t start = 0;
+  for (int batch = 0; batch < file.num_batches() && start < num_data; ++batch) {
+    const int64_t batch_start = file.batch_start(batch);
+    const int64_t batch_end = batch_start + file.batch_num_rows(batch);
+    data_size_t end = start;
+    while (end < num_data && global_row(end) < batch_end) {
+      ++end;
+    }
+    if (end == start) {
+      continue;
+    }
+    // set label, weight and query
+    values.resize(file.batch_num_rows(batch));
+    file.ReadColumn(batch, label_idx_, values.data());
+    for (data_size_t i = start; i < end; ++i) {
+      dataset->metadata_.SetLabelAt(i, static_cast<label_t>(values[global_row(i) - batch_start]));
+    }
+    if (weight_idx_ >= 0) {
+      file.ReadColumn(batch, column_of(weight_idx_), values.data());
+      for (data_size_t i = start; i < end; ++i) {
+        dataset->metadata_.SetWeightAt(i, static_cast<label_t>(values[global_row(i) - batch_start]));
+      }
+    }
+    if (group_idx_ >= 0) {
+      file.ReadColumn(batch, column_of(group_idx_), values.data());
+      for (data_size_t i = start; i < end; ++i) {
+        dataset->metadata_.SetQueryAt(i, static_cast<data_size_t>(values[global_row(i) - batch_start]));
+      }
+    }
+    // push data, features of one group are pushed by the same thread as they may share one bin
+    std::vector<double> group_values;
+    OMP_INIT_EX();
+    #pragma omp parallel for schedule(dynamic) private(group_values)
+    for (int group = 0; group < dataset->num_groups_; ++group) {
+      OMP_LOOP_EX_BEGIN();
+      const int tid = omp_get_thread_num();
+      group_values.resize(file.batch_num_rows(batch));
+      for (int sub_feature = 0; sub_feature < dataset->group_feature_cnt_[group]; ++sub_feature) {
+        const int feature_idx = dataset->group_feature_start_[group] + sub_feature;
+        file.ReadColumn(batch, column_of(dataset->real_feature_idx_[feature_idx]), group_values.data());
+        for (data_size_t i = start; i < end; ++i) {
+          dataset->feature_groups_[group]->PushData(tid, sub_feature, i, group_values[global_row(i) - batch_start]);
+        }
+      }
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
+    // set initial score
+    if (predict_fun_ != nullptr) {
+      std::vector<std::pair<int, double>> oneline_features;
+      std::vector<double> oneline_init_score(num_class_);
+      OMP_INIT_EX();
+      #pragma omp parallel for schedule(static) private(oneline_features) firstprivate(oneline_init_score)
+      for (data_size_t i = start; i < end; ++i) {
+        OMP_LOOP_EX_BEGIN();
+        oneline_features.clear();
+        for (int j = 0; j < num_features; ++j) {
+          const int col = column_of(j);
+          if (!file.IsSupported(col)) {
+            continue;
+          }
+          const double value = file.Value(batch, col, global_row(i) - batch_start);
+          if (std::fabs(value) > kZeroThreshold || std::isnan(value)) {
+            oneline_features.emplace_back(j, value);
+          }
+        }
+        predict_fun_(oneline_features, oneline_init_score.data());
+        for (int k = 0; k < num_class_; ++k) {
+          init_score[static_cast<size_t>(k) * num_data + i] = oneline_init_score[k];
+        }
+        OMP_LOOP_EX_END();
+      }
+      OMP_THROW_EX();
+    }
+    start = end;
+  }
+  // metadata_ will manage space of init_score
+  if (!init_score.empty()) {
+    dataset->metadata_.SetInitScore(init_score.data(), static_cast<data_size_t>(init_score.size()));
+  }
+  dataset->FinishLoad();
+  Log::Info("Loaded %d rows of Arrow file %s", num_data, filename);
+  return dataset.release();
+}
+
 Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* bin_filename,
                                         int rank, int num_machines, int* num_global_data,
                                         std::vector<data_size_t>* used_data_indices) {
@@ -432,6 +722,16 @@ Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* b
     }
     mem_ptr += num_bounds * sizeof(double);
   }
+  // files of version 0 don't have the version
+  uint32_t version = 0;
+  if (mem_ptr + sizeof(version) <= buffer.data() + size_of_head) {
+    version = *(reinterpret_cast<const uint32_t*>(mem_ptr));
+    mem_ptr += sizeof(version);
+  }
+  if (version > Dataset::binary_file_version) {
+    Log::Fatal("Binary file %s has version %u, this version of LightGBM reads up to version %u",
+               bin_filename, version, Dataset::binary_file_version);
+  }
 
   // read size of meta data
   read_cnt = reader->Read(buffer.data(), sizeof(size_t));
@@ -494,29 +794,66 @@ Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* b
     dataset->num_data_ = static_cast<data_size_t>((*used_data_indices).size());
   }
   dataset->metadata_.PartitionLabel(*used_data_indices);
+  // bin data are aligned from version 1, they can be read in place from a memory mapping of the file
+  const bool is_aligned = version >= 1;
+  if (is_aligned && config_.mmap_binary_file && used_data_indices->empty()) {
+    auto mapped_file = MappedFile::Make(bin_filename);
+    if (mapped_file != nullptr && mapped_file->is_mapped()) {
+      dataset->mapped_file_ = std::move(mapped_file);
+    }
+  }
+  const MappedFile* mapped_file = dataset->mapped_file_.get();
+  size_t offset = size_of_token + sizeof(size_t) + size_of_head + sizeof(size_t) + size_of_metadata;
   // read feature data
   for (int i = 0; i < dataset->num_groups_; ++i) {
-    // read feature size
-    read_cnt = reader->Read(buffer.data(), sizeof(size_t));
-    if (read_cnt != sizeof(size_t)) {
-      Log::Fatal("Binary file error: feature %d has the wrong size", i);
-    }
-    size_t size_of_feature = *(reinterpret_cast<size_t*>(buffer.data()));
-    // re-allocate space if not enough
-    if (size_of_feature > buffer_size) {
-      buffer_size = size_of_feature;
-      buffer.resize(buffer_size);
+    if (is_aligned) {
+      const size_t padding = Dataset::BinaryFeaturePadding(offset);
+      if (mapped_file == nullptr && reader->Read(buffer.data(), padding) != padding) {
+        Log::Fatal("Binary file error: feature %d has the wrong size", i);
+      }
+      offset += padding;
     }
+    size_t size_of_feature = 0;
+    const char* feature_memory = nullptr;
+    if (mapped_file != nullptr) {
+      if (offset + sizeof(size_t) > mapped_file->size()) {
+        Log::Fatal("Binary file error: feature %d has the wrong size", i);
+      }
+      std::memcpy(&size_of_feature, mapped_file->data() + offset, sizeof(size_t));
+      if (size_of_feature > mapped_file->size() - offset - sizeof(size_t)) {
+        Log::Fatal("Binary file error: feature %d is incorrect, file is truncated", i);
+      }
+      feature_memory = mapped_file->data() + offset + sizeof(size_t);
+    } else {
+      // read feature size
+      read_cnt = reader->Read(buffer.data(), sizeof(size_t));
+      if (read_cnt != sizeof(size_t)) {
+        Log::Fatal("Binary file error: feature %d has the wrong size", i);
+      }
+      size_of_feature = *(reinterpret_cast<size_t*>(buffer.data()));
+      // re-allocate space if not enough
+      if (size_of_feature > buffer_size) {
+        buffer_size = size_of_feature;
+        buffer.resize(buffer_size);
+      }
 
-    read_cnt = reader->Read(buffer.data(), size_of_feature);
+      read_cnt = reader->Read(buffer.data(), size_of_feature);
 
-    if (read_cnt != size_of_feature) {
-      Log::Fatal("Binary file error: feature %d is incorrect, read count: %d", i, read_cnt);
+      if (read_cnt != size_of_feature) {
+        Log::Fatal("Binary file error: feature %d is incorrect, read count: %d", i, read_cnt);
+      }
+      feature_memory = buffer.data();
     }
+    offset += sizeof(size_t) + size_of_feature;
     dataset->feature_groups_.emplace_back(std::unique_ptr<FeatureGroup>(
-      new FeatureGroup(buffer.data(),
+      new FeatureGroup(feature_memory,
                        *num_global_data,
-                       *used_data_indices)));
+                       *used_data_indices,
+                       is_aligned,
+                       mapped_file != nullptr)));
+  }
+  if (mapped_file != nullptr) {
+    Log::Debug("Feature data of binary file %s are read in place", bin_filename);
   }
   dataset->feature_groups_.shrink_to_fit();
   dataset->is_finish_load_ = true;
@@ -820,9 +1157,78 @@ std::vector<std::string> DatasetLoader::SampleTextDataFromFile(const char* filen
   return out_data;
 }
 
+std::vector<QuantileSketch> DatasetLoader::SketchTextDataFromMemory(const std::vector<std::string>& data,
+                                                                    const Parser* parser) {
+  std::vector<QuantileSketch> sketches;
+  // bound the memory of parsed values
+  const data_size_t chunk_size = std::max(1024, (1 << 22) / std::max(1, parser->NumFeatures()));
+  const data_size_t num_data = static_cast<data_size_t>(data.size());
+  for (data_size_t start = 0; start < num_data; start += chunk_size) {
+    PushTextDataToSketches(data.data() + start, std::min(chunk_size, num_data - start), parser, &sketches);
+  }
+  return sketches;
+}
+
+std::vector<QuantileSketch> DatasetLoader::SketchTextDataFromFile(const char* filename, const Parser* parser,
+                                                                  const std::vector<data_size_t>& used_data_indices) {
+  std::vector<QuantileSketch> sketches;
+  auto process_fun = [this, parser, &sketches] (data_size_t, const std::vector<std::string>& lines) {
+    PushTextDataToSketches(lines.data(), static_cast<data_size_t>(lines.size()), parser, &sketches);
+  };
+  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes);
+  if (!used_data_indices.empty()) {
+    text_reader.ReadPartAndProcessParallel(used_data_indices, process_fun);
+  } else {
+    text_reader.ReadAllAndProcessParallel(process_fun);
+  }
+  return sketches;
+}
+
+void DatasetLoader::PushTextDataToSketches(const std::string* lines, data_size_t num_lines, const Parser* parser,
+                                           std::vector<QuantileSketch>* sketches) {
+  // parse blocks of lines in parallel, values of each feature are then pushed in the order of lines,
+  // so the sketches don't depend on the number of threads
+  std::vector<std::vector<std::vector<double>>> block_values(OMP_NUM_THREADS());
+  const int num_blocks = Threading::For<data_size_t>(0, num_lines, 1024,
+                                                     [this, lines, parser, &block_values] (int block, data_size_t start, data_size_t end) {
+    std::vector<std::pair<int, double>> oneline_features;
+    double label;
+    auto& values = block_values[block];
+    for (data_size_t i = start; i < end; ++i) {
+      oneline_features.clear();
+      parser->ParseOneLine(lines[i].c_str(), &oneline_features, &label);
+      for (const auto& inner_data : oneline_features) {
+        if (ignore_features_.count(inner_data.first) > 0) {
+          continue;
+        }
+        if (static_cast<size_t>(inner_data.first) >= values.size()) {
+          values.resize(inner_data.first + 1);
+        }
+        values[inner_data.first].push_back(inner_data.second);
+      }
+    }
+  });
+  size_t num_features = sketches->size();
+  for (int block = 0; block < num_blocks; ++block) {
+    num_features = std::max(num_features, block_values[block].size());
+  }
+  sketches->resize(num_features, QuantileSketch(config_.quantile_sketch_size));
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(num_features); ++i) {
+    for (int block = 0; block < num_blocks; ++block) {
+      if (static_cast<size_t>(i) < block_values[block].size()) {
+        for (double value : block_values[block][i]) {
+          (*sketches)[i].Push(value);
+        }
+      }
+    }
+  }
+}
+
 void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
                                                     const std::vector<std::string>& sample_data,
-                                                    const Parser* parser, Dataset* dataset) {
+                                                    const Parser* parser, std::vector<QuantileSketch>* sketches,
+                                                    Dataset* dataset) {
   std::vector<std::vector<double>> sample_values;
   std::vector<std::vector<int>> sample_indices;
   std::vector<std::pair<int, double>> oneline_features;
@@ -842,12 +1248,38 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
       }
     }
   }
+  ConstructBinMappersFromSampleValues(rank, num_machines, parser->NumFeatures(), &sample_values, &sample_indices,
+                                      sample_data.size(), sketches, dataset);
+}
 
+void DatasetLoader::ConstructBinMappersFromSampleValues(int rank, int num_machines, int num_features,
+                                                        std::vector<std::vector<double>>* sample_values_ptr,
+                                                        std::vector<std::vector<int>>* sample_indices_ptr,
+                                                        size_t total_sample_cnt, std::vector<QuantileSketch>* sketches,
+                                                        Dataset* dataset) {
+  auto& sample_values = *sample_values_ptr;
+  auto& sample_indices = *sample_indices_ptr;
   dataset->feature_groups_.clear();
-  dataset->num_total_features_ = std::max(static_cast<int>(sample_values.size()), parser->NumFeatures());
+  if (sketches != nullptr && sketches->size() > sample_values.size()) {
+    // features may be only out of the sample
+    sample_values.resize(sketches->size());
+    sample_indices.resize(sketches->size());
+  }
+  dataset->num_total_features_ = std::max(static_cast<int>(sample_values.size()), num_features);
   if (num_machines > 1) {
     dataset->num_total_features_ = Network::GlobalSyncUpByMax(dataset->num_total_features_);
   }
+  size_t total_sketch_cnt = 0;
+  if (sketches != nullptr) {
+    sketches->resize(dataset->num_total_features_, QuantileSketch(config_.quantile_sketch_size));
+    for (auto& sketch : *sketches) {
+      sketch.Compact();
+    }
+    total_sketch_cnt = static_cast<size_t>(dataset->num_data_);
+    if (num_machines > 1) {
+      total_sketch_cnt = Network::GlobalSyncUpBySum(total_sketch_cnt);
+    }
+  }
   if (!feature_names_.empty()) {
     CHECK_EQ(dataset->num_total_features_, static_cast<int>(feature_names_.size()));
   }
@@ -879,7 +1311,9 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
   dataset->set_feature_names(feature_names_);
   std::vector<std::unique_ptr<BinMapper>> bin_mappers(dataset->num_total_features_);
   const data_size_t filter_cnt = static_cast<data_size_t>(
-    static_cast<double>(config_.min_data_in_leaf* sample_data.size()) / dataset->num_data_);
+    static_cast<double>(config_.min_data_in_leaf* total_sample_cnt) / dataset->num_data_);
+  // the counts of sketches are of all data
+  const data_size_t sketch_filter_cnt = config_.min_data_in_leaf;
   // start find bins
   if (num_machines == 1) {
     // if only one machine, find bin locally
@@ -896,14 +1330,20 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
         bin_type = BinType::CategoricalBin;
       }
       bin_mappers[i].reset(new BinMapper());
-      if (config_.max_bin_by_feature.empty()) {
+      // a pruned sketch would merge categories, so categorical features use the sample
+      if (sketches != nullptr && bin_type != BinType::CategoricalBin) {
+        bin_mappers[i]->FindBinFromSketch((*sketches)[i], total_sketch_cnt,
+                                          config_.max_bin_by_feature.empty() ? config_.max_bin : config_.max_bin_by_feature[i],
+                                          config_.min_data_in_bin, sketch_filter_cnt, config_.feature_pre_filter, bin_type,
+                                          config_.use_missing, config_.zero_as_missing, forced_bin_bounds[i]);
+      } else if (config_.max_bin_by_feature.empty()) {
         bin_mappers[i]->FindBin(sample_values[i].data(), static_cast<int>(sample_values[i].size()),
-                                sample_data.size(), config_.max_bin, config_.min_data_in_bin,
+                                total_sample_cnt, config_.max_bin, config_.min_data_in_bin,
                                 filter_cnt, config_.feature_pre_filter, bin_type, config_.use_missing, config_.zero_as_missing,
                                 forced_bin_bounds[i]);
       } else {
         bin_mappers[i]->FindBin(sample_values[i].data(), static_cast<int>(sample_values[i].size()),
-                                sample_data.size(), config_.max_bin_by_feature[i],
+                                total_sample_cnt, config_.max_bin_by_feature[i],
                                 config_.min_data_in_bin, filter_cnt, config_.feature_pre_filter, bin_type, config_.use_missing,
                                 config_.zero_as_missing, forced_bin_bounds[i]);
       }
@@ -924,6 +1364,34 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
       start[i + 1] = start[i] + len[i];
     }
     len[num_machines - 1] = dataset->num_total_features_ - start[num_machines - 1];
+    std::vector<QuantileSketch> global_sketches;
+    if (sketches != nullptr) {
+      // merge the sketches of the features of this machine from all machines
+      const comm_size_t type_size = QuantileSketch::SizesInByte(config_.quantile_sketch_size);
+      if (static_cast<int64_t>(type_size) * dataset->num_total_features_ > std::numeric_limits<comm_size_t>::max()) {
+        Log::Fatal("Quantile sketches of %d features are too large to be merged, please use a smaller quantile_sketch_size",
+                   dataset->num_total_features_);
+      }
+      std::vector<char> input_buffer(static_cast<size_t>(type_size) * dataset->num_total_features_);
+      for (int i = 0; i < dataset->num_total_features_; ++i) {
+        (*sketches)[i].CopyTo(input_buffer.data() + static_cast<size_t>(type_size) * i);
+      }
+      std::vector<comm_size_t> block_start(num_machines);
+      std::vector<comm_size_t> block_len(num_machines);
+      for (int i = 0; i < num_machines; ++i) {
+        block_start[i] = start[i] * type_size;
+        block_len[i] = len[i] * type_size;
+      }
+      // the output is also used as receive buffer by the reduce scatter
+      std::vector<char> output_buffer(input_buffer.size());
+      Network::ReduceScatter(input_buffer.data(), static_cast<comm_size_t>(input_buffer.size()), type_size,
+                             block_start.data(), block_len.data(), output_buffer.data(),
+                             static_cast<comm_size_t>(output_buffer.size()), &QuantileSketch::MergeReducer);
+      global_sketches.resize(len[rank], QuantileSketch(config_.quantile_sketch_size));
+      for (int i = 0; i < len[rank]; ++i) {
+        global_sketches[i].CopyFrom(output_buffer.data() + static_cast<size_t>(type_size) * i);
+      }
+    }
     OMP_INIT_EX();
     #pragma omp parallel for schedule(guided)
     for (int i = 0; i < len[rank]; ++i) {
@@ -936,19 +1404,27 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
         bin_type = BinType::CategoricalBin;
       }
       bin_mappers[i].reset(new BinMapper());
+      if (sketches != nullptr && bin_type != BinType::CategoricalBin) {
+        const int feature_idx = start[rank] + i;
+        bin_mappers[i]->FindBinFromSketch(global_sketches[i], total_sketch_cnt,
+                                          config_.max_bin_by_feature.empty() ? config_.max_bin : config_.max_bin_by_feature[feature_idx],
+                                          config_.min_data_in_bin, sketch_filter_cnt, config_.feature_pre_filter, bin_type,
+                                          config_.use_missing, config_.zero_as_missing, forced_bin_bounds[feature_idx]);
+        continue;
+      }
       if (static_cast<int>(sample_values.size()) <= start[rank] + i) {
         continue;
       }
       if (config_.max_bin_by_feature.empty()) {
         bin_mappers[i]->FindBin(sample_values[start[rank] + i].data(),
                                 static_cast<int>(sample_values[start[rank] + i].size()),
-                                sample_data.size(), config_.max_bin, config_.min_data_in_bin,
+                                total_sample_cnt, config_.max_bin, config_.min_data_in_bin,
                                 filter_cnt, config_.feature_pre_filter, bin_type, config_.use_missing, config_.zero_as_missing,
                                 forced_bin_bounds[i]);
       } else {
         bin_mappers[i]->FindBin(sample_values[start[rank] + i].data(),
                                 static_cast<int>(sample_values[start[rank] + i].size()),
-                                sample_data.size(), config_.max_bin_by_feature[i],
+                                total_sample_cnt, config_.max_bin_by_feature[i],
                                 config_.min_data_in_bin, filter_cnt, config_.feature_pre_filter, bin_type,
                                 config_.use_missing, config_.zero_as_missing, forced_bin_bounds[i]);
       }
@@ -996,7 +1472,7 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
   }
   dataset->Construct(&bin_mappers, dataset->num_total_features_, forced_bin_bounds, Common::Vector2Ptr<int>(&sample_indices).data(),
                      Common::Vector2Ptr<double>(&sample_values).data(),
-                     Common::VectorSize<int>(sample_indices).data(), static_cast<int>(sample_indices.size()), sample_data.size(), config_);
+                     Common::VectorSize<int>(sample_indices).data(), static_cast<int>(sample_indices.size()), total_sample_cnt, config_);
 }
 
 /*! \brief Extract local features from memory */
@@ -1063,7 +1539,7 @@ void DatasetLoader::ExtractFeaturesFromMemory(std::vector<std::string>* text_dat
       // set label
       dataset->metadata_.SetLabelAt(i, static_cast<label_t>(tmp_label));
       // free processed line:
-      text_data[i].clear();
+      ref_text_data[i].clear();
       // shrink_to_fit will be very slow in linux, and seems not free memory, disable for now
       // text_reader_->Lines()[i].shrink_to_fit();
       // push data
@@ -1167,6 +1643,115 @@ void DatasetLoader::ExtractFeaturesFromFile(const char* filename, const Parser*
   dataset->FinishLoad();
 }
 
+void DatasetLoader::ExtractFeaturesFromStream(const char* filename, const Parser* parser,
+                                              const std::function<void(const std::vector<std::string>&)>& construct_fun,
+                                              Dataset* dataset) {
+  // init scores are stored by rows while loading, as the number of data is unknown
+  std::vector<double> init_score;
+  std::function<void(data_size_t, const std::vector<std::string>&)> process_fun =
+    [this, &init_score, &parser, &dataset]
+  (data_size_t start_idx, const std::vector<std::string>& lines) {
+    std::vector<std::pair<int, double>> oneline_features;
+    double tmp_label = 0.0f;
+    OMP_INIT_EX();
+    #pragma omp parallel for schedule(static) private(oneline_features) firstprivate(tmp_label)
+    for (data_size_t i = 0; i < static_cast<data_size_t>(lines.size()); ++i) {
+      OMP_LOOP_EX_BEGIN();
+      const int tid = omp_get_thread_num();
+      const data_size_t row_idx = start_idx + i;
+      oneline_features.clear();
+      // parser
+      parser->ParseOneLine(lines[i].c_str(), &oneline_features, &tmp_label);
+      // set initial score
+      if (!init_score.empty()) {
+        predict_fun_(oneline_features, init_score.data() + static_cast<size_t>(row_idx) * num_class_);
+      }
+      // set label
+      dataset->metadata_.SetLabelAt(row_idx, static_cast<label_t>(tmp_label));
+      std::vector<bool> is_feature_added(dataset->num_features_, false);
+      // push data
+      for (auto& inner_data : oneline_features) {
+        if (inner_data.first >= dataset->num_total_features_) { continue; }
+        int feature_idx = dataset->used_feature_map_[inner_data.first];
+        if (feature_idx >= 0) {
+          is_feature_added[feature_idx] = true;
+          // if is used feature
+          int group = dataset->feature2group_[feature_idx];
+          int sub_feature = dataset->feature2subfeature_[feature_idx];
+          dataset->feature_groups_[group]->PushData(tid, sub_feature, row_idx, inner_data.second);
+        } else {
+          if (inner_data.first == weight_idx_) {
+            dataset->metadata_.SetWeightAt(row_idx, static_cast<label_t>(inner_data.second));
+          } else if (inner_data.first == group_idx_) {
+            dataset->metadata_.SetQueryAt(row_idx, static_cast<data_size_t>(inner_data.second));
+          }
+        }
+      }
+      dataset->FinishOneRow(tid, row_idx, is_feature_added);
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
+  };
+  // resize dataset, metadata and init scores
+  auto resize_fun = [this, &init_score, &dataset] (data_size_t num_data) {
+    dataset->ReSize(num_data);
+    dataset->metadata_.ReSize(num_data);
+    if (predict_fun_ != nullptr) {
+      init_score.resize(static_cast<size_t>(num_data) * num_class_);
+    }
+  };
+  const size_t first_chunk_size = static_cast<size_t>(config_.stream_first_chunk_size);
+  std::vector<std::string> first_chunk;
+  bool is_constructed = false;
+  data_size_t num_data = 0;
+  auto construct_and_push_first_chunk = [&] () {
+    construct_fun(first_chunk);
+    num_data = static_cast<data_size_t>(first_chunk.size());
+    if (predict_fun_ != nullptr) {
+      init_score.resize(static_cast<size_t>(num_data) * num_class_);
+    }
+    process_fun(0, first_chunk);
+    std::vector<std::string>().swap(first_chunk);
+    is_constructed = true;
+  };
+  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes);
+  text_reader.ReadAllAndProcessParallel(
+    [&] (data_size_t start_idx, const std::vector<std::string>& lines) {
+    if (!is_constructed) {
+      first_chunk.insert(first_chunk.end(), lines.begin(), lines.end());
+      if (first_chunk.size() >= first_chunk_size) {
+        construct_and_push_first_chunk();
+      }
+      return;
+    }
+    num_data = start_idx + static_cast<data_size_t>(lines.size());
+    if (num_data > dataset->num_data_) {
+      // double the space, so each row is copied O(1) times on average
+      const int64_t capacity = std::max(static_cast<int64_t>(num_data), 2 * static_cast<int64_t>(dataset->num_data_));
+      resize_fun(static_cast<data_size_t>(std::min(capacity, static_cast<int64_t>(std::numeric_limits<data_size_t>::max()))));
+    }
+    process_fun(start_idx, lines);
+  });
+  if (!is_constructed) {
+    construct_and_push_first_chunk();
+  }
+  resize_fun(num_data);
+  Log::Info("Loaded %d lines of %s in one pass", num_data, filename);
+
+  // metadata_ will manage space of init_score
+  if (!init_score.empty()) {
+    std::vector<double> col_major_init_score(init_score.size());
+    #pragma omp parallel for schedule(static, 512) if (num_data >= 1024)
+    for (data_size_t i = 0; i < num_data; ++i) {
+      for (int k = 0; k < num_class_; ++k) {
+        col_major_init_score[static_cast<size_t>(k) * num_data + i] = init_score[static_cast<size_t>(i) * num_class_ + k];
+      }
+    }
+    dataset->metadata_.SetInitScore(col_major_init_score.data(), static_cast<data_size_t>(col_major_init_score.size()));
+  }
+  dataset->FinishLoad();
+}
+
 /*! \brief Check can load from binary file */
 std::string DatasetLoader::CheckCanLoadFromBin(const char* filename) {
   std::string bin_filename(filename);
@@ -61,6 +61,7 @@ class DenseBin : public Bin {
     } else {
       data_.resize(num_data_, static_cast<VAL_T>(0));
     }
+    data_ptr_ = data_.data();
   }
 
   ~DenseBin() {}
@@ -82,12 +83,25 @@ class DenseBin : public Bin {
 
   void ReSize(data_size_t num_data) override {
     if (num_data_ != num_data) {
+      // growing is done by doubling while loading, shrinking is the final size, so give back the spare space
+      const bool is_shrinking = num_data < num_data_;
       num_data_ = num_data;
       if (IS_4BIT) {
         data_.resize((num_data_ + 1) / 2, static_cast<VAL_T>(0));
+        // still loading, the pushed high halves are merged in FinishLoad
+        if (!buf_.empty()) {
+          buf_.resize((num_data_ + 1) / 2, static_cast<uint8_t>(0));
+          if (is_shrinking) {
+            buf_.shrink_to_fit();
+          }
+        }
       } else {
-        data_.resize(num_data_);
+        data_.resize(num_data_, static_cast<VAL_T>(0));
+      }
+      if (is_shrinking) {
+        data_.shrink_to_fit();
       }
+      data_ptr_ = data_.data();
     }
   }
 
@@ -99,10 +113,10 @@ class DenseBin : public Bin {
                                data_size_t start, data_size_t end,
                                const score_t* ordered_gradients,
                                const score_t* ordered_hessians,
-                               hist_t* out) const {
+                               hist_acc_t* out) const {
     data_size_t i = start;
-    hist_t* grad = out;
-    hist_t* hess = out + 1;
+    hist_acc_t* grad = out;
+    hist_acc_t* hess = out + 1;
     hist_cnt_t* cnt = reinterpret_cast<hist_cnt_t*>(hess);
     if (USE_PREFETCH) {
       const data_size_t pf_offset = 64 / sizeof(VAL_T);
@@ -112,9 +126,9 @@ class DenseBin : public Bin {
         const auto pf_idx =
             USE_INDICES ? data_indices[i + pf_offset] : i + pf_offset;
         if (IS_4BIT) {
-          PREFETCH_T0(data_.data() + (pf_idx >> 1));
+          PREFETCH_T0(data_ptr_ + (pf_idx >> 1));
         } else {
-          PREFETCH_T0(data_.data() + pf_idx);
+          PREFETCH_T0(data_ptr_ + pf_idx);
         }
         const auto ti = static_cast<uint32_t>(data(idx)) << 1;
         if (USE_HESSIAN) {
@@ -142,7 +156,7 @@ class DenseBin : public Bin {
   void ConstructHistogram(const data_size_t* data_indices, data_size_t start,
                           data_size_t end, const score_t* ordered_gradients,
                           const score_t* ordered_hessians,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     ConstructHistogramInner<true, true, true>(
         data_indices, start, end, ordered_gradients, ordered_hessians, out);
   }
@@ -150,25 +164,85 @@ class DenseBin : public Bin {
   void ConstructHistogram(data_size_t start, data_size_t end,
                           const score_t* ordered_gradients,
                           const score_t* ordered_hessians,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     ConstructHistogramInner<false, false, true>(
         nullptr, start, end, ordered_gradients, ordered_hessians, out);
   }
 
   void ConstructHistogram(const data_size_t* data_indices, data_size_t start,
                           data_size_t end, const score_t* ordered_gradients,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     ConstructHistogramInner<true, true, false>(data_indices, start, end,
                                                ordered_gradients, nullptr, out);
   }
 
   void ConstructHistogram(data_size_t start, data_size_t end,
                           const score_t* ordered_gradients,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     ConstructHistogramInner<false, false, false>(
         nullptr, start, end, ordered_gradients, nullptr, out);
   }
 
+  template <bool USE_INDICES, bool USE_PREFETCH, typename PACKED_HIST_T,
+            int HIST_BITS>
+  void ConstructIntHistogramInner(const data_size_t* data_indices,
+                                  data_size_t start, data_size_t end,
+                                  const int16_t* ordered_int_grad_hess,
+                                  PACKED_HIST_T* out) const {
+    data_size_t i = start;
+    if (USE_PREFETCH) {
+      const data_size_t pf_offset = 64 / sizeof(VAL_T);
+      const data_size_t pf_end = end - pf_offset;
+      for (; i < pf_end; ++i) {
+        const auto idx = USE_INDICES ? data_indices[i] : i;
+        const auto pf_idx =
+            USE_INDICES ? data_indices[i + pf_offset] : i + pf_offset;
+        if (IS_4BIT) {
+          PREFETCH_T0(data_ptr_ + (pf_idx >> 1));
+        } else {
+          PREFETCH_T0(data_ptr_ + pf_idx);
+        }
+        out[data(idx)] += PackIntGradHess<PACKED_HIST_T, HIST_BITS>(
+            ordered_int_grad_hess[i]);
+      }
+    }
+    for (; i < end; ++i) {
+      const auto idx = USE_INDICES ? data_indices[i] : i;
+      out[data(idx)] += PackIntGradHess<PACKED_HIST_T, HIST_BITS>(
+          ordered_int_grad_hess[i]);
+    }
+  }
+
+  void ConstructHistogramInt32(const data_size_t* data_indices,
+                               data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int32_t* out) const override {
+    ConstructIntHistogramInner<true, true, int32_t, 16>(
+        data_indices, start, end, ordered_int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt32(data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int32_t* out) const override {
+    ConstructIntHistogramInner<false, false, int32_t, 16>(
+        nullptr, start, end, ordered_int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt64(const data_size_t* data_indices,
+                               data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int64_t* out) const override {
+    ConstructIntHistogramInner<true, true, int64_t, 32>(
+        data_indices, start, end, ordered_int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt64(data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int64_t* out) const override {
+    ConstructIntHistogramInner<false, false, int64_t, 32>(
+        nullptr, start, end, ordered_int_grad_hess, out);
+  }
+
 
   template <bool MISS_IS_ZERO, bool MISS_IS_NA, bool MFB_IS_ZERO,
             bool MFB_IS_NA, bool USE_MIN_BIN>
@@ -373,7 +447,7 @@ class DenseBin : public Bin {
       for (int i = 0; i < len; ++i) {
         data_[i] |= buf_[i];
       }
-      buf_.clear();
+      std::vector<uint8_t>().swap(buf_);
     }
   }
 
@@ -413,11 +487,19 @@ class DenseBin : public Bin {
     }
   }
 
+  void LoadFromMemoryInPlace(const void* memory, data_size_t num_data) override {
+    num_data_ = num_data;
+    data_.clear();
+    data_.shrink_to_fit();
+    buf_.clear();
+    data_ptr_ = reinterpret_cast<const VAL_T*>(memory);
+  }
+
   inline VAL_T data(data_size_t idx) const {
     if (IS_4BIT) {
-      return (data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
+      return (data_ptr_[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
     } else {
-      return data_[idx];
+      return data_ptr_[idx];
     }
   }
 
@@ -429,30 +511,32 @@ class DenseBin : public Bin {
       for (int i = 0; i < num_used_indices - rest; i += 2) {
         data_size_t idx = used_indices[i];
         const auto bin1 = static_cast<uint8_t>(
-            (other_bin->data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
+            (other_bin->data_ptr_[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
         idx = used_indices[i + 1];
         const auto bin2 = static_cast<uint8_t>(
-            (other_bin->data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
+            (other_bin->data_ptr_[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
         const int i1 = i >> 1;
         data_[i1] = (bin1 | (bin2 << 4));
       }
       if (rest) {
         data_size_t idx = used_indices[num_used_indices - 1];
         data_[num_used_indices >> 1] =
-            (other_bin->data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
+            (other_bin->data_ptr_[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
       }
     } else {
       for (int i = 0; i < num_used_indices; ++i) {
-        data_[i] = other_bin->data_[used_indices[i]];
+        data_[i] = other_bin->data_ptr_[used_indices[i]];
       }
     }
   }
 
   void SaveBinaryToFile(const VirtualFileWriter* writer) const override {
-    writer->Write(data_.data(), sizeof(VAL_T) * data_.size());
+    writer->Write(data_ptr_, SizesInByte());
   }
 
-  size_t SizesInByte() const override { return sizeof(VAL_T) * data_.size(); }
+  size_t SizesInByte() const override {
+    return sizeof(VAL_T) * static_cast<size_t>(IS_4BIT ? (num_data_ + 1) / 2 : num_data_);
+  }
 
   DenseBin<VAL_T, IS_4BIT>* Clone() override;
 
@@ -460,9 +544,14 @@ class DenseBin : public Bin {
   data_size_t num_data_;
   std::vector<VAL_T, Common::AlignmentAllocator<VAL_T, kAlignedSize>> data_;
   std::vector<uint8_t> buf_;
+  /*! \brief Data read by this bin, data_ or the memory given to LoadFromMemoryInPlace */
+  const VAL_T* data_ptr_ = nullptr;
 
   DenseBin<VAL_T, IS_4BIT>(const DenseBin<VAL_T, IS_4BIT>& other)
-      : num_data_(other.num_data_), data_(other.data_) {}
+      : num_data_(other.num_data_),
+        data_(other.data_ptr_, other.data_ptr_ + other.SizesInByte() / sizeof(VAL_T)) {
+    data_ptr_ = data_.data();
+  }
 };
 
 template <typename VAL_T, bool IS_4BIT>
@@ -10,11 +10,24 @@
 #include <algorithm>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
 #ifdef USE_HDFS
 #include <hdfs.h>
 #endif
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace LightGBM {
 
 struct LocalFile : VirtualFileReader, VirtualFileWriter {
@@ -50,6 +63,10 @@ struct LocalFile : VirtualFileReader, VirtualFileWriter {
     return fwrite(buffer, bytes, 1, file_) == 1 ? bytes : 0;
   }
 
+  bool Flush() const {
+    return fflush(file_) == 0;
+  }
+
  private:
   FILE* file_ = NULL;
   const std::string filename_;
@@ -98,6 +115,10 @@ struct HDFSFile : VirtualFileReader, VirtualFileWriter {
     return FileOperation<const void*>(data, bytes, &hdfsWrite);
   }
 
+  bool Flush() const {
+    return hdfsFlush(fs_, file_) == 0;
+  }
+
  private:
   template <typename BufferType>
   using fileOp = tSize (*)(hdfsFS, hdfsFile, BufferType, tSize);
@@ -196,4 +217,78 @@ bool VirtualFileWriter::Exists(const std::string& filename) {
   return file.Exists();
 }
 
+MappedFile::~MappedFile() {
+  if (is_mapped_) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<char*>(data_), size_);
+#endif
+  }
+}
+
+std::unique_ptr<MappedFile> MappedFile::Make(const std::string& filename) {
+  std::unique_ptr<MappedFile> ret(new MappedFile());
+  if (0 != filename.find(kHdfsProto)) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+      return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+      HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapping != NULL) {
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // the view keeps the mapping alive
+        CloseHandle(mapping);
+        if (view != NULL) {
+          ret->data_ = static_cast<const char*>(view);
+          ret->size_ = static_cast<size_t>(file_size.QuadPart);
+          ret->is_mapped_ = true;
+        }
+      }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+      void* addr = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        ret->data_ = static_cast<const char*>(addr);
+        ret->size_ = static_cast<size_t>(file_stat.st_size);
+        ret->is_mapped_ = true;
+      }
+    }
+    // the mapping keeps the file alive
+    close(fd);
+#endif
+    if (ret->is_mapped_) {
+      return ret;
+    }
+  }
+  // fall back to reading the whole file
+  auto reader = VirtualFileReader::Make(filename);
+  if (!reader->Init()) {
+    return nullptr;
+  }
+  const size_t buffer_size = 16 * 1024 * 1024;
+  std::vector<char> content;
+  std::vector<char> buffer(buffer_size);
+  size_t read_cnt = 0;
+  while ((read_cnt = reader->Read(buffer.data(), buffer_size)) > 0) {
+    content.insert(content.end(), buffer.begin(), buffer.begin() + read_cnt);
+  }
+  ret->buffer_.reset(new char[std::max<size_t>(content.size(), 1)]);
+  std::copy(content.begin(), content.end(), ret->buffer_.get());
+  ret->data_ = ret->buffer_.get();
+  ret->size_ = content.size();
+  return ret;
+}
+
 }  // namespace LightGBM
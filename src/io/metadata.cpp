@@ -55,6 +55,29 @@ void Metadata::Init(data_size_t num_data, int weight_idx, int query_idx) {
   }
 }
 
+void Metadata::ReSize(data_size_t num_data) {
+  // the last call sets the final size, after the space was doubled while loading
+  const bool is_shrinking = num_data < num_data_;
+  num_data_ = num_data;
+  label_.resize(num_data_, 0.0f);
+  if (is_shrinking) {
+    label_.shrink_to_fit();
+  }
+  if (!weight_load_from_file_ && !weights_.empty()) {
+    weights_.resize(num_data_, 0.0f);
+    num_weights_ = num_data_;
+    if (is_shrinking) {
+      weights_.shrink_to_fit();
+    }
+  }
+  if (!queries_.empty()) {
+    queries_.resize(num_data_, 0);
+    if (is_shrinking) {
+      queries_.shrink_to_fit();
+    }
+  }
+}
+
 void Metadata::Init(const Metadata& fullset, const data_size_t* used_indices, data_size_t num_used_indices) {
   num_data_ = num_used_indices;
 
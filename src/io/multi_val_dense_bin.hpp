@@ -53,10 +53,10 @@ class MultiValDenseBin : public MultiValBin {
 
   template<bool USE_INDICES, bool USE_PREFETCH, bool ORDERED>
   void ConstructHistogramInner(const data_size_t* data_indices, data_size_t start, data_size_t end,
-    const score_t* gradients, const score_t* hessians, hist_t* out) const {
+    const score_t* gradients, const score_t* hessians, hist_acc_t* out) const {
     data_size_t i = start;
-    hist_t* grad = out;
-    hist_t* hess = out + 1;
+    hist_acc_t* grad = out;
+    hist_acc_t* hess = out + 1;
     if (USE_PREFETCH) {
       const data_size_t pf_offset = 32 / sizeof(VAL_T);
       const data_size_t pf_end = end - pf_offset;
@@ -100,14 +100,14 @@ class MultiValDenseBin : public MultiValBin {
 
   void ConstructHistogram(const data_size_t* data_indices, data_size_t start,
                           data_size_t end, const score_t* gradients,
-                          const score_t* hessians, hist_t* out) const override {
+                          const score_t* hessians, hist_acc_t* out) const override {
     ConstructHistogramInner<true, true, false>(data_indices, start, end,
                                                gradients, hessians, out);
   }
 
   void ConstructHistogram(data_size_t start, data_size_t end,
                           const score_t* gradients, const score_t* hessians,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     ConstructHistogramInner<false, false, false>(
         nullptr, start, end, gradients, hessians, out);
   }
@@ -116,11 +116,95 @@ class MultiValDenseBin : public MultiValBin {
                                  data_size_t start, data_size_t end,
                                  const score_t* gradients,
                                  const score_t* hessians,
-                                 hist_t* out) const override {
+                                 hist_acc_t* out) const override {
     ConstructHistogramInner<true, true, true>(data_indices, start, end,
                                               gradients, hessians, out);
   }
 
+  template <bool USE_INDICES, bool USE_PREFETCH, bool ORDERED,
+            typename PACKED_HIST_T, int HIST_BITS>
+  void ConstructIntHistogramInner(const data_size_t* data_indices,
+                                  data_size_t start, data_size_t end,
+                                  const int16_t* int_grad_hess,
+                                  PACKED_HIST_T* out) const {
+    data_size_t i = start;
+    if (USE_PREFETCH) {
+      const data_size_t pf_offset = 32 / sizeof(VAL_T);
+      const data_size_t pf_end = end - pf_offset;
+
+      for (; i < pf_end; ++i) {
+        const auto idx = USE_INDICES ? data_indices[i] : i;
+        const auto pf_idx =
+            USE_INDICES ? data_indices[i + pf_offset] : i + pf_offset;
+        if (!ORDERED) {
+          PREFETCH_T0(int_grad_hess + pf_idx);
+        }
+        PREFETCH_T0(data_.data() + RowPtr(pf_idx));
+        const auto packed = PackIntGradHess<PACKED_HIST_T, HIST_BITS>(
+            int_grad_hess[ORDERED ? i : idx]);
+        const auto j_start = RowPtr(idx);
+        for (auto j = j_start; j < j_start + num_feature_; ++j) {
+          out[data_[j]] += packed;
+        }
+      }
+    }
+    for (; i < end; ++i) {
+      const auto idx = USE_INDICES ? data_indices[i] : i;
+      const auto packed = PackIntGradHess<PACKED_HIST_T, HIST_BITS>(
+          int_grad_hess[ORDERED ? i : idx]);
+      const auto j_start = RowPtr(idx);
+      for (auto j = j_start; j < j_start + num_feature_; ++j) {
+        out[data_[j]] += packed;
+      }
+    }
+  }
+
+  void ConstructHistogramInt32(const data_size_t* data_indices,
+                               data_size_t start, data_size_t end,
+                               const int16_t* int_grad_hess,
+                               int32_t* out) const override {
+    ConstructIntHistogramInner<true, true, false, int32_t, 16>(
+        data_indices, start, end, int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt32(data_size_t start, data_size_t end,
+                               const int16_t* int_grad_hess,
+                               int32_t* out) const override {
+    ConstructIntHistogramInner<false, false, false, int32_t, 16>(
+        nullptr, start, end, int_grad_hess, out);
+  }
+
+  void ConstructHistogramOrderedInt32(const data_size_t* data_indices,
+                                      data_size_t start, data_size_t end,
+                                      const int16_t* ordered_int_grad_hess,
+                                      int32_t* out) const override {
+    ConstructIntHistogramInner<true, true, true, int32_t, 16>(
+        data_indices, start, end, ordered_int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt64(const data_size_t* data_indices,
+                               data_size_t start, data_size_t end,
+                               const int16_t* int_grad_hess,
+                               int64_t* out) const override {
+    ConstructIntHistogramInner<true, true, false, int64_t, 32>(
+        data_indices, start, end, int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt64(data_size_t start, data_size_t end,
+                               const int16_t* int_grad_hess,
+                               int64_t* out) const override {
+    ConstructIntHistogramInner<false, false, false, int64_t, 32>(
+        nullptr, start, end, int_grad_hess, out);
+  }
+
+  void ConstructHistogramOrderedInt64(const data_size_t* data_indices,
+                                      data_size_t start, data_size_t end,
+                                      const int16_t* ordered_int_grad_hess,
+                                      int64_t* out) const override {
+    ConstructIntHistogramInner<true, true, true, int64_t, 32>(
+        data_indices, start, end, ordered_int_grad_hess, out);
+  }
+
   MultiValBin* CreateLike(data_size_t num_data, int num_bin, int num_feature, double) const override {
     return new MultiValDenseBin<VAL_T>(num_data, num_bin, num_feature);
   }
@@ -101,7 +101,7 @@ class SparseBin : public Bin {
   void ConstructHistogram(const data_size_t* data_indices, data_size_t start,
                           data_size_t end, const score_t* ordered_gradients,
                           const score_t* ordered_hessians,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     data_size_t i_delta, cur_pos;
     InitIndex(data_indices[start], &i_delta, &cur_pos);
     data_size_t i = start;
@@ -132,7 +132,7 @@ class SparseBin : public Bin {
   void ConstructHistogram(data_size_t start, data_size_t end,
                           const score_t* ordered_gradients,
                           const score_t* ordered_hessians,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     data_size_t i_delta, cur_pos;
     InitIndex(start, &i_delta, &cur_pos);
     while (cur_pos < start && i_delta < num_vals_) {
@@ -147,11 +147,11 @@ class SparseBin : public Bin {
 
   void ConstructHistogram(const data_size_t* data_indices, data_size_t start,
                           data_size_t end, const score_t* ordered_gradients,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     data_size_t i_delta, cur_pos;
     InitIndex(data_indices[start], &i_delta, &cur_pos);
     data_size_t i = start;
-    hist_t* grad = out;
+    hist_acc_t* grad = out;
     hist_cnt_t* cnt = reinterpret_cast<hist_cnt_t*>(out + 1);
     for (;;) {
       if (cur_pos < data_indices[i]) {
@@ -180,10 +180,10 @@ class SparseBin : public Bin {
 
   void ConstructHistogram(data_size_t start, data_size_t end,
                           const score_t* ordered_gradients,
-                          hist_t* out) const override {
+                          hist_acc_t* out) const override {
     data_size_t i_delta, cur_pos;
     InitIndex(start, &i_delta, &cur_pos);
-    hist_t* grad = out;
+    hist_acc_t* grad = out;
     hist_cnt_t* cnt = reinterpret_cast<hist_cnt_t*>(out + 1);
     while (cur_pos < start && i_delta < num_vals_) {
       cur_pos += deltas_[++i_delta];
@@ -197,6 +197,84 @@ class SparseBin : public Bin {
   }
 #undef ACC_GH
 
+  template <typename PACKED_HIST_T, int HIST_BITS>
+  void ConstructIntHistogramInner(const data_size_t* data_indices,
+                                  data_size_t start, data_size_t end,
+                                  const int16_t* ordered_int_grad_hess,
+                                  PACKED_HIST_T* out) const {
+    data_size_t i_delta, cur_pos;
+    InitIndex(data_indices[start], &i_delta, &cur_pos);
+    data_size_t i = start;
+    for (;;) {
+      if (cur_pos < data_indices[i]) {
+        cur_pos += deltas_[++i_delta];
+        if (i_delta >= num_vals_) {
+          break;
+        }
+      } else if (cur_pos > data_indices[i]) {
+        if (++i >= end) {
+          break;
+        }
+      } else {
+        out[vals_[i_delta]] += PackIntGradHess<PACKED_HIST_T, HIST_BITS>(
+            ordered_int_grad_hess[i]);
+        if (++i >= end) {
+          break;
+        }
+        cur_pos += deltas_[++i_delta];
+        if (i_delta >= num_vals_) {
+          break;
+        }
+      }
+    }
+  }
+
+  template <typename PACKED_HIST_T, int HIST_BITS>
+  void ConstructIntHistogramInner(data_size_t start, data_size_t end,
+                                  const int16_t* ordered_int_grad_hess,
+                                  PACKED_HIST_T* out) const {
+    data_size_t i_delta, cur_pos;
+    InitIndex(start, &i_delta, &cur_pos);
+    while (cur_pos < start && i_delta < num_vals_) {
+      cur_pos += deltas_[++i_delta];
+    }
+    while (cur_pos < end && i_delta < num_vals_) {
+      out[vals_[i_delta]] += PackIntGradHess<PACKED_HIST_T, HIST_BITS>(
+          ordered_int_grad_hess[cur_pos]);
+      cur_pos += deltas_[++i_delta];
+    }
+  }
+
+  void ConstructHistogramInt32(const data_size_t* data_indices,
+                               data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int32_t* out) const override {
+    ConstructIntHistogramInner<int32_t, 16>(data_indices, start, end,
+                                            ordered_int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt32(data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int32_t* out) const override {
+    ConstructIntHistogramInner<int32_t, 16>(start, end, ordered_int_grad_hess,
+                                            out);
+  }
+
+  void ConstructHistogramInt64(const data_size_t* data_indices,
+                               data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int64_t* out) const override {
+    ConstructIntHistogramInner<int64_t, 32>(data_indices, start, end,
+                                            ordered_int_grad_hess, out);
+  }
+
+  void ConstructHistogramInt64(data_size_t start, data_size_t end,
+                               const int16_t* ordered_int_grad_hess,
+                               int64_t* out) const override {
+    ConstructIntHistogramInner<int64_t, 32>(start, end, ordered_int_grad_hess,
+                                            out);
+  }
+
   inline void NextNonzeroFast(data_size_t* i_delta,
                               data_size_t* cur_pos) const {
     *cur_pos += deltas_[++(*i_delta)];
@@ -555,6 +633,12 @@ class SparseBin : public Bin {
     }
   }
 
+  void LoadFromMemoryInPlace(const void* memory, data_size_t num_data) override {
+    // sparse data are small, they are copied
+    num_data_ = num_data;
+    LoadFromMemory(memory, std::vector<data_size_t>());
+  }
+
   void CopySubrow(const Bin* full_bin, const data_size_t* used_indices,
                   data_size_t num_used_indices) override {
     auto other_bin = dynamic_cast<const SparseBin<VAL_T>*>(full_bin);
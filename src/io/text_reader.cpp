@@ -0,0 +1,53 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+// SSE2 is part of x86-64, so the vector scan needs no runtime dispatch
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define TEXT_READER_SSE2
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#endif
+
+// intrinsics headers go first, common.h may redefine _mm_malloc
+#include <LightGBM/utils/text_reader.h>
+
+namespace LightGBM {
+
+#ifdef TEXT_READER_SSE2
+static inline int CountTrailingZeros(int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, static_cast<unsigned long>(mask));
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(static_cast<unsigned int>(mask));
+#endif
+}
+#endif
+
+const char* FindEndOfLine(const char* begin, const char* end) {
+  const char* p = begin;
+#ifdef TEXT_READER_SSE2
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; end - p >= 16; p += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, newline),
+                                                    _mm_cmpeq_epi8(chunk, carriage_return)));
+    if (mask != 0) {
+      return p + CountTrailingZeros(mask);
+    }
+  }
+#endif
+  for (; p < end; ++p) {
+    if (*p == '\n' || *p == '\r') {
+      return p;
+    }
+  }
+  return end;
+}
+
+}  // namespace LightGBM
@@ -8,9 +8,13 @@
 #include <LightGBM/utils/common.h>
 #include <LightGBM/utils/threading.h>
 
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <iomanip>
 #include <sstream>
+#include <type_traits>
+#include <utility>
 
 namespace LightGBM {
 
@@ -493,9 +497,161 @@ std::string Tree::NodeToIfElseByMap(int index, bool predict_leaf_index) const {
   return str_buf.str();
 }
 
+std::string Tree::DecisionToC(int node, const std::string& prefix, const std::string& cat_name) const {
+  std::stringstream str_buf;
+  str_buf << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+  uint8_t missing_type = GetMissingType(decision_type_[node]);
+  if (GetDecisionType(decision_type_[node], kCategoricalMask)) {
+    // negative, too large and NaN values go right, as in CategoricalDecision
+    int cat_idx = static_cast<int>(threshold_[node]);
+    str_buf << prefix << "_in_bitset(" << cat_name << " + " << cat_boundaries_[cat_idx] << ", "
+            << cat_boundaries_[cat_idx + 1] - cat_boundaries_[cat_idx] << ", fval)";
+    return str_buf.str();
+  }
+  bool default_left = GetDecisionType(decision_type_[node], kDefaultLeftMask);
+  std::stringstream is_zero;
+  is_zero << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+  is_zero << "(fval >= " << -kZeroThreshold << " && fval <= " << kZeroThreshold << ")";
+  if (missing_type == MissingType::None) {
+    // NaN is compared as zero
+    if (threshold_[node] >= 0.0) {
+      str_buf << "!(fval > " << threshold_[node] << ")";
+    } else {
+      str_buf << "fval <= " << threshold_[node];
+    }
+  } else if (missing_type == MissingType::Zero) {
+    // NaN is converted to zero, so it is missing too
+    if (default_left) {
+      str_buf << "fval <= " << threshold_[node] << " || isnan(fval) || " << is_zero.str();
+    } else {
+      str_buf << "fval <= " << threshold_[node] << " && !isnan(fval) && !" << is_zero.str();
+    }
+  } else {
+    if (default_left) {
+      str_buf << "fval <= " << threshold_[node] << " || isnan(fval)";
+    } else {
+      str_buf << "fval <= " << threshold_[node] << " && !isnan(fval)";
+    }
+  }
+  return str_buf.str();
+}
+
+void Tree::NodeToC(int index, int depth, const std::string& prefix, const std::string& cat_name,
+                   std::stringstream* str_buf) const {
+  const std::string indent(2 * depth, ' ');
+  if (index >= 0) {
+    *str_buf << indent << "fval = row[" << split_feature_[index] << "];\n";
+    *str_buf << indent << "if (" << DecisionToC(index, prefix, cat_name) << ") {\n";
+    NodeToC(left_child_[index], depth + 1, prefix, cat_name, str_buf);
+    *str_buf << indent << "} else {\n";
+    NodeToC(right_child_[index], depth + 1, prefix, cat_name, str_buf);
+    *str_buf << indent << "}\n";
+  } else {
+    *str_buf << indent << "return " << leaf_value_[~index] << ";\n";
+  }
+}
+
+std::string Tree::ToC(const std::string& prefix, int index) const {
+  std::stringstream str_buf;
+  str_buf << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+  const std::string name = prefix + "_tree_" + std::to_string(index);
+  const std::string cat_name = name + "_cat";
+  if (num_cat_ > 0) {
+    str_buf << "static const uint32_t " << cat_name << "[] = {";
+    for (size_t i = 0; i < cat_threshold_.size(); ++i) {
+      if (i != 0) {
+        str_buf << ", ";
+      }
+      str_buf << cat_threshold_[i] << "u";
+    }
+    str_buf << "};\n\n";
+  }
+  str_buf << "static double " << name << "(const float* row) {\n";
+  if (num_leaves_ <= 1) {
+    str_buf << "  (void)row;\n";
+    str_buf << "  return " << leaf_value_[0] << ";\n";
+  } else {
+    str_buf << "  double fval;\n";
+    NodeToC(0, 1, prefix, cat_name, &str_buf);
+  }
+  str_buf << "}\n";
+  return str_buf.str();
+}
+
+namespace {
+
+/*! \brief Copy count elements from buffer into a vector, buffer is advanced past them */
+template<typename T>
+void ReadBinaryArray(const char** buffer, const char* end, size_t count, std::vector<T>* out) {
+  const size_t bytes = sizeof(T) * count;
+  if (static_cast<size_t>(end - *buffer) < bytes) {
+    Log::Fatal("Binary tree model is truncated");
+  }
+  out->resize(count);
+  if (bytes > 0) {
+    std::memcpy(out->data(), *buffer, bytes);
+  }
+  *buffer += bytes;
+}
+
+template<typename T>
+void ReadBinaryValue(const char** buffer, const char* end, T* out) {
+  if (static_cast<size_t>(end - *buffer) < sizeof(T)) {
+    Log::Fatal("Binary tree model is truncated");
+  }
+  std::memcpy(out, *buffer, sizeof(T));
+  *buffer += sizeof(T);
+}
+
+/*! \brief Range of the value of each key of a text tree */
+typedef std::unordered_map<std::string, std::pair<const char*, const char*>> TextFields;
+
+/*!
+* \brief Parse the n numbers separated by spaces of a field of a text tree, without copying them.
+*        Floating point numbers are parsed by strtod when exact is true, so they round-trip,
+*        and by the faster Atof otherwise
+*/
+template<typename T>
+void ParseField(TextFields* fields, const char* name, int n, bool exact, std::vector<T>* out) {
+  const char* p = (*fields)[name].first;
+  const char* end = (*fields)[name].second;
+  std::vector<T>& ret = *out;
+  ret.resize(n);
+  for (int i = 0; i < n; ++i) {
+    if (p >= end) {
+      Log::Fatal("Tree model string format error, %s should have %d values", name, n);
+    }
+    if (std::is_floating_point<T>::value) {
+      double value = 0.0;
+      if (exact) {
+        char* value_end = nullptr;
+        value = std::strtod(p, &value_end);
+        if (value_end == p) {
+          Log::Fatal("Tree model string format error, bad value in %s", name);
+        }
+        p = value_end;
+      } else {
+        p = Common::Atof(p, &value);
+      }
+      ret[i] = static_cast<T>(value);
+    } else {
+      p = Common::Atoi(p, &ret[i]);
+    }
+    while (p < end && *p == ' ') {
+      ++p;
+    }
+  }
+  if (p != end) {
+    Log::Fatal("Tree model string format error, %s should have %d values", name, n);
+  }
+}
+
+}  // namespace
+
 Tree::Tree(const char* str, size_t* used_len) {
   auto p = str;
-  std::unordered_map<std::string, std::string> key_vals;
+  // values are parsed in place, only their ranges are kept
+  TextFields key_vals;
   const int max_num_line = 17;
   int read_line = 0;
   while (read_line < max_num_line) {
@@ -506,7 +662,7 @@ Tree::Tree(const char* str, size_t* used_len) {
     ++p;
     start = p;
     while (*p != '\r' && *p != '\n') ++p;
-    key_vals[key] = std::string(start, p - start);
+    key_vals[key] = std::make_pair(start, p);
     ++read_line;
     if (*p == '\r') ++p;
     if (*p == '\n') ++p;
@@ -517,22 +673,22 @@ Tree::Tree(const char* str, size_t* used_len) {
     Log::Fatal("Tree model should contain num_leaves field");
   }
 
-  Common::Atoi(key_vals["num_leaves"].c_str(), &num_leaves_);
+  Common::Atoi(key_vals["num_leaves"].first, &num_leaves_);
 
   if (key_vals.count("num_cat") <= 0) {
     Log::Fatal("Tree model should contain num_cat field");
   }
 
-  Common::Atoi(key_vals["num_cat"].c_str(), &num_cat_);
+  Common::Atoi(key_vals["num_cat"].first, &num_cat_);
 
   if (key_vals.count("leaf_value")) {
-    leaf_value_ = Common::StringToArray<double>(key_vals["leaf_value"], num_leaves_);
+    ParseField(&key_vals, "leaf_value", num_leaves_, true, &leaf_value_);
   } else {
     Log::Fatal("Tree model string format error, should contain leaf_value field");
   }
 
   if (key_vals.count("shrinkage")) {
-    Common::Atof(key_vals["shrinkage"].c_str(), &shrinkage_);
+    Common::Atof(key_vals["shrinkage"].first, &shrinkage_);
   } else {
     shrinkage_ = 1.0f;
   }
@@ -540,85 +696,164 @@ Tree::Tree(const char* str, size_t* used_len) {
   if (num_leaves_ <= 1) { return; }
 
   if (key_vals.count("left_child")) {
-    left_child_ = Common::StringToArrayFast<int>(key_vals["left_child"], num_leaves_ - 1);
+    ParseField(&key_vals, "left_child", num_leaves_ - 1, false, &left_child_);
   } else {
     Log::Fatal("Tree model string format error, should contain left_child field");
   }
 
   if (key_vals.count("right_child")) {
-    right_child_ = Common::StringToArrayFast<int>(key_vals["right_child"], num_leaves_ - 1);
+    ParseField(&key_vals, "right_child", num_leaves_ - 1, false, &right_child_);
   } else {
     Log::Fatal("Tree model string format error, should contain right_child field");
   }
 
   if (key_vals.count("split_feature")) {
-    split_feature_ = Common::StringToArrayFast<int>(key_vals["split_feature"], num_leaves_ - 1);
+    ParseField(&key_vals, "split_feature", num_leaves_ - 1, false, &split_feature_);
   } else {
     Log::Fatal("Tree model string format error, should contain split_feature field");
   }
 
   if (key_vals.count("threshold")) {
-    threshold_ = Common::StringToArray<double>(key_vals["threshold"], num_leaves_ - 1);
+    ParseField(&key_vals, "threshold", num_leaves_ - 1, true, &threshold_);
   } else {
     Log::Fatal("Tree model string format error, should contain threshold field");
   }
 
   if (key_vals.count("split_gain")) {
-    split_gain_ = Common::StringToArrayFast<float>(key_vals["split_gain"], num_leaves_ - 1);
+    ParseField(&key_vals, "split_gain", num_leaves_ - 1, false, &split_gain_);
   } else {
     split_gain_.resize(num_leaves_ - 1);
   }
 
   if (key_vals.count("internal_count")) {
-    internal_count_ = Common::StringToArrayFast<int>(key_vals["internal_count"], num_leaves_ - 1);
+    ParseField(&key_vals, "internal_count", num_leaves_ - 1, false, &internal_count_);
   } else {
     internal_count_.resize(num_leaves_ - 1);
   }
 
   if (key_vals.count("internal_value")) {
-    internal_value_ = Common::StringToArrayFast<double>(key_vals["internal_value"], num_leaves_ - 1);
+    ParseField(&key_vals, "internal_value", num_leaves_ - 1, false, &internal_value_);
   } else {
     internal_value_.resize(num_leaves_ - 1);
   }
 
   if (key_vals.count("internal_weight")) {
-    internal_weight_ = Common::StringToArrayFast<double>(key_vals["internal_weight"], num_leaves_ - 1);
+    ParseField(&key_vals, "internal_weight", num_leaves_ - 1, false, &internal_weight_);
   } else {
     internal_weight_.resize(num_leaves_ - 1);
   }
 
   if (key_vals.count("leaf_weight")) {
-    leaf_weight_ = Common::StringToArray<double>(key_vals["leaf_weight"], num_leaves_);
+    ParseField(&key_vals, "leaf_weight", num_leaves_, true, &leaf_weight_);
   } else {
     leaf_weight_.resize(num_leaves_);
   }
 
   if (key_vals.count("leaf_count")) {
-    leaf_count_ = Common::StringToArrayFast<int>(key_vals["leaf_count"], num_leaves_);
+    ParseField(&key_vals, "leaf_count", num_leaves_, false, &leaf_count_);
   } else {
     leaf_count_.resize(num_leaves_);
   }
 
   if (key_vals.count("decision_type")) {
-    decision_type_ = Common::StringToArrayFast<int8_t>(key_vals["decision_type"], num_leaves_ - 1);
+    ParseField(&key_vals, "decision_type", num_leaves_ - 1, false, &decision_type_);
   } else {
     decision_type_ = std::vector<int8_t>(num_leaves_ - 1, 0);
   }
 
   if (num_cat_ > 0) {
     if (key_vals.count("cat_boundaries")) {
-      cat_boundaries_ = Common::StringToArrayFast<int>(key_vals["cat_boundaries"], num_cat_ + 1);
+      ParseField(&key_vals, "cat_boundaries", num_cat_ + 1, false, &cat_boundaries_);
     } else {
       Log::Fatal("Tree model should contain cat_boundaries field.");
     }
 
     if (key_vals.count("cat_threshold")) {
-      cat_threshold_ = Common::StringToArrayFast<uint32_t>(key_vals["cat_threshold"], cat_boundaries_.back());
+      ParseField(&key_vals, "cat_threshold", cat_boundaries_.back(), false, &cat_threshold_);
     } else {
       Log::Fatal("Tree model should contain cat_threshold field");
     }
   }
   max_depth_ = -1;
+  RecomputeObliviousLevels();
+}
+
+Tree::Tree(const char* buffer, size_t len)
+  :track_branch_features_(false) {
+  const char* end = buffer + len;
+  ReadBinaryValue(&buffer, end, &num_leaves_);
+  ReadBinaryValue(&buffer, end, &num_cat_);
+  ReadBinaryValue(&buffer, end, &shrinkage_);
+  if (num_leaves_ < 1 || num_cat_ < 0 || num_cat_ >= num_leaves_) {
+    Log::Fatal("Binary tree model format error, %d leaves and %d categorical splits", num_leaves_, num_cat_);
+  }
+  max_leaves_ = num_leaves_;
+  const size_t num_nodes = static_cast<size_t>(num_leaves_ - 1);
+  ReadBinaryArray(&buffer, end, num_leaves_, &leaf_value_);
+  if (num_nodes == 0) {
+    return;
+  }
+  ReadBinaryArray(&buffer, end, num_nodes, &left_child_);
+  ReadBinaryArray(&buffer, end, num_nodes, &right_child_);
+  ReadBinaryArray(&buffer, end, num_nodes, &split_feature_);
+  ReadBinaryArray(&buffer, end, num_nodes, &threshold_);
+  ReadBinaryArray(&buffer, end, num_nodes, &split_gain_);
+  ReadBinaryArray(&buffer, end, num_nodes, &internal_count_);
+  ReadBinaryArray(&buffer, end, num_nodes, &internal_value_);
+  ReadBinaryArray(&buffer, end, num_nodes, &internal_weight_);
+  ReadBinaryArray(&buffer, end, num_leaves_, &leaf_weight_);
+  ReadBinaryArray(&buffer, end, num_leaves_, &leaf_count_);
+  ReadBinaryArray(&buffer, end, num_nodes, &decision_type_);
+  if (num_cat_ > 0) {
+    ReadBinaryArray(&buffer, end, num_cat_ + 1, &cat_boundaries_);
+    if (cat_boundaries_.back() < 0) {
+      Log::Fatal("Binary tree model format error, negative size of categorical bitsets");
+    }
+    ReadBinaryArray(&buffer, end, cat_boundaries_.back(), &cat_threshold_);
+  }
+  max_depth_ = -1;
+  RecomputeObliviousLevels();
+}
+
+size_t Tree::SaveBinaryToFile(const VirtualFileWriter* writer) const {
+  size_t written = writer->Write(&num_leaves_, sizeof(num_leaves_));
+  written += writer->Write(&num_cat_, sizeof(num_cat_));
+  written += writer->Write(&shrinkage_, sizeof(shrinkage_));
+  written += writer->Write(leaf_value_.data(), sizeof(double) * num_leaves_);
+  if (num_leaves_ <= 1) {
+    return written;
+  }
+  const size_t num_nodes = static_cast<size_t>(num_leaves_ - 1);
+  written += writer->Write(left_child_.data(), sizeof(int) * num_nodes);
+  written += writer->Write(right_child_.data(), sizeof(int) * num_nodes);
+  written += writer->Write(split_feature_.data(), sizeof(int) * num_nodes);
+  written += writer->Write(threshold_.data(), sizeof(double) * num_nodes);
+  written += writer->Write(split_gain_.data(), sizeof(float) * num_nodes);
+  written += writer->Write(internal_count_.data(), sizeof(int) * num_nodes);
+  written += writer->Write(internal_value_.data(), sizeof(double) * num_nodes);
+  written += writer->Write(internal_weight_.data(), sizeof(double) * num_nodes);
+  written += writer->Write(leaf_weight_.data(), sizeof(double) * num_leaves_);
+  written += writer->Write(leaf_count_.data(), sizeof(int) * num_leaves_);
+  written += writer->Write(decision_type_.data(), sizeof(int8_t) * num_nodes);
+  if (num_cat_ > 0) {
+    written += writer->Write(cat_boundaries_.data(), sizeof(int) * (num_cat_ + 1));
+    written += writer->Write(cat_threshold_.data(), sizeof(uint32_t) * cat_boundaries_[num_cat_]);
+  }
+  return written;
+}
+
+size_t Tree::SizesInByte() const {
+  size_t ret = sizeof(num_leaves_) + sizeof(num_cat_) + sizeof(shrinkage_) + sizeof(double) * num_leaves_;
+  if (num_leaves_ <= 1) {
+    return ret;
+  }
+  const size_t num_nodes = static_cast<size_t>(num_leaves_ - 1);
+  ret += (sizeof(int) * 4 + sizeof(double) * 3 + sizeof(float) + sizeof(int8_t)) * num_nodes;
+  ret += (sizeof(double) + sizeof(int)) * num_leaves_;
+  if (num_cat_ > 0) {
+    ret += sizeof(int) * (num_cat_ + 1) + sizeof(uint32_t) * cat_boundaries_[num_cat_];
+  }
+  return ret;
 }
 
 void Tree::ExtendPath(PathElement *unique_path, int unique_depth,
@@ -706,8 +941,9 @@ void Tree::TreeSHAP(const double *feature_values, double *phi,
     const int hot_index = Decision(feature_values[split_feature_[node]], node);
     const int cold_index = (hot_index == left_child_[node] ? right_child_[node] : left_child_[node]);
     const double w = data_count(node);
-    const double hot_zero_fraction = data_count(hot_index) / w;
-    const double cold_zero_fraction = data_count(cold_index) / w;
+    // nodes without training data (e.g. of oblivious trees) split their weight evenly
+    const double hot_zero_fraction = w > 0 ? data_count(hot_index) / w : 0.5;
+    const double cold_zero_fraction = w > 0 ? data_count(cold_index) / w : 0.5;
     double incoming_zero_fraction = 1;
     double incoming_one_fraction = 1;
 
@@ -724,11 +960,17 @@ void Tree::TreeSHAP(const double *feature_values, double *phi,
       unique_depth -= 1;
     }
 
-    TreeSHAP(feature_values, phi, hot_index, unique_depth + 1, unique_path,
-             hot_zero_fraction*incoming_zero_fraction, incoming_one_fraction, split_feature_[node]);
+    // a branch without training data adds nothing if the record doesn't go to it,
+    // and would divide by its zero fraction
+    if (hot_zero_fraction*incoming_zero_fraction > 0 || incoming_one_fraction != 0) {
+      TreeSHAP(feature_values, phi, hot_index, unique_depth + 1, unique_path,
+               hot_zero_fraction*incoming_zero_fraction, incoming_one_fraction, split_feature_[node]);
+    }
 
-    TreeSHAP(feature_values, phi, cold_index, unique_depth + 1, unique_path,
-             cold_zero_fraction*incoming_zero_fraction, 0, split_feature_[node]);
+    if (cold_zero_fraction*incoming_zero_fraction > 0) {
+      TreeSHAP(feature_values, phi, cold_index, unique_depth + 1, unique_path,
+               cold_zero_fraction*incoming_zero_fraction, 0, split_feature_[node]);
+    }
   }
 }
 
@@ -758,8 +1000,9 @@ void Tree::TreeSHAPByMap(const std::unordered_map<int, double>& feature_values,
     const int hot_index = Decision(feature_values.count(split_feature_[node]) > 0 ? feature_values.at(split_feature_[node]) : 0.0f, node);
     const int cold_index = (hot_index == left_child_[node] ? right_child_[node] : left_child_[node]);
     const double w = data_count(node);
-    const double hot_zero_fraction = data_count(hot_index) / w;
-    const double cold_zero_fraction = data_count(cold_index) / w;
+    // nodes without training data (e.g. of oblivious trees) split their weight evenly
+    const double hot_zero_fraction = w > 0 ? data_count(hot_index) / w : 0.5;
+    const double cold_zero_fraction = w > 0 ? data_count(cold_index) / w : 0.5;
     double incoming_zero_fraction = 1;
     double incoming_one_fraction = 1;
 
@@ -776,11 +1019,15 @@ void Tree::TreeSHAPByMap(const std::unordered_map<int, double>& feature_values,
       unique_depth -= 1;
     }
 
-    TreeSHAPByMap(feature_values, phi, hot_index, unique_depth + 1, unique_path,
-                  hot_zero_fraction*incoming_zero_fraction, incoming_one_fraction, split_feature_[node]);
+    if (hot_zero_fraction*incoming_zero_fraction > 0 || incoming_one_fraction != 0) {
+      TreeSHAPByMap(feature_values, phi, hot_index, unique_depth + 1, unique_path,
+                    hot_zero_fraction*incoming_zero_fraction, incoming_one_fraction, split_feature_[node]);
+    }
 
-    TreeSHAPByMap(feature_values, phi, cold_index, unique_depth + 1, unique_path,
-                  cold_zero_fraction*incoming_zero_fraction, 0, split_feature_[node]);
+    if (cold_zero_fraction*incoming_zero_fraction > 0) {
+      TreeSHAPByMap(feature_values, phi, cold_index, unique_depth + 1, unique_path,
+                    cold_zero_fraction*incoming_zero_fraction, 0, split_feature_[node]);
+    }
   }
 }
 
@@ -808,4 +1055,44 @@ void Tree::RecomputeMaxDepth() {
   }
 }
 
+void Tree::RecomputeObliviousLevels() {
+  oblivious_nodes_.clear();
+  oblivious_leaves_.clear();
+  if (num_leaves_ <= 1 || (num_leaves_ & (num_leaves_ - 1)) != 0) {
+    return;
+  }
+  // nodes of one depth, children of node at position i are at positions 2 * i and 2 * i + 1
+  std::vector<int> nodes(1, 0);
+  std::vector<int> next_nodes;
+  std::vector<int> level_nodes;
+  while (nodes[0] >= 0) {
+    const int node = nodes[0];
+    if (GetDecisionType(decision_type_[node], kCategoricalMask)) {
+      return;
+    }
+    next_nodes.clear();
+    for (const int cur : nodes) {
+      if (cur < 0 || split_feature_[cur] != split_feature_[node]
+          || threshold_[cur] != threshold_[node]
+          || decision_type_[cur] != decision_type_[node]) {
+        return;
+      }
+      next_nodes.push_back(left_child_[cur]);
+      next_nodes.push_back(right_child_[cur]);
+    }
+    level_nodes.push_back(node);
+    nodes.swap(next_nodes);
+  }
+  for (const int leaf : nodes) {
+    if (leaf >= 0) {
+      return;
+    }
+  }
+  oblivious_nodes_ = level_nodes;
+  oblivious_leaves_.resize(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    oblivious_leaves_[i] = ~nodes[i];
+  }
+}
+
 }  // namespace LightGBM
@@ -12,6 +12,9 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include <vector>
 
 namespace LightGBM {
@@ -169,6 +172,13 @@ class BinaryLogloss: public ObjectiveFunction {
     output[0] = 1.0f / (1.0f + std::exp(-sigmoid_ * input[0]));
   }
 
+  std::string ConvertOutputToC() const override {
+    std::stringstream str_buf;
+    str_buf << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    str_buf << "output[0] = 1.0f / (1.0f + exp(-(" << sigmoid_ << ") * output[0]));";
+    return str_buf.str();
+  }
+
   std::string ToString() const override {
     std::stringstream str_buf;
     str_buf << GetName() << " ";
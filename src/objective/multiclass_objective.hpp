@@ -12,6 +12,9 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include <memory>
 #include <vector>
 
@@ -133,6 +136,17 @@ class MulticlassSoftmax: public ObjectiveFunction {
     Common::Softmax(input, output, num_class_);
   }
 
+  std::string ConvertOutputToC() const override {
+    // same operations as Common::Softmax
+    std::stringstream str_buf;
+    str_buf << "double wmax = output[0];\n";
+    str_buf << "double wsum = 0.0f;\n";
+    str_buf << "for (int i = 1; i < " << num_class_ << "; ++i) { wmax = output[i] < wmax ? wmax : output[i]; }\n";
+    str_buf << "for (int i = 0; i < " << num_class_ << "; ++i) { output[i] = exp(output[i] - wmax); wsum += output[i]; }\n";
+    str_buf << "for (int i = 0; i < " << num_class_ << "; ++i) { output[i] /= wsum; }";
+    return str_buf.str();
+  }
+
   const char* GetName() const override {
     return "multiclass";
   }
@@ -242,6 +256,14 @@ class MulticlassOVA: public ObjectiveFunction {
     }
   }
 
+  std::string ConvertOutputToC() const override {
+    std::stringstream str_buf;
+    str_buf << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    str_buf << "for (int i = 0; i < " << num_class_ << "; ++i) { output[i] = 1.0f / (1.0f + exp(-("
+            << sigmoid_ << ") * output[i])); }";
+    return str_buf.str();
+  }
+
   std::string ToString() const override {
     std::stringstream str_buf;
     str_buf << GetName() << " ";
@@ -77,6 +77,8 @@ class RankingObjective : public ObjectiveFunction {
     return str_buf.str();
   }
 
+  std::string ConvertOutputToC() const override { return ""; }
+
   bool NeedAccuratePrediction() const override { return false; }
 
  protected:
@@ -151,6 +151,13 @@ class RegressionL2loss: public ObjectiveFunction {
     }
   }
 
+  std::string ConvertOutputToC() const override {
+    if (sqrt_) {
+      return "output[0] = ((output[0] > 0.0) - (output[0] < 0.0)) * output[0] * output[0];";
+    }
+    return "";
+  }
+
   std::string ToString() const override {
     std::stringstream str_buf;
     str_buf << GetName();
@@ -459,6 +466,10 @@ class RegressionPoissonLoss: public RegressionL2loss {
     output[0] = std::exp(input[0]);
   }
 
+  std::string ConvertOutputToC() const override {
+    return "output[0] = exp(output[0]);";
+  }
+
   const char* GetName() const override {
     return "poisson";
   }
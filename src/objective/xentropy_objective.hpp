@@ -102,6 +102,10 @@ class CrossEntropy: public ObjectiveFunction {
     output[0] = 1.0f / (1.0f + std::exp(-input[0]));
   }
 
+  std::string ConvertOutputToC() const override {
+    return "output[0] = 1.0f / (1.0f + exp(-output[0]));";
+  }
+
   std::string ToString() const override {
     std::stringstream str_buf;
     str_buf << GetName();
@@ -229,6 +233,10 @@ class CrossEntropyLambda: public ObjectiveFunction {
     output[0] = std::log(1.0f + std::exp(input[0]));
   }
 
+  std::string ConvertOutputToC() const override {
+    return "output[0] = log(1.0f + exp(output[0]));";
+  }
+
   std::string ToString() const override {
     std::stringstream str_buf;
     str_buf << GetName();
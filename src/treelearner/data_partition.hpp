@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include <vector>
 
 namespace LightGBM {
@@ -29,12 +30,14 @@ class DataPartition {
   }
 
   void ResetLeaves(int num_leaves) {
+    ++generation_;
     num_leaves_ = num_leaves;
     leaf_begin_.resize(num_leaves_);
     leaf_count_.resize(num_leaves_);
   }
 
   void ResetNumData(int num_data) {
+    ++generation_;
     num_data_ = num_data;
     indices_.resize(num_data_);
     runner_.ReSize(num_data_);
@@ -47,6 +50,7 @@ class DataPartition {
   * \brief Init, will put all data on the root(leaf_idx = 0)
   */
   void Init() {
+    ++generation_;
     std::fill(leaf_begin_.begin(), leaf_begin_.end(), 0);
     std::fill(leaf_count_.begin(), leaf_count_.end(), 0);
     if (used_data_indices_ == nullptr) {
@@ -97,15 +101,45 @@ class DataPartition {
   * \param feature_bins feature bin data
   * \param threshold threshold that want to split
   * \param right_leaf index of right leaf
+  * \param gradients If not nullptr, gradients of the smaller new leaf are gathered into ordered_gradients
+  *        while the data are partitioned, in the order of its data indices
+  * \param hessians If not nullptr, hessians are gathered into ordered_hessians as well
+  * \return Index of the leaf whose gradients are gathered, -1 if none
   */
-  void Split(int leaf, const Dataset* dataset, int feature,
-             const uint32_t* threshold, int num_threshold, bool default_left,
-             int right_leaf) {
+  int Split(int leaf, const Dataset* dataset, int feature,
+            const uint32_t* threshold, int num_threshold, bool default_left,
+            int right_leaf, const score_t* gradients = nullptr,
+            const score_t* hessians = nullptr,
+            score_t* ordered_gradients = nullptr,
+            score_t* ordered_hessians = nullptr) {
     Common::FunctionTimer fun_timer("DataPartition::Split", global_timer);
+    ++generation_;
     // get leaf boundary
     const data_size_t begin = leaf_begin_[leaf];
     const data_size_t cnt = leaf_count_[leaf];
+    if (cnt <= 0) {
+      // empty leaves only appear in oblivious trees
+      leaf_begin_[right_leaf] = begin;
+      leaf_count_[right_leaf] = 0;
+      return -1;
+    }
     auto left_start = indices_.data() + begin;
+    std::function<void(const data_size_t*, data_size_t, data_size_t)> gather_func = nullptr;
+    if (gradients != nullptr) {
+      gather_func = [=](const data_size_t* indices, data_size_t cur_cnt,
+                        data_size_t pos) {
+        if (hessians != nullptr) {
+          for (data_size_t i = 0; i < cur_cnt; ++i) {
+            ordered_gradients[pos + i] = gradients[indices[i]];
+            ordered_hessians[pos + i] = hessians[indices[i]];
+          }
+        } else {
+          for (data_size_t i = 0; i < cur_cnt; ++i) {
+            ordered_gradients[pos + i] = gradients[indices[i]];
+          }
+        }
+      };
+    }
     const auto left_cnt = runner_.Run<false>(
         cnt,
         [=](int, data_size_t cur_start, data_size_t cur_cnt, data_size_t* left,
@@ -113,10 +147,15 @@ class DataPartition {
           return dataset->Split(feature, threshold, num_threshold, default_left,
                                 left_start + cur_start, cur_cnt, left, right);
         },
-        left_start);
+        left_start, gather_func);
     leaf_count_[leaf] = left_cnt;
     leaf_begin_[right_leaf] = left_cnt + begin;
     leaf_count_[right_leaf] = cnt - left_cnt;
+    if (gradients == nullptr) {
+      return -1;
+    }
+    // same rule as ParallelPartitionRunner::Run
+    return left_cnt < cnt - left_cnt ? leaf : right_leaf;
   }
 
   /*!
@@ -148,6 +187,9 @@ class DataPartition {
   /*! \brief Get number of leaves */
   int num_leaves() const { return num_leaves_; }
 
+  /*! \brief Get generation of the partition, it changes whenever the data of the leaves change */
+  uint64_t generation() const { return generation_; }
+
  private:
   /*! \brief Number of all data */
   data_size_t num_data_;
@@ -163,6 +205,8 @@ class DataPartition {
   const data_size_t* used_data_indices_;
   /*! \brief used data count, used for bagging */
   data_size_t used_data_count_;
+  /*! \brief Number of changes of the partition */
+  uint64_t generation_ = 0;
   ParallelPartitionRunner<data_size_t, true> runner_;
 };
 
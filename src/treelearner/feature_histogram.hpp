@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -73,12 +74,15 @@ class FeatureHistogram {
   hist_t* RawData() { return data_; }
 
   /*!
-   * \brief Subtract current histograms with other
+   * \brief Subtract current histograms with other, in hist_acc_t and rounded once to hist_t.
+   *        Both histograms were rounded to hist_t when stored, so with USE_FLOAT_HIST an entry is
+   *        within 2^-24 * (|this| + |other| + |result|) of the difference of the exact sums
    * \param other The histogram that want to subtract
    */
   void Subtract(const FeatureHistogram& other) {
     for (int i = 0; i < (meta_->num_bin - meta_->offset) * 2; ++i) {
-      data_[i] -= other.data_[i];
+      data_[i] = static_cast<hist_t>(static_cast<hist_acc_t>(data_[i]) -
+                                     static_cast<hist_acc_t>(other.data_[i]));
     }
   }
 
@@ -94,6 +98,87 @@ class FeatureHistogram {
     output->gain *= meta_->penalty;
   }
 
+  /*!
+   * \brief Add the gain of splitting the leaf at each threshold to gains, for oblivious trees whose
+   *        nodes of one depth share the threshold. The gain is relative to not splitting the leaf, it is 0
+   *        for thresholds leaving less than min_data_in_leaf data or min_sum_hessian_in_leaf on a side.
+   *        Missing values go left, as in the reverse scan of FindBestThresholdSequentially
+   * \param gains Gains of the thresholds 0 to num_bin - 2, threshold t puts the bins <= t on the left
+   */
+  void AddObliviousGains(double sum_gradient, double sum_hessian,
+                         data_size_t num_data, double parent_output,
+                         double* gains) const {
+    auto add_gain = [gains](int threshold, bool is_valid, double gain, double,
+                            double, data_size_t, double, double, data_size_t) {
+      if (is_valid) {
+        gains[threshold] += gain;
+      }
+    };
+    if (meta_->config->path_smooth > kEpsilon) {
+      ScanObliviousThresholds<true>(sum_gradient, sum_hessian, num_data,
+                                    parent_output, add_gain);
+    } else {
+      ScanObliviousThresholds<false>(sum_gradient, sum_hessian, num_data,
+                                     parent_output, add_gain);
+    }
+  }
+
+  /*!
+   * \brief Split of the leaf at one threshold of AddObliviousGains. The sums of both sides are set
+   *        even if the split is not valid, then both outputs are parent_output and the gain is 0
+   */
+  void GetObliviousSplit(uint32_t threshold, double sum_gradient,
+                         double sum_hessian, data_size_t num_data,
+                         double parent_output, SplitInfo* output) const {
+    const bool use_smoothing = meta_->config->path_smooth > kEpsilon;
+    const Config* config = meta_->config;
+    auto get_split = [=](int t, bool is_valid, double gain,
+                         double sum_left_gradient, double sum_left_hessian,
+                         data_size_t left_count, double sum_right_gradient,
+                         double sum_right_hessian, data_size_t right_count) {
+      if (t != static_cast<int>(threshold)) {
+        return;
+      }
+      output->threshold = threshold;
+      output->default_left = true;
+      output->monotone_type = 0;
+      output->left_count = left_count;
+      output->right_count = right_count;
+      output->left_sum_gradient = sum_left_gradient;
+      output->left_sum_hessian = sum_left_hessian - kEpsilon;
+      output->right_sum_gradient = sum_right_gradient;
+      output->right_sum_hessian = sum_right_hessian - kEpsilon;
+      if (!is_valid) {
+        output->left_output = parent_output;
+        output->right_output = parent_output;
+        output->gain = 0.0;
+      } else if (use_smoothing) {
+        output->left_output = CalculateSplittedLeafOutput<true, true, true>(
+            sum_left_gradient, sum_left_hessian, config->lambda_l1, config->lambda_l2,
+            config->max_delta_step, config->path_smooth, left_count, parent_output);
+        output->right_output = CalculateSplittedLeafOutput<true, true, true>(
+            sum_right_gradient, sum_right_hessian, config->lambda_l1, config->lambda_l2,
+            config->max_delta_step, config->path_smooth, right_count, parent_output);
+        output->gain = gain;
+      } else {
+        output->left_output = CalculateSplittedLeafOutput<true, true, false>(
+            sum_left_gradient, sum_left_hessian, config->lambda_l1, config->lambda_l2,
+            config->max_delta_step, config->path_smooth, left_count, parent_output);
+        output->right_output = CalculateSplittedLeafOutput<true, true, false>(
+            sum_right_gradient, sum_right_hessian, config->lambda_l1, config->lambda_l2,
+            config->max_delta_step, config->path_smooth, right_count, parent_output);
+        output->gain = gain;
+      }
+    };
+    if (use_smoothing) {
+      ScanObliviousThresholds<true>(sum_gradient, sum_hessian, num_data,
+                                    parent_output, get_split);
+    } else {
+      ScanObliviousThresholds<false>(sum_gradient, sum_hessian, num_data,
+                                     parent_output, get_split);
+    }
+  }
+
   template <bool USE_RAND, bool USE_L1, bool USE_MAX_OUTPUT, bool USE_SMOOTHING>
   double BeforeNumercal(double sum_gradient, double sum_hessian, double parent_output, data_size_t num_data,
                         SplitInfo* output, int* rand_threshold) {
@@ -850,20 +935,143 @@ class FeatureHistogram {
     }
   }
 
-  template <bool USE_RAND, bool USE_MC, bool USE_L1, bool USE_MAX_OUTPUT, bool USE_SMOOTHING,
-            bool REVERSE, bool SKIP_DEFAULT_BIN, bool NA_AS_MISSING>
-  void FindBestThresholdSequentially(double sum_gradient, double sum_hessian,
-                                     data_size_t num_data,
-                                     const ConstraintEntry& constraints,
-                                     double min_gain_shift, SplitInfo* output,
-                                     int rand_threshold, double parent_output) {
+  /*!
+   * \brief Call func for each threshold from num_bin - 2 to 0, with the sums of both sides, used by oblivious trees.
+   *        func(threshold, is_valid, gain, sum_left_gradient, sum_left_hessian, left_count,
+   *        sum_right_gradient, sum_right_hessian, right_count), hessians include kEpsilon
+   */
+  template <bool USE_SMOOTHING, typename FUNC>
+  void ScanObliviousThresholds(double sum_gradient, double sum_hessian,
+                               data_size_t num_data, double parent_output,
+                               const FUNC& func) const {
+    const Config* config = meta_->config;
     const int8_t offset = meta_->offset;
-    double best_sum_left_gradient = NAN;
-    double best_sum_left_hessian = NAN;
-    double best_gain = kMinScore;
-    data_size_t best_left_count = 0;
-    uint32_t best_threshold = static_cast<uint32_t>(meta_->num_bin);
+    const int na_bin = meta_->missing_type == MissingType::NaN ? meta_->num_bin - 1 : -1;
+    const int skip_bin = meta_->missing_type == MissingType::Zero
+                             ? static_cast<int>(meta_->default_bin) : -1;
+    sum_hessian += 2 * kEpsilon;
     const double cnt_factor = num_data / sum_hessian;
+    const double gain_shift = GetLeafGain<true, true, USE_SMOOTHING>(
+        sum_gradient, sum_hessian, config->lambda_l1, config->lambda_l2,
+        config->max_delta_step, config->path_smooth, num_data, parent_output);
+    double sum_right_gradient = 0.0f;
+    double sum_right_hessian = kEpsilon;
+    data_size_t right_count = 0;
+    for (int threshold = meta_->num_bin - 2; threshold >= 0; --threshold) {
+      // missing values stay on the left
+      const int bin = threshold + 1;
+      if (bin != na_bin && bin != skip_bin) {
+        const auto grad = GET_GRAD(data_, bin - offset);
+        const auto hess = GET_HESS(data_, bin - offset);
+        sum_right_gradient += grad;
+        sum_right_hessian += hess;
+        right_count += static_cast<data_size_t>(Common::RoundInt(hess * cnt_factor));
+      }
+      const double sum_left_gradient = sum_gradient - sum_right_gradient;
+      const double sum_left_hessian = sum_hessian - sum_right_hessian;
+      const data_size_t left_count = num_data - right_count;
+      const bool is_valid = left_count >= config->min_data_in_leaf &&
+                            right_count >= config->min_data_in_leaf &&
+                            sum_left_hessian >= config->min_sum_hessian_in_leaf &&
+                            sum_right_hessian >= config->min_sum_hessian_in_leaf;
+      double gain = 0.0;
+      if (is_valid) {
+        gain = (GetLeafGain<true, true, USE_SMOOTHING>(
+                    sum_left_gradient, sum_left_hessian, config->lambda_l1,
+                    config->lambda_l2, config->max_delta_step, config->path_smooth,
+                    left_count, parent_output) +
+                GetLeafGain<true, true, USE_SMOOTHING>(
+                    sum_right_gradient, sum_right_hessian, config->lambda_l1,
+                    config->lambda_l2, config->max_delta_step, config->path_smooth,
+                    right_count, parent_output) -
+                gain_shift) * meta_->penalty;
+      }
+      func(threshold, is_valid, gain, sum_left_gradient, sum_left_hessian,
+           left_count, sum_right_gradient, sum_right_hessian, right_count);
+    }
+  }
+
+  /*! \brief Candidate thresholds of ScanThresholds, whose gains are computed together */
+  struct ThresholdBlock {
+    static const int kSize = 64;
+    double sum_left_gradient[kSize];
+    double sum_left_hessian[kSize];
+    double sum_right_gradient[kSize];
+    double sum_right_hessian[kSize];
+    double l1_left_gradient[kSize];
+    double l1_right_gradient[kSize];
+    double gain[kSize];
+    data_size_t left_count[kSize];
+    uint32_t threshold[kSize];
+    int size = 0;
+  };
+
+  /*!
+  * \brief Compute gains of the thresholds of a block and keep the best one,
+  *        same order and arithmetic as the scalar scan of FindBestThresholdSequentially
+  */
+  template <bool USE_L1>
+  void FindBestThresholdInBlock(ThresholdBlock* block, double min_gain_shift,
+                                double* best_gain, data_size_t* best_left_count,
+                                double* best_sum_left_gradient,
+                                double* best_sum_left_hessian,
+                                uint32_t* best_threshold) {
+    const double l1 = meta_->config->lambda_l1;
+    const double l2 = meta_->config->lambda_l2;
+    const int size = block->size;
+    const double* left_gradient = block->sum_left_gradient;
+    const double* right_gradient = block->sum_right_gradient;
+    if (USE_L1) {
+      // same as ThresholdL1 up to the sign, which doesn't matter for the gain
+      for (int i = 0; i < size; ++i) {
+        const double left = std::fabs(block->sum_left_gradient[i]) - l1;
+        const double right = std::fabs(block->sum_right_gradient[i]) - l1;
+        block->l1_left_gradient[i] = left > 0.0 ? left : 0.0;
+        block->l1_right_gradient[i] = right > 0.0 ? right : 0.0;
+      }
+      left_gradient = block->l1_left_gradient;
+      right_gradient = block->l1_right_gradient;
+    }
+    // same as GetLeafGain without max_delta_step and path smoothing,
+    // without branches so the compiler can vectorize it
+    for (int i = 0; i < size; ++i) {
+      block->gain[i] =
+          (left_gradient[i] * left_gradient[i]) / (block->sum_left_hessian[i] + l2) +
+          (right_gradient[i] * right_gradient[i]) / (block->sum_right_hessian[i] + l2);
+    }
+    for (int i = 0; i < size; ++i) {
+      const double current_gain = block->gain[i];
+      // gain with split is worse than without split
+      if (current_gain <= min_gain_shift) {
+        continue;
+      }
+      // mark to is splittable
+      is_splittable_ = true;
+      // better split point
+      if (current_gain > *best_gain) {
+        *best_left_count = block->left_count[i];
+        *best_sum_left_gradient = block->sum_left_gradient[i];
+        *best_sum_left_hessian = block->sum_left_hessian[i];
+        *best_threshold = block->threshold[i];
+        *best_gain = current_gain;
+      }
+    }
+    block->size = 0;
+  }
+
+  /*!
+  * \brief Call func for each threshold of the sequential scan which satisfies min_data_in_leaf and
+  *        min_sum_hessian_in_leaf, in the order of the scan.
+  *        func(threshold, sum_left_gradient, sum_left_hessian, left_count,
+  *        sum_right_gradient, sum_right_hessian, right_count), hessians include kEpsilon
+  */
+  template <bool REVERSE, bool SKIP_DEFAULT_BIN, bool NA_AS_MISSING, typename FUNC>
+  void ScanThresholds(double sum_gradient, double sum_hessian, data_size_t num_data,
+                      const FUNC& func) const {
+    const int8_t offset = meta_->offset;
+    const double cnt_factor = num_data / sum_hessian;
+    const data_size_t min_data_in_leaf = meta_->config->min_data_in_leaf;
+    const double min_sum_hessian_in_leaf = meta_->config->min_sum_hessian_in_leaf;
     if (REVERSE) {
       double sum_right_gradient = 0.0f;
       double sum_right_hessian = kEpsilon;
@@ -888,51 +1096,24 @@ class FeatureHistogram {
         sum_right_hessian += hess;
         right_count += cnt;
         // if data not enough, or sum hessian too small
-        if (right_count < meta_->config->min_data_in_leaf ||
-            sum_right_hessian < meta_->config->min_sum_hessian_in_leaf) {
+        if (right_count < min_data_in_leaf ||
+            sum_right_hessian < min_sum_hessian_in_leaf) {
           continue;
         }
         data_size_t left_count = num_data - right_count;
         // if data not enough
-        if (left_count < meta_->config->min_data_in_leaf) {
+        if (left_count < min_data_in_leaf) {
           break;
         }
 
         double sum_left_hessian = sum_hessian - sum_right_hessian;
         // if sum hessian too small
-        if (sum_left_hessian < meta_->config->min_sum_hessian_in_leaf) {
+        if (sum_left_hessian < min_sum_hessian_in_leaf) {
           break;
         }
-
-        double sum_left_gradient = sum_gradient - sum_right_gradient;
-        if (USE_RAND) {
-          if (t - 1 + offset != rand_threshold) {
-            continue;
-          }
-        }
-        // current split gain
-        double current_gain = GetSplitGains<USE_MC, USE_L1, USE_MAX_OUTPUT, USE_SMOOTHING>(
-            sum_left_gradient, sum_left_hessian, sum_right_gradient,
-            sum_right_hessian, meta_->config->lambda_l1,
-            meta_->config->lambda_l2, meta_->config->max_delta_step,
-            constraints, meta_->monotone_type, meta_->config->path_smooth,
-            left_count, right_count, parent_output);
-        // gain with split is worse than without split
-        if (current_gain <= min_gain_shift) {
-          continue;
-        }
-
-        // mark to is splittable
-        is_splittable_ = true;
-        // better split point
-        if (current_gain > best_gain) {
-          best_left_count = left_count;
-          best_sum_left_gradient = sum_left_gradient;
-          best_sum_left_hessian = sum_left_hessian;
-          // left is <= threshold, right is > threshold.  so this is t-1
-          best_threshold = static_cast<uint32_t>(t - 1 + offset);
-          best_gain = current_gain;
-        }
+        // left is <= threshold, right is > threshold.  so this is t-1
+        func(t - 1 + offset, sum_gradient - sum_right_gradient, sum_left_hessian, left_count,
+             sum_right_gradient, sum_right_hessian, right_count);
       }
     } else {
       double sum_left_gradient = 0.0f;
@@ -973,51 +1154,97 @@ class FeatureHistogram {
               Common::RoundInt(GET_HESS(data_, t) * cnt_factor));
         }
         // if data not enough, or sum hessian too small
-        if (left_count < meta_->config->min_data_in_leaf ||
-            sum_left_hessian < meta_->config->min_sum_hessian_in_leaf) {
+        if (left_count < min_data_in_leaf ||
+            sum_left_hessian < min_sum_hessian_in_leaf) {
           continue;
         }
         data_size_t right_count = num_data - left_count;
         // if data not enough
-        if (right_count < meta_->config->min_data_in_leaf) {
+        if (right_count < min_data_in_leaf) {
           break;
         }
 
         double sum_right_hessian = sum_hessian - sum_left_hessian;
         // if sum hessian too small
-        if (sum_right_hessian < meta_->config->min_sum_hessian_in_leaf) {
+        if (sum_right_hessian < min_sum_hessian_in_leaf) {
           break;
         }
+        func(t + offset, sum_left_gradient, sum_left_hessian, left_count,
+             sum_gradient - sum_left_gradient, sum_right_hessian, right_count);
+      }
+    }
+  }
 
-        double sum_right_gradient = sum_gradient - sum_left_gradient;
-        if (USE_RAND) {
-          if (t + offset != rand_threshold) {
-            continue;
-          }
-        }
-        // current split gain
-        double current_gain = GetSplitGains<USE_MC, USE_L1, USE_MAX_OUTPUT, USE_SMOOTHING>(
-            sum_left_gradient, sum_left_hessian, sum_right_gradient,
-            sum_right_hessian, meta_->config->lambda_l1,
-            meta_->config->lambda_l2, meta_->config->max_delta_step,
-            constraints, meta_->monotone_type, meta_->config->path_smooth, left_count,
-            right_count, parent_output);
-        // gain with split is worse than without split
-        if (current_gain <= min_gain_shift) {
-          continue;
-        }
+  template <bool USE_RAND, bool USE_MC, bool USE_L1, bool USE_MAX_OUTPUT, bool USE_SMOOTHING,
+            bool REVERSE, bool SKIP_DEFAULT_BIN, bool NA_AS_MISSING>
+  void FindBestThresholdSequentially(double sum_gradient, double sum_hessian,
+                                     data_size_t num_data,
+                                     const ConstraintEntry& constraints,
+                                     double min_gain_shift, SplitInfo* output,
+                                     int rand_threshold, double parent_output) {
+    double best_sum_left_gradient = NAN;
+    double best_sum_left_hessian = NAN;
+    double best_gain = kMinScore;
+    data_size_t best_left_count = 0;
+    uint32_t best_threshold = static_cast<uint32_t>(meta_->num_bin);
+    if (!USE_RAND && !USE_MC && !USE_MAX_OUTPUT && !USE_SMOOTHING) {
+      // gains only depend on the sums, they are computed by blocks in a loop without branches
+      ThresholdBlock block;
+      ScanThresholds<REVERSE, SKIP_DEFAULT_BIN, NA_AS_MISSING>(
+          sum_gradient, sum_hessian, num_data,
+          [&](int threshold, double sum_left_gradient, double sum_left_hessian,
+              data_size_t left_count, double sum_right_gradient,
+              double sum_right_hessian, data_size_t) {
+            const int i = block.size++;
+            block.sum_left_gradient[i] = sum_left_gradient;
+            block.sum_left_hessian[i] = sum_left_hessian;
+            block.sum_right_gradient[i] = sum_right_gradient;
+            block.sum_right_hessian[i] = sum_right_hessian;
+            block.left_count[i] = left_count;
+            block.threshold[i] = static_cast<uint32_t>(threshold);
+            if (block.size == ThresholdBlock::kSize) {
+              FindBestThresholdInBlock<USE_L1>(&block, min_gain_shift, &best_gain,
+                                               &best_left_count, &best_sum_left_gradient,
+                                               &best_sum_left_hessian, &best_threshold);
+            }
+          });
+      FindBestThresholdInBlock<USE_L1>(&block, min_gain_shift, &best_gain,
+                                       &best_left_count, &best_sum_left_gradient,
+                                       &best_sum_left_hessian, &best_threshold);
+    } else {
+      ScanThresholds<REVERSE, SKIP_DEFAULT_BIN, NA_AS_MISSING>(
+          sum_gradient, sum_hessian, num_data,
+          [&](int threshold, double sum_left_gradient, double sum_left_hessian,
+              data_size_t left_count, double sum_right_gradient,
+              double sum_right_hessian, data_size_t right_count) {
+            if (USE_RAND) {
+              if (threshold != rand_threshold) {
+                return;
+              }
+            }
+            // current split gain
+            double current_gain = GetSplitGains<USE_MC, USE_L1, USE_MAX_OUTPUT, USE_SMOOTHING>(
+                sum_left_gradient, sum_left_hessian, sum_right_gradient,
+                sum_right_hessian, meta_->config->lambda_l1,
+                meta_->config->lambda_l2, meta_->config->max_delta_step,
+                constraints, meta_->monotone_type, meta_->config->path_smooth,
+                left_count, right_count, parent_output);
+            // gain with split is worse than without split
+            if (current_gain <= min_gain_shift) {
+              return;
+            }
 
-        // mark to is splittable
-        is_splittable_ = true;
-        // better split point
-        if (current_gain > best_gain) {
-          best_left_count = left_count;
-          best_sum_left_gradient = sum_left_gradient;
-          best_sum_left_hessian = sum_left_hessian;
-          best_threshold = static_cast<uint32_t>(t + offset);
-          best_gain = current_gain;
-        }
-      }
+            // mark to is splittable
+            is_splittable_ = true;
+            // better split point
+            if (current_gain > best_gain) {
+              best_left_count = left_count;
+              best_sum_left_gradient = sum_left_gradient;
+              best_sum_left_hessian = sum_left_hessian;
+              best_threshold = static_cast<uint32_t>(threshold);
+              best_gain = current_gain;
+            }
+          });
     }
 
     if (is_splittable_ && best_gain > output->gain + min_gain_shift) {
@@ -1104,6 +1331,9 @@ class HistogramPool {
       std::fill(mapper_.begin(), mapper_.end(), -1);
       std::fill(inverse_mapper_.begin(), inverse_mapper_.end(), -1);
       std::fill(last_used_time_.begin(), last_used_time_.end(), 0);
+      compressed_.clear();
+      compressed_.resize(total_size_);
+      compressed_size_ = 0;
     }
   }
   template <bool USE_DATA, bool USE_CONFIG>
@@ -1187,6 +1417,7 @@ class HistogramPool {
       Log::Info("Total Bins %d", bin_cnt_over_features);
     }
     int old_cache_size = static_cast<int>(pool_.size());
+    SetCompressedSize(config);
     Reset(cache_size, total_size);
 
     if (cache_size > old_cache_size) {
@@ -1212,6 +1443,7 @@ class HistogramPool {
 
   void ResetConfig(const Dataset* train_data, const Config* config) {
     CHECK_GT(train_data->num_features(), 0);
+    SetCompressedSize(config);
     const Config* old_config = feature_metas_[0].config;
     SetFeatureInfo<false, true>(train_data, config, &feature_metas_);
     // if need to reset the function pointers
@@ -1252,12 +1484,15 @@ class HistogramPool {
       last_used_time_[slot] = ++cur_time_;
 
       // reset previous mapper
-      if (inverse_mapper_[slot] >= 0) mapper_[inverse_mapper_[slot]] = -1;
+      if (inverse_mapper_[slot] >= 0) {
+        Compress(slot, inverse_mapper_[slot]);
+        mapper_[inverse_mapper_[slot]] = -1;
+      }
 
       // update current mapper
       mapper_[idx] = slot;
       inverse_mapper_[slot] = idx;
-      return false;
+      return Restore(idx, slot);
     }
   }
 
@@ -1272,6 +1507,9 @@ class HistogramPool {
       return;
     }
     if (mapper_[src_idx] < 0) {
+      if (!compressed_[src_idx].values.empty()) {
+        std::swap(compressed_[src_idx], compressed_[dst_idx]);
+      }
       return;
     }
     // get slot of src idx
@@ -1286,6 +1524,89 @@ class HistogramPool {
   }
 
  private:
+  /*! \brief Histograms of a leaf evicted from the pool, without the empty bins */
+  struct CompressedHistogram {
+    std::vector<uint32_t> bins;
+    std::vector<hist_t> values;
+    std::vector<int8_t> is_splittable;
+
+    /*! \brief Memory held by the vectors, which may be more than they use */
+    size_t SizeInByte() const {
+      return bins.capacity() * sizeof(uint32_t) + values.capacity() * sizeof(hist_t) +
+             is_splittable.capacity() * sizeof(int8_t);
+    }
+  };
+
+  void SetCompressedSize(const Config* config) {
+    if (config->histogram_pool_size <= 0 || config->compressed_histogram_pool_size == 0) {
+      max_compressed_size_ = 0;
+    } else if (config->compressed_histogram_pool_size < 0) {
+      max_compressed_size_ = std::numeric_limits<size_t>::max();
+    } else {
+      max_compressed_size_ = static_cast<size_t>(config->compressed_histogram_pool_size * 1024 * 1024);
+    }
+  }
+
+  /*!
+  * \brief Keep the histograms of leaf idx in slot in compressed form, if there is enough space
+  */
+  void Compress(int slot, int idx) {
+    if (max_compressed_size_ == 0) {
+      return;
+    }
+    const hist_t* data = data_[slot].data();
+    const int num_bin = static_cast<int>(data_[slot].size() / 2);
+    const int num_feature = static_cast<int>(feature_metas_.size());
+    size_t num_used_bin = 0;
+    for (int i = 0; i < num_bin; ++i) {
+      num_used_bin += data[i * 2] != 0.0f || data[i * 2 + 1] != 0.0f;
+    }
+    // check the space before allocating, the vectors are then allocated to their exact sizes
+    const size_t size = num_used_bin * (sizeof(uint32_t) + 2 * sizeof(hist_t)) +
+                        num_feature * sizeof(int8_t);
+    if (num_used_bin == 0 || compressed_size_ + size > max_compressed_size_) {
+      return;
+    }
+    CompressedHistogram& compressed = compressed_[idx];
+    compressed.bins.reserve(num_used_bin);
+    compressed.values.reserve(num_used_bin * 2);
+    compressed.is_splittable.reserve(num_feature);
+    for (int i = 0; i < num_bin; ++i) {
+      if (data[i * 2] != 0.0f || data[i * 2 + 1] != 0.0f) {
+        compressed.bins.push_back(static_cast<uint32_t>(i));
+        compressed.values.push_back(data[i * 2]);
+        compressed.values.push_back(data[i * 2 + 1]);
+      }
+    }
+    for (int j = 0; j < num_feature; ++j) {
+      compressed.is_splittable.push_back(pool_[slot][j].is_splittable());
+    }
+    compressed_size_ += compressed.SizeInByte();
+  }
+
+  /*!
+  * \brief Restore the histograms of leaf idx into slot
+  * \return True if leaf idx had compressed histograms
+  */
+  bool Restore(int idx, int slot) {
+    if (max_compressed_size_ == 0 || compressed_[idx].values.empty()) {
+      return false;
+    }
+    CompressedHistogram& compressed = compressed_[idx];
+    hist_t* data = data_[slot].data();
+    std::fill(data_[slot].begin(), data_[slot].end(), 0.0f);
+    for (size_t i = 0; i < compressed.bins.size(); ++i) {
+      data[compressed.bins[i] * 2] = compressed.values[i * 2];
+      data[compressed.bins[i] * 2 + 1] = compressed.values[i * 2 + 1];
+    }
+    for (size_t j = 0; j < compressed.is_splittable.size(); ++j) {
+      pool_[slot][j].set_is_splittable(compressed.is_splittable[j] != 0);
+    }
+    compressed_size_ -= compressed.SizeInByte();
+    compressed = CompressedHistogram();
+    return true;
+  }
+
   std::vector<std::unique_ptr<FeatureHistogram[]>> pool_;
   std::vector<
       std::vector<hist_t, Common::AlignmentAllocator<hist_t, kAlignedSize>>>
@@ -1298,6 +1619,10 @@ class HistogramPool {
   std::vector<int> inverse_mapper_;
   std::vector<int> last_used_time_;
   int cur_time_ = 0;
+  /*! \brief Compressed histograms of the leaves evicted from the pool */
+  std::vector<CompressedHistogram> compressed_;
+  size_t compressed_size_ = 0;
+  size_t max_compressed_size_ = 0;
 };
 
 }  // namespace LightGBM
@@ -295,7 +295,7 @@ void GPUTreeLearner::AllocateGPUMemory() {
   device_data_indices_ = std::unique_ptr<boost::compute::vector<data_size_t>>(new boost::compute::vector<data_size_t>(allocated_num_data_, ctx_));
   boost::compute::fill(device_data_indices_->begin(), device_data_indices_->end(), 0, queue_);
   // histogram bin entry size depends on the precision (single/double)
-  hist_bin_entry_sz_ = config_->gpu_use_dp ? sizeof(hist_t) * 2 : sizeof(gpu_hist_t) * 2;
+  hist_bin_entry_sz_ = config_->gpu_use_dp ? sizeof(double) * 2 : sizeof(gpu_hist_t) * 2;
   Log::Info("Size of histogram bin entry: %d", hist_bin_entry_sz_);
   // create output buffer, each feature has a histogram with device_bin_size_ bins,
   // each work group generates a sub-histogram of dword_features_ features.
@@ -981,7 +981,7 @@ void GPUTreeLearner::ConstructHistograms(const std::vector<int8_t>& is_feature_u
   if (is_gpu_used) {
     if (config_->gpu_use_dp) {
       // use double precision
-      WaitAndGetHistograms<hist_t>(ptr_smaller_leaf_hist_data);
+      WaitAndGetHistograms<double>(ptr_smaller_leaf_hist_data);
     } else {
       // use single precision
       WaitAndGetHistograms<gpu_hist_t>(ptr_smaller_leaf_hist_data);
@@ -1046,7 +1046,7 @@ void GPUTreeLearner::ConstructHistograms(const std::vector<int8_t>& is_feature_u
     if (is_gpu_used) {
       if (config_->gpu_use_dp) {
         // use double precision
-        WaitAndGetHistograms<hist_t>(ptr_larger_leaf_hist_data);
+        WaitAndGetHistograms<double>(ptr_larger_leaf_hist_data);
       } else {
         // use single precision
         WaitAndGetHistograms<gpu_hist_t>(ptr_larger_leaf_hist_data);
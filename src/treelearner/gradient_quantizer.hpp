@@ -0,0 +1,146 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+#ifndef LIGHTGBM_TREELEARNER_GRADIENT_QUANTIZER_HPP_
+#define LIGHTGBM_TREELEARNER_GRADIENT_QUANTIZER_HPP_
+
+#include <LightGBM/config.h>
+#include <LightGBM/meta.h>
+#include <LightGBM/utils/common.h>
+#include <LightGBM/utils/log.h>
+#include <LightGBM/utils/openmp_wrapper.h>
+#include <LightGBM/utils/random.h>
+#include <LightGBM/utils/threading.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace LightGBM {
+
+/*!
+* \brief Quantizes gradients and hessians of each iteration to small integers, used by
+*        histogram construction with integer accumulators (see Dataset::ConstructIntHistograms).
+*        Gradients are in [-num_grad_quant_bins / 2, num_grad_quant_bins / 2] units of grad_scale,
+*        hessians are in [0, num_grad_quant_bins] units of hess_scale.
+*/
+class GradientQuantizer {
+ public:
+  explicit GradientQuantizer(const Config* config) : config_(config) {}
+
+  void ResetConfig(const Config* config) {
+    config_ = config;
+  }
+
+  /*!
+  * \brief Allocate buffers for num_data data
+  */
+  void Init(data_size_t num_data) {
+    num_data_ = num_data;
+    int_grad_hess_.resize(num_data_);
+    ordered_int_grad_hess_.resize(num_data_);
+    gradients_.resize(num_data_);
+    hessians_.resize(num_data_);
+    const size_t num_rand_blocks = static_cast<size_t>((num_data_ + kRandBlock - 1) / kRandBlock);
+    for (size_t i = rands_.size(); i < num_rand_blocks; ++i) {
+      rands_.emplace_back(config_->seed + static_cast<int>(i));
+    }
+  }
+
+  /*!
+  * \brief Quantize gradients and hessians of the current iteration
+  * \param gradients Gradients of num_data data
+  * \param hessians Hessians of num_data data
+  */
+  void Quantize(const score_t* gradients, const score_t* hessians) {
+    const int num_bins = config_->num_grad_quant_bins;
+    if (static_cast<int64_t>(num_data_) * num_bins >= (static_cast<int64_t>(1) << 31)) {
+      Log::Fatal("Number of data (%d) times num_grad_quant_bins (%d) must be less than 2^31 with use_quantized_grad",
+                 num_data_, num_bins);
+    }
+    const int num_threads = OMP_NUM_THREADS();
+    std::vector<score_t> block_max_abs_grad(num_threads, 0.0f);
+    std::vector<score_t> block_max_hess(num_threads, 0.0f);
+    std::vector<score_t> block_min_hess(num_threads, 0.0f);
+    Threading::For<data_size_t>(0, num_data_, 1024, [&] (int block, data_size_t start, data_size_t end) {
+      score_t max_abs_grad = 0.0f;
+      score_t max_hess = 0.0f;
+      score_t min_hess = 0.0f;
+      for (data_size_t i = start; i < end; ++i) {
+        max_abs_grad = std::max(max_abs_grad, std::fabs(gradients[i]));
+        max_hess = std::max(max_hess, hessians[i]);
+        min_hess = std::min(min_hess, hessians[i]);
+      }
+      block_max_abs_grad[block] = max_abs_grad;
+      block_max_hess[block] = max_hess;
+      block_min_hess[block] = min_hess;
+    });
+    const score_t max_abs_grad = *std::max_element(block_max_abs_grad.begin(), block_max_abs_grad.end());
+    const score_t max_hess = *std::max_element(block_max_hess.begin(), block_max_hess.end());
+    if (*std::min_element(block_min_hess.begin(), block_min_hess.end()) < 0.0f) {
+      Log::Fatal("Hessians must be non-negative with use_quantized_grad");
+    }
+    const int max_int_grad = num_bins / 2;
+    const int max_int_hess = num_bins;
+    grad_scale_ = max_abs_grad > 0.0f ? static_cast<double>(max_abs_grad) / max_int_grad : 1.0;
+    hess_scale_ = max_hess > 0.0f ? static_cast<double>(max_hess) / max_int_hess : 1.0;
+    const double inv_grad_scale = 1.0 / grad_scale_;
+    const double inv_hess_scale = 1.0 / hess_scale_;
+    const bool stochastic_rounding = config_->stochastic_rounding;
+    const int num_rand_blocks = static_cast<int>((num_data_ + kRandBlock - 1) / kRandBlock);
+    #pragma omp parallel for schedule(static)
+    for (int block = 0; block < num_rand_blocks; ++block) {
+      const data_size_t start = block * kRandBlock;
+      const data_size_t end = std::min(start + kRandBlock, num_data_);
+      for (data_size_t i = start; i < end; ++i) {
+        const double grad_offset = stochastic_rounding ? rands_[block].NextFloat() : 0.5;
+        const double hess_offset = stochastic_rounding ? rands_[block].NextFloat() : 0.5;
+        int int_grad = static_cast<int>(std::floor(gradients[i] * inv_grad_scale + grad_offset));
+        int int_hess = static_cast<int>(std::floor(hessians[i] * inv_hess_scale + hess_offset));
+        int_grad = std::max(-max_int_grad, std::min(max_int_grad, int_grad));
+        int_hess = std::max(0, std::min(max_int_hess, int_hess));
+        // gradient in the high byte, hessian in the low byte
+        int_grad_hess_[i] = static_cast<int16_t>(int_grad * 256 + int_hess);
+        gradients_[i] = static_cast<score_t>(int_grad * grad_scale_);
+        hessians_[i] = static_cast<score_t>(int_hess * hess_scale_);
+      }
+    }
+  }
+
+  /*! \brief Quantized gradient and hessian of each data, see PackIntGradHess */
+  const int16_t* int_grad_hess() const { return int_grad_hess_.data(); }
+
+  /*! \brief Buffer for the quantized values ordered by the data indices of a leaf */
+  int16_t* ordered_int_grad_hess() { return ordered_int_grad_hess_.data(); }
+
+  /*! \brief Quantized gradients as score_t, consistent with the histograms */
+  const score_t* gradients() const { return gradients_.data(); }
+
+  /*! \brief Quantized hessians as score_t, consistent with the histograms */
+  const score_t* hessians() const { return hessians_.data(); }
+
+  double grad_scale() const { return grad_scale_; }
+
+  double hess_scale() const { return hess_scale_; }
+
+  /*! \brief Max of absolute quantized gradient and quantized hessian of one data */
+  int max_int_grad_hess() const { return config_->num_grad_quant_bins; }
+
+ private:
+  /*! \brief Number of data sharing one random generator, so results don't depend on the number of threads */
+  static const data_size_t kRandBlock = 1024;
+
+  const Config* config_;
+  data_size_t num_data_ = 0;
+  std::vector<int16_t, Common::AlignmentAllocator<int16_t, kAlignedSize>> int_grad_hess_;
+  std::vector<int16_t, Common::AlignmentAllocator<int16_t, kAlignedSize>> ordered_int_grad_hess_;
+  std::vector<score_t, Common::AlignmentAllocator<score_t, kAlignedSize>> gradients_;
+  std::vector<score_t, Common::AlignmentAllocator<score_t, kAlignedSize>> hessians_;
+  std::vector<Random> rands_;
+  double grad_scale_ = 1.0;
+  double hess_scale_ = 1.0;
+};
+
+}  // namespace LightGBM
+#endif   // LIGHTGBM_TREELEARNER_GRADIENT_QUANTIZER_HPP_
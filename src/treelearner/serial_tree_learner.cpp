@@ -59,6 +59,11 @@ void SerialTreeLearner::Init(const Dataset* train_data, bool is_constant_hessian
   ordered_gradients_.resize(num_data_);
   ordered_hessians_.resize(num_data_);
 
+  if (config_->use_quantized_grad) {
+    gradient_quantizer_.reset(new GradientQuantizer(config_));
+    gradient_quantizer_->Init(num_data_);
+  }
+
   GetShareStates(train_data_, is_constant_hessian, true);
   histogram_pool_.DynamicChangeSize(train_data_, share_state_->is_colwise, config_, max_cache_size, config_->num_leaves);
   Log::Info("Number of data points in the train set: %d, number of used features: %d", num_data_, num_features_);
@@ -108,6 +113,9 @@ void SerialTreeLearner::ResetTrainingDataInner(const Dataset* train_data,
   // initialize ordered gradients and hessians
   ordered_gradients_.resize(num_data_);
   ordered_hessians_.resize(num_data_);
+  if (gradient_quantizer_ != nullptr) {
+    gradient_quantizer_->Init(num_data_);
+  }
   if (cegb_ != nullptr) {
     cegb_->Init();
   }
@@ -146,6 +154,15 @@ void SerialTreeLearner::ResetConfig(const Config* config) {
     }
     cegb_->Init();
   }
+  if (config_->use_quantized_grad) {
+    if (gradient_quantizer_ == nullptr) {
+      gradient_quantizer_.reset(new GradientQuantizer(config_));
+    }
+    gradient_quantizer_->ResetConfig(config_);
+    gradient_quantizer_->Init(num_data_);
+  } else {
+    gradient_quantizer_.reset(nullptr);
+  }
   constraints_.reset(LeafConstraintsBase::Create(config_, config_->num_leaves));
 }
 
@@ -153,6 +170,12 @@ Tree* SerialTreeLearner::Train(const score_t* gradients, const score_t *hessians
   Common::FunctionTimer fun_timer("SerialTreeLearner::Train", global_timer);
   gradients_ = gradients;
   hessians_ = hessians;
+  if (gradient_quantizer_ != nullptr) {
+    // leaf sums and outputs use the quantized values, so that they agree with the histograms
+    gradient_quantizer_->Quantize(gradients, hessians);
+    gradients_ = gradient_quantizer_->gradients();
+    hessians_ = gradient_quantizer_->hessians();
+  }
   int num_threads = OMP_NUM_THREADS();
   if (share_state_->num_threads != num_threads && share_state_->num_threads > 0) {
     Log::Warning(
@@ -164,6 +187,10 @@ Tree* SerialTreeLearner::Train(const score_t* gradients, const score_t *hessians
 
   // some initial works before training
   BeforeTrain();
+  is_leaf_batch_ = config_->leaf_batch_size > 1 && share_state_->is_colwise &&
+                   gradient_quantizer_ == nullptr && cegb_ == nullptr &&
+                   config_->histogram_pool_size <= 0 &&
+                   config_->monotone_constraints.empty();
 
   bool track_branch_features = !(config_->interaction_constraints_vector.empty());
   auto tree = std::unique_ptr<Tree>(new Tree(config_->num_leaves, track_branch_features));
@@ -176,8 +203,20 @@ Tree* SerialTreeLearner::Train(const score_t* gradients, const score_t *hessians
   // only root leaf can be splitted on first time
   int right_leaf = -1;
 
+  if (config_->tree_growth_policy == std::string("oblivious")) {
+    GrowOblivious(tree_ptr);
+    tree->RecomputeObliviousLevels();
+    Log::Debug("Trained an oblivious tree with leaves = %d", tree->num_leaves());
+    return tree.release();
+  }
+
   int init_splits = ForceSplits(tree_ptr, &left_leaf, &right_leaf, &cur_depth);
 
+  if (is_leaf_batch_) {
+    GrowByLeafBatches(tree_ptr, left_leaf, right_leaf, &cur_depth);
+    Log::Debug("Trained a tree with leaves = %d and max_depth = %d", tree->num_leaves(), cur_depth);
+    return tree.release();
+  }
   for (int split = init_splits; split < config_->num_leaves - 1; ++split) {
     // some initial works before finding best split
     if (BeforeFindBestSplit(tree_ptr, left_leaf, right_leaf)) {
@@ -313,7 +352,304 @@ bool SerialTreeLearner::BeforeFindBestSplit(const Tree* tree, int left_leaf, int
   return true;
 }
 
-void SerialTreeLearner::FindBestSplits(const Tree* tree) {
+void SerialTreeLearner::GrowByLeafBatches(Tree* tree, int left_leaf,
+                                          int right_leaf, int* cur_depth) {
+  if (BeforeFindBestSplit(tree, left_leaf, right_leaf)) {
+    FindBestSplits(tree);
+  }
+  std::vector<int> candidates;
+  std::vector<std::pair<int, int>> leaf_pairs;
+  std::vector<std::pair<LeafSplits, LeafSplits>> leaf_splits;
+  while (tree->num_leaves() < config_->num_leaves) {
+    candidates.clear();
+    for (int leaf = 0; leaf < tree->num_leaves(); ++leaf) {
+      if (best_split_per_leaf_[leaf].gain > 0.0) {
+        candidates.push_back(leaf);
+      }
+    }
+    // cannot split, quit
+    if (candidates.empty()) {
+      int best_leaf = static_cast<int>(ArrayArgs<SplitInfo>::ArgMax(best_split_per_leaf_));
+      Log::Warning("No further splits with positive gain, best gain: %f", best_split_per_leaf_[best_leaf].gain);
+      break;
+    }
+    const int num_splits = std::min(
+        {config_->leaf_batch_size, config_->num_leaves - tree->num_leaves(),
+         static_cast<int>(candidates.size())});
+    std::partial_sort(candidates.begin(), candidates.begin() + num_splits,
+                      candidates.end(), [this](int a, int b) {
+                        if (best_split_per_leaf_[a] > best_split_per_leaf_[b]) {
+                          return true;
+                        }
+                        return !(best_split_per_leaf_[b] > best_split_per_leaf_[a]) && a < b;
+                      });
+    // split the leaves with the largest gains, their new leaves are found together
+    leaf_pairs.clear();
+    leaf_splits.clear();
+    for (int i = 0; i < num_splits; ++i) {
+      Split(tree, candidates[i], &left_leaf, &right_leaf);
+      *cur_depth = std::max(*cur_depth, tree->leaf_depth(left_leaf));
+      leaf_pairs.emplace_back(left_leaf, right_leaf);
+      leaf_splits.emplace_back(*smaller_leaf_splits_, *larger_leaf_splits_);
+    }
+    FindBestSplitsForLeaves(tree, leaf_pairs, leaf_splits);
+  }
+}
+
+void SerialTreeLearner::FindBestSplitsForLeaves(
+    const Tree* tree, const std::vector<std::pair<int, int>>& leaf_pairs,
+    const std::vector<std::pair<LeafSplits, LeafSplits>>& leaf_splits) {
+  const int num_pairs = static_cast<int>(leaf_pairs.size());
+  std::vector<int8_t> is_valid(num_pairs, 0);
+  std::vector<int8_t> use_subtract(num_pairs, 0);
+  std::vector<FeatureHistogram*> smaller_histogram_array(num_pairs, nullptr);
+  std::vector<FeatureHistogram*> larger_histogram_array(num_pairs, nullptr);
+  std::vector<std::vector<int8_t>> is_feature_used(num_pairs);
+  std::vector<Dataset::HistogramLeaf> histogram_leaves;
+  for (int i = 0; i < num_pairs; ++i) {
+    *smaller_leaf_splits_ = leaf_splits[i].first;
+    *larger_leaf_splits_ = leaf_splits[i].second;
+    if (!BeforeFindBestSplit(tree, leaf_pairs[i].first, leaf_pairs[i].second)) {
+      continue;
+    }
+    is_valid[i] = 1;
+    use_subtract[i] = parent_leaf_histogram_array_ != nullptr;
+    smaller_histogram_array[i] = smaller_leaf_histogram_array_;
+    larger_histogram_array[i] = larger_leaf_histogram_array_;
+    is_feature_used[i] = GetUsedFeatures();
+    // the data of the leaves don't overlap, so neither do their ordered gradients
+    const data_size_t smaller_begin =
+        data_partition_->leaf_begin(smaller_leaf_splits_->leaf_index());
+    histogram_leaves.push_back(
+        {&is_feature_used[i], smaller_leaf_splits_->data_indices(),
+         smaller_leaf_splits_->num_data_in_leaf(),
+         ordered_gradients_.data() + smaller_begin,
+         ordered_hessians_.data() + smaller_begin,
+         smaller_leaf_histogram_array_[0].RawData() - kHistOffset});
+    if (larger_leaf_histogram_array_ != nullptr && !use_subtract[i]) {
+      const data_size_t larger_begin =
+          data_partition_->leaf_begin(larger_leaf_splits_->leaf_index());
+      histogram_leaves.push_back(
+          {&is_feature_used[i], larger_leaf_splits_->data_indices(),
+           larger_leaf_splits_->num_data_in_leaf(),
+           ordered_gradients_.data() + larger_begin,
+           ordered_hessians_.data() + larger_begin,
+           larger_leaf_histogram_array_[0].RawData() - kHistOffset});
+    }
+  }
+  {
+    Common::FunctionTimer fun_timer("SerialTreeLearner::ConstructHistograms",
+                                    global_timer);
+    train_data_->ConstructHistogramsForLeaves(histogram_leaves, gradients_,
+                                              hessians_, share_state_.get());
+  }
+  for (int i = 0; i < num_pairs; ++i) {
+    if (!is_valid[i]) {
+      continue;
+    }
+    *smaller_leaf_splits_ = leaf_splits[i].first;
+    *larger_leaf_splits_ = leaf_splits[i].second;
+    smaller_leaf_histogram_array_ = smaller_histogram_array[i];
+    larger_leaf_histogram_array_ = larger_histogram_array[i];
+    FindBestSplitsFromHistograms(is_feature_used[i], use_subtract[i] != 0, tree);
+  }
+}
+
+void SerialTreeLearner::GrowOblivious(Tree* tree) {
+  // the largest depth with 2^depth <= num_leaves
+  int max_depth = 0;
+  while ((2 << max_depth) <= config_->num_leaves) {
+    ++max_depth;
+  }
+  if (config_->max_depth > 0) {
+    max_depth = std::min(max_depth, config_->max_depth);
+  }
+  const std::vector<int8_t>& is_feature_used = col_sampler_.is_feature_used_bytree();
+  // leaves of the current depth, in the order of their bit index
+  std::vector<LeafSplits> leaf_splits(1, *smaller_leaf_splits_);
+  std::vector<FeatureHistogram*> histograms(1, nullptr);
+  histogram_pool_.Get(0, &histograms[0]);
+  smaller_leaf_histogram_array_ = histograms[0];
+  larger_leaf_histogram_array_ = nullptr;
+  ConstructHistograms(is_feature_used, false);
+#pragma omp parallel for schedule(static) num_threads(share_state_->num_threads)
+  for (int feature_index = 0; feature_index < num_features_; ++feature_index) {
+    if (is_feature_used[feature_index]) {
+      train_data_->FixHistogram(feature_index, leaf_splits[0].sum_gradients(),
+                                leaf_splits[0].sum_hessians(),
+                                histograms[0][feature_index].RawData());
+    }
+  }
+  std::vector<LeafSplits> next_leaf_splits;
+  std::vector<FeatureHistogram*> next_histograms;
+  std::vector<Dataset::HistogramLeaf> histogram_leaves;
+  for (int depth = 0; depth < max_depth; ++depth) {
+    int inner_feature_index = -1;
+    uint32_t threshold = 0;
+    const double gain = FindBestObliviousSplit(tree, leaf_splits, histograms,
+                                               &inner_feature_index, &threshold);
+    // cannot split, quit
+    if (inner_feature_index < 0 || gain <= config_->min_gain_to_split) {
+      Log::Warning("No further splits with positive gain, best gain: %f", gain);
+      break;
+    }
+    const int real_feature_index = train_data_->RealFeatureIndex(inner_feature_index);
+    const double threshold_double = train_data_->RealThreshold(inner_feature_index, threshold);
+    const MissingType missing_type =
+        train_data_->FeatureBinMapper(inner_feature_index)->missing_type();
+    const int num_level_leaves = static_cast<int>(leaf_splits.size());
+    const bool is_last_depth = depth + 1 == max_depth;
+    next_leaf_splits.clear();
+    next_histograms.clear();
+    histogram_leaves.clear();
+    for (int i = 0; i < num_level_leaves; ++i) {
+      const LeafSplits& cur = leaf_splits[i];
+      SplitInfo split;
+      if (cur.num_data_in_leaf() > 0) {
+        histograms[i][inner_feature_index].GetObliviousSplit(
+            threshold, cur.sum_gradients(), cur.sum_hessians(),
+            cur.num_data_in_leaf(), cur.weight(), &split);
+      } else {
+        split.left_sum_gradient = split.right_sum_gradient = 0.0;
+        split.left_sum_hessian = split.right_sum_hessian = 0.0;
+        split.left_output = split.right_output = cur.weight();
+        split.gain = 0.0;
+      }
+      const int left_leaf = cur.leaf_index();
+      const int right_leaf = tree->NextLeafId();
+      data_partition_->Split(left_leaf, train_data_, inner_feature_index,
+                             &threshold, 1, true, right_leaf);
+      const data_size_t left_count = data_partition_->leaf_count(left_leaf);
+      const data_size_t right_count = data_partition_->leaf_count(right_leaf);
+      tree->Split(left_leaf, inner_feature_index, real_feature_index, threshold,
+                  threshold_double, split.left_output, split.right_output,
+                  left_count, right_count, split.left_sum_hessian,
+                  split.right_sum_hessian, static_cast<float>(split.gain),
+                  missing_type, true);
+      next_leaf_splits.push_back(cur);
+      next_leaf_splits.back().Init(left_leaf, data_partition_.get(),
+                                   split.left_sum_gradient, split.left_sum_hessian,
+                                   split.left_output);
+      next_leaf_splits.push_back(cur);
+      next_leaf_splits.back().Init(right_leaf, data_partition_.get(),
+                                   split.right_sum_gradient, split.right_sum_hessian,
+                                   split.right_output);
+      if (is_last_depth) {
+        continue;
+      }
+      // the histograms of the parent go to the larger leaf, the smaller one is constructed
+      FeatureHistogram* smaller_histogram = nullptr;
+      FeatureHistogram* larger_histogram = nullptr;
+      histogram_pool_.Get(left_leaf, &larger_histogram);
+      if (left_count < right_count) {
+        histogram_pool_.Move(left_leaf, right_leaf);
+        histogram_pool_.Get(left_leaf, &smaller_histogram);
+        next_histograms.push_back(smaller_histogram);
+        next_histograms.push_back(larger_histogram);
+      } else {
+        histogram_pool_.Get(right_leaf, &smaller_histogram);
+        next_histograms.push_back(larger_histogram);
+        next_histograms.push_back(smaller_histogram);
+      }
+      const LeafSplits& smaller = next_leaf_splits[left_count < right_count ? 2 * i : 2 * i + 1];
+      if (smaller.num_data_in_leaf() > 0) {
+        histogram_leaves.push_back(
+            {&is_feature_used, smaller.data_indices(), smaller.num_data_in_leaf(),
+             ordered_gradients_.data() + data_partition_->leaf_begin(smaller.leaf_index()),
+             ordered_hessians_.data() + data_partition_->leaf_begin(smaller.leaf_index()),
+             smaller_histogram[0].RawData() - kHistOffset});
+      }
+    }
+    leaf_splits.swap(next_leaf_splits);
+    if (is_last_depth) {
+      break;
+    }
+    histograms.swap(next_histograms);
+    {
+      Common::FunctionTimer fun_timer("SerialTreeLearner::ConstructHistograms",
+                                      global_timer);
+      train_data_->ConstructHistogramsForLeaves(histogram_leaves, gradients_,
+                                                hessians_, share_state_.get());
+    }
+    // the larger leaves are the parents minus the smaller ones, empty leaves keep the parents
+#pragma omp parallel for schedule(static) num_threads(share_state_->num_threads)
+    for (int feature_index = 0; feature_index < num_features_; ++feature_index) {
+      if (!is_feature_used[feature_index]) {
+        continue;
+      }
+      for (int i = 0; i < num_level_leaves; ++i) {
+        const bool is_left_smaller = leaf_splits[2 * i].num_data_in_leaf() < leaf_splits[2 * i + 1].num_data_in_leaf();
+        const LeafSplits& smaller = leaf_splits[is_left_smaller ? 2 * i : 2 * i + 1];
+        if (smaller.num_data_in_leaf() <= 0) {
+          continue;
+        }
+        FeatureHistogram* smaller_histogram = histograms[is_left_smaller ? 2 * i : 2 * i + 1];
+        FeatureHistogram* larger_histogram = histograms[is_left_smaller ? 2 * i + 1 : 2 * i];
+        train_data_->FixHistogram(feature_index, smaller.sum_gradients(),
+                                  smaller.sum_hessians(),
+                                  smaller_histogram[feature_index].RawData());
+        larger_histogram[feature_index].Subtract(smaller_histogram[feature_index]);
+      }
+    }
+  }
+}
+
+double SerialTreeLearner::FindBestObliviousSplit(
+    const Tree* tree, const std::vector<LeafSplits>& leaf_splits,
+    const std::vector<FeatureHistogram*>& histograms, int* best_feature,
+    uint32_t* best_threshold) {
+  Common::FunctionTimer fun_timer("SerialTreeLearner::FindBestObliviousSplit",
+                                  global_timer);
+  // feature_fraction_bynode samples once per depth, all its leaves share the split
+  std::vector<int8_t> node_used_features =
+      col_sampler_.GetByNode(tree, leaf_splits[0].leaf_index());
+  std::vector<double> feature_gains(num_features_, kMinScore);
+  std::vector<uint32_t> feature_thresholds(num_features_, 0);
+  const int num_leaves = static_cast<int>(leaf_splits.size());
+  OMP_INIT_EX();
+#pragma omp parallel for schedule(static) num_threads(share_state_->num_threads)
+  for (int feature_index = 0; feature_index < num_features_; ++feature_index) {
+    OMP_LOOP_EX_BEGIN();
+    if (!col_sampler_.is_feature_used_bytree()[feature_index] ||
+        !node_used_features[feature_index] ||
+        train_data_->FeatureBinMapper(feature_index)->bin_type() != BinType::NumericalBin) {
+      continue;
+    }
+    const int num_bin = train_data_->FeatureNumBin(feature_index);
+    if (num_bin < 2) {
+      continue;
+    }
+    std::vector<double> gains(num_bin - 1, 0.0);
+    for (int i = 0; i < num_leaves; ++i) {
+      if (leaf_splits[i].num_data_in_leaf() > 0) {
+        histograms[i][feature_index].AddObliviousGains(
+            leaf_splits[i].sum_gradients(), leaf_splits[i].sum_hessians(),
+            leaf_splits[i].num_data_in_leaf(), leaf_splits[i].weight(),
+            gains.data());
+      }
+    }
+    for (int t = 0; t < num_bin - 1; ++t) {
+      if (gains[t] > feature_gains[feature_index]) {
+        feature_gains[feature_index] = gains[t];
+        feature_thresholds[feature_index] = static_cast<uint32_t>(t);
+      }
+    }
+    OMP_LOOP_EX_END();
+  }
+  OMP_THROW_EX();
+  *best_feature = -1;
+  double best_gain = kMinScore;
+  for (int feature_index = 0; feature_index < num_features_; ++feature_index) {
+    if (feature_gains[feature_index] > best_gain) {
+      best_gain = feature_gains[feature_index];
+      *best_feature = feature_index;
+      *best_threshold = feature_thresholds[feature_index];
+    }
+  }
+  return best_gain;
+}
+
+std::vector<int8_t> SerialTreeLearner::GetUsedFeatures() {
   std::vector<int8_t> is_feature_used(num_features_, 0);
   #pragma omp parallel for schedule(static, 256) if (num_features_ >= 512)
   for (int feature_index = 0; feature_index < num_features_; ++feature_index) {
@@ -325,6 +661,11 @@ void SerialTreeLearner::FindBestSplits(const Tree* tree) {
     }
     is_feature_used[feature_index] = 1;
   }
+  return is_feature_used;
+}
+
+void SerialTreeLearner::FindBestSplits(const Tree* tree) {
+  std::vector<int8_t> is_feature_used = GetUsedFeatures();
   bool use_subtract = parent_leaf_histogram_array_ != nullptr;
   ConstructHistograms(is_feature_used, use_subtract);
   FindBestSplitsFromHistograms(is_feature_used, use_subtract, tree);
@@ -334,14 +675,21 @@ void SerialTreeLearner::ConstructHistograms(
     const std::vector<int8_t>& is_feature_used, bool use_subtract) {
   Common::FunctionTimer fun_timer("SerialTreeLearner::ConstructHistograms",
                                   global_timer);
-  // construct smaller leaf
+  if (gradient_quantizer_ != nullptr) {
+    ConstructIntHistograms(is_feature_used, use_subtract);
+    return;
+  }
+  // construct smaller leaf, its gradients may have been gathered by the last split
+  const int smaller_leaf = smaller_leaf_splits_->leaf_index();
+  const bool is_ordered = smaller_leaf >= 0 && smaller_leaf == share_state_->ordered_leaf &&
+                          share_state_->ordered_generation == data_partition_->generation();
   hist_t* ptr_smaller_leaf_hist_data =
       smaller_leaf_histogram_array_[0].RawData() - kHistOffset;
   train_data_->ConstructHistograms(
       is_feature_used, smaller_leaf_splits_->data_indices(),
       smaller_leaf_splits_->num_data_in_leaf(), gradients_, hessians_,
       ordered_gradients_.data(), ordered_hessians_.data(), share_state_.get(),
-      ptr_smaller_leaf_hist_data);
+      ptr_smaller_leaf_hist_data, is_ordered);
 
   if (larger_leaf_histogram_array_ != nullptr && !use_subtract) {
     // construct larger leaf
@@ -355,6 +703,35 @@ void SerialTreeLearner::ConstructHistograms(
   }
 }
 
+void SerialTreeLearner::ConstructIntHistograms(
+    const std::vector<int8_t>& is_feature_used, bool use_subtract) {
+  // construct smaller leaf
+  hist_t* ptr_smaller_leaf_hist_data =
+      smaller_leaf_histogram_array_[0].RawData() - kHistOffset;
+  train_data_->ConstructIntHistograms(
+      is_feature_used, smaller_leaf_splits_->data_indices(),
+      smaller_leaf_splits_->num_data_in_leaf(),
+      gradient_quantizer_->int_grad_hess(),
+      gradient_quantizer_->ordered_int_grad_hess(),
+      gradient_quantizer_->grad_scale(), gradient_quantizer_->hess_scale(),
+      gradient_quantizer_->max_int_grad_hess(), share_state_.get(),
+      ptr_smaller_leaf_hist_data);
+
+  if (larger_leaf_histogram_array_ != nullptr && !use_subtract) {
+    // construct larger leaf
+    hist_t* ptr_larger_leaf_hist_data =
+        larger_leaf_histogram_array_[0].RawData() - kHistOffset;
+    train_data_->ConstructIntHistograms(
+        is_feature_used, larger_leaf_splits_->data_indices(),
+        larger_leaf_splits_->num_data_in_leaf(),
+        gradient_quantizer_->int_grad_hess(),
+        gradient_quantizer_->ordered_int_grad_hess(),
+        gradient_quantizer_->grad_scale(), gradient_quantizer_->hess_scale(),
+        gradient_quantizer_->max_int_grad_hess(), share_state_.get(),
+        ptr_larger_leaf_hist_data);
+  }
+}
+
 void SerialTreeLearner::FindBestSplitsFromHistograms(
     const std::vector<int8_t>& is_feature_used, bool use_subtract, const Tree* tree) {
   Common::FunctionTimer fun_timer(
@@ -558,12 +935,23 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
   bool is_numerical_split =
       train_data_->FeatureBinMapper(inner_feature_index)->bin_type() ==
       BinType::NumericalBin;
+  // gather the gradients of the smaller leaf for its histograms while partitioning
+  const score_t* gather_gradients = nullptr;
+  const score_t* gather_hessians = nullptr;
+  if (share_state_->is_colwise && gradient_quantizer_ == nullptr && !is_leaf_batch_) {
+    gather_gradients = gradients_;
+    if (!share_state_->is_constant_hessian) {
+      gather_hessians = hessians_;
+    }
+  }
+  int gathered_leaf = -1;
   if (is_numerical_split) {
     auto threshold_double = train_data_->RealThreshold(
         inner_feature_index, best_split_info.threshold);
-    data_partition_->Split(best_leaf, train_data_, inner_feature_index,
-                           &best_split_info.threshold, 1,
-                           best_split_info.default_left, next_leaf_id);
+    gathered_leaf = data_partition_->Split(
+        best_leaf, train_data_, inner_feature_index, &best_split_info.threshold,
+        1, best_split_info.default_left, next_leaf_id, gather_gradients,
+        gather_hessians, ordered_gradients_.data(), ordered_hessians_.data());
     if (update_cnt) {
       // don't need to update this in data-based parallel model
       best_split_info.left_count = data_partition_->leaf_count(*left_leaf);
@@ -595,10 +983,11 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
     std::vector<uint32_t> cat_bitset = Common::ConstructBitset(
         threshold_int.data(), best_split_info.num_cat_threshold);
 
-    data_partition_->Split(best_leaf, train_data_, inner_feature_index,
-                           cat_bitset_inner.data(),
-                           static_cast<int>(cat_bitset_inner.size()),
-                           best_split_info.default_left, next_leaf_id);
+    gathered_leaf = data_partition_->Split(
+        best_leaf, train_data_, inner_feature_index, cat_bitset_inner.data(),
+        static_cast<int>(cat_bitset_inner.size()), best_split_info.default_left,
+        next_leaf_id, gather_gradients, gather_hessians,
+        ordered_gradients_.data(), ordered_hessians_.data());
 
     if (update_cnt) {
       // don't need to update this in data-based parallel model
@@ -624,6 +1013,10 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
 #ifdef DEBUG
   CHECK(*right_leaf == next_leaf_id);
 #endif
+  if (gathered_leaf >= 0) {
+    share_state_->ordered_leaf = gathered_leaf;
+    share_state_->ordered_generation = data_partition_->generation();
+  }
 
   // init the leaves that used on next iteration
   if (best_split_info.left_count < best_split_info.right_count) {
@@ -17,11 +17,13 @@
 #include <cstdio>
 #include <memory>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "col_sampler.hpp"
 #include "data_partition.hpp"
 #include "feature_histogram.hpp"
+#include "gradient_quantizer.hpp"
 #include "leaf_splits.hpp"
 #include "monotone_constraints.hpp"
 #include "split_info.hpp"
@@ -87,7 +89,6 @@ class SerialTreeLearner: public TreeLearner {
     } else {
       ResetTrainingDataInner(subset, share_state_->is_constant_hessian, false);
       share_state_->is_use_subrow = true;
-      share_state_->is_subrow_copied = false;
       share_state_->bagging_use_indices = used_indices;
       share_state_->bagging_indices_cnt = num_data;
     }
@@ -136,8 +137,57 @@ class SerialTreeLearner: public TreeLearner {
 
   virtual void FindBestSplits(const Tree* tree);
 
+  /*!
+  * \brief Get the features whose histograms are needed for the current leaves
+  */
+  std::vector<int8_t> GetUsedFeatures();
+
+  /*!
+  * \brief Grow the tree by splitting up to leaf_batch_size leaves with the largest gains at each step
+  * \param tree Current tree
+  * \param left_leaf Left leaf of the last split
+  * \param right_leaf Right leaf of the last split, -1 if only root leaf
+  * \param cur_depth Max depth of the tree, updated by the splits
+  */
+  void GrowByLeafBatches(Tree* tree, int left_leaf, int right_leaf, int* cur_depth);
+
+  /*!
+  * \brief Grow an oblivious tree: all the leaves of a depth are split by the same numerical split,
+  *        which has the largest sum of gains over them
+  * \param tree Current tree, only has the root leaf
+  */
+  void GrowOblivious(Tree* tree);
+
+  /*!
+  * \brief Find the best split shared by the leaves of one depth of an oblivious tree
+  * \param tree Current tree
+  * \param leaf_splits Sums of the leaves
+  * \param histograms Histograms of the leaves
+  * \param best_feature Output inner feature index, -1 if there is no valid split
+  * \param best_threshold Output threshold in bin
+  * \return Sum of gains of the split
+  */
+  double FindBestObliviousSplit(const Tree* tree, const std::vector<LeafSplits>& leaf_splits,
+                                const std::vector<FeatureHistogram*>& histograms,
+                                int* best_feature, uint32_t* best_threshold);
+
+  /*!
+  * \brief Same as FindBestSplits for several pairs of new leaves, their histograms are constructed together
+  * \param tree Current tree
+  * \param leaf_pairs Left and right leaves of each split
+  * \param leaf_splits Smaller and larger leaf splits of each split
+  */
+  void FindBestSplitsForLeaves(const Tree* tree,
+                               const std::vector<std::pair<int, int>>& leaf_pairs,
+                               const std::vector<std::pair<LeafSplits, LeafSplits>>& leaf_splits);
+
   virtual void ConstructHistograms(const std::vector<int8_t>& is_feature_used, bool use_subtract);
 
+  /*!
+  * \brief Same as ConstructHistograms, from the quantized gradients and hessians of gradient_quantizer_
+  */
+  void ConstructIntHistograms(const std::vector<int8_t>& is_feature_used, bool use_subtract);
+
   virtual void FindBestSplitsFromHistograms(const std::vector<int8_t>& is_feature_used, bool use_subtract, const Tree*);
 
   /*!
@@ -215,6 +265,10 @@ class SerialTreeLearner: public TreeLearner {
   const Json* forced_split_json_;
   std::unique_ptr<TrainingShareStates> share_state_;
   std::unique_ptr<CostEfficientGradientBoosting> cegb_;
+  /*! \brief quantizes gradients and hessians when use_quantized_grad, nullptr otherwise */
+  std::unique_ptr<GradientQuantizer> gradient_quantizer_;
+  /*! \brief whether the current tree is grown by GrowByLeafBatches */
+  bool is_leaf_batch_ = false;
 };
 
 inline data_size_t SerialTreeLearner::GetGlobalDataCountInLeaf(int leaf_idx) const {
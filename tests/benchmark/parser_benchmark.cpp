@@ -0,0 +1,200 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Throughput of the text data loading stages on generated CSV and LibSVM files:
+ * finding line ends in memory (byte by byte and by FindEndOfLine), converting all the numbers
+ * in memory (by Common::Atof and by strtod), reading lines of file, parsing them, and
+ * constructing a Dataset through the C API.
+ *
+ * Usage: parser_benchmark [number of rows] [number of columns]
+ *
+ * The files are written to the current directory and removed afterwards.
+ * Returns 1 if the stages don't agree on the number of lines, or Common::Atof doesn't convert
+ * the numbers to the same doubles as strtod.
+ */
+#include <LightGBM/c_api.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/utils/common.h>
+#include <LightGBM/utils/text_reader.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define CHECK_CALL(x) \
+  if ((x) != 0) { \
+    std::fprintf(stderr, "%s failed: %s\n", #x, LGBM_GetLastError()); \
+    std::exit(2); \
+  }
+
+using LightGBM::data_size_t;
+
+/*!
+* \brief Write rows of random values, a fifth of them zeros, as CSV or LibSVM
+*/
+static void WriteFile(const char* filename, bool is_libsvm, int num_rows, int num_columns) {
+  FILE* file = std::fopen(filename, "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "could not write %s\n", filename);
+    std::exit(2);
+  }
+  std::mt19937 gen(0);
+  std::normal_distribution<double> dist;
+  std::uniform_int_distribution<int> is_zero(0, 4);
+  for (int i = 0; i < num_rows; ++i) {
+    std::fprintf(file, "%d", static_cast<int>(gen() & 1));
+    for (int j = 0; j < num_columns; ++j) {
+      const double value = is_zero(gen) == 0 ? 0.0 : dist(gen);
+      if (!is_libsvm) {
+        std::fprintf(file, ",%.17g", value);
+      } else if (value != 0.0) {
+        std::fprintf(file, " %d:%.17g", j, value);
+      }
+    }
+    std::fprintf(file, "\n");
+  }
+  std::fclose(file);
+}
+
+/*!
+* \brief Convert all the numbers of text by convert, which returns the end of the number, into values.
+*        Labels, LibSVM indices and values are all numbers separated by one character, which
+*        Common::Atof already skips when it is a space
+* \return Number of lines
+*/
+static int64_t ConvertAll(const std::string& text, std::vector<double>* values,
+                          const std::function<const char*(const char*, double*)>& convert) {
+  int64_t cnt = 0;
+  values->clear();
+  const char* p = text.c_str();
+  while (*p != '\0') {
+    double value;
+    const char* end = convert(p, &value);
+    values->push_back(value);
+    if (*end == '\0') {
+      break;
+    } else if (*end == '\n') {
+      ++cnt;
+    }
+    // skip the separator, unless it was already skipped
+    p = end != p && std::strchr(" ,:\n", *end) == nullptr ? end : end + 1;
+  }
+  return cnt;
+}
+
+/*!
+* \brief Time one run of stage, which returns the number of lines it saw
+*/
+static int64_t Run(const char* name, size_t num_bytes, const std::function<int64_t()>& stage) {
+  const auto start = std::chrono::steady_clock::now();
+  const int64_t num_lines = stage();
+  const auto end = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  std::printf("  %-34s %10.3f s %10.1f MB/s\n", name, seconds, num_bytes / seconds / 1e6);
+  return num_lines;
+}
+
+static bool Benchmark(const char* filename, bool is_libsvm, int num_rows, int num_columns) {
+  WriteFile(filename, is_libsvm, num_rows, num_columns);
+  LightGBM::TextReader<data_size_t> reader(filename, false);
+  size_t num_bytes = 0;
+  const std::vector<char> content = reader.ReadContent(&num_bytes);
+  std::printf("%s: %d rows, %.1f MB\n", is_libsvm ? "LibSVM" : "CSV", num_rows, num_bytes / 1e6);
+  std::vector<int64_t> num_lines;
+
+  num_lines.push_back(Run("line ends, byte by byte", num_bytes, [&] () {
+    int64_t cnt = 0;
+    const char* end = content.data() + num_bytes;
+    for (const char* p = content.data(); p != end; ++p) {
+      while (p != end && *p != '\n' && *p != '\r') {
+        ++p;
+      }
+      if (p == end) {
+        break;
+      }
+      ++cnt;
+    }
+    return cnt;
+  }));
+  num_lines.push_back(Run("line ends, FindEndOfLine", num_bytes, [&] () {
+    int64_t cnt = 0;
+    const char* end = content.data() + num_bytes;
+    for (const char* p = LightGBM::FindEndOfLine(content.data(), end); p != end;
+         p = LightGBM::FindEndOfLine(p + 1, end)) {
+      ++cnt;
+    }
+    return cnt;
+  }));
+  const std::string text(content.data(), num_bytes);
+  std::vector<double> atof_values;
+  std::vector<double> strtod_values;
+  num_lines.push_back(Run("numbers, Common::Atof", num_bytes, [&] () {
+    return ConvertAll(text, &atof_values, [] (const char* p, double* value) {
+      return LightGBM::Common::Atof(p, value);
+    });
+  }));
+  num_lines.push_back(Run("numbers, strtod", num_bytes, [&] () {
+    return ConvertAll(text, &strtod_values, [] (const char* p, double* value) {
+      char* end;
+      *value = std::strtod(p, &end);
+      return static_cast<const char*>(end);
+    });
+  }));
+  if (atof_values.size() != strtod_values.size() ||
+      std::memcmp(atof_values.data(), strtod_values.data(), atof_values.size() * sizeof(double)) != 0) {
+    std::fprintf(stderr, "%s: Common::Atof and strtod convert the numbers differently\n", filename);
+    return false;
+  }
+  num_lines.push_back(Run("TextReader::CountLine", num_bytes, [&] () {
+    return static_cast<int64_t>(reader.CountLine());
+  }));
+
+  std::unique_ptr<LightGBM::Parser> parser(LightGBM::Parser::CreateParser(filename, false, 0, 0));
+  num_lines.push_back(Run("TextReader + Parser::ParseOneLine", num_bytes, [&] () {
+    std::vector<std::pair<int, double>> features;
+    double label;
+    // each line is terminated by the reader, like the lines handed to the parser by DatasetLoader
+    std::string line;
+    return static_cast<int64_t>(reader.ReadAllAndProcess([&] (data_size_t, const char* buffer, size_t size) {
+      line.assign(buffer, size);
+      features.clear();
+      parser->ParseOneLine(line.c_str(), &features, &label);
+    }));
+  }));
+
+  num_lines.push_back(Run("LGBM_DatasetCreateFromFile", num_bytes, [&] () {
+    DatasetHandle dataset;
+    CHECK_CALL(LGBM_DatasetCreateFromFile(filename, "verbose=-1", nullptr, &dataset));
+    int num_data;
+    CHECK_CALL(LGBM_DatasetGetNumData(dataset, &num_data));
+    CHECK_CALL(LGBM_DatasetFree(dataset));
+    return static_cast<int64_t>(num_data);
+  }));
+  std::remove(filename);
+
+  for (int64_t cnt : num_lines) {
+    if (cnt != num_rows) {
+      std::fprintf(stderr, "%s: a stage saw %lld lines instead of %d\n", filename,
+                   static_cast<long long>(cnt), num_rows);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const int num_rows = argc > 1 ? std::atoi(argv[1]) : 200000;
+  const int num_columns = argc > 2 ? std::atoi(argv[2]) : 50;
+  bool ok = Benchmark("parser_benchmark.csv", false, num_rows, num_columns);
+  ok &= Benchmark("parser_benchmark.svm", true, num_rows, num_columns);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Latency and heap allocations of the single row prediction paths of the C API.
+ *
+ * Usage: single_row_predict <model file> [number of calls]
+ *
+ * Global operator new is replaced to count allocations, including those made inside
+ * lib_lightgbm when it is linked as a shared library on ELF platforms.
+ * Returns 1 if a path documented as allocation free allocates.
+ */
+#include <LightGBM/c_api.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <vector>
+
+static std::atomic<int64_t> num_allocations(0);
+
+void* operator new(size_t size) {
+  ++num_allocations;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+#define CHECK_CALL(x) \
+  if ((x) != 0) { \
+    std::fprintf(stderr, "%s failed: %s\n", #x, LGBM_GetLastError()); \
+    std::exit(2); \
+  }
+
+/*!
+* \brief Call predict once per row, rows are cycled
+* \return true if no allocation happened in the timed calls
+*/
+static bool Run(const char* name, int num_calls, int num_rows, const std::function<void(int)>& predict,
+                bool expect_no_allocation) {
+  // warm up, thread local buffers and lazily built structures are created here
+  for (int i = 0; i < num_rows; ++i) {
+    predict(i);
+  }
+  const int64_t allocations_before = num_allocations.load();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_calls; ++i) {
+    predict(i % num_rows);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const int64_t allocations = num_allocations.load() - allocations_before;
+  const double ns = std::chrono::duration<double, std::nano>(end - start).count() / num_calls;
+  std::printf("%-36s %10.1f ns/call %8.2f allocations/call\n", name, ns,
+              static_cast<double>(allocations) / num_calls);
+  return !expect_no_allocation || allocations == 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <model file> [number of calls]\n", argv[0]);
+    return 2;
+  }
+  const int num_calls = argc > 2 ? std::atoi(argv[2]) : 100000;
+  const int num_rows = 1024;
+
+  BoosterHandle booster;
+  int num_iterations;
+  CHECK_CALL(LGBM_BoosterCreateFromModelfile(argv[1], &num_iterations, &booster));
+  int num_feature;
+  CHECK_CALL(LGBM_BoosterGetNumFeature(booster, &num_feature));
+  int num_class;
+  CHECK_CALL(LGBM_BoosterGetNumClasses(booster, &num_class));
+
+  std::mt19937 gen(0);
+  std::normal_distribution<double> dist;
+  std::vector<double> rows(static_cast<size_t>(num_rows) * num_feature);
+  std::vector<float> rows_float(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    rows[i] = dist(gen);
+    rows_float[i] = static_cast<float>(rows[i]);
+  }
+  std::vector<double> out(num_class);
+  int64_t out_len;
+  const char* parameter = "num_threads=1";
+  const int predict_type = C_API_PREDICT_RAW_SCORE;
+  bool ok = true;
+
+  Run("BoosterPredictForMatSingleRow", num_calls, num_rows, [&] (int i) {
+    CHECK_CALL(LGBM_BoosterPredictForMatSingleRow(booster, rows.data() + static_cast<size_t>(i) * num_feature,
+                                                  C_API_DTYPE_FLOAT64, num_feature, 1, predict_type, 0, -1,
+                                                  parameter, &out_len, out.data()));
+  }, false);
+
+  FastConfigHandle fast_config;
+  CHECK_CALL(LGBM_BoosterPredictForMatSingleRowFastInit(booster, predict_type, 0, -1, C_API_DTYPE_FLOAT64,
+                                                        num_feature, parameter, &fast_config));
+  ok &= Run("BoosterPredictForMatSingleRowFast", num_calls, num_rows, [&] (int i) {
+    CHECK_CALL(LGBM_BoosterPredictForMatSingleRowFast(fast_config, rows.data() + static_cast<size_t>(i) * num_feature,
+                                                      &out_len, out.data()));
+  }, true);
+  CHECK_CALL(LGBM_FastConfigFree(fast_config));
+
+  FrozenBoosterHandle frozen;
+  CHECK_CALL(LGBM_BoosterFreeze(booster, predict_type, 0, -1, parameter, &frozen));
+  ok &= Run("FrozenBoosterPredictForMatSingleRow", num_calls, num_rows, [&] (int i) {
+    CHECK_CALL(LGBM_FrozenBoosterPredictForMatSingleRow(frozen, rows.data() + static_cast<size_t>(i) * num_feature,
+                                                        C_API_DTYPE_FLOAT64, num_feature, &out_len, out.data()));
+  }, true);
+
+  int64_t scratch_size;
+  CHECK_CALL(LGBM_FrozenBoosterGetScratchSize(frozen, C_API_DTYPE_FLOAT64, num_feature, &scratch_size));
+  ok &= Run("FrozenBoosterPredictNoAlloc float64", num_calls, num_rows, [&] (int i) {
+    CHECK_CALL(LGBM_FrozenBoosterPredictForMatSingleRowNoAlloc(frozen,
+                                                               rows.data() + static_cast<size_t>(i) * num_feature,
+                                                               C_API_DTYPE_FLOAT64, num_feature, nullptr,
+                                                               &out_len, out.data()));
+  }, scratch_size == 0);
+
+  CHECK_CALL(LGBM_FrozenBoosterGetScratchSize(frozen, C_API_DTYPE_FLOAT32, num_feature, &scratch_size));
+  std::vector<double> scratch(scratch_size);
+  ok &= Run("FrozenBoosterPredictNoAlloc float32", num_calls, num_rows, [&] (int i) {
+    CHECK_CALL(LGBM_FrozenBoosterPredictForMatSingleRowNoAlloc(frozen,
+                                                               rows_float.data() + static_cast<size_t>(i) * num_feature,
+                                                               C_API_DTYPE_FLOAT32, num_feature, scratch.data(),
+                                                               &out_len, out.data()));
+  }, true);
+
+  CHECK_CALL(LGBM_FrozenBoosterFree(frozen));
+  CHECK_CALL(LGBM_BoosterFree(booster));
+  if (!ok) {
+    std::fprintf(stderr, "an allocation free path allocated\n");
+    return 1;
+  }
+  return 0;
+}
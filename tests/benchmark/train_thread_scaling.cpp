@@ -0,0 +1,85 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Training time per iteration for numbers of threads from 1 to 96, on generated dense data.
+ *
+ * Usage: train_thread_scaling [number of rows] [number of columns] [number of iterations]
+ *                             [max number of threads] [extra parameters]
+ *
+ * Thread counts above the max number of threads are skipped. On multi-socket machines,
+ * run it with the threads pinned, e.g. OMP_PROC_BIND=spread OMP_PLACES=cores.
+ */
+#include <LightGBM/c_api.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CHECK_CALL(x) \
+  if ((x) != 0) { \
+    std::fprintf(stderr, "%s failed: %s\n", #x, LGBM_GetLastError()); \
+    std::exit(2); \
+  }
+
+int main(int argc, char** argv) {
+  const int num_rows = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const int num_columns = argc > 2 ? std::atoi(argv[2]) : 28;
+  const int num_iterations = argc > 3 ? std::atoi(argv[3]) : 50;
+  const int max_threads = argc > 4 ? std::atoi(argv[4]) : 96;
+  const std::string extra_parameters = argc > 5 ? argv[5] : "";
+  const int thread_counts[] = {1, 2, 4, 8, 12, 16, 24, 32, 48, 64, 96};
+
+  // label depends on a few columns, so trees keep splitting
+  std::mt19937 gen(0);
+  std::normal_distribution<double> dist;
+  std::vector<double> rows(static_cast<size_t>(num_rows) * num_columns);
+  std::vector<float> labels(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    double* row = rows.data() + static_cast<size_t>(i) * num_columns;
+    for (int j = 0; j < num_columns; ++j) {
+      row[j] = dist(gen);
+    }
+    const double score = row[0] + 0.5 * row[1 % num_columns] * row[2 % num_columns] + 0.3 * dist(gen);
+    labels[i] = score > 0 ? 1.0f : 0.0f;
+  }
+  const std::string parameters = "objective=binary verbose=-1 " + extra_parameters;
+  DatasetHandle dataset;
+  CHECK_CALL(LGBM_DatasetCreateFromMat(rows.data(), C_API_DTYPE_FLOAT64, num_rows, num_columns, 1,
+                                       parameters.c_str(), nullptr, &dataset));
+  CHECK_CALL(LGBM_DatasetSetField(dataset, "label", labels.data(), num_rows, C_API_DTYPE_FLOAT32));
+
+  std::printf("%d rows, %d columns, %d iterations\n", num_rows, num_columns, num_iterations);
+  std::printf("%8s %14s %10s %12s\n", "threads", "ms/iteration", "speedup", "efficiency");
+  double single_thread_ms = 0.0;
+  for (int num_threads : thread_counts) {
+    if (num_threads > max_threads) {
+      break;
+    }
+    const std::string booster_parameters = parameters + " num_threads=" + std::to_string(num_threads);
+    BoosterHandle booster;
+    CHECK_CALL(LGBM_BoosterCreate(dataset, booster_parameters.c_str(), &booster));
+    int is_finished = 0;
+    // the first iteration allocates the histogram pool and the other buffers
+    CHECK_CALL(LGBM_BoosterUpdateOneIter(booster, &is_finished));
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i < num_iterations && !is_finished; ++i) {
+      CHECK_CALL(LGBM_BoosterUpdateOneIter(booster, &is_finished));
+    }
+    const auto end = std::chrono::steady_clock::now();
+    CHECK_CALL(LGBM_BoosterFree(booster));
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count() / std::max(num_iterations - 1, 1);
+    if (num_threads == 1) {
+      single_thread_ms = ms;
+    }
+    const double speedup = single_thread_ms / ms;
+    std::printf("%8d %14.2f %10.2f %11.0f%%\n", num_threads, ms, speedup, 100.0 * speedup / num_threads);
+  }
+  CHECK_CALL(LGBM_DatasetFree(dataset));
+  return 0;
+}
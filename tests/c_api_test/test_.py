@@ -50,6 +50,8 @@ dtype_float32 = 0
 dtype_float64 = 1
 dtype_int32 = 2
 dtype_int64 = 3
+dtype_uint8 = 4
+dtype_uint16 = 5
 
 
 def c_array(ctype, values):
@@ -288,4 +290,58 @@ def test_booster():
         25,
         c_str(''),
         c_str('preb.txt'))
+    bins = np.zeros(mat.shape, dtype=np.uint16)
+    for j in range(mat.shape[1]):
+        bounds = np.zeros(mat.shape[0], dtype=np.float64)
+        num_bounds = ctypes.c_int64()
+        LIB.LGBM_BoosterGetFeatureBinUpperBounds(
+            booster2,
+            j,
+            ctypes.c_int64(bounds.size),
+            ctypes.byref(num_bounds),
+            bounds.ctypes.data_as(ctypes.POINTER(ctypes.c_double)))
+        bins[:, j] = np.searchsorted(bounds[:num_bounds.value], mat[:, j], side='left')
+    preb_binned = np.zeros(mat.shape[0], dtype=np.float64)
+    LIB.LGBM_BoosterPredictForBinnedMat(
+        booster2,
+        bins.ctypes.data_as(ctypes.POINTER(ctypes.c_void_p)),
+        dtype_uint16,
+        mat.shape[0],
+        mat.shape[1],
+        1,
+        1,
+        0,
+        25,
+        c_str(''),
+        ctypes.byref(num_preb),
+        preb_binned.ctypes.data_as(ctypes.POINTER(ctypes.c_double)))
+    np.testing.assert_allclose(preb_binned, preb)
+    frozen = ctypes.c_void_p()
+    LIB.LGBM_BoosterFreeze(booster2, 1, 0, 25, c_str(''), ctypes.byref(frozen))
+    preb_frozen = np.zeros(1, dtype=np.float64)
+    for i in range(10):
+        row = np.array(mat[i], copy=True)
+        LIB.LGBM_FrozenBoosterPredictForMatSingleRow(
+            frozen,
+            row.ctypes.data_as(ctypes.POINTER(ctypes.c_void_p)),
+            dtype_float64,
+            mat.shape[1],
+            ctypes.byref(num_preb),
+            preb_frozen.ctypes.data_as(ctypes.POINTER(ctypes.c_double)))
+        np.testing.assert_allclose(preb_frozen[0], preb[i])
+    scratch_size = ctypes.c_int64(0)
+    LIB.LGBM_FrozenBoosterGetScratchSize(frozen, dtype_float32, mat.shape[1], ctypes.byref(scratch_size))
+    scratch = np.zeros(scratch_size.value, dtype=np.float64)
+    for i in range(10):
+        row = np.array(mat[i], dtype=np.float32)
+        LIB.LGBM_FrozenBoosterPredictForMatSingleRowNoAlloc(
+            frozen,
+            row.ctypes.data_as(ctypes.POINTER(ctypes.c_void_p)),
+            dtype_float32,
+            mat.shape[1],
+            scratch.ctypes.data_as(ctypes.POINTER(ctypes.c_double)),
+            ctypes.byref(num_preb),
+            preb_frozen.ctypes.data_as(ctypes.POINTER(ctypes.c_double)))
+        np.testing.assert_allclose(preb_frozen[0], preb[i], rtol=1e-5)
+    LIB.LGBM_FrozenBoosterFree(frozen)
     LIB.LGBM_BoosterFree(booster2)
@@ -0,0 +1,121 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Check a model converted with convert_model_language=c against the interpreter of lib_lightgbm.
+ *
+ * Usage: check_compiled_model <model file> <data file>
+ *
+ * The data file is delimited text with the label in the first column, as in the examples.
+ * The compiled model must have been generated from the same model file with the default
+ * prefix, e.g. by the compiled_model target of CMake (-DCOMPILED_MODEL=<model file>).
+ * Returns 1 if any normal or raw score prediction differs.
+ */
+#include <LightGBM/c_api.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+extern "C" {
+int lgbm_model_num_features(void);
+int lgbm_model_num_outputs(void);
+void lgbm_model_predict(const float* data, int64_t num_rows, int32_t num_cols, int is_raw_score, double* output);
+}
+
+#define CHECK_CALL(x) \
+  if ((x) != 0) { \
+    std::fprintf(stderr, "%s failed: %s\n", #x, LGBM_GetLastError()); \
+    std::exit(2); \
+  }
+
+/*! \brief Read rows of the data file without the label, shorter rows are padded with zeros */
+static std::vector<float> ReadRows(const char* filename, int num_cols, int64_t* num_rows) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    std::fprintf(stderr, "cannot open %s\n", filename);
+    std::exit(2);
+  }
+  std::vector<float> data;
+  std::string line;
+  *num_rows = 0;
+  while (std::getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<float> row(num_cols, 0.0f);
+    const char* p = line.c_str();
+    for (int col = -1; col < num_cols; ++col) {
+      const char* field_end = p + std::strcspn(p, "\t, ");
+      if (col >= 0) {
+        // empty fields are missing values, strtod would skip to the next field
+        char* end = nullptr;
+        const double value = p == field_end ? NAN : std::strtod(p, &end);
+        row[col] = end == p ? NAN : static_cast<float>(value);
+      }
+      if (*field_end == '\0') {
+        break;
+      }
+      p = field_end + 1;
+    }
+    data.insert(data.end(), row.begin(), row.end());
+    ++(*num_rows);
+  }
+  return data;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "Usage: %s <model file> <data file>\n", argv[0]);
+    return 2;
+  }
+  BoosterHandle booster;
+  int num_iterations;
+  CHECK_CALL(LGBM_BoosterCreateFromModelfile(argv[1], &num_iterations, &booster));
+  int num_feature;
+  CHECK_CALL(LGBM_BoosterGetNumFeature(booster, &num_feature));
+  if (num_feature != lgbm_model_num_features()) {
+    std::fprintf(stderr, "compiled model has %d features, model file has %d\n",
+                 lgbm_model_num_features(), num_feature);
+    return 1;
+  }
+  int64_t num_rows;
+  const std::vector<float> data = ReadRows(argv[2], num_feature, &num_rows);
+  const int num_outputs = lgbm_model_num_outputs();
+  std::vector<double> expected(num_rows * num_outputs);
+  std::vector<double> result(num_rows * num_outputs);
+
+  bool ok = true;
+  for (int is_raw_score = 0; is_raw_score < 2; ++is_raw_score) {
+    int64_t out_len;
+    CHECK_CALL(LGBM_BoosterPredictForMat(booster, data.data(), C_API_DTYPE_FLOAT32, static_cast<int32_t>(num_rows),
+                                         num_feature, 1, is_raw_score ? C_API_PREDICT_RAW_SCORE : C_API_PREDICT_NORMAL,
+                                         0, -1, "", &out_len, expected.data()));
+    if (out_len != static_cast<int64_t>(expected.size())) {
+      std::fprintf(stderr, "interpreter predicted %lld values, expected %lld\n",
+                   static_cast<long long>(out_len), static_cast<long long>(expected.size()));
+      return 1;
+    }
+    lgbm_model_predict(data.data(), num_rows, num_feature, is_raw_score, result.data());
+    double max_diff = 0.0;
+    int64_t num_diff = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      const double diff = std::fabs(result[i] - expected[i]);
+      max_diff = std::max(max_diff, diff);
+      if (!(diff <= 1e-10 * std::max(1.0, std::fabs(expected[i])))) {
+        ++num_diff;
+      }
+    }
+    std::printf("%s: %lld rows, %lld differences, max difference %g\n", is_raw_score ? "raw score" : "normal",
+                static_cast<long long>(num_rows), static_cast<long long>(num_diff), max_diff);
+    ok = ok && num_diff == 0;
+  }
+  CHECK_CALL(LGBM_BoosterFree(booster));
+  return ok ? 0 : 1;
+}
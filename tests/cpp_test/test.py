@@ -1,6 +1,9 @@
 # coding: utf-8
 import glob
+import sys
 import numpy as np
 
 preds = [np.loadtxt(name) for name in glob.glob('*.pred')]
-np.testing.assert_allclose(preds[0], preds[1])
+# a relative tolerance can be given for models trained by different builds
+rtol = float(sys.argv[1]) if len(sys.argv) > 1 else 1e-7
+np.testing.assert_allclose(preds[0], preds[1], rtol=rtol)
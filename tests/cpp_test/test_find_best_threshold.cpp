@@ -0,0 +1,274 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Checks that FeatureHistogram::FindBestThreshold, whose numerical scans compute the gains by blocks
+ * when there are no random thresholds, monotone constraints, max_delta_step or path smoothing,
+ * finds the same split as the scalar scan it replaced, bit for bit. Random histograms are
+ * scanned with and without lambda_l1, for the three missing types, with and without the most
+ * frequent bin 0 left out, and with more thresholds than one block.
+ *
+ * Returns 1 if any check fails.
+ */
+#include <LightGBM/config.h>
+#include <LightGBM/meta.h>
+#include <LightGBM/tree.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../src/treelearner/feature_histogram.hpp"
+
+using LightGBM::Config;
+using LightGBM::ConstraintEntry;
+using LightGBM::data_size_t;
+using LightGBM::FeatureHistogram;
+using LightGBM::FeatureMetainfo;
+using LightGBM::hist_t;
+using LightGBM::kEpsilon;
+using LightGBM::kMinScore;
+using LightGBM::MissingType;
+using LightGBM::SplitInfo;
+
+static int num_failures = 0;
+
+#define EXPECT(cond, ...) \
+  if (!(cond)) { \
+    std::fprintf(stderr, "%s:%d: %s failed: ", __FILE__, __LINE__, #cond); \
+    std::fprintf(stderr, __VA_ARGS__); \
+    std::fprintf(stderr, "\n"); \
+    ++num_failures; \
+  }
+
+static double LeafGain(double sum_gradient, double sum_hessian, const Config& config) {
+  const double sg = config.lambda_l1 > 0 ? FeatureHistogram::ThresholdL1(sum_gradient, config.lambda_l1) : sum_gradient;
+  return (sg * sg) / (sum_hessian + config.lambda_l2);
+}
+
+/*! \brief The scalar scan of FindBestThresholdSequentially, one gain per threshold */
+static void ScanSequentially(const FeatureMetainfo& meta, const hist_t* data, double sum_gradient,
+                             double sum_hessian, data_size_t num_data, double min_gain_shift,
+                             bool reverse, bool skip_default_bin, bool na_as_missing,
+                             bool* is_splittable, SplitInfo* output) {
+  const Config& config = *meta.config;
+  const int offset = meta.offset;
+  double best_sum_left_gradient = NAN;
+  double best_sum_left_hessian = NAN;
+  double best_gain = kMinScore;
+  data_size_t best_left_count = 0;
+  uint32_t best_threshold = static_cast<uint32_t>(meta.num_bin);
+  const double cnt_factor = num_data / sum_hessian;
+  auto update = [&](double sum_left_gradient, double sum_left_hessian, double sum_right_gradient,
+                    double sum_right_hessian, data_size_t left_count, uint32_t threshold) {
+    const double current_gain = LeafGain(sum_left_gradient, sum_left_hessian, config) +
+                                LeafGain(sum_right_gradient, sum_right_hessian, config);
+    if (current_gain <= min_gain_shift) {
+      return;
+    }
+    *is_splittable = true;
+    if (current_gain > best_gain) {
+      best_left_count = left_count;
+      best_sum_left_gradient = sum_left_gradient;
+      best_sum_left_hessian = sum_left_hessian;
+      best_threshold = threshold;
+      best_gain = current_gain;
+    }
+  };
+  if (reverse) {
+    double sum_right_gradient = 0.0f;
+    double sum_right_hessian = kEpsilon;
+    data_size_t right_count = 0;
+    for (int t = meta.num_bin - 1 - offset - na_as_missing; t >= 1 - offset; --t) {
+      if (skip_default_bin && (t + offset) == static_cast<int>(meta.default_bin)) {
+        continue;
+      }
+      sum_right_gradient += data[2 * t];
+      sum_right_hessian += data[2 * t + 1];
+      right_count += static_cast<data_size_t>(LightGBM::Common::RoundInt(data[2 * t + 1] * cnt_factor));
+      if (right_count < config.min_data_in_leaf || sum_right_hessian < config.min_sum_hessian_in_leaf) {
+        continue;
+      }
+      const data_size_t left_count = num_data - right_count;
+      if (left_count < config.min_data_in_leaf) {
+        break;
+      }
+      const double sum_left_hessian = sum_hessian - sum_right_hessian;
+      if (sum_left_hessian < config.min_sum_hessian_in_leaf) {
+        break;
+      }
+      update(sum_gradient - sum_right_gradient, sum_left_hessian, sum_right_gradient,
+             sum_right_hessian, left_count, static_cast<uint32_t>(t - 1 + offset));
+    }
+  } else {
+    double sum_left_gradient = 0.0f;
+    double sum_left_hessian = kEpsilon;
+    data_size_t left_count = 0;
+    int t = 0;
+    if (na_as_missing && offset == 1) {
+      sum_left_gradient = sum_gradient;
+      sum_left_hessian = sum_hessian - kEpsilon;
+      left_count = num_data;
+      for (int i = 0; i < meta.num_bin - offset; ++i) {
+        sum_left_gradient -= data[2 * i];
+        sum_left_hessian -= data[2 * i + 1];
+        left_count -= static_cast<data_size_t>(LightGBM::Common::RoundInt(data[2 * i + 1] * cnt_factor));
+      }
+      t = -1;
+    }
+    for (; t <= meta.num_bin - 2 - offset; ++t) {
+      if (skip_default_bin && (t + offset) == static_cast<int>(meta.default_bin)) {
+        continue;
+      }
+      if (t >= 0) {
+        sum_left_gradient += data[2 * t];
+        sum_left_hessian += data[2 * t + 1];
+        left_count += static_cast<data_size_t>(LightGBM::Common::RoundInt(data[2 * t + 1] * cnt_factor));
+      }
+      if (left_count < config.min_data_in_leaf || sum_left_hessian < config.min_sum_hessian_in_leaf) {
+        continue;
+      }
+      const data_size_t right_count = num_data - left_count;
+      if (right_count < config.min_data_in_leaf) {
+        break;
+      }
+      const double sum_right_hessian = sum_hessian - sum_left_hessian;
+      if (sum_right_hessian < config.min_sum_hessian_in_leaf) {
+        break;
+      }
+      update(sum_left_gradient, sum_left_hessian, sum_gradient - sum_left_gradient,
+             sum_right_hessian, left_count, static_cast<uint32_t>(t + offset));
+    }
+  }
+  if (*is_splittable && best_gain > output->gain + min_gain_shift) {
+    output->threshold = best_threshold;
+    output->left_count = best_left_count;
+    output->left_sum_gradient = best_sum_left_gradient;
+    output->left_sum_hessian = best_sum_left_hessian - kEpsilon;
+    output->gain = best_gain - min_gain_shift;
+    output->default_left = reverse;
+  }
+}
+
+/*! \brief FindBestThreshold of numerical features with the scalar scans */
+static SplitInfo FindBestThresholdSequentially(const FeatureMetainfo& meta, const hist_t* data,
+                                               double sum_gradient, double sum_hessian,
+                                               data_size_t num_data) {
+  SplitInfo output;
+  output.default_left = true;
+  output.gain = kMinScore;
+  sum_hessian += 2 * kEpsilon;
+  const double min_gain_shift = LeafGain(sum_gradient, sum_hessian, *meta.config) + meta.config->min_gain_to_split;
+  bool is_splittable = false;
+  if (meta.num_bin > 2 && meta.missing_type != MissingType::None) {
+    const bool is_zero = meta.missing_type == MissingType::Zero;
+    ScanSequentially(meta, data, sum_gradient, sum_hessian, num_data, min_gain_shift,
+                     true, is_zero, !is_zero, &is_splittable, &output);
+    ScanSequentially(meta, data, sum_gradient, sum_hessian, num_data, min_gain_shift,
+                     false, is_zero, !is_zero, &is_splittable, &output);
+  } else {
+    ScanSequentially(meta, data, sum_gradient, sum_hessian, num_data, min_gain_shift,
+                     true, false, false, &is_splittable, &output);
+    if (meta.missing_type == MissingType::NaN) {
+      output.default_left = false;
+    }
+  }
+  output.gain *= meta.penalty;
+  return output;
+}
+
+int main() {
+  std::mt19937 gen(0);
+  std::normal_distribution<double> gradient_dist;
+  std::uniform_real_distribution<double> hessian_dist(0.05, 0.25);
+  std::uniform_int_distribution<int> count_dist(0, 12);
+  int num_checks = 0;
+  int num_default_left[2] = {0, 0};
+  Config config;
+  config.max_delta_step = 0.0;
+  config.path_smooth = 0.0;
+  for (double lambda_l1 : {0.0, 0.7}) {
+    for (double lambda_l2 : {0.0, 1.0}) {
+      for (int min_data_in_leaf : {1, 20}) {
+        for (double min_gain_to_split : {0.0, 0.5}) {
+          config.lambda_l1 = lambda_l1;
+          config.lambda_l2 = lambda_l2;
+          config.min_data_in_leaf = min_data_in_leaf;
+          config.min_sum_hessian_in_leaf = 1e-3;
+          config.min_gain_to_split = min_gain_to_split;
+          // thresholds in one block, and in several blocks of 64
+          for (int num_bin : {2, 3, 17, 150}) {
+            for (MissingType missing_type : {MissingType::None, MissingType::Zero, MissingType::NaN}) {
+              for (int offset : {0, 1}) {
+                for (int trial = 0; trial < 8; ++trial) {
+                  FeatureMetainfo meta;
+                  meta.num_bin = num_bin;
+                  meta.missing_type = missing_type;
+                  meta.offset = static_cast<int8_t>(offset);
+                  meta.default_bin = static_cast<uint32_t>(trial % num_bin);
+                  meta.config = &config;
+                  meta.bin_type = LightGBM::BinType::NumericalBin;
+                  // bin 0 is left out of the histogram with offset 1, only its sums are in the totals
+                  double sum_gradient = 0.0;
+                  double sum_hessian = 0.0;
+                  data_size_t num_data = 0;
+                  std::vector<hist_t> data(2 * (num_bin - offset));
+                  for (int bin = 0; bin < num_bin; ++bin) {
+                    const int cnt = trial % 2 == 0 && bin % 5 == 3 ? 0 : count_dist(gen);
+                    const double hessian_per_data = hessian_dist(gen);
+                    const double gradient = cnt * (gradient_dist(gen) + (bin < num_bin / 3 ? 0.5 : -0.2));
+                    const double hessian = cnt * hessian_per_data;
+                    sum_gradient += gradient;
+                    sum_hessian += hessian;
+                    num_data += cnt;
+                    if (bin >= offset) {
+                      data[2 * (bin - offset)] = static_cast<hist_t>(gradient);
+                      data[2 * (bin - offset) + 1] = static_cast<hist_t>(hessian);
+                    }
+                  }
+                  if (num_data == 0) {
+                    continue;
+                  }
+                  const SplitInfo expected = FindBestThresholdSequentially(meta, data.data(), sum_gradient,
+                                                                           sum_hessian, num_data);
+                  FeatureHistogram histogram;
+                  histogram.Init(data.data(), &meta);
+                  SplitInfo output;
+                  histogram.FindBestThreshold(sum_gradient, sum_hessian, num_data, ConstraintEntry(), 0.0, &output);
+                  ++num_checks;
+                  EXPECT(output.gain == expected.gain || (std::isnan(output.gain) && std::isnan(expected.gain)),
+                         "gain %.17g instead of %.17g (num_bin %d, missing type %d, offset %d, l1 %g)",
+                         output.gain, expected.gain, num_bin, static_cast<int>(missing_type), offset, lambda_l1);
+                  if (expected.gain == kMinScore) {
+                    continue;
+                  }
+                  EXPECT(output.threshold == expected.threshold && output.default_left == expected.default_left &&
+                         output.left_count == expected.left_count &&
+                         output.left_sum_gradient == expected.left_sum_gradient &&
+                         output.left_sum_hessian == expected.left_sum_hessian,
+                         "split at %u, default left %d instead of %u, %d (num_bin %d, missing type %d, offset %d, l1 %g)",
+                         output.threshold, output.default_left, expected.threshold, expected.default_left,
+                         num_bin, static_cast<int>(missing_type), offset, lambda_l1);
+                  if (missing_type == MissingType::NaN && num_bin > 2) {
+                    ++num_default_left[expected.default_left];
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  // missing values must go to both sides in some of the splits
+  EXPECT(num_default_left[0] > 0 && num_default_left[1] > 0,
+         "NaN splits with default left %d and default right %d", num_default_left[1], num_default_left[0]);
+  if (num_failures > 0) {
+    std::fprintf(stderr, "%d checks failed\n", num_failures);
+    return 1;
+  }
+  std::printf("all %d splits are the same\n", num_checks);
+  return 0;
+}
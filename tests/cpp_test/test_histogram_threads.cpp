@@ -0,0 +1,238 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Checks the col-wise histograms of Dataset::ConstructHistograms and
+ * Dataset::ConstructHistogramsForLeaves with several numbers of threads. The gradients span many
+ * orders of magnitude, so their sums depend on the order they are added in.
+ * - With few feature groups and many rows, the histograms are constructed by tiles of
+ *   (group, row block) merged afterwards. They must be the same, bit for bit, for the same number
+ *   of threads, and within the rounding errors of the sums for different numbers of threads.
+ * - With many feature groups and many rows, the row blocks are passes over all the groups, and the
+ *   histograms must not depend on the number of threads, bit for bit.
+ * - The histograms of a leaf subtracted from the ones of its parent by FeatureHistogram::Subtract
+ *   must be within the rounding errors of hist_t of the ones constructed directly.
+ *
+ * Returns 1 if any check fails.
+ */
+#include <LightGBM/c_api.h>
+#include <LightGBM/config.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/tree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../../src/treelearner/feature_histogram.hpp"
+
+using LightGBM::Config;
+using LightGBM::data_size_t;
+using LightGBM::Dataset;
+using LightGBM::FeatureHistogram;
+using LightGBM::FeatureMetainfo;
+using LightGBM::hist_acc_t;
+using LightGBM::hist_t;
+using LightGBM::score_t;
+using LightGBM::TrainingShareStates;
+
+static int num_failures = 0;
+
+#define EXPECT(cond, ...) \
+  if (!(cond)) { \
+    std::fprintf(stderr, "%s:%d: %s failed: ", __FILE__, __LINE__, #cond); \
+    std::fprintf(stderr, __VA_ARGS__); \
+    std::fprintf(stderr, "\n"); \
+    ++num_failures; \
+  }
+
+#define CHECK_CALL(x) \
+  if ((x) != 0) { \
+    std::fprintf(stderr, "%s failed: %s\n", #x, LGBM_GetLastError()); \
+    return 2; \
+  }
+
+/*! \brief Histograms of the leaves, the whole data, a part of the rows, and some small leaves */
+static std::vector<std::vector<hist_t>> ConstructAll(const Dataset* dataset, std::vector<score_t>* gradients,
+                                                     std::vector<score_t>* hessians,
+                                                     const std::vector<std::vector<data_size_t>>& leaves,
+                                                     bool is_constant_hessian, int num_threads) {
+  const std::vector<int8_t> is_feature_used(dataset->num_features(), 1);
+  std::unique_ptr<TrainingShareStates> share_state(dataset->GetShareStates(
+      gradients->data(), hessians->data(), is_feature_used, is_constant_hessian, true, false));
+  share_state->num_threads = num_threads;
+  const size_t hist_size = static_cast<size_t>(dataset->NumTotalBin()) * 2;
+  std::vector<std::vector<hist_t>> hists;
+  std::vector<score_t> ordered_gradients(dataset->num_data());
+  std::vector<score_t> ordered_hessians(dataset->num_data());
+  // one leaf at a time
+  hists.emplace_back(hist_size);
+  dataset->ConstructHistograms(is_feature_used, nullptr, dataset->num_data(), gradients->data(),
+                               hessians->data(), ordered_gradients.data(), ordered_hessians.data(),
+                               share_state.get(), hists.back().data());
+  for (const auto& leaf : leaves) {
+    hists.emplace_back(hist_size);
+    dataset->ConstructHistograms(is_feature_used, leaf.data(), static_cast<data_size_t>(leaf.size()),
+                                 gradients->data(), hessians->data(), ordered_gradients.data(),
+                                 ordered_hessians.data(), share_state.get(), hists.back().data());
+  }
+  // all the leaves together, their ordered gradients mustn't overlap
+  std::vector<Dataset::HistogramLeaf> histogram_leaves;
+  const size_t first_batched = hists.size();
+  data_size_t begin = 0;
+  for (const auto& leaf : leaves) {
+    hists.emplace_back(hist_size);
+    histogram_leaves.push_back({&is_feature_used, leaf.data(), static_cast<data_size_t>(leaf.size()),
+                                ordered_gradients.data() + begin, ordered_hessians.data() + begin,
+                                nullptr});
+    begin += static_cast<data_size_t>(leaf.size());
+  }
+  for (size_t i = 0; i < histogram_leaves.size(); ++i) {
+    histogram_leaves[i].hist_data = hists[first_batched + i].data();
+  }
+  dataset->ConstructHistogramsForLeaves(histogram_leaves, gradients->data(), hessians->data(),
+                                        share_state.get());
+  return hists;
+}
+
+/*! \brief Rounding error bound of the sums of the values whose absolute values sum to abs_sum */
+static double ErrorBound(double abs_sum) {
+  return (sizeof(hist_t) == sizeof(float) ? 1e-6 : 1e-12) * abs_sum + 1e-30;
+}
+
+/*!
+* \brief Checks FeatureHistogram::Subtract of the histograms of leaf from the ones of all the data.
+*        The parent, the leaf and the result are each rounded once to hist_t, and the absolute values
+*        of their exact sums add up to at most twice the sums of the absolute values of the parent
+*/
+static void CheckSubtract(const Dataset* dataset, std::vector<score_t>* gradients,
+                          std::vector<score_t>* hessians, std::vector<score_t>* abs_gradients,
+                          const std::vector<data_size_t>& leaf) {
+  std::vector<data_size_t> other_leaf;
+  for (data_size_t i = 0, j = 0; i < dataset->num_data(); ++i) {
+    if (j < static_cast<data_size_t>(leaf.size()) && leaf[j] == i) {
+      ++j;
+    } else {
+      other_leaf.push_back(i);
+    }
+  }
+  const std::vector<std::vector<data_size_t>> leaves = {leaf, other_leaf};
+  auto hists = ConstructAll(dataset, gradients, hessians, leaves, false, 1);
+  const auto abs_sums = ConstructAll(dataset, abs_gradients, hessians, leaves, false, 1);
+  Config config;
+  FeatureMetainfo meta;
+  meta.num_bin = dataset->NumTotalBin();
+  meta.default_bin = 0;
+  meta.config = &config;
+  meta.bin_type = LightGBM::BinType::NumericalBin;
+  FeatureHistogram parent;
+  parent.Init(hists[0].data(), &meta);
+  FeatureHistogram smaller;
+  smaller.Init(hists[1].data(), &meta);
+  parent.Subtract(smaller);
+  int num_errors = 0;
+  for (size_t j = 0; j < hists[0].size(); ++j) {
+    const double error = std::fabs(static_cast<double>(hists[0][j]) - hists[2][j]);
+    const double abs_sum = std::fabs(static_cast<double>(abs_sums[0][j]));
+    // rounding to hist_t, and accumulating the num_data values in hist_acc_t
+    num_errors += error > (std::numeric_limits<hist_t>::epsilon() +
+                           dataset->num_data() * std::numeric_limits<hist_acc_t>::epsilon()) * abs_sum + 1e-30;
+  }
+  EXPECT(num_errors == 0, "%d entries of the subtracted histograms are too far from the constructed ones",
+         num_errors);
+}
+
+/*! \brief Checks the histograms of random data of num_rows rows and num_columns columns */
+static int CheckDataset(int num_rows, int num_columns, bool is_thread_independent) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> uniform;
+  std::uniform_real_distribution<double> exponent(-6.0, 6.0);
+  std::vector<double> rows(static_cast<size_t>(num_rows) * num_columns);
+  for (auto& value : rows) {
+    value = uniform(gen);
+  }
+  std::vector<score_t> gradients(num_rows);
+  std::vector<score_t> hessians(num_rows);
+  std::vector<score_t> abs_gradients(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    gradients[i] = static_cast<score_t>((uniform(gen) - 0.5) * std::pow(10.0, exponent(gen)));
+    hessians[i] = static_cast<score_t>(uniform(gen) * std::pow(10.0, exponent(gen)));
+    abs_gradients[i] = std::fabs(gradients[i]);
+  }
+  // leaves of several sizes, from one row block to many
+  std::vector<data_size_t> permutation(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    permutation[i] = i;
+  }
+  std::shuffle(permutation.begin(), permutation.end(), gen);
+  std::vector<std::vector<data_size_t>> leaves;
+  data_size_t begin = 0;
+  for (data_size_t leaf_size : {100, 3000, 9000, num_rows / 2}) {
+    leaves.emplace_back(permutation.begin() + begin, permutation.begin() + begin + leaf_size);
+    std::sort(leaves.back().begin(), leaves.back().end());
+    begin += leaf_size;
+  }
+
+  DatasetHandle handle;
+  CHECK_CALL(LGBM_DatasetCreateFromMat(rows.data(), C_API_DTYPE_FLOAT64, num_rows, num_columns, 1,
+                                       "force_col_wise=true verbose=-1", nullptr, &handle));
+  const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+  for (bool is_constant_hessian : {false, true}) {
+    const auto expected = ConstructAll(dataset, &gradients, &hessians, leaves, is_constant_hessian, 1);
+    const auto abs_sums = ConstructAll(dataset, &abs_gradients, &hessians, leaves, is_constant_hessian, 1);
+    for (int num_threads : {1, 2, 3, 8}) {
+      const auto hists = ConstructAll(dataset, &gradients, &hessians, leaves, is_constant_hessian, num_threads);
+      for (size_t i = 0; i < leaves.size(); ++i) {
+        EXPECT(std::memcmp(hists[1 + i].data(), hists[1 + leaves.size() + i].data(),
+                           hists[1 + i].size() * sizeof(hist_t)) == 0,
+               "batched histograms of leaf %d differ with %d threads (constant hessian %d)",
+               static_cast<int>(i), num_threads, is_constant_hessian);
+      }
+      const auto again = ConstructAll(dataset, &gradients, &hessians, leaves, is_constant_hessian, num_threads);
+      for (size_t i = 0; i < hists.size(); ++i) {
+        EXPECT(std::memcmp(again[i].data(), hists[i].data(), hists[i].size() * sizeof(hist_t)) == 0,
+               "histograms %d differ between two runs with %d threads (constant hessian %d)",
+               static_cast<int>(i), num_threads, is_constant_hessian);
+        if (is_thread_independent) {
+          EXPECT(std::memcmp(expected[i].data(), hists[i].data(), hists[i].size() * sizeof(hist_t)) == 0,
+                 "histograms %d differ with %d threads (constant hessian %d)", static_cast<int>(i),
+                 num_threads, is_constant_hessian);
+          continue;
+        }
+        int num_errors = 0;
+        for (size_t j = 0; j < hists[i].size(); ++j) {
+          const double error = std::fabs(static_cast<double>(hists[i][j]) - expected[i][j]);
+          num_errors += error > ErrorBound(std::fabs(static_cast<double>(abs_sums[i][j])));
+        }
+        EXPECT(num_errors == 0, "%d entries of histograms %d are too far from 1 thread with %d threads "
+               "(constant hessian %d)", num_errors, static_cast<int>(i), num_threads, is_constant_hessian);
+      }
+    }
+  }
+  CheckSubtract(dataset, &gradients, &hessians, &abs_gradients, leaves.back());
+  CHECK_CALL(LGBM_DatasetFree(handle));
+  return 0;
+}
+
+int main() {
+  // few groups, the tiles of the row blocks are merged
+  if (CheckDataset(100000, 3, false) != 0) {
+    return 2;
+  }
+  // many groups, the row blocks are passes over all the groups
+  if (CheckDataset(300000, 40, true) != 0) {
+    return 2;
+  }
+  if (num_failures > 0) {
+    std::fprintf(stderr, "%d checks failed\n", num_failures);
+    return 1;
+  }
+  std::printf("all histograms are the same\n");
+  return 0;
+}
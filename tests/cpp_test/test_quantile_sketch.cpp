@@ -0,0 +1,200 @@
+/*!
+ * Copyright (c) 2020 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+/*
+ * Checks of QuantileSketch with small capacities, so the summaries are pruned many times:
+ * the total weight, the counts kept exact by pruning, the merges by MergeReducer,
+ * and that the order of merges doesn't change a summary which is not pruned.
+ *
+ * Returns 1 if any check fails.
+ */
+#include <LightGBM/utils/quantile_sketch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using LightGBM::QuantileSketch;
+
+static int num_failures = 0;
+
+#define EXPECT(cond, ...) \
+  if (!(cond)) { \
+    std::fprintf(stderr, "%s:%d: %s failed: ", __FILE__, __LINE__, #cond); \
+    std::fprintf(stderr, __VA_ARGS__); \
+    std::fprintf(stderr, "\n"); \
+    ++num_failures; \
+  }
+
+/*! \brief Random values with repeats, a tenth of them zeros and a twentieth NaNs */
+static std::vector<double> GenerateValues(int num_values, int num_distinct, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> value_dist(-num_distinct / 3, num_distinct - num_distinct / 3);
+  std::uniform_int_distribution<int> kind(0, 19);
+  std::vector<double> values(num_values);
+  for (auto& value : values) {
+    const int k = kind(gen);
+    value = k < 2 ? 0.0 : (k == 2 ? std::numeric_limits<double>::quiet_NaN() : value_dist(gen) * 0.25);
+  }
+  return values;
+}
+
+static QuantileSketch Sketch(const std::vector<double>& values, size_t begin, size_t end, int capacity) {
+  QuantileSketch sketch(capacity);
+  for (size_t i = begin; i < end; ++i) {
+    sketch.Push(values[i]);
+  }
+  sketch.Compact();
+  return sketch;
+}
+
+/*! \brief Number of non-zero values <= bound */
+static int64_t CountUpTo(const std::vector<double>& values, double bound) {
+  int64_t cnt = 0;
+  for (double value : values) {
+    cnt += !std::isnan(value) && std::fabs(value) > LightGBM::kZeroThreshold && value <= bound;
+  }
+  return cnt;
+}
+
+/*!
+* \brief Checks that hold for any summary of values: the number of values, the numbers of NaNs and of negative values,
+*        the min and max values, and that weights only move to larger values, so no prefix is over counted.
+*        If is_exact, the count up to every kept value must be exact.
+*/
+static void CheckSummary(const char* name, const QuantileSketch& sketch, const std::vector<double>& values,
+                         int capacity, bool is_exact) {
+  const auto& kept = sketch.values();
+  const auto& weights = sketch.weights();
+  EXPECT(kept.size() == weights.size() && static_cast<int>(kept.size()) <= capacity,
+         "%s: %d values for capacity %d", name, static_cast<int>(kept.size()), capacity);
+  EXPECT(std::is_sorted(kept.begin(), kept.end()) && std::adjacent_find(kept.begin(), kept.end()) == kept.end(),
+         "%s: values are not sorted and distinct", name);
+  int num_na = 0;
+  double min_value = std::numeric_limits<double>::infinity();
+  double max_value = -std::numeric_limits<double>::infinity();
+  for (double value : values) {
+    if (std::isnan(value)) {
+      ++num_na;
+    } else if (std::fabs(value) > LightGBM::kZeroThreshold) {
+      min_value = std::min(min_value, value);
+      max_value = std::max(max_value, value);
+    }
+  }
+  EXPECT(sketch.na_cnt() == num_na, "%s: %d NaNs instead of %d", name, sketch.na_cnt(), num_na);
+  EXPECT(!kept.empty() && kept.front() == min_value && kept.back() == max_value, "%s: min or max value is lost", name);
+  int64_t total_weight = 0;
+  for (size_t i = 0; i < kept.size(); ++i) {
+    total_weight += weights[i];
+    const int64_t cnt = CountUpTo(values, kept[i]);
+    if (is_exact || i + 1 == kept.size() || (kept[i] < 0 && kept[i + 1] > 0)) {
+      EXPECT(total_weight == cnt, "%s: %lld values up to %g instead of %lld", name,
+             static_cast<long long>(total_weight), kept[i], static_cast<long long>(cnt));
+    } else {
+      EXPECT(total_weight <= cnt, "%s: %lld values up to %g, more than %lld", name,
+             static_cast<long long>(total_weight), kept[i], static_cast<long long>(cnt));
+    }
+  }
+  EXPECT(total_weight == CountUpTo(values, max_value), "%s: total weight %lld", name,
+         static_cast<long long>(total_weight));
+}
+
+static bool IsSame(const QuantileSketch& a, const QuantileSketch& b) {
+  return a.values() == b.values() && a.weights() == b.weights() && a.na_cnt() == b.na_cnt();
+}
+
+static void TestPrune(int capacity) {
+  const std::vector<double> values = GenerateValues(20000, 1000, capacity);
+  CheckSummary("pushed", Sketch(values, 0, values.size(), capacity), values, capacity, false);
+  // values pushed in increasing order are never merged below kept values, so every prefix count stays exact
+  std::vector<double> sorted_values = values;
+  std::sort(sorted_values.begin(), sorted_values.end(), [] (double a, double b) {
+    return !std::isnan(a) && (std::isnan(b) || a < b);
+  });
+  CheckSummary("pushed in order", Sketch(sorted_values, 0, sorted_values.size(), capacity),
+               sorted_values, capacity, true);
+}
+
+static void TestMergeReducer(int capacity) {
+  const std::vector<double> values = GenerateValues(30000, 1000, 100 + capacity);
+  const size_t num_parts = 3;
+  const size_t part_size = values.size() / num_parts;
+  const int num_features = 2;
+  const int type_size = QuantileSketch::SizesInByte(capacity);
+  // each part holds two features, the second is the negated values
+  std::vector<double> negated_values(values.size());
+  std::transform(values.begin(), values.end(), negated_values.begin(), [] (double v) { return -v; });
+  std::vector<std::vector<char>> buffers(num_parts, std::vector<char>(static_cast<size_t>(type_size) * num_features));
+  for (size_t part = 0; part < num_parts; ++part) {
+    Sketch(values, part * part_size, (part + 1) * part_size, capacity).CopyTo(buffers[part].data());
+    Sketch(negated_values, part * part_size, (part + 1) * part_size, capacity).CopyTo(buffers[part].data() + type_size);
+  }
+  for (size_t part = 1; part < num_parts; ++part) {
+    QuantileSketch::MergeReducer(buffers[part].data(), buffers[0].data(), type_size,
+                                 static_cast<LightGBM::comm_size_t>(buffers[0].size()));
+  }
+  QuantileSketch merged(capacity);
+  merged.CopyFrom(buffers[0].data());
+  CheckSummary("reduced", merged, values, capacity, false);
+  merged.CopyFrom(buffers[0].data() + type_size);
+  CheckSummary("reduced negated", merged, negated_values, capacity, false);
+}
+
+static void TestMergeOrder() {
+  // fewer distinct values than the capacity, so no summary is pruned
+  const int capacity = 64;
+  const std::vector<double> values = GenerateValues(5000, capacity - 1, 7);
+  const size_t bounds[] = {0, 700, 2500, 2600, values.size()};
+  std::vector<QuantileSketch> parts;
+  for (size_t i = 0; i + 1 < sizeof(bounds) / sizeof(bounds[0]); ++i) {
+    parts.push_back(Sketch(values, bounds[i], bounds[i + 1], capacity));
+  }
+  const QuantileSketch all = Sketch(values, 0, values.size(), capacity);
+  CheckSummary("all", all, values, capacity, true);
+  QuantileSketch forward(capacity);
+  for (const auto& part : parts) {
+    forward.Merge(part);
+  }
+  QuantileSketch backward(capacity);
+  for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+    backward.Merge(*it);
+  }
+  // ((p0 + p1) + (p2 + p3)), as done by the reduce scatter of machines
+  QuantileSketch left = parts[0];
+  left.Merge(parts[1]);
+  QuantileSketch right = parts[2];
+  right.Merge(parts[3]);
+  right.Merge(left);
+  const int type_size = QuantileSketch::SizesInByte(capacity);
+  std::vector<char> src(type_size);
+  std::vector<char> dst(type_size);
+  parts[3].CopyTo(dst.data());
+  for (int i = 2; i >= 0; --i) {
+    parts[i].CopyTo(src.data());
+    QuantileSketch::MergeReducer(src.data(), dst.data(), type_size, type_size);
+  }
+  QuantileSketch reduced(capacity);
+  reduced.CopyFrom(dst.data());
+  EXPECT(IsSame(all, forward), "merging in order differs from pushing all values");
+  EXPECT(IsSame(all, backward), "merging in reverse order differs from pushing all values");
+  EXPECT(IsSame(all, right), "merging in a tree differs from pushing all values");
+  EXPECT(IsSame(all, reduced), "MergeReducer differs from pushing all values");
+}
+
+int main() {
+  for (int capacity : {8, 64}) {
+    TestPrune(capacity);
+    TestMergeReducer(capacity);
+  }
+  TestMergeOrder();
+  if (num_failures > 0) {
+    std::fprintf(stderr, "%d checks failed\n", num_failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}
@@ -20,6 +20,12 @@ try:
 except ImportError:
     import pickle
 
+try:
+    import pyarrow as pa
+    PYARROW_INSTALLED = True
+except ImportError:
+    PYARROW_INSTALLED = False
+
 
 decreasing_generator = itertools.count(0, -1)
 
@@ -74,6 +80,59 @@ class TestEngine(unittest.TestCase):
         self.assertEqual(len(evals_result['valid_0']['binary_logloss']), 50)
         self.assertAlmostEqual(evals_result['valid_0']['binary_logloss'][-1], ret, places=5)
 
+    def test_quantized_grad(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        X_train, X_test, y_train, y_test = train_test_split(X, y, test_size=0.1, random_state=42)
+        params = {
+            'objective': 'binary',
+            'verbose': -1,
+            'use_quantized_grad': True
+        }
+        for extra_params in ({}, {'force_row_wise': True}, {'bagging_fraction': 0.5, 'bagging_freq': 1},
+                             {'num_grad_quant_bins': 64, 'stochastic_rounding': False}):
+            gbm = lgb.train(dict(params, **extra_params), lgb.Dataset(X_train, y_train), num_boost_round=50)
+            self.assertLess(log_loss(y_test, gbm.predict(X_test)), 0.15)
+        # random rounding doesn't depend on the number of threads
+        preds = [lgb.train(dict(params, num_threads=num_threads), lgb.Dataset(X_train, y_train),
+                           num_boost_round=10).predict(X_test) for num_threads in (1, 4)]
+        np.testing.assert_array_equal(preds[0], preds[1])
+
+        # gradients and hessians which are already quantized give the same trees as without quantization
+        def sign_objective(preds, train_data):
+            return np.sign(preds - train_data.get_label()), np.ones_like(preds)
+
+        X = np.random.RandomState(0).rand(20000, 10)
+        X[X < 0.7] = 0
+        y = X[:, 0] * 3 + X[:, 1] - X[:, 2] * 2
+        params = {
+            'verbose': -1,
+            'num_grad_quant_bins': 2,
+            'min_data_in_leaf': 5
+        }
+        for data in (X, csr_matrix(X)):
+            for extra_params in ({}, {'force_row_wise': True}, {'bagging_fraction': 0.5, 'bagging_freq': 1}):
+                preds = [lgb.train(dict(params, use_quantized_grad=use_quantized_grad, **extra_params),
+                                   lgb.Dataset(data, y), num_boost_round=10, fobj=sign_objective).predict(X)
+                         for use_quantized_grad in (False, True)]
+                np.testing.assert_allclose(preds[0], preds[1])
+
+    def test_bagging_subset_multi_val(self):
+        rng = np.random.RandomState(7)
+        X = rng.randint(0, 4, size=(4000, 200)) * (rng.rand(4000, 200) < 0.05).astype(np.float64)
+        y = (X[:, :10].sum(axis=1) + rng.rand(4000) > 1.5).astype(float)
+        X_train, X_test, y_train, y_test = train_test_split(X, y, test_size=0.1, random_state=42)
+        params = {'objective': 'binary',
+                  'bagging_fraction': 0.3,
+                  'bagging_freq': 1,
+                  'verbose': -1}
+        # the rows of the bagging subset are read from the full data, or copied with a subset of columns
+        for extra_params in ({'force_row_wise': True}, {'force_col_wise': True},
+                             {'force_row_wise': True, 'feature_fraction': 0.3},
+                             {'force_row_wise': True, 'use_quantized_grad': True}):
+            gbm = lgb.train(dict(params, **extra_params), lgb.Dataset(csr_matrix(X_train), y_train),
+                            num_boost_round=50)
+            self.assertLess(log_loss(y_test, gbm.predict(csr_matrix(X_test))), 0.3)
+
     def test_rf(self):
         X, y = load_breast_cancer(return_X_y=True)
         X_train, X_test, y_train, y_test = train_test_split(X, y, test_size=0.1, random_state=42)
@@ -840,6 +899,53 @@ class TestEngine(unittest.TestCase):
         for ret in other_ret:
             self.assertAlmostEqual(ret_origin, ret, places=5)
 
+    def test_save_load_binary(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        X[::5, 0] = np.nan
+        X[::7, 1] = 0
+        X[:, 2] = np.random.RandomState(0).randint(0, 10, X.shape[0])
+        X_train, X_test, y_train, _ = train_test_split(X, y, test_size=0.1, random_state=42)
+        params = {
+            'objective': 'binary',
+            'verbose': -1
+        }
+        lgb_train = lgb.Dataset(X_train, y_train, categorical_feature=[2])
+        gbm = lgb.train(params, lgb_train, num_boost_round=20)
+        gbm.save_model('lgb_binary.model', binary=True)
+        gbm_load = lgb.Booster(model_file='lgb_binary.model')
+        self.assertEqual(gbm.model_to_string(), gbm_load.model_to_string())
+        np.testing.assert_array_equal(gbm.predict(X_test), gbm_load.predict(X_test))
+        np.testing.assert_array_equal(gbm.predict(X_test, pred_contrib=True),
+                                      gbm_load.predict(X_test, pred_contrib=True))
+        np.testing.assert_array_equal(gbm.predict(X_test, start_iteration=5, num_iteration=10),
+                                      gbm_load.predict(X_test, start_iteration=5, num_iteration=10))
+        # trees are read from the file only when something else than prediction needs them
+        gbm_load = lgb.Booster(model_file='lgb_binary.model')
+        np.testing.assert_array_equal(gbm.predict(X_test), gbm_load.predict(X_test))
+        np.testing.assert_array_equal(gbm.feature_importance(), gbm_load.feature_importance())
+        self.assertEqual(gbm.dump_model(), gbm_load.dump_model())
+        # packed trees with a child out of its tree are rebuilt from the trees
+        with open('lgb_binary.model', 'rb') as f:
+            model_bytes = bytearray(f.read())
+        header_offset = len(b'______LightGBM_Binary_Model_Token______\n') + 8
+        flat_forest_offset = int(np.frombuffer(model_bytes, dtype=np.uint64, count=1, offset=header_offset + 16)[0])
+        # left child of the root of the first tree, after the 32 bytes header and the threshold and split feature
+        left_child_offset = flat_forest_offset + 32 + 12
+        model_bytes[left_child_offset:left_child_offset + 4] = np.array([1 << 30], dtype=np.int32).tobytes()
+        with open('lgb_binary.model', 'wb') as f:
+            f.write(model_bytes)
+        gbm_load = lgb.Booster(model_file='lgb_binary.model')
+        np.testing.assert_array_equal(gbm.predict(X_test), gbm_load.predict(X_test))
+        # subset of iterations, and continued training
+        gbm.save_model('lgb_binary.model', binary=True, start_iteration=5, num_iteration=10)
+        gbm_load = lgb.Booster(model_file='lgb_binary.model')
+        self.assertEqual(gbm_load.current_iteration(), 10)
+        np.testing.assert_allclose(gbm.predict(X_test, start_iteration=5, num_iteration=10, raw_score=True),
+                                   gbm_load.predict(X_test, raw_score=True))
+        gbm_continued = lgb.train(params, lgb.Dataset(X_train, y_train, categorical_feature=[2]),
+                                  num_boost_round=5, init_model='lgb_binary.model')
+        self.assertEqual(gbm_continued.current_iteration(), 15)
+
     @unittest.skipIf(not lgb.compat.PANDAS_INSTALLED, 'pandas is not installed')
     def test_pandas_categorical(self):
         import pandas as pd
@@ -1017,6 +1123,60 @@ class TestEngine(unittest.TestCase):
         # validate the values are the same
         np.testing.assert_allclose(contribs_csc.toarray(), contribs_dense)
 
+    def test_block_prediction_paths(self):
+        rng = np.random.RandomState(0)
+        num_data = 2000
+        X = rng.randn(num_data, 4)
+        X[rng.rand(num_data) < 0.2, 0] = np.nan
+        X[rng.rand(num_data) < 0.3, 1] = 0
+        X[rng.rand(num_data) < 0.1, 2] = np.nan
+        X[rng.rand(num_data) < 0.1, 2] = 0
+        y = np.nan_to_num(X[:, 0], nan=1.) + X[:, 1] + (X[:, 1] == 0) + np.isnan(X[:, 2]) + rng.rand(num_data)
+        X_test = X.copy()
+        X_test[::7, 1] = 1e-40  # treated as zero
+        X_test[::11, 3] = np.nan  # NaN in a feature without missing values in training, treated as zero
+        X_test[::13, 3] = np.inf
+        X_test[::17, 3] = -np.inf
+        # missing types NaN, Zero and None
+        for extra_params in ({}, {'zero_as_missing': True}, {'use_missing': False}):
+            params = dict({'objective': 'regression', 'num_leaves': 31, 'verbose': -1}, **extra_params)
+            gbm = lgb.train(params, lgb.Dataset(X, y), num_boost_round=20)
+            # values on thresholds go left
+            for tree in gbm.dump_model()['tree_info'][:5]:
+                node = tree['tree_structure']
+                X_test[rng.randint(num_data), node['split_feature']] = node['threshold']
+            # blocks of 16 records or more are routed by the AVX-512 kernel if the CPU has it,
+            # smaller blocks by the scalar loop, both must give the same bits
+            expected = np.concatenate([gbm.predict(X_test[i:i + 15], raw_score=True)
+                                       for i in range(0, num_data, 15)])
+            np.testing.assert_array_equal(gbm.predict(X_test, raw_score=True), expected)
+            np.testing.assert_array_equal(gbm.predict(X_test[:16], raw_score=True), expected[:16])
+
+    def test_contribs_blocks(self):
+        np.random.seed(0)
+        X = np.random.rand(500, 8)
+        X[X < 0.05] = 0
+        X[:, 2] = np.random.randint(0, 6, 500)
+        y = np.random.randint(0, 2, 500)
+        params = {
+            'objective': 'binary',
+            'num_leaves': 31,
+            'min_data_in_leaf': 3,
+            'verbose': -1
+        }
+        lgb_train = lgb.Dataset(X, y, categorical_feature=[2])
+        gbm = lgb.train(params, lgb_train, num_boost_round=10)
+        # sparse output goes through the sparse implementation, one record at a time
+        expected = gbm.predict(csr_matrix(X), pred_contrib=True).toarray()
+        for num_rows in [1, 5, 40, 500]:
+            for num_threads in [1, 4]:
+                contribs = gbm.predict(X[:num_rows], pred_contrib=True, num_threads=num_threads)
+                np.testing.assert_allclose(contribs, expected[:num_rows], rtol=1e-9, atol=1e-12)
+        contribs = gbm.predict(X, pred_contrib=True, start_iteration=2, num_iteration=5)
+        np.testing.assert_allclose(np.sum(contribs, axis=1),
+                                   gbm.predict(X, raw_score=True, start_iteration=2, num_iteration=5),
+                                   rtol=1e-9, atol=1e-12)
+
     @unittest.skipIf(psutil.virtual_memory().available / 1024 / 1024 / 1024 < 3, 'not enough RAM')
     def test_int32_max_sparse_contribs(self):
         params = {
@@ -1127,6 +1287,145 @@ class TestEngine(unittest.TestCase):
         self.assertEqual(subset_data_3.get_data(), "lgb_train_data.bin")
         self.assertEqual(subset_data_4.get_data(), "lgb_train_data.bin")
 
+    def test_binary_dataset_mmap(self):
+        rng = np.random.RandomState(42)
+        X = np.hstack([rng.randn(2000, 5), rng.randint(0, 5, size=(2000, 2)),
+                       rng.randint(0, 4, size=(2000, 60)) * (rng.rand(2000, 60) < 0.05)]).astype(np.float64)
+        X[::7, 0] = np.nan
+        y = (X[:, 0] + X[:, 5] + X[:, 7:12].sum(axis=1) > 1).astype(float)
+        bin_filename = 'lgb_mmap_data.bin'
+        lgb.Dataset(X, y).save_binary(bin_filename)
+        params = {'objective': 'binary', 'num_leaves': 15, 'verbose': -1}
+        for extra_params in ({}, {'force_row_wise': True}, {'bagging_fraction': 0.3, 'bagging_freq': 1}):
+            models = [lgb.train(dict(params, **extra_params),
+                                lgb.Dataset(bin_filename, params={'mmap_binary_file': mmap_binary_file}),
+                                num_boost_round=10).model_to_string()
+                      for mmap_binary_file in (True, False)]
+            self.assertEqual(models[0], models[1])
+        # the data read in place are saved as they are
+        resaved_filename = 'lgb_mmap_data_resaved.bin'
+        lgb.Dataset(bin_filename, params={'mmap_binary_file': True}).construct().save_binary(resaved_filename)
+        with open(bin_filename, 'rb') as f, open(resaved_filename, 'rb') as f_resaved:
+            self.assertEqual(f.read(), f_resaved.read())
+        os.remove(resaved_filename)
+        os.remove(bin_filename)
+
+    def test_stream_loading(self):
+        rng = np.random.RandomState(42)
+        num_data = 600000  # larger than one read buffer, so the dataset grows while loading
+        X = np.column_stack([rng.randint(0, 4, size=num_data), rng.randint(0, 50, size=num_data) / 10.,
+                             rng.randint(0, 3, size=num_data) * (rng.rand(num_data) < 0.1)])
+        y = (X[:, 0] + X[:, 1] + X[:, 2] + rng.rand(num_data) > 4).astype(int)
+        weight = rng.randint(1, 3, size=num_data)
+        data_filename = 'lgb_stream_data.csv'
+        np.savetxt(data_filename, np.column_stack([y, weight, X]), fmt='%g', delimiter=',')
+        params = {'objective': 'binary', 'num_leaves': 7, 'verbose': -1}
+        datasets = [lgb.Dataset(data_filename, params={'stream_loading': stream_loading,
+                                                       'stream_first_chunk_size': 1000,
+                                                       'weight_column': 0}).construct()
+                    for stream_loading in (False, True)]
+        self.assertEqual(datasets[1].num_data(), num_data)
+        np.testing.assert_array_equal(datasets[0].get_label(), datasets[1].get_label())
+        np.testing.assert_array_equal(datasets[0].get_weight(), datasets[1].get_weight())
+        # all distinct values are in the first chunk, so the bins are the same
+        models = [lgb.train(params, dataset, num_boost_round=5).model_to_string() for dataset in datasets]
+        self.assertEqual(models[0], models[1])
+        os.remove(data_filename)
+
+    def test_text_parsing_rounding(self):
+        rng = np.random.RandomState(42)
+        num_data = 1000
+        X = rng.rand(num_data, 2)
+        y = rng.randint(0, 2, size=num_data)
+        init_score = rng.choice([-1, 1], size=num_data) * 10. ** rng.uniform(-300, 300, size=num_data)
+        init_score[:100] = rng.randn(100)
+        data_filename = 'lgb_parse_data.csv'
+        np.savetxt(data_filename, np.column_stack([y, X]), delimiter=',')
+        # shortest round trip, fixed precision and more digits than double holds
+        init_score_str = [fmt % v for v, fmt in zip(init_score.tolist(), itertools.cycle(['%r', '%.18e', '%.30e']))]
+        with open(data_filename + '.init', 'w') as f:
+            f.write('\n'.join(init_score_str) + '\n')
+        dataset = lgb.Dataset(data_filename).construct()
+        # values are correctly rounded
+        np.testing.assert_array_equal(dataset.get_init_score(), [float(v) for v in init_score_str])
+        os.remove(data_filename + '.init')
+        os.remove(data_filename)
+
+    def test_quantile_sketch(self):
+        rng = np.random.RandomState(42)
+        num_data = 20000
+        X = np.column_stack([np.round(rng.lognormal(0, 2, size=num_data), 2), rng.randint(-10, 10, size=num_data),
+                             np.where(rng.rand(num_data) < 0.1, np.nan, np.round(rng.randn(num_data), 2))])
+        y = (np.log1p(X[:, 0]) + X[:, 1] * 0.1 + rng.rand(num_data) > 2).astype(int)
+        data_filename = 'lgb_sketch_data.csv'
+        np.savetxt(data_filename, np.column_stack([y, X]), delimiter=',')
+        params = {'objective': 'binary', 'num_leaves': 7, 'verbose': -1}
+
+        def train_model(dataset_params):
+            dataset = lgb.Dataset(data_filename, params=dataset_params)
+            return lgb.train(params, dataset, num_boost_round=5).model_to_string().split('parameters:')[0]
+
+        # features have fewer distinct values than the sketch size, so the bins are the same as from all data
+        full_model = train_model({'bin_construct_sample_cnt': num_data})
+        for two_round in (False, True):
+            sketch_model = train_model({'bin_construct_sample_cnt': 100, 'use_quantile_sketch': True,
+                                        'two_round': two_round})
+            self.assertEqual(full_model, sketch_model)
+        # categories are never merged by a small sketch, categorical features use the sample
+        X = np.column_stack([rng.randint(0, 40, size=num_data), rng.randint(-3, 4, size=num_data)])
+        y = ((X[:, 0] % 3 == 0) + X[:, 1] * 0.2 + rng.rand(num_data) > 1).astype(int)
+        np.savetxt(data_filename, np.column_stack([y, X]), delimiter=',')
+        full_model = train_model({'bin_construct_sample_cnt': num_data, 'categorical_feature': 0})
+        sketch_model = train_model({'bin_construct_sample_cnt': num_data, 'categorical_feature': 0,
+                                    'use_quantile_sketch': True, 'quantile_sketch_size': 8})
+        self.assertEqual(full_model, sketch_model)
+        os.remove(data_filename)
+
+    @unittest.skipIf(not PYARROW_INSTALLED, 'pyarrow is not installed')
+    def test_arrow_file(self):
+        rng = np.random.RandomState(42)
+        num_data = 3000
+        X = np.column_stack([rng.rand(num_data), rng.rand(num_data), rng.randint(0, 10, size=num_data),
+                             rng.rand(num_data) < 0.3])
+        X[rng.rand(num_data) < 0.1, 1] = np.nan
+        y = X[:, 0] * 3 + X[:, 2] * 0.2 + X[:, 3] + rng.rand(num_data) * 0.1
+        table = pa.table({'label': y, 'f0': X[:, 0], 'f1': pa.array(X[:, 1], mask=np.isnan(X[:, 1])),
+                          'f2': X[:, 2].astype(np.int16), 'f3': X[:, 3].astype(bool),
+                          'id': [str(i) for i in range(num_data)]})
+        arrow_filename = 'lgb_data.arrow'
+        csv_filename = 'lgb_data.csv'
+        with pa.OSFile(arrow_filename, 'wb') as sink, pa.ipc.new_file(sink, table.schema) as writer:
+            writer.write_table(table, max_chunksize=1000)
+        np.savetxt(csv_filename, np.column_stack([y, X, np.zeros(num_data)]), delimiter=',', fmt='%.17g',
+                   header='label,f0,f1,f2,f3,id', comments='')
+        params = {'objective': 'regression', 'num_leaves': 15, 'verbose': -1, 'ignore_column': 'name:id'}
+        arrow_data = lgb.Dataset(arrow_filename, params=params).construct()
+        csv_data = lgb.Dataset(csv_filename, params=dict(params, header=True)).construct()
+        self.assertListEqual(arrow_data.get_feature_name(), ['f0', 'f1', 'f2', 'f3', 'id'])
+        np.testing.assert_array_equal(arrow_data.get_label(), csv_data.get_label())
+        # values are read exactly, so the models are the same
+        evals_result = {}
+        arrow_model = lgb.train(params, arrow_data, num_boost_round=10,
+                                valid_sets=[lgb.Dataset(arrow_filename, reference=arrow_data)],
+                                evals_result=evals_result, verbose_eval=False)
+        csv_model = lgb.train(params, csv_data, num_boost_round=10)
+        self.assertEqual(arrow_model.model_to_string().split('parameters:')[0],
+                         csv_model.model_to_string().split('parameters:')[0])
+        pred = arrow_model.predict(np.column_stack([X, np.zeros(num_data)]))
+        self.assertAlmostEqual(evals_result['valid_0']['l2'][-1], mean_squared_error(y, pred), places=5)
+        # columns of unsupported types must be ignored
+        self.assertRaises(lgb.basic.LightGBMError, lgb.Dataset(arrow_filename).construct)
+        # validation data must have the columns of the features used by training data
+        narrow_filename = 'lgb_data_narrow.arrow'
+        narrow_table = table.select(['label', 'f0', 'f1'])
+        with pa.OSFile(narrow_filename, 'wb') as sink, pa.ipc.new_file(sink, narrow_table.schema) as writer:
+            writer.write_table(narrow_table)
+        self.assertRaises(lgb.basic.LightGBMError,
+                          lgb.Dataset(narrow_filename, params=params, reference=arrow_data).construct)
+        os.remove(arrow_filename)
+        os.remove(csv_filename)
+        os.remove(narrow_filename)
+
     def generate_trainset_for_monotone_constraints_tests(self, x3_to_category=True):
         number_of_dpoints = 3000
         x1_positively_correlated_with_y = np.random.random(size=number_of_dpoints)
@@ -2278,6 +2577,134 @@ class TestEngine(unittest.TestCase):
         err_new = mean_squared_error(y, predicted_new)
         self.assertLess(err, err_new)
 
+    def test_compressed_histogram_pool(self):
+        # histograms evicted from a small pool are restored, so trees are the same as with an unlimited pool
+        X, y = load_breast_cancer(return_X_y=True)
+        params = {'objective': 'binary',
+                  'num_leaves': 63,
+                  'min_data_in_leaf': 5,
+                  'verbose': -1}
+        preds = [lgb.train(dict(params, **extra_params), lgb.Dataset(X, y), num_boost_round=10).predict(X)
+                 for extra_params in ({},
+                                      {'histogram_pool_size': 0.001, 'compressed_histogram_pool_size': -1},
+                                      {'histogram_pool_size': 0.001, 'compressed_histogram_pool_size': -1,
+                                       'force_row_wise': True})]
+        np.testing.assert_array_equal(preds[0], preds[1])
+        np.testing.assert_array_equal(preds[0], preds[2])
+
+    def test_small_histogram_pool(self):
+        # the histograms of both leaves are constructed when the parent one was evicted from the pool,
+        # the larger leaf mustn't reuse the gradients gathered for the smaller one
+        X, y = load_breast_cancer(return_X_y=True)
+        params = {'objective': 'binary',
+                  'num_leaves': 63,
+                  'min_data_in_leaf': 5,
+                  'force_col_wise': True,
+                  'compressed_histogram_pool_size': 0,
+                  'verbose': -1}
+        for extra_params in ({}, {'bagging_fraction': 0.5, 'bagging_freq': 1}):
+            preds = [lgb.train(dict(params, histogram_pool_size=pool_size, **extra_params),
+                               lgb.Dataset(X, y), num_boost_round=10).predict(X)
+                     for pool_size in (-1, 0.001)]
+            np.testing.assert_allclose(preds[0], preds[1], rtol=1e-6)
+
+    def test_leaf_batch_size(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        X_train, X_test, y_train, y_test = train_test_split(X, y, test_size=0.1, random_state=42)
+        params = {'objective': 'binary',
+                  'metric': 'binary_logloss',
+                  'num_leaves': 31,
+                  'min_data_in_leaf': 5,
+                  'force_col_wise': True,
+                  'verbose': -1}
+        lgb_train = lgb.Dataset(X_train, y_train)
+        for extra_params in ({}, {'objective': 'regression'}):
+            bst = lgb.train(dict(params, leaf_batch_size=8, **extra_params), lgb_train, num_boost_round=20)
+            self.assertEqual(bst.dump_model()['tree_info'][-1]['num_leaves'], 31)
+            ret = log_loss(y_test, np.clip(bst.predict(X_test), 1e-15, 1 - 1e-15))
+            self.assertLess(ret, 0.2)
+
+    def test_leaf_batch_size_same_trees(self):
+        # num_leaves doesn't limit trees of max_depth levels, which then have the same splits whatever
+        # order their leaves are split in, so batches of leaves must find the same trees as one leaf at a time
+        rng = np.random.RandomState(42)
+        X_sparse = rng.rand(2000, 30) * (rng.rand(2000, 30) < 0.1)
+        y_sparse = (X_sparse[:, :10].sum(axis=1) + 0.1 * rng.rand(2000) > 0.5).astype(int)
+        params = {'objective': 'binary',
+                  'num_leaves': 8,
+                  'max_depth': 3,
+                  'min_data_in_leaf': 1,
+                  'min_sum_hessian_in_leaf': 0,
+                  'force_col_wise': True,
+                  'verbose': -1}
+        # dense bins only, then sparse features in a multi-val group
+        for X, y in (load_breast_cancer(return_X_y=True), (csr_matrix(X_sparse), y_sparse)):
+            models = [lgb.train(dict(params, leaf_batch_size=leaf_batch_size), lgb.Dataset(X, y), num_boost_round=10)
+                      for leaf_batch_size in (1, 8)]
+            for tree, tree_batched in zip(models[0].dump_model()['tree_info'], models[1].dump_model()['tree_info']):
+                self.assertGreater(tree['num_leaves'], 4)
+                self.assertEqual(tree['num_leaves'], tree_batched['num_leaves'])
+            np.testing.assert_allclose(models[0].predict(X), models[1].predict(X), rtol=1e-10)
+
+    def test_oblivious_tree(self):
+
+        def _check_levels(node, depth, splits):
+            if 'split_index' not in node:
+                return
+            splits.setdefault(depth, set()).add((node['split_feature'], node['threshold'], node['decision_type']))
+            _check_levels(node['left_child'], depth + 1, splits)
+            _check_levels(node['right_child'], depth + 1, splits)
+
+        X, y = load_breast_cancer(return_X_y=True)
+        X[::7, 3] = np.nan
+        X_train, X_test, y_train, y_test = train_test_split(X, y, test_size=0.1, random_state=42)
+        params = {'objective': 'binary',
+                  'metric': 'binary_logloss',
+                  'tree_growth_policy': 'oblivious',
+                  'num_leaves': 20,
+                  'min_data_in_leaf': 5,
+                  'verbose': -1}
+        bst = lgb.train(params, lgb.Dataset(X_train, y_train), num_boost_round=30)
+        ret = log_loss(y_test, bst.predict(X_test))
+        self.assertLess(ret, 0.2)
+        for tree in bst.dump_model()['tree_info']:
+            # depth 4 is the largest one with no more than 20 leaves
+            self.assertEqual(tree['num_leaves'], 16)
+            splits = {}
+            _check_levels(tree['tree_structure'], 0, splits)
+            self.assertTrue(all(len(level_splits) == 1 for level_splits in splits.values()))
+        bst_loaded = lgb.Booster(model_str=bst.model_to_string())
+        np.testing.assert_array_equal(bst.predict(X_test), bst_loaded.predict(X_test))
+        self.assertRaises(lgb.basic.LightGBMError, lgb.train,
+                          dict(params, monotone_constraints=[1] + [0] * (X.shape[1] - 1)),
+                          lgb.Dataset(X_train, y_train), num_boost_round=1)
+
+    def test_oblivious_tree_contribs(self):
+
+        def _leaf_counts(node):
+            if 'split_index' not in node:
+                return [node['leaf_count']]
+            return _leaf_counts(node['left_child']) + _leaf_counts(node['right_child'])
+
+        X, y = load_breast_cancer(return_X_y=True)
+        X[::7, 3] = np.nan
+        params = {'objective': 'binary',
+                  'tree_growth_policy': 'oblivious',
+                  'num_leaves': 64,
+                  'min_data_in_leaf': 5,
+                  'verbose': -1}
+        bst = lgb.train(params, lgb.Dataset(X, y), num_boost_round=10)
+        # deep oblivious trees have nodes without training data
+        self.assertIn(0, [leaf_count for tree in bst.dump_model()['tree_info']
+                          for leaf_count in _leaf_counts(tree['tree_structure'])])
+        raw_score = bst.predict(X, raw_score=True)
+        contribs = bst.predict(X, pred_contrib=True)
+        self.assertFalse(np.isnan(contribs).any())
+        np.testing.assert_allclose(np.sum(contribs, axis=1), raw_score, rtol=1e-9, atol=1e-12)
+        contribs_csr = bst.predict(csr_matrix(X), pred_contrib=True).toarray()
+        self.assertFalse(np.isnan(contribs_csr).any())
+        np.testing.assert_allclose(contribs_csr, contribs, rtol=1e-9, atol=1e-12)
+
     @unittest.skipIf(not lgb.compat.PANDAS_INSTALLED, 'pandas is not installed')
     def test_trees_to_dataframe(self):
 